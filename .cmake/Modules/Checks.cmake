@@ -9,6 +9,7 @@ check_include_file (stdlib.h HAVE_STDLIB_H)
 check_include_file (strings.h HAVE_STRINGS_H)
 check_include_file (string.h HAVE_STRING_H)
 check_include_file (sys/endian.h HAVE_SYS_ENDIAN_H)
+check_include_file (sys/mman.h HAVE_SYS_MMAN_H)
 check_include_file (sys/stat.h HAVE_SYS_STAT_H)
 check_include_file (sys/types.h HAVE_SYS_TYPES_H)
 check_include_file (unistd.h HAVE_UNISTD_H)
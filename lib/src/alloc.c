@@ -0,0 +1,115 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "alloc.h"
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+
+// allocator for the thread, or NULL for the standard library functions
+static THREAD_LOCAL const struct cp_allocator *current_allocator;
+
+
+const struct cp_allocator *cp_set_allocator(
+        const struct cp_allocator *allocator)
+{
+    const struct cp_allocator *prev = current_allocator;
+    current_allocator = (allocator == NULL || allocator->malloc == NULL)?
+            NULL : allocator;
+    return prev;
+}
+
+
+struct cp_allocator cp_current_allocator(void)
+{
+    if (current_allocator == NULL)
+    {
+        struct cp_allocator allocator = { NULL, NULL, NULL, NULL };
+        return allocator;
+    }
+    return *current_allocator;
+}
+
+
+void *cp_malloc(size_t size)
+{
+    const struct cp_allocator *a = current_allocator;
+    if (a == NULL)
+    {
+        return malloc(size);
+    }
+    void *m = a->malloc(a->userdata, size);
+    if (m == NULL)
+    {
+        errno = ENOMEM;
+    }
+    return m;
+}
+
+
+void *cp_calloc(size_t nmemb, size_t size)
+{
+    const struct cp_allocator *a = current_allocator;
+    if (a == NULL)
+    {
+        return calloc(nmemb, size);
+    }
+    if (size > 0 && nmemb > SIZE_MAX / size)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+    void *m = cp_malloc(nmemb * size);
+    if (m == NULL)
+    {
+        return NULL;
+    }
+    memset(m, 0, nmemb * size);
+    return m;
+}
+
+
+void *cp_realloc(void *ptr, size_t size)
+{
+    const struct cp_allocator *a = current_allocator;
+    if (a == NULL)
+    {
+        return realloc(ptr, size);
+    }
+    void *m = a->realloc(a->userdata, ptr, size);
+    if (m == NULL && size > 0)
+    {
+        errno = ENOMEM;
+    }
+    return m;
+}
+
+
+void cp_free(void *ptr)
+{
+    const struct cp_allocator *a = current_allocator;
+    if (a == NULL)
+    {
+        free(ptr);
+        return;
+    }
+    if (ptr != NULL)
+    {
+        a->free(a->userdata, ptr);
+    }
+}
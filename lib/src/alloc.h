@@ -0,0 +1,66 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CYPHER_PARSER_ALLOC_H
+#define CYPHER_PARSER_ALLOC_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+
+/*
+ * A set of allocation functions. When the functions are NULL, the standard
+ * library allocation functions are used.
+ */
+struct cp_allocator
+{
+    void *(*malloc)(void *userdata, size_t size);
+    void *(*realloc)(void *userdata, void *ptr, size_t size);
+    void (*free)(void *userdata, void *ptr);
+    void *userdata;
+};
+
+
+/*
+ * Set the allocator used for all subsequent allocations by the calling
+ * thread, or NULL to use the standard library functions. The allocator must
+ * remain valid until it is replaced. Returns the previously set allocator.
+ */
+const struct cp_allocator *cp_set_allocator(
+        const struct cp_allocator *allocator);
+
+/*
+ * Get the allocator in use by the calling thread.
+ */
+struct cp_allocator cp_current_allocator(void);
+
+static inline bool cp_allocator_equal(const struct cp_allocator *a,
+        const struct cp_allocator *b)
+{
+    return a->malloc == b->malloc && a->realloc == b->realloc &&
+        a->free == b->free && a->userdata == b->userdata;
+}
+
+void *cp_malloc(size_t size);
+
+void *cp_calloc(size_t nmemb, size_t size);
+
+void *cp_realloc(void *ptr, size_t size);
+
+void cp_free(void *ptr);
+
+
+#endif/*CYPHER_PARSER_ALLOC_H*/
@@ -0,0 +1,187 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "arena.h"
+#include "alloc.h"
+#include <assert.h>
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#define CYPHER_PARSER_ARENA_MIN_CHUNK_SIZE 1024
+#define CYPHER_PARSER_ARENA_MAX_CHUNK_SIZE (64*1024)
+
+
+struct cp_arena_chunk
+{
+    struct cp_arena_chunk *next;
+};
+
+
+union alignment
+{
+    void *p;
+    long long ll;
+    double d;
+};
+
+#define ALIGNMENT sizeof(union alignment)
+#define ALIGN(n) (((n) + (ALIGNMENT - 1)) & ~(ALIGNMENT - 1))
+#define CHUNK_HEADER_SIZE ALIGN(sizeof(struct cp_arena_chunk))
+
+
+static void *chunk_alloc(cp_arena_t *arena, size_t size);
+
+
+void cp_arena_init(cp_arena_t *arena)
+{
+    memset(arena, 0, sizeof(cp_arena_t));
+}
+
+
+void *cp_arena_alloc(cp_arena_t *arena, size_t size)
+{
+    if (size > SIZE_MAX - CHUNK_HEADER_SIZE - ALIGNMENT)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+    size = (size == 0)? ALIGNMENT : ALIGN(size);
+    if (size > (size_t)(arena->limit - arena->next))
+    {
+        return chunk_alloc(arena, size);
+    }
+    void *m = arena->next;
+    arena->next += size;
+    return m;
+}
+
+
+void *chunk_alloc(cp_arena_t *arena, size_t size)
+{
+    size_t chunk_size = (arena->chunk_size == 0)?
+            CYPHER_PARSER_ARENA_MIN_CHUNK_SIZE : arena->chunk_size;
+
+    if (size > chunk_size / 2)
+    {
+        // allocate a chunk for just this allocation, leaving the current
+        // chunk for subsequent allocations
+        struct cp_arena_chunk *chunk = cp_malloc(CHUNK_HEADER_SIZE + size);
+        if (chunk == NULL)
+        {
+            return NULL;
+        }
+        if (arena->chunks == NULL)
+        {
+            chunk->next = NULL;
+            arena->chunks = chunk;
+            arena->last = chunk;
+        }
+        else
+        {
+            chunk->next = arena->chunks->next;
+            arena->chunks->next = chunk;
+            if (arena->last == arena->chunks)
+            {
+                arena->last = chunk;
+            }
+        }
+        return (char *)chunk + CHUNK_HEADER_SIZE;
+    }
+
+    struct cp_arena_chunk *chunk = cp_malloc(CHUNK_HEADER_SIZE + chunk_size);
+    if (chunk == NULL)
+    {
+        return NULL;
+    }
+    chunk->next = arena->chunks;
+    arena->chunks = chunk;
+    if (arena->last == NULL)
+    {
+        arena->last = chunk;
+    }
+    arena->next = (char *)chunk + CHUNK_HEADER_SIZE + size;
+    arena->limit = (char *)chunk + CHUNK_HEADER_SIZE + chunk_size;
+    if (chunk_size < CYPHER_PARSER_ARENA_MAX_CHUNK_SIZE)
+    {
+        arena->chunk_size = chunk_size * 2;
+    }
+    return (char *)chunk + CHUNK_HEADER_SIZE;
+}
+
+
+void *cp_arena_calloc(cp_arena_t *arena, size_t size)
+{
+    void *m = cp_arena_alloc(arena, size);
+    if (m == NULL)
+    {
+        return NULL;
+    }
+    memset(m, 0, size);
+    return m;
+}
+
+
+void *cp_arena_mdup(cp_arena_t *arena, const void *src, size_t size)
+{
+    void *m = cp_arena_alloc(arena, size);
+    if (m == NULL)
+    {
+        return NULL;
+    }
+    memcpy(m, src, size);
+    return m;
+}
+
+
+char *cp_arena_strdup(cp_arena_t *arena, const char *s)
+{
+    return cp_arena_mdup(arena, s, strlen(s) + 1);
+}
+
+
+void cp_arena_move(cp_arena_t *arena, cp_arena_t *from)
+{
+    assert(arena != from);
+    if (from->chunks == NULL)
+    {
+        return;
+    }
+    if (arena->chunks == NULL)
+    {
+        *arena = *from;
+    }
+    else
+    {
+        arena->last->next = from->chunks;
+        arena->last = from->last;
+    }
+    cp_arena_init(from);
+}
+
+
+void cp_arena_cleanup(cp_arena_t *arena)
+{
+    struct cp_arena_chunk *chunk = arena->chunks;
+    while (chunk != NULL)
+    {
+        struct cp_arena_chunk *next = chunk->next;
+        cp_free(chunk);
+        chunk = next;
+    }
+    cp_arena_init(arena);
+}
@@ -0,0 +1,65 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CYPHER_PARSER_ARENA_H
+#define CYPHER_PARSER_ARENA_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+
+struct cp_arena_chunk;
+
+/*
+ * A bump allocator. Memory allocated from an arena cannot be freed
+ * individually, and is released only when the arena is cleaned up.
+ */
+typedef struct cp_arena cp_arena_t;
+struct cp_arena
+{
+    struct cp_arena_chunk *chunks; // most recently allocated first
+    struct cp_arena_chunk *last;
+    char *next;
+    char *limit;
+    size_t chunk_size;
+};
+
+
+void cp_arena_init(cp_arena_t *arena);
+
+void *cp_arena_alloc(cp_arena_t *arena, size_t size);
+
+void *cp_arena_calloc(cp_arena_t *arena, size_t size);
+
+void *cp_arena_mdup(cp_arena_t *arena, const void *src, size_t size);
+
+char *cp_arena_strdup(cp_arena_t *arena, const char *s);
+
+/*
+ * Move all memory allocated from one arena into another, leaving the
+ * former empty.
+ */
+void cp_arena_move(cp_arena_t *arena, cp_arena_t *from);
+
+static inline bool cp_arena_is_empty(const cp_arena_t *arena)
+{
+    return arena->chunks == NULL;
+}
+
+void cp_arena_cleanup(cp_arena_t *arena);
+
+
+#endif/*CYPHER_PARSER_ARENA_H*/
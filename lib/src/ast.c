@@ -19,6 +19,7 @@
 #include "astnode.h"
 #include "util.h"
 #include <assert.h>
+#include <errno.h>
 #include <math.h>
 
 
@@ -137,6 +138,8 @@ struct cypher_astnode_vts
     const struct cypher_astnode_vt *map_projection_property;
     const struct cypher_astnode_vt *map_projection_identifier;
     const struct cypher_astnode_vt *map_projection_all_properties;
+    const struct cypher_astnode_vt *deferred_body;
+    const struct cypher_astnode_vt *lazy_clause;
 };
 static const struct cypher_astnode_vts cypher_astnode_vts =
 {
@@ -253,7 +256,9 @@ static const struct cypher_astnode_vts cypher_astnode_vts =
     .map_projection_property = &cypher_map_projection_property_astnode_vt,
     .map_projection_identifier = &cypher_map_projection_identifier_astnode_vt,
     .map_projection_all_properties =
-            &cypher_map_projection_all_properties_astnode_vt
+            &cypher_map_projection_all_properties_astnode_vt,
+    .deferred_body = &cypher_deferred_body_astnode_vt,
+    .lazy_clause = &cypher_lazy_clause_astnode_vt
 };
 
 #define VT_OFFSET(name) offsetof(struct cypher_astnode_vts, name) \
@@ -385,6 +390,8 @@ const uint8_t CYPHER_AST_MAP_PROJECTION_IDENTIFIER =
         VT_OFFSET(map_projection_identifier);
 const uint8_t CYPHER_AST_MAP_PROJECTION_ALL_PROPERTIES =
         VT_OFFSET(map_projection_all_properties);
+const uint8_t CYPHER_AST_DEFERRED_BODY = VT_OFFSET(deferred_body);
+const uint8_t CYPHER_AST_LAZY_CLAUSE = VT_OFFSET(lazy_clause);
 static const uint8_t _MAX_VT_OFF =
     (sizeof(struct cypher_astnode_vts) / sizeof(struct cypher_astnode_vt *));
 
@@ -393,6 +400,14 @@ static_assert(
     "cannot have more than 2^8 AST node types");
 
 
+// arena that nodes are allocated from, if any (see cypher_ast_set_arena)
+static THREAD_LOCAL cp_arena_t *current_arena;
+// index of the lines of constructed nodes (see cypher_ast_set_line_index)
+static THREAD_LOCAL const cp_line_index_t *current_line_index;
+// table that names are interned in, if any (see cypher_ast_set_symbol_table)
+static THREAD_LOCAL cp_symbol_table_t *current_symbol_table;
+
+
 cypher_astnode_type_t cypher_astnode_type(const cypher_astnode_t *node)
 {
     REQUIRE(node != NULL, _MAX_VT_OFF);
@@ -443,7 +458,17 @@ const char *cypher_astnode_typestr(cypher_astnode_type_t type)
 
 struct cypher_input_range cypher_astnode_range(const cypher_astnode_t *node)
 {
-    return node->range;
+    if (node->start == CYPHER_ASTNODE_NO_OFFSET)
+    {
+        return *(node->location.range);
+    }
+    const cp_line_index_t *index = node->location.line_index;
+    struct cypher_input_range range =
+        { .start = cp_line_index_position(index,
+                  index->start.offset + node->start),
+          .end = cp_line_index_position(index,
+                  index->start.offset + node->end) };
+    return range;
 }
 
 
@@ -464,7 +489,7 @@ cypher_astnode_t **cypher_ast_vclone(cypher_astnode_t * const *ast,
         return NULL;
     }
 
-    cypher_astnode_t **clones = calloc(n, sizeof(cypher_astnode_t *));
+    cypher_astnode_t **clones = cp_calloc(n, sizeof(cypher_astnode_t *));
     if (clones == NULL)
     {
         return NULL;
@@ -483,7 +508,7 @@ cypher_astnode_t **cypher_ast_vclone(cypher_astnode_t * const *ast,
 failure:
     errsv = errno;
     cypher_ast_vfree(clones, n);
-    free(clones);
+    cp_free(clones);
     errno = errsv;
     return NULL;
 }
@@ -501,15 +526,26 @@ void cypher_ast_free(cypher_astnode_t *ast)
         cp_release_annotation(ast->annotations);
     }
 
+    if (ast->in_arena)
+    {
+        // memory is released with the arena, but annotations on any
+        // descendants must still be detached
+        cypher_ast_vfree(ast->children, ast->nchildren);
+        return;
+    }
+
     cypher_astnode_t **children = ast->children;
     unsigned int nchildren = ast->nchildren;
+    struct cypher_input_range *range = (ast->start == CYPHER_ASTNODE_NO_OFFSET)?
+            ast->location.range : NULL;
 
     assert(ast->type < _MAX_VT_OFF);
     const struct cypher_astnode_vt *vt = VT_PTR(ast->type);
     vt->release(ast);
 
     cypher_ast_vfree(children, nchildren);
-    free(children);
+    cp_free(children);
+    cp_free(range);
 }
 
 
@@ -526,12 +562,19 @@ void cypher_astnode_free(cypher_astnode_t *ast)
     }
 
     cypher_astnode_t **children = ast->children;
+    struct cypher_input_range *range = (ast->start == CYPHER_ASTNODE_NO_OFFSET)?
+            ast->location.range : NULL;
+    bool in_arena = ast->in_arena;
 
     assert(ast->type < _MAX_VT_OFF);
     const struct cypher_astnode_vt *vt = VT_PTR(ast->type);
     vt->release(ast);
 
-    free(children);
+    if (!in_arena)
+    {
+        cp_free(children);
+        cp_free(range);
+    }
 }
 
 
@@ -554,18 +597,26 @@ cypher_astnode_t *cypher_ast_clone(const cypher_astnode_t *ast)
 
     assert(ast->type < _MAX_VT_OFF);
     const struct cypher_astnode_vt *vt = VT_PTR(ast->type);
+    // the clone may outlive the line index and symbol table of the
+    // original, so is given an explicit range and its own names
+    const cp_line_index_t *prev_line_index = cypher_ast_set_line_index(NULL);
+    cp_symbol_table_t *prev_symbol_table = cypher_ast_set_symbol_table(NULL);
     cypher_astnode_t *clone = vt->clone(ast, children);
+    cypher_ast_set_symbol_table(prev_symbol_table);
+    cypher_ast_set_line_index(prev_line_index);
     if (clone == NULL)
     {
         goto failure;
     }
+    // the children are copied by the node constructor
+    cp_free(children);
     return clone;
 
     int errsv;
 failure:
     errsv = errno;
     cypher_ast_vfree(children, ast->nchildren);
-    free(children);
+    cp_free(children);
     errno = errsv;
     return NULL;
 }
@@ -607,7 +658,7 @@ static ssize_t cypher_astnode_detailstr_realloc(const cypher_astnode_t *node,
     }
     if ((size_t)width > *bufcap)
     {
-        char *newbuf = realloc(*buf, (size_t)width + 1);
+        char *newbuf = cp_realloc(*buf, (size_t)width + 1);
         if (newbuf == NULL)
         {
             return -1;
@@ -632,8 +683,9 @@ static void ast_fprint_field_widths(const cypher_astnode_t *ast,
 
     *max_ordinal = maxu(*max_ordinal, ast->ordinal);
 
-    *max_start = maxzu(*max_start, ast->range.start.offset);
-    *max_end = maxzu(*max_end, ast->range.end.offset);
+    struct cypher_input_range range = cypher_astnode_range(ast);
+    *max_start = maxzu(*max_start, range.start.offset);
+    *max_end = maxzu(*max_end, range.end.offset);
 
     const char *typestr = cypher_astnode_typestr(cypher_astnode_type(ast));
     *name_width = maxu(*name_width, strlen(typestr) + (depth * 2));
@@ -733,10 +785,11 @@ static int _cypher_ast_fprint(const cypher_astnode_t *ast, FILE *stream,
 #else
     const char* format = "%s%*zu..%-*zu%s  %s";
 #endif
+    struct cypher_input_range range = cypher_astnode_range(ast);
     if (fprintf(stream, format,
                 colorization->ast_range[0],
-                start_width, ast->range.start.offset,
-                end_width, ast->range.end.offset,
+                start_width, range.start.offset,
+                end_width, range.end.offset,
                 colorization->ast_range[1], colorization->ast_indent[0]) < 0)
     {
         return -1;
@@ -792,7 +845,7 @@ static int _cypher_ast_fprint(const cypher_astnode_t *ast, FILE *stream,
 
     for (unsigned int i = 0; i < cypher_astnode_nchildren(ast); ++i)
     {
-        const cypher_astnode_t *child = cypher_astnode_get_child(ast, i);
+        const cypher_astnode_t *child = ast->children[i];
         if (_cypher_ast_fprint(child, stream, colorization, buf, bufcap,
                     render_width, ordinal_width, start_width, end_width,
                     name_width, depth+1) < 0)
@@ -824,14 +877,14 @@ int cypher_ast_fprint(const cypher_astnode_t *ast, FILE *stream,
     unsigned int end_width = (unsigned int)log10(max_end)+1;
 
     size_t bufcap = 1024;
-    char *buf = malloc(bufcap);
+    char *buf = cp_malloc(bufcap);
     if (buf == NULL)
     {
         return -1;
     }
     int r = _cypher_ast_fprint(ast, stream, colorization, &buf, &bufcap, width,
             ordinal_width, start_width, end_width, name_width, 0);
-    free(buf);
+    cp_free(buf);
     return r;
 }
 
@@ -859,7 +912,7 @@ int cypher_ast_fprintv(cypher_astnode_t * const *asts, unsigned int n,
     unsigned int end_width = (unsigned int)log10(max_end)+1;
 
     size_t bufcap = 1024;
-    char *buf = malloc(bufcap);
+    char *buf = cp_malloc(bufcap);
     if (buf == NULL)
     {
         return -1;
@@ -880,7 +933,7 @@ int cypher_ast_fprintv(cypher_astnode_t * const *asts, unsigned int n,
     result = 0;
 
 cleanup:
-    free(buf);
+    cp_free(buf);
     return result;
 }
 
@@ -892,14 +945,42 @@ int cypher_astnode_init(cypher_astnode_t *node,
     assert(node != NULL);
     assert(nchildren == 0 || children != NULL);
 
+    if (nchildren > CYPHER_ASTNODE_MAX_CHILDREN)
+    {
+        errno = EOVERFLOW;
+        return -1;
+    }
+
     node->type = type;
-    node->range = range;
+    if (current_line_index != NULL)
+    {
+        // offsets within the indexed input always fit, as the parser
+        // buffers positions as an int
+        assert(range.start.offset >= current_line_index->start.offset);
+        assert(range.end.offset - current_line_index->start.offset <
+                CYPHER_ASTNODE_NO_OFFSET);
+        node->start = range.start.offset - current_line_index->start.offset;
+        node->end = range.end.offset - current_line_index->start.offset;
+        node->location.line_index = current_line_index;
+    }
+    else
+    {
+        node->location.range = cypher_astnode_mdup(node, &range,
+                sizeof(struct cypher_input_range));
+        if (node->location.range == NULL)
+        {
+            return -1;
+        }
+        node->start = CYPHER_ASTNODE_NO_OFFSET;
+        node->end = CYPHER_ASTNODE_NO_OFFSET;
+    }
     if (nchildren > 0)
     {
-        node->children = mdup(children, nchildren * sizeof(cypher_astnode_t *));
+        node->children = cypher_astnode_mdup(node, children,
+                nchildren * sizeof(cypher_astnode_t *));
         if (node->children == NULL)
         {
-            return -1;
+            goto failure;
         }
         node->nchildren = nchildren;
     }
@@ -909,12 +990,145 @@ int cypher_astnode_init(cypher_astnode_t *node,
         node->nchildren = 0;
     }
     return 0;
+
+    int errsv;
+failure:
+    errsv = errno;
+    if (node->start == CYPHER_ASTNODE_NO_OFFSET)
+    {
+        cypher_astnode_mfree(node, node->location.range);
+    }
+    errno = errsv;
+    return -1;
 }
 
 
 void cypher_astnode_release(cypher_astnode_t *node)
 {
-    free(node);
+    cypher_astnode_dealloc(node);
+}
+
+
+cp_arena_t *cypher_ast_set_arena(cp_arena_t *arena)
+{
+    cp_arena_t *prev = current_arena;
+    current_arena = arena;
+    return prev;
+}
+
+
+const cp_line_index_t *cypher_ast_set_line_index(
+        const cp_line_index_t *index)
+{
+    const cp_line_index_t *prev = current_line_index;
+    current_line_index = index;
+    return prev;
+}
+
+
+cp_symbol_table_t *cypher_ast_set_symbol_table(cp_symbol_table_t *table)
+{
+    cp_symbol_table_t *prev = current_symbol_table;
+    current_symbol_table = table;
+    return prev;
+}
+
+
+void *cypher_astnode_alloc(size_t size)
+{
+    assert(size >= sizeof(cypher_astnode_t));
+    if (current_arena == NULL)
+    {
+        return cp_calloc(1, size);
+    }
+    cypher_astnode_t *node = cp_arena_calloc(current_arena, size);
+    if (node == NULL)
+    {
+        return NULL;
+    }
+    node->in_arena = true;
+    return node;
+}
+
+
+void *cypher_astnode_alloc_named(size_t size, const char *s, size_t n,
+        unsigned int id, const struct cp_symbol **symbol)
+{
+    if (current_symbol_table != NULL)
+    {
+        *symbol = cp_symbol_table_intern(current_symbol_table, s, n);
+        return (*symbol == NULL)? NULL : cypher_astnode_alloc(size);
+    }
+
+    // the structure ends with a pointer, so is suitably aligned for a symbol
+    assert(size % sizeof(struct cp_symbol *) == 0);
+    char *node = cypher_astnode_alloc(size + sizeof(struct cp_symbol) + n+1);
+    if (node == NULL)
+    {
+        return NULL;
+    }
+    struct cp_symbol *own = (struct cp_symbol *)(node + size);
+    own->id = id;
+    own->length = n;
+    memcpy(own->name, s, n);
+    own->name[n] = '\0';
+    *symbol = own;
+    return node;
+}
+
+
+void *cypher_astnode_alloc_text(size_t size, const char *s, size_t n,
+        bool ref, const char **text)
+{
+    if (ref)
+    {
+        *text = s;
+        return cypher_astnode_alloc(size);
+    }
+
+    char *node = cypher_astnode_alloc(size + n+1);
+    if (node == NULL)
+    {
+        return NULL;
+    }
+    char *copy = node + size;
+    if (n > 0)
+    {
+        memcpy(copy, s, n);
+    }
+    copy[n] = '\0';
+    *text = copy;
+    return node;
+}
+
+
+void cypher_astnode_dealloc(void *node)
+{
+    if (node != NULL && !((cypher_astnode_t *)node)->in_arena)
+    {
+        cp_free(node);
+    }
+}
+
+
+void *cypher_astnode_mdup(const cypher_astnode_t *node, const void *src,
+        size_t size)
+{
+    if (node->in_arena)
+    {
+        assert(current_arena != NULL);
+        return cp_arena_mdup(current_arena, src, size);
+    }
+    return mdup(src, size);
+}
+
+
+void cypher_astnode_mfree(const cypher_astnode_t *node, void *ptr)
+{
+    if (!node->in_arena)
+    {
+        cp_free(ptr);
+    }
 }
 
 
@@ -940,7 +1154,12 @@ const cypher_astnode_t *cypher_astnode_get_child(const cypher_astnode_t *node,
     {
         return NULL;
     }
-    return node->children[index];
+    const cypher_astnode_t *child = node->children[index];
+    if (child->type == CYPHER_AST_LAZY_CLAUSE)
+    {
+        return cypher_ast_lazy_clause_get_clause(child);
+    }
+    return child;
 }
 
 
@@ -18,6 +18,9 @@
 #define CYPHER_PARSER_AST_H
 
 #include "cypher-parser.h"
+#include "arena.h"
+#include "line_index.h"
+#include "symbol_table.h"
 
 
 unsigned int cypher_ast_set_ordinals(cypher_astnode_t *ast, unsigned int n);
@@ -32,5 +35,89 @@ void cypher_ast_vfree(cypher_astnode_t * const *ast, unsigned int n);
 cypher_astnode_t **cypher_ast_vclone(cypher_astnode_t * const *ast,
         unsigned int n);
 
+/*
+ * Set the arena that AST nodes constructed by the calling thread are
+ * allocated from, or NULL to allocate each node individually. Returns the
+ * previously set arena.
+ */
+cp_arena_t *cypher_ast_set_arena(cp_arena_t *arena);
+
+/*
+ * Set the line index that the line and column of the ranges of AST nodes
+ * constructed by the calling thread are resolved from, or NULL if the ranges
+ * are complete. The index must remain valid for the lifetime of the nodes.
+ * Returns the previously set index.
+ */
+const cp_line_index_t *cypher_ast_set_line_index(
+        const cp_line_index_t *index);
+
+/*
+ * Set the symbol table that the names of AST nodes constructed by the
+ * calling thread are interned in, or NULL if names are to be stored with
+ * each node. The table must remain valid for the lifetime of the nodes.
+ * Returns the previously set table.
+ */
+cp_symbol_table_t *cypher_ast_set_symbol_table(cp_symbol_table_t *table);
+
+/*
+ * Decode an integer literal. Returns 0 on success, or ERANGE or EINVAL if
+ * the literal is out of range or invalid.
+ */
+int cypher_ast_decode_integer(const char *s, size_t n, int64_t *value);
+
+/*
+ * Decode a null terminated float literal, which is modified during (but
+ * restored after) decoding. Returns 0 on success, or ERANGE or EINVAL if
+ * the literal is out of range or invalid.
+ */
+int cypher_ast_decode_float(char *s, size_t n, double *value);
+
+/*
+ * An element of a packed collection, with offsets relative to the start of
+ * the collection.
+ */
+struct cypher_ast_packed_element
+{
+    uint32_t start; // including any leading '-'
+    uint32_t literal_start;
+    uint32_t literal_end;
+    uint32_t end; // including any whitespace following the literal
+    uint32_t text; // offset of the literal text, or value for strings
+};
+
+union cypher_ast_packed_value
+{
+    int64_t integer;
+    double flt;
+};
+
+/*
+ * Construct a `CYPHER_AST_COLLECTION` node with elements of the specified
+ * type (`CYPHER_AST_INTEGER`, `CYPHER_AST_FLOAT` or `CYPHER_AST_STRING`)
+ * stored packed, which are only constructed as nodes when accessed. The
+ * text holds the literal (or value) of each element in order, each followed
+ * by a null terminator. The node must be constructed with a line index set,
+ * and not in an arena.
+ */
+cypher_astnode_t *cypher_ast_packed_collection(cypher_astnode_type_t type,
+        const union cypher_ast_packed_value *values,
+        const struct cypher_ast_packed_element *elements,
+        unsigned int nelements, const char *text, size_t textlen,
+        struct cypher_input_range range);
+
+/*
+ * Construct `CYPHER_AST_STRING`, `CYPHER_AST_LINE_COMMENT` and
+ * `CYPHER_AST_BLOCK_COMMENT` nodes that reference their text rather than
+ * copying it. The text must be null terminated, and
+ * remain valid for the lifetime of the node (e.g. be retained by the line
+ * index of the node).
+ */
+cypher_astnode_t *cypher_ast_string_ref(const char *s, size_t n,
+        struct cypher_input_range range);
+cypher_astnode_t *cypher_ast_line_comment_ref(const char *s, size_t n,
+        struct cypher_input_range range);
+cypher_astnode_t *cypher_ast_block_comment_ref(const char *s, size_t n,
+        struct cypher_input_range range);
+
 
 #endif/*CYPHER_PARSER_AST_H*/
@@ -50,7 +50,8 @@ cypher_astnode_t *cypher_ast_all_rels_scan(const cypher_astnode_t *identifier,
 {
     REQUIRE_CHILD(children, nchildren, identifier, CYPHER_AST_IDENTIFIER, NULL);
 
-    struct all_rels_scan *node = calloc(1, sizeof(struct all_rels_scan));
+    struct all_rels_scan *node =
+            cypher_astnode_alloc(sizeof(struct all_rels_scan));
     if (node == NULL)
     {
         return NULL;
@@ -58,7 +59,7 @@ cypher_astnode_t *cypher_ast_all_rels_scan(const cypher_astnode_t *identifier,
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_ALL_RELS_SCAN,
             children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->identifier = identifier;
@@ -76,7 +77,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *identifier = children[child_index(self, node->identifier)];
 
     return cypher_ast_all_rels_scan(identifier, children, self->nchildren,
-            self->range);
+            cypher_astnode_range(self));
 }
 
 
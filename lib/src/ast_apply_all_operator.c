@@ -55,7 +55,7 @@ cypher_astnode_t *cypher_ast_apply_all_operator(
             CYPHER_AST_FUNCTION_NAME, NULL);
 
     struct apply_all_operator *node =
-            calloc(1, sizeof(struct apply_all_operator));
+            cypher_astnode_alloc(sizeof(struct apply_all_operator));
     if (node == NULL)
     {
         return NULL;
@@ -72,7 +72,7 @@ cypher_astnode_t *cypher_ast_apply_all_operator(
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -88,7 +88,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *func_name = children[child_index(self, node->func_name)];
 
     return cypher_ast_apply_all_operator(func_name, node->distinct,
-            children, self->nchildren, self->range);
+            children, self->nchildren, cypher_astnode_range(self));
 }
 
 
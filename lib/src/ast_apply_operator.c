@@ -58,8 +58,9 @@ cypher_astnode_t *cypher_ast_apply_operator(const cypher_astnode_t *func_name,
     REQUIRE_CHILD_ALL(children, nchildren, args, nargs,
             CYPHER_AST_EXPRESSION, NULL);
 
-    struct apply_operator *node = calloc(1, sizeof(struct apply_operator) +
-            nargs * sizeof(cypher_astnode_t *));
+    struct apply_operator *node =
+            cypher_astnode_alloc(sizeof(struct apply_operator) +
+                nargs * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
         return NULL;
@@ -79,7 +80,7 @@ cypher_astnode_t *cypher_ast_apply_operator(const cypher_astnode_t *func_name,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -93,7 +94,8 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
         container_of(self, struct apply_operator, _astnode);
 
     cypher_astnode_t *func_name = children[child_index(self, node->func_name)];
-    cypher_astnode_t **args = calloc(node->nargs, sizeof(cypher_astnode_t *));
+    cypher_astnode_t **args = cp_calloc(node->nargs,
+            sizeof(cypher_astnode_t *));
     if (args == NULL)
     {
         return NULL;
@@ -105,9 +107,9 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
 
     cypher_astnode_t *clone = cypher_ast_apply_operator(func_name,
             node->distinct, args, node->nargs, children, self->nchildren,
-            self->range);
+            cypher_astnode_range(self));
     int errsv = errno;
-    free(args);
+    cp_free(args);
     errno = errsv;
     return clone;
 }
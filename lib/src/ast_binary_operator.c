@@ -56,7 +56,8 @@ cypher_astnode_t *cypher_ast_binary_operator(const cypher_operator_t *op,
     REQUIRE_CHILD(children, nchildren, arg1, CYPHER_AST_EXPRESSION, NULL);
     REQUIRE_CHILD(children, nchildren, arg2, CYPHER_AST_EXPRESSION, NULL);
 
-    struct binary_operator *node = calloc(1, sizeof(struct binary_operator));
+    struct binary_operator *node =
+            cypher_astnode_alloc(sizeof(struct binary_operator));
     if (node == NULL)
     {
         return NULL;
@@ -64,7 +65,7 @@ cypher_astnode_t *cypher_ast_binary_operator(const cypher_operator_t *op,
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_BINARY_OPERATOR,
             children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->op = op;
@@ -85,7 +86,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *arg2 = children[child_index(self, node->arg2)];
 
     return cypher_ast_binary_operator(node->op, arg1, arg2, children,
-            self->nchildren, self->range);
+            self->nchildren, cypher_astnode_range(self));
 }
 
 
@@ -64,7 +64,7 @@ cypher_astnode_t *cypher_ast_call(const cypher_astnode_t *proc_name,
     REQUIRE_CHILD_OPTIONAL(children, nchildren, predicate,
             CYPHER_AST_EXPRESSION, NULL);
 
-    struct call_clause *node = calloc(1, sizeof(struct call_clause) +
+    struct call_clause *node = cypher_astnode_alloc(sizeof(struct call_clause) +
             nprojections * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
@@ -78,7 +78,8 @@ cypher_astnode_t *cypher_ast_call(const cypher_astnode_t *proc_name,
     node->proc_name = proc_name;
     if (nargs > 0)
     {
-        node->args = mdup(args, nargs * sizeof(cypher_astnode_t *));
+        node->args = cypher_astnode_mdup(&(node->_astnode), args,
+                nargs * sizeof(cypher_astnode_t *));
         if (node->args == NULL)
         {
             goto cleanup;
@@ -94,7 +95,7 @@ cypher_astnode_t *cypher_ast_call(const cypher_astnode_t *proc_name,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -103,7 +104,7 @@ cleanup:
 void call_release(cypher_astnode_t *self)
 {
     struct call_clause *node = container_of(self, struct call_clause, _astnode);
-    free(node->args);
+    cypher_astnode_mfree(self, node->args);
     cypher_astnode_release(self);
 }
 
@@ -115,7 +116,8 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     struct call_clause *node = container_of(self, struct call_clause, _astnode);
 
     cypher_astnode_t *proc_name = children[child_index(self, node->proc_name)];
-    cypher_astnode_t **args = calloc(node->nargs, sizeof(cypher_astnode_t *));
+    cypher_astnode_t **args = cp_calloc(node->nargs,
+            sizeof(cypher_astnode_t *));
     if (args == NULL)
     {
         return NULL;
@@ -125,7 +127,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
         args[i] = children[child_index(self, node->args[i])];
     }
     cypher_astnode_t **projections =
-            calloc(node->nprojections, sizeof(cypher_astnode_t *));
+            cp_calloc(node->nprojections, sizeof(cypher_astnode_t *));
     if (projections == NULL)
     {
         return NULL;
@@ -140,10 +142,10 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
 
     cypher_astnode_t *clone = cypher_ast_call(proc_name, args, node->nargs,
             projections, node->nprojections, predicate,
-            children, self->nchildren, self->range);
+            children, self->nchildren, cypher_astnode_range(self));
     int errsv = errno;
-    free(args);
-    free(projections);
+    cp_free(args);
+    cp_free(projections);
     errno = errsv;
     return clone;
 }
@@ -60,8 +60,9 @@ cypher_astnode_t *cypher_ast_case(const cypher_astnode_t *expression,
     REQUIRE_CHILD_OPTIONAL(children, nchildren, deflt,
             CYPHER_AST_EXPRESSION, NULL);
 
-    struct case_expression *node = calloc(1, sizeof(struct case_expression) +
-            nalternatives * 2 * sizeof(cypher_astnode_t *));
+    struct case_expression *node =
+            cypher_astnode_alloc(sizeof(struct case_expression) +
+                nalternatives * 2 * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
         return NULL;
@@ -81,7 +82,7 @@ cypher_astnode_t *cypher_ast_case(const cypher_astnode_t *expression,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -96,13 +97,13 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
 
     cypher_astnode_t *expression = (node->expression == NULL) ? NULL :
             children[child_index(self, node->expression)];
-    cypher_astnode_t **alternatives = calloc(node->nalternatives,
+    cypher_astnode_t **alternatives = cp_calloc(node->nalternatives * 2,
             sizeof(cypher_astnode_t *));
     if (alternatives == NULL)
     {
         return NULL;
     }
-    for (unsigned int i = 0; i < node->nalternatives; ++i)
+    for (unsigned int i = 0; i < node->nalternatives * 2; ++i)
     {
         alternatives[i] = children[child_index(self, node->alternatives[i])];
     }
@@ -110,9 +111,10 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
             children[child_index(self, node->deflt)];
 
     cypher_astnode_t *clone = cypher_ast_case(expression, alternatives,
-            node->nalternatives, deflt, children, self->nchildren, self->range);
+            node->nalternatives, deflt, children, self->nchildren,
+            cypher_astnode_range(self));
     int errsv = errno;
-    free(alternatives);
+    cp_free(alternatives);
     errno = errsv;
     return clone;
 }
@@ -16,14 +16,32 @@
  */
 #include "../../config.h"
 #include "astnode.h"
+#include "alloc.h"
+#include "operators.h"
 #include "util.h"
 #include <assert.h>
 
 
+struct packed
+{
+    cypher_astnode_type_t type;
+    // the allocator to construct the elements with, being that of the AST
+    struct cp_allocator allocator;
+    // the elements constructed on access, if any
+    cypher_astnode_t **constructed;
+    const int64_t *integers;
+    const double *floats;
+    const struct cypher_ast_packed_element *elements;
+    const char *text;
+    size_t textlen;
+};
+
+
 struct collection
 {
     cypher_astnode_t _astnode;
     size_t nelements;
+    struct packed *packed;
     const cypher_astnode_t *elements[];
 };
 
@@ -31,6 +49,11 @@ struct collection
 static cypher_astnode_t *clone(const cypher_astnode_t *self,
         cypher_astnode_t **children);
 static ssize_t detailstr(const cypher_astnode_t *self, char *str, size_t size);
+static void collection_release(cypher_astnode_t *self);
+static cypher_astnode_t *construct_element(const struct collection *node,
+        unsigned int index);
+static struct cypher_input_range element_range(const struct collection *node,
+        uint32_t start, uint32_t end);
 
 
 static const struct cypher_astnode_vt *parents[] =
@@ -41,7 +64,7 @@ const struct cypher_astnode_vt cypher_collection_astnode_vt =
       .nparents = 1,
       .name = "collection",
       .detailstr = detailstr,
-      .release = cypher_astnode_release,
+      .release = collection_release,
       .clone = clone };
 
 
@@ -53,7 +76,7 @@ cypher_astnode_t *cypher_ast_collection(
     REQUIRE_CHILD_ALL(children, nchildren, elements, nelements,
             CYPHER_AST_EXPRESSION, NULL);
 
-    struct collection *node = calloc(1, sizeof(struct collection) +
+    struct collection *node = cypher_astnode_alloc(sizeof(struct collection) +
             nelements * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
@@ -62,7 +85,7 @@ cypher_astnode_t *cypher_ast_collection(
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_COLLECTION,
                 children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     memcpy(node->elements, elements, nelements * sizeof(cypher_astnode_t *));
@@ -71,32 +94,203 @@ cypher_astnode_t *cypher_ast_collection(
 }
 
 
+cypher_astnode_t *cypher_ast_packed_collection(cypher_astnode_type_t type,
+        const union cypher_ast_packed_value *values,
+        const struct cypher_ast_packed_element *elements,
+        unsigned int nelements, const char *text, size_t textlen,
+        struct cypher_input_range range)
+{
+    assert(type == CYPHER_AST_INTEGER || type == CYPHER_AST_FLOAT ||
+            type == CYPHER_AST_STRING);
+    assert(nelements > 0);
+    size_t nvalues = (type == CYPHER_AST_STRING)? 0 : nelements;
+    // the packed data follows the node structure, which ends with a pointer
+    struct collection *node = cypher_astnode_alloc(sizeof(struct collection) +
+            sizeof(struct packed) + nvalues * sizeof(int64_t) +
+            nelements * sizeof(struct cypher_ast_packed_element) +
+            textlen + 1);
+    if (node == NULL)
+    {
+        return NULL;
+    }
+    if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_COLLECTION,
+                NULL, 0, range))
+    {
+        cypher_astnode_dealloc(node);
+        return NULL;
+    }
+    assert(node->_astnode.start != CYPHER_ASTNODE_NO_OFFSET &&
+            "a packed collection requires a line index");
+    assert(!node->_astnode.in_arena);
+    node->nelements = nelements;
+
+    struct packed *packed = (struct packed *)(node + 1);
+    char *p = (char *)(packed + 1);
+    packed->type = type;
+    packed->allocator = cp_current_allocator();
+    if (type == CYPHER_AST_INTEGER)
+    {
+        int64_t *integers = (int64_t *)p;
+        for (unsigned int i = 0; i < nelements; ++i)
+        {
+            integers[i] = values[i].integer;
+        }
+        packed->integers = integers;
+    }
+    else if (type == CYPHER_AST_FLOAT)
+    {
+        double *floats = (double *)p;
+        for (unsigned int i = 0; i < nelements; ++i)
+        {
+            floats[i] = values[i].flt;
+        }
+        packed->floats = floats;
+    }
+    p += nvalues * sizeof(int64_t);
+    memcpy(p, elements, nelements * sizeof(struct cypher_ast_packed_element));
+    packed->elements = (struct cypher_ast_packed_element *)p;
+    p += nelements * sizeof(struct cypher_ast_packed_element);
+    memcpy(p, text, textlen);
+    p[textlen] = '\0';
+    packed->text = p;
+    packed->textlen = textlen;
+    node->packed = packed;
+    return &(node->_astnode);
+}
+
+
 cypher_astnode_t *clone(const cypher_astnode_t *self,
         cypher_astnode_t **children)
 {
     REQUIRE_TYPE(self, CYPHER_AST_COLLECTION, NULL);
     struct collection *node = container_of(self, struct collection, _astnode);
 
-    cypher_astnode_t **elements = calloc(node->nelements,
+    cypher_astnode_t **elements = cp_calloc(node->nelements,
             sizeof(cypher_astnode_t *));
     if (elements == NULL)
     {
         return NULL;
     }
-    for (unsigned int i = 0; i < node->nelements; ++i)
+
+    cypher_astnode_t *clone = NULL;
+    if (node->packed != NULL)
+    {
+        // the clone may outlive the packed data, so has its own elements
+        assert(self->nchildren == 0);
+        unsigned int i = 0;
+        for (; i < node->nelements; ++i)
+        {
+            elements[i] = construct_element(node, i);
+            if (elements[i] == NULL)
+            {
+                break;
+            }
+        }
+        if (i == node->nelements)
+        {
+            clone = cypher_ast_collection(elements, node->nelements,
+                    elements, node->nelements, cypher_astnode_range(self));
+        }
+        if (clone == NULL)
+        {
+            int errsv = errno;
+            cypher_ast_vfree(elements, i);
+            errno = errsv;
+        }
+    }
+    else
     {
-        elements[i] = children[child_index(self, node->elements[i])];
+        for (unsigned int i = 0; i < node->nelements; ++i)
+        {
+            elements[i] = children[child_index(self, node->elements[i])];
+        }
+        clone = cypher_ast_collection(elements, node->nelements,
+                children, self->nchildren, cypher_astnode_range(self));
     }
 
-    cypher_astnode_t *clone = cypher_ast_collection(elements, node->nelements,
-            children, self->nchildren, self->range);
     int errsv = errno;
-    free(elements);
+    cp_free(elements);
     errno = errsv;
     return clone;
 }
 
 
+void collection_release(cypher_astnode_t *self)
+{
+    struct collection *node = container_of(self, struct collection, _astnode);
+    if (node->packed != NULL && node->packed->constructed != NULL)
+    {
+        struct cp_allocator allocator = node->packed->allocator;
+        const struct cp_allocator *prev = cp_set_allocator(&allocator);
+        cypher_ast_vfree(node->packed->constructed, node->nelements);
+        cp_free(node->packed->constructed);
+        cp_set_allocator(prev);
+    }
+    cypher_astnode_release(self);
+}
+
+
+// construct the node for an element of a packed collection, resolving its
+// range from the line index of the collection
+cypher_astnode_t *construct_element(const struct collection *node,
+        unsigned int index)
+{
+    const struct packed *packed = node->packed;
+    const struct cypher_ast_packed_element *element =
+            &(packed->elements[index]);
+    const char *text = packed->text + element->text;
+    // each literal in the text is followed by a null terminator
+    size_t n = ((index + 1 < node->nelements)?
+            packed->elements[index + 1].text : packed->textlen) -
+            element->text - 1;
+    struct cypher_input_range range = element_range(node,
+            element->literal_start, element->literal_end);
+
+    cypher_astnode_t *literal;
+    if (packed->type == CYPHER_AST_INTEGER)
+    {
+        literal = cypher_ast_integer(text, n, range);
+    }
+    else if (packed->type == CYPHER_AST_FLOAT)
+    {
+        literal = cypher_ast_float(text, n, range);
+    }
+    else
+    {
+        assert(packed->type == CYPHER_AST_STRING);
+        literal = cypher_ast_string(text, n, range);
+    }
+    if (literal == NULL || element->start == element->literal_start)
+    {
+        return literal;
+    }
+
+    cypher_astnode_t *negation = cypher_ast_unary_operator(
+            CYPHER_OP_UNARY_MINUS, literal, &literal, 1,
+            element_range(node, element->start, element->end));
+    if (negation == NULL)
+    {
+        int errsv = errno;
+        cypher_ast_free(literal);
+        errno = errsv;
+        return NULL;
+    }
+    return negation;
+}
+
+
+struct cypher_input_range element_range(const struct collection *node,
+        uint32_t start, uint32_t end)
+{
+    const cp_line_index_t *index = node->_astnode.location.line_index;
+    size_t offset = index->start.offset + node->_astnode.start;
+    struct cypher_input_range range =
+        { .start = cp_line_index_position(index, offset + start),
+          .end = cp_line_index_position(index, offset + end) };
+    return range;
+}
+
+
 unsigned int cypher_ast_collection_length(const cypher_astnode_t *astnode)
 {
     REQUIRE_TYPE(astnode, CYPHER_AST_COLLECTION, 0);
@@ -117,7 +311,74 @@ const cypher_astnode_t *cypher_ast_collection_get(
     {
         return NULL;
     }
-    return node->elements[index];
+    struct packed *packed = node->packed;
+    if (packed == NULL)
+    {
+        return node->elements[index];
+    }
+    if (packed->constructed != NULL && packed->constructed[index] != NULL)
+    {
+        return packed->constructed[index];
+    }
+
+    // the elements are constructed using the allocator of the collection,
+    // with their offsets resolved from its line index
+    const struct cp_allocator *prev = cp_set_allocator(&(packed->allocator));
+    const cp_line_index_t *prev_line_index =
+            cypher_ast_set_line_index(astnode->location.line_index);
+    cypher_astnode_t *element = NULL;
+    if (packed->constructed == NULL)
+    {
+        packed->constructed = cp_calloc(node->nelements,
+                sizeof(cypher_astnode_t *));
+    }
+    if (packed->constructed != NULL)
+    {
+        element = construct_element(node, index);
+    }
+    if (element != NULL)
+    {
+        cypher_ast_set_ordinals(element, astnode->ordinal);
+        packed->constructed[index] = element;
+    }
+    cypher_ast_set_line_index(prev_line_index);
+    cp_set_allocator(prev);
+    return element;
+}
+
+
+const int64_t *cypher_ast_collection_get_integers(
+        const cypher_astnode_t *astnode)
+{
+    REQUIRE_TYPE(astnode, CYPHER_AST_COLLECTION, NULL);
+    struct collection *node =
+            container_of(astnode, struct collection, _astnode);
+    return (node->packed != NULL)? node->packed->integers : NULL;
+}
+
+
+const double *cypher_ast_collection_get_floats(
+        const cypher_astnode_t *astnode)
+{
+    REQUIRE_TYPE(astnode, CYPHER_AST_COLLECTION, NULL);
+    struct collection *node =
+            container_of(astnode, struct collection, _astnode);
+    return (node->packed != NULL)? node->packed->floats : NULL;
+}
+
+
+const char *cypher_ast_collection_get_string(const cypher_astnode_t *astnode,
+        unsigned int index)
+{
+    REQUIRE_TYPE(astnode, CYPHER_AST_COLLECTION, NULL);
+    struct collection *node =
+            container_of(astnode, struct collection, _astnode);
+    if (node->packed == NULL || node->packed->type != CYPHER_AST_STRING ||
+            index >= node->nelements)
+    {
+        return NULL;
+    }
+    return node->packed->text + node->packed->elements[index].text;
 }
 
 
@@ -126,5 +387,12 @@ ssize_t detailstr(const cypher_astnode_t *self, char *str, size_t size)
     REQUIRE_TYPE(self, CYPHER_AST_COLLECTION, -1);
     struct collection *node = container_of(self, struct collection, _astnode);
 
-    return snprint_sequence(str, size, node->elements, node->nelements);
+    if (node->packed == NULL)
+    {
+        return snprint_sequence(str, size, node->elements, node->nelements);
+    }
+    const char *typestr = (node->packed->type == CYPHER_AST_INTEGER)?
+            "integers" : (node->packed->type == CYPHER_AST_FLOAT)?
+            "floats" : "strings";
+    return snprintf(str, size, "packed, %zu %s", node->nelements, typestr);
 }
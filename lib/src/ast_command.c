@@ -50,7 +50,7 @@ cypher_astnode_t *cypher_ast_command(const cypher_astnode_t *name,
     REQUIRE_CHILD_ALL(children, nchildren, args, nargs,
             CYPHER_AST_STRING, NULL);
 
-    struct command *node = calloc(1, sizeof(struct command) +
+    struct command *node = cypher_astnode_alloc(sizeof(struct command) +
             nargs * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
@@ -69,7 +69,7 @@ cypher_astnode_t *cypher_ast_command(const cypher_astnode_t *name,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -82,7 +82,8 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     struct command *node = container_of(self, struct command, _astnode);
 
     cypher_astnode_t *name = children[child_index(self, node->name)];
-    cypher_astnode_t **args = calloc(node->nargs, sizeof(cypher_astnode_t *));
+    cypher_astnode_t **args = cp_calloc(node->nargs,
+            sizeof(cypher_astnode_t *));
     if (args == NULL)
     {
         return NULL;
@@ -93,9 +94,9 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     }
 
     cypher_astnode_t *clone = cypher_ast_command(name, args, node->nargs,
-            children, self->nchildren, self->range);
+            children, self->nchildren, cypher_astnode_range(self));
     int errsv = errno;
-    free(args);
+    cp_free(args);
     errno = errsv;
     return clone;
 }
@@ -58,7 +58,7 @@ cypher_astnode_t *cypher_ast_comparison(unsigned int length,
     REQUIRE_CHILD_ALL(children, nchildren, args, length+1,
             CYPHER_AST_EXPRESSION, NULL);
 
-    struct comparison *node = calloc(1, sizeof(struct comparison) +
+    struct comparison *node = cypher_astnode_alloc(sizeof(struct comparison) +
             (length + 1) * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
@@ -67,11 +67,12 @@ cypher_astnode_t *cypher_ast_comparison(unsigned int length,
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_COMPARISON,
             children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->length = length;
-    node->ops = mdup(ops, length * sizeof(cypher_astnode_t *));
+    node->ops = cypher_astnode_mdup(&(node->_astnode), ops,
+            length * sizeof(cypher_astnode_t *));
     if (node->ops == NULL)
     {
         goto cleanup;
@@ -82,8 +83,8 @@ cypher_astnode_t *cypher_ast_comparison(unsigned int length,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node->ops);
-    free(node);
+    cypher_astnode_mfree(&(node->_astnode), node->ops);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -92,7 +93,7 @@ cleanup:
 void comparison_release(cypher_astnode_t *self)
 {
     struct comparison *node = container_of(self, struct comparison, _astnode);
-    free(node->ops);
+    cypher_astnode_mfree(self, node->ops);
     cypher_astnode_release(self);
 }
 
@@ -103,7 +104,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     REQUIRE_TYPE(self, CYPHER_AST_COMPARISON, NULL);
     struct comparison *node = container_of(self, struct comparison, _astnode);
 
-    cypher_astnode_t **args = calloc(node->length + 1,
+    cypher_astnode_t **args = cp_calloc(node->length + 1,
             sizeof(cypher_astnode_t *));
     if (args == NULL)
     {
@@ -115,9 +116,9 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     }
 
     cypher_astnode_t *clone = cypher_ast_comparison(node->length, node->ops,
-            args, children, self->nchildren, self->range);
+            args, children, self->nchildren, cypher_astnode_range(self));
     int errsv = errno;
-    free(args);
+    cp_free(args);
     errno = errsv;
     return clone;
 }
@@ -51,7 +51,7 @@ cypher_astnode_t *cypher_ast_create(bool unique,
 {
     REQUIRE_CHILD(children, nchildren, pattern, CYPHER_AST_PATTERN, NULL);
 
-    struct create *node = calloc(1, sizeof(struct create));
+    struct create *node = cypher_astnode_alloc(sizeof(struct create));
     if (node == NULL)
     {
         return NULL;
@@ -59,7 +59,7 @@ cypher_astnode_t *cypher_ast_create(bool unique,
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_CREATE,
             children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->unique = unique;
@@ -77,7 +77,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *pattern = children[child_index(self, node->pattern)];
 
     return cypher_ast_create(node->unique, pattern, children, self->nchildren,
-            self->range);
+            cypher_astnode_range(self));
 }
 
 
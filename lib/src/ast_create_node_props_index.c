@@ -56,8 +56,9 @@ cypher_astnode_t *cypher_ast_create_node_props_index(
     REQUIRE_CHILD_ALL(children, nchildren, prop_names, nprops,
             CYPHER_AST_PROP_NAME, NULL);
 
-    struct create_index *node = calloc(1, sizeof(struct create_index) +
-            nprops * sizeof(cypher_astnode_t *));
+    struct create_index *node =
+            cypher_astnode_alloc(sizeof(struct create_index) +
+                nprops * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
         return NULL;
@@ -75,7 +76,7 @@ cypher_astnode_t *cypher_ast_create_node_props_index(
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -89,7 +90,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
             container_of(self, struct create_index, _astnode);
 
     cypher_astnode_t *label = children[child_index(self, node->label)];
-    cypher_astnode_t **prop_names = calloc(node->nprops,
+    cypher_astnode_t **prop_names = cp_calloc(node->nprops,
             sizeof(cypher_astnode_t *));
     if (prop_names == NULL)
     {
@@ -102,9 +103,9 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
 
     cypher_astnode_t *clone = cypher_ast_create_node_props_index(label,
             prop_names, node->nprops, children, self->nchildren,
-            self->range);
+            cypher_astnode_range(self));
     int errsv = errno;
-    free(prop_names);
+    cp_free(prop_names);
     errno = errsv;
     return clone;
 }
@@ -57,7 +57,7 @@ cypher_astnode_t *cypher_ast_create_rel_prop_constraint(
     REQUIRE_CHILD(children, nchildren, reltype, CYPHER_AST_RELTYPE, NULL);
     REQUIRE_CHILD(children, nchildren, expression, CYPHER_AST_EXPRESSION, NULL);
 
-    struct constraint *node = calloc(1, sizeof(struct constraint));
+    struct constraint *node = cypher_astnode_alloc(sizeof(struct constraint));
     if (node == NULL)
     {
         return NULL;
@@ -65,7 +65,7 @@ cypher_astnode_t *cypher_ast_create_rel_prop_constraint(
     if (cypher_astnode_init(&(node->_astnode),
             CYPHER_AST_CREATE_REL_PROP_CONSTRAINT, children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->identifier = identifier;
@@ -87,7 +87,8 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *expression = children[child_index(self, node->expression)];
 
     return cypher_ast_create_rel_prop_constraint(identifier, reltype,
-            expression, node->unique, children, self->nchildren, self->range);
+            expression, node->unique, children, self->nchildren,
+            cypher_astnode_range(self));
 }
 
 
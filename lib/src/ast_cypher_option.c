@@ -57,8 +57,9 @@ cypher_astnode_t *cypher_ast_cypher_option(const cypher_astnode_t *version,
     REQUIRE_CHILD_ALL(children, nchildren, params, nparams,
             CYPHER_AST_CYPHER_OPTION_PARAM, NULL);
 
-    struct cypher_option *node = calloc(1, sizeof(struct cypher_option) +
-            nparams * sizeof(cypher_astnode_t *));
+    struct cypher_option *node =
+            cypher_astnode_alloc(sizeof(struct cypher_option) +
+                nparams * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
         return NULL;
@@ -77,7 +78,7 @@ cypher_astnode_t *cypher_ast_cypher_option(const cypher_astnode_t *version,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -92,7 +93,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
 
     cypher_astnode_t *version = (node->version == NULL) ? NULL :
             children[child_index(self, node->version)];
-    cypher_astnode_t **params = calloc(node->nparams,
+    cypher_astnode_t **params = cp_calloc(node->nparams,
             sizeof(cypher_astnode_t *));
     if (params == NULL)
     {
@@ -104,9 +105,10 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     }
 
     cypher_astnode_t *clone = cypher_ast_cypher_option(version,
-            params, node->nparams, children, self->nchildren, self->range);
+            params, node->nparams, children, self->nchildren,
+            cypher_astnode_range(self));
     int errsv = errno;
-    free(params);
+    cp_free(params);
     errno = errsv;
     return clone;
 }
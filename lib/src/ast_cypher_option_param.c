@@ -49,7 +49,7 @@ cypher_astnode_t *cypher_ast_cypher_option_param(const cypher_astnode_t *name,
     REQUIRE_CHILD(children, nchildren, value, CYPHER_AST_STRING, NULL);
 
     struct cypher_option_param *node =
-            calloc(1, sizeof(struct cypher_option_param));
+            cypher_astnode_alloc(sizeof(struct cypher_option_param));
     if (node == NULL)
     {
         return NULL;
@@ -57,7 +57,7 @@ cypher_astnode_t *cypher_ast_cypher_option_param(const cypher_astnode_t *name,
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_CYPHER_OPTION_PARAM,
             children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->name = name;
@@ -77,7 +77,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *value = children[child_index(self, node->value)];
 
     return cypher_ast_cypher_option_param(name, value, children,
-            self->nchildren, self->range);
+            self->nchildren, cypher_astnode_range(self));
 }
 
 
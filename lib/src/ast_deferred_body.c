@@ -0,0 +1,110 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "astnode.h"
+#include "util.h"
+#include <assert.h>
+
+
+struct deferred_body
+{
+    cypher_astnode_t _astnode;
+    cypher_astnode_type_t clause_type;
+    size_t length;
+    char p[];
+};
+
+
+static cypher_astnode_t *clone(const cypher_astnode_t *self,
+        cypher_astnode_t **children);
+static ssize_t detailstr(const cypher_astnode_t *self, char *str, size_t size);
+
+
+const struct cypher_astnode_vt cypher_deferred_body_astnode_vt =
+    { .name = "deferred body",
+      .detailstr = detailstr,
+      .release = cypher_astnode_release,
+      .clone = clone };
+
+
+cypher_astnode_t *cypher_ast_deferred_body(const char *s, size_t n,
+        cypher_astnode_type_t clause_type, struct cypher_input_range range)
+{
+    REQUIRE(s != NULL || n == 0, NULL);
+    struct deferred_body *node = cypher_astnode_alloc(
+            sizeof(struct deferred_body) + n+1);
+    if (node == NULL)
+    {
+        return NULL;
+    }
+    if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_DEFERRED_BODY,
+                NULL, 0, range))
+    {
+        cypher_astnode_dealloc(node);
+        return NULL;
+    }
+    node->clause_type = clause_type;
+    node->length = n;
+    memcpy(node->p, s, n);
+    node->p[n] = '\0';
+    return &(node->_astnode);
+}
+
+
+cypher_astnode_t *clone(const cypher_astnode_t *self,
+        cypher_astnode_t **children)
+{
+    REQUIRE_TYPE(self, CYPHER_AST_DEFERRED_BODY, NULL);
+    struct deferred_body *node =
+            container_of(self, struct deferred_body, _astnode);
+    return cypher_ast_deferred_body(node->p, node->length, node->clause_type,
+            cypher_astnode_range(self));
+}
+
+
+cypher_astnode_type_t cypher_ast_deferred_body_get_clause_type(
+        const cypher_astnode_t *astnode)
+{
+    REQUIRE_TYPE(astnode, CYPHER_AST_DEFERRED_BODY, 0);
+    struct deferred_body *node =
+            container_of(astnode, struct deferred_body, _astnode);
+    return node->clause_type;
+}
+
+
+const char *cypher_ast_deferred_body_get_text(const cypher_astnode_t *astnode,
+        size_t *n)
+{
+    REQUIRE_TYPE(astnode, CYPHER_AST_DEFERRED_BODY, NULL);
+    struct deferred_body *node =
+            container_of(astnode, struct deferred_body, _astnode);
+    if (n != NULL)
+    {
+        *n = node->length;
+    }
+    return node->p;
+}
+
+
+ssize_t detailstr(const cypher_astnode_t *self, char *str, size_t size)
+{
+    REQUIRE_TYPE(self, CYPHER_AST_DEFERRED_BODY, -1);
+    struct deferred_body *node =
+            container_of(self, struct deferred_body, _astnode);
+    return snprintf(str, size, "%s, %zu bytes",
+            cypher_astnode_typestr(node->clause_type), node->length);
+}
@@ -55,8 +55,9 @@ cypher_astnode_t *cypher_ast_delete(bool detach,
     REQUIRE_CHILD_ALL(children, nchildren, expressions, nexpressions,
             CYPHER_AST_EXPRESSION, NULL);
 
-    struct delete_clause *node = calloc(1, sizeof(struct delete_clause) +
-            nexpressions * sizeof(cypher_astnode_t *));
+    struct delete_clause *node =
+            cypher_astnode_alloc(sizeof(struct delete_clause) +
+                nexpressions * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
         return NULL;
@@ -75,7 +76,7 @@ cypher_astnode_t *cypher_ast_delete(bool detach,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -88,7 +89,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     struct delete_clause *node =
             container_of(self, struct delete_clause, _astnode);
 
-    cypher_astnode_t **expressions = calloc(node->nexpressions,
+    cypher_astnode_t **expressions = cp_calloc(node->nexpressions,
             sizeof(cypher_astnode_t *));
     if (expressions == NULL)
     {
@@ -100,9 +101,10 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     }
 
     cypher_astnode_t *clone = cypher_ast_delete(node->detach, expressions,
-            node->nexpressions, children, self->nchildren, self->range);
+            node->nexpressions, children, self->nchildren,
+            cypher_astnode_range(self));
     int errsv = errno;
-    free(expressions);
+    cp_free(expressions);
     errno = errsv;
     return clone;
 }
@@ -57,7 +57,7 @@ cypher_astnode_t *cypher_ast_drop_node_prop_constraint(
     REQUIRE_CHILD(children, nchildren, label, CYPHER_AST_LABEL, NULL);
     REQUIRE_CHILD(children, nchildren, expression, CYPHER_AST_EXPRESSION, NULL);
 
-    struct constraint *node = calloc(1, sizeof(struct constraint));
+    struct constraint *node = cypher_astnode_alloc(sizeof(struct constraint));
     if (node == NULL)
     {
         return NULL;
@@ -65,7 +65,7 @@ cypher_astnode_t *cypher_ast_drop_node_prop_constraint(
     if (cypher_astnode_init(&(node->_astnode),
             CYPHER_AST_DROP_NODE_PROP_CONSTRAINT, children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->identifier = identifier;
@@ -87,7 +87,8 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *expression = children[child_index(self, node->expression)];
 
     return cypher_ast_drop_node_prop_constraint(identifier, label, expression,
-            node->unique, children, self->nchildren, self->range);
+            node->unique, children, self->nchildren,
+            cypher_astnode_range(self));
 }
 
 
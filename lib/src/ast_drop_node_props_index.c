@@ -56,7 +56,7 @@ cypher_astnode_t *cypher_ast_drop_node_props_index(
     REQUIRE_CHILD_ALL(children, nchildren, prop_names, nprops,
             CYPHER_AST_PROP_NAME, NULL);
 
-    struct drop_index *node = calloc(1, sizeof(struct drop_index) +
+    struct drop_index *node = cypher_astnode_alloc(sizeof(struct drop_index) +
             nprops * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
@@ -75,7 +75,7 @@ cypher_astnode_t *cypher_ast_drop_node_props_index(
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -89,7 +89,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
             container_of(self, struct drop_index, _astnode);
 
     cypher_astnode_t *label = children[child_index(self, node->label)];
-    cypher_astnode_t **prop_names = calloc(node->nprops,
+    cypher_astnode_t **prop_names = cp_calloc(node->nprops,
             sizeof(cypher_astnode_t *));
     if (prop_names == NULL)
     {
@@ -101,9 +101,10 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     }
 
     cypher_astnode_t *clone = cypher_ast_drop_node_props_index(label,
-            prop_names, node->nprops, children, self->nchildren, self->range);
+            prop_names, node->nprops, children, self->nchildren,
+            cypher_astnode_range(self));
     int errsv = errno;
-    free(prop_names);
+    cp_free(prop_names);
     errno = errsv;
     return clone;
 }
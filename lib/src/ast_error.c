@@ -23,7 +23,9 @@
 struct error
 {
     cypher_astnode_t _astnode;
-    char p[];
+    size_t length;
+    // the text, following the structure
+    const char *p;
 };
 
 
@@ -42,7 +44,9 @@ const struct cypher_astnode_vt cypher_error_astnode_vt =
 cypher_astnode_t *cypher_ast_error(const char *s, size_t n,
         struct cypher_input_range range)
 {
-    struct error *node = calloc(1, sizeof(struct error) + n+1);
+    const char *p;
+    struct error *node = cypher_astnode_alloc_text(
+            sizeof(struct error), s, n, false, &p);
     if (node == NULL)
     {
         return NULL;
@@ -50,11 +54,11 @@ cypher_astnode_t *cypher_ast_error(const char *s, size_t n,
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_ERROR,
                 NULL, 0, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
-    memcpy(node->p, s, n);
-    node->p[n] = '\0';
+    node->length = n;
+    node->p = p;
     return &(node->_astnode);
 }
 
@@ -64,7 +68,8 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
 {
     REQUIRE_TYPE(self, CYPHER_AST_ERROR, NULL);
     struct error *node = container_of(self, struct error, _astnode);
-    return cypher_ast_error(node->p, strlen(node->p), self->range);
+    return cypher_ast_error(node->p, node->length,
+            cypher_astnode_range(self));
 }
 
 
@@ -76,6 +81,14 @@ const char *cypher_ast_error_get_value(const cypher_astnode_t *astnode)
 }
 
 
+size_t cypher_ast_error_get_length(const cypher_astnode_t *astnode)
+{
+    REQUIRE_TYPE(astnode, CYPHER_AST_ERROR, 0);
+    struct error *node = container_of(astnode, struct error, _astnode);
+    return node->length;
+}
+
+
 ssize_t detailstr(const cypher_astnode_t *self, char *str, size_t size)
 {
     REQUIRE_TYPE(self, CYPHER_AST_ERROR, -1);
@@ -71,7 +71,7 @@ cypher_astnode_t *cypher_ast_extract(const cypher_astnode_t *identifier,
     REQUIRE_CHILD_OPTIONAL(children, nchildren, eval,
             CYPHER_AST_EXPRESSION, NULL);
 
-    struct extract *node = calloc(1, sizeof(struct extract));
+    struct extract *node = cypher_astnode_alloc(sizeof(struct extract));
     if (node == NULL)
     {
         return NULL;
@@ -79,7 +79,7 @@ cypher_astnode_t *cypher_ast_extract(const cypher_astnode_t *identifier,
     if (cypher_list_comprehension_astnode_init(&(node->_list_comprehension_astnode),
             CYPHER_AST_EXTRACT, &lc_vt, children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->identifier = identifier;
@@ -104,7 +104,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
             children[child_index(self, node->eval)];
 
     return cypher_ast_extract(identifier, expression, eval, children,
-            self->nchildren, self->range);
+            self->nchildren, cypher_astnode_range(self));
 }
 
 
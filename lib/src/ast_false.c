@@ -46,7 +46,8 @@ const struct cypher_astnode_vt cypher_false_astnode_vt =
 
 cypher_astnode_t *cypher_ast_false(struct cypher_input_range range)
 {
-    struct false_literal *node = calloc(1, sizeof(struct false_literal));
+    struct false_literal *node =
+            cypher_astnode_alloc(sizeof(struct false_literal));
     if (node == NULL)
     {
         return NULL;
@@ -54,7 +55,7 @@ cypher_astnode_t *cypher_ast_false(struct cypher_input_range range)
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_FALSE,
             NULL, 0, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     return &(node->_astnode);
@@ -65,7 +66,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
         cypher_astnode_t **children)
 {
     REQUIRE_TYPE(self, CYPHER_AST_FALSE, NULL);
-    return cypher_ast_false(self->range);
+    return cypher_ast_false(cypher_astnode_range(self));
 }
 
 
@@ -18,15 +18,21 @@
 #include "astnode.h"
 #include "util.h"
 #include <assert.h>
+#include <errno.h>
+#include <locale.h>
+#include <math.h>
 
 
 struct flt
 {
     cypher_astnode_t _astnode;
+    double value;
+    int err; // ERANGE or EINVAL if the literal could not be decoded
     char p[];
 };
 
 
+
 static cypher_astnode_t *clone(const cypher_astnode_t *self,
         cypher_astnode_t **children);
 static ssize_t detailstr(const cypher_astnode_t *self, char *str, size_t size);
@@ -47,7 +53,7 @@ const struct cypher_astnode_vt cypher_float_astnode_vt =
 cypher_astnode_t *cypher_ast_float(const char *s, size_t n,
         struct cypher_input_range range)
 {
-    struct flt *node = calloc(1, sizeof(struct flt) + n+1);
+    struct flt *node = cypher_astnode_alloc(sizeof(struct flt) + n+1);
     if (node == NULL)
     {
         return NULL;
@@ -55,21 +61,89 @@ cypher_astnode_t *cypher_ast_float(const char *s, size_t n,
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_FLOAT, NULL, 0,
                 range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     memcpy(node->p, s, n);
     node->p[n] = '\0';
+    node->err = cypher_ast_decode_float(node->p, n, &(node->value));
     return &(node->_astnode);
 }
 
 
+int cypher_ast_decode_float(char *s, size_t n, double *value)
+{
+    // check the literal is of the form [0-9]* ('.' [0-9]*)? ([eE] [-+]? [0-9]+)
+    // with at least one digit before the exponent, as strtod accepts more
+    size_t i = 0;
+    size_t ndigits = 0;
+    for (; i < n && s[i] >= '0' && s[i] <= '9'; ++i, ++ndigits)
+        ;
+    char *point = NULL;
+    if (i < n && s[i] == '.')
+    {
+        point = s + i;
+        for (++i; i < n && s[i] >= '0' && s[i] <= '9'; ++i, ++ndigits)
+            ;
+    }
+    if (ndigits == 0)
+    {
+        return EINVAL;
+    }
+    if (i < n && (s[i] == 'e' || s[i] == 'E'))
+    {
+        ++i;
+        if (i < n && (s[i] == '-' || s[i] == '+'))
+        {
+            ++i;
+        }
+        if (i >= n || s[i] < '0' || s[i] > '9')
+        {
+            return EINVAL;
+        }
+        for (; i < n && s[i] >= '0' && s[i] <= '9'; ++i)
+            ;
+    }
+    if (i < n)
+    {
+        return EINVAL;
+    }
+
+    // strtod expects the decimal point of the current locale
+    const char *decimal_point = localeconv()->decimal_point;
+    bool swap_point = point != NULL && decimal_point[0] != '.' &&
+            decimal_point[0] != '\0' && decimal_point[1] == '\0';
+    if (swap_point)
+    {
+        *point = decimal_point[0];
+    }
+    int errsv = errno;
+    errno = 0;
+    char *end;
+    double v = strtod(s, &end);
+    // both overflow and underflow are out of range, rather than decoding
+    // to infinity or (perhaps) zero
+    int err = (end != s + n)? EINVAL : (errno == ERANGE)? ERANGE : 0;
+    errno = errsv;
+    if (swap_point)
+    {
+        *point = '.';
+    }
+    if (err == 0)
+    {
+        *value = v;
+    }
+    return err;
+}
+
+
 cypher_astnode_t *clone(const cypher_astnode_t *self,
         cypher_astnode_t **children)
 {
     REQUIRE_TYPE(self, CYPHER_AST_FLOAT, NULL);
     struct flt *node = container_of(self, struct flt, _astnode);
-    return cypher_ast_float(node->p, strlen(node->p), self->range);
+    return cypher_ast_float(node->p, strlen(node->p),
+            cypher_astnode_range(self));
 }
 
 
@@ -81,6 +155,20 @@ const char *cypher_ast_float_get_valuestr(const cypher_astnode_t *astnode)
 }
 
 
+int cypher_ast_float_get_value(const cypher_astnode_t *astnode, double *value)
+{
+    REQUIRE_TYPE(astnode, CYPHER_AST_FLOAT, -1);
+    struct flt *node = container_of(astnode, struct flt, _astnode);
+    if (node->err != 0)
+    {
+        errno = node->err;
+        return -1;
+    }
+    *value = node->value;
+    return 0;
+}
+
+
 ssize_t detailstr(const cypher_astnode_t *self, char *str, size_t size)
 {
     REQUIRE_TYPE(self, CYPHER_AST_FLOAT, -1);
@@ -58,8 +58,9 @@ cypher_astnode_t *cypher_ast_foreach(const cypher_astnode_t *identifier,
     REQUIRE_CHILD_ALL(children, nchildren, clauses, nclauses,
             CYPHER_AST_QUERY_CLAUSE, NULL);
 
-    struct foreach_clause *node = calloc(1, sizeof(struct foreach_clause) +
-            nclauses * sizeof(cypher_astnode_t *));
+    struct foreach_clause *node =
+            cypher_astnode_alloc(sizeof(struct foreach_clause) +
+                nclauses * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
         return NULL;
@@ -78,7 +79,7 @@ cypher_astnode_t *cypher_ast_foreach(const cypher_astnode_t *identifier,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -93,7 +94,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
 
     cypher_astnode_t *identifier = children[child_index(self, node->identifier)];
     cypher_astnode_t *expression = children[child_index(self, node->expression)];
-    cypher_astnode_t **clauses = calloc(node->nclauses,
+    cypher_astnode_t **clauses = cp_calloc(node->nclauses,
             sizeof(cypher_astnode_t *));
     if (clauses == NULL)
     {
@@ -105,9 +106,10 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     }
 
     cypher_astnode_t *clone = cypher_ast_foreach(identifier, expression,
-            clauses, node->nclauses, children, self->nchildren, self->range);
+            clauses, node->nclauses, children, self->nchildren,
+            cypher_astnode_range(self));
     int errsv = errno;
-    free(clauses);
+    cp_free(clauses);
     errno = errsv;
     return clone;
 }
@@ -23,10 +23,12 @@
 struct function_name
 {
     cypher_astnode_t _astnode;
-    char p[];
+    const struct cp_symbol *symbol;
 };
 
 
+static cypher_astnode_t *construct(const char *s, size_t n,
+        unsigned int id, struct cypher_input_range range);
 static cypher_astnode_t *clone(const cypher_astnode_t *self,
         cypher_astnode_t **children);
 static ssize_t detailstr(const cypher_astnode_t *self, char *str, size_t size);
@@ -42,7 +44,16 @@ const struct cypher_astnode_vt cypher_function_name_astnode_vt =
 cypher_astnode_t *cypher_ast_function_name(const char *s, size_t n,
         struct cypher_input_range range)
 {
-    struct function_name *node = calloc(1, sizeof(struct function_name) + n+1);
+    return construct(s, n, 0, range);
+}
+
+
+cypher_astnode_t *construct(const char *s, size_t n, unsigned int id,
+        struct cypher_input_range range)
+{
+    const struct cp_symbol *symbol;
+    struct function_name *node = cypher_astnode_alloc_named(
+            sizeof(struct function_name), s, n, id, &symbol);
     if (node == NULL)
     {
         return NULL;
@@ -50,11 +61,10 @@ cypher_astnode_t *cypher_ast_function_name(const char *s, size_t n,
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_FUNCTION_NAME,
                 NULL, 0, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
-    memcpy(node->p, s, n);
-    node->p[n] = '\0';
+    node->symbol = symbol;
     return &(node->_astnode);
 }
 
@@ -65,7 +75,8 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     REQUIRE_TYPE(self, CYPHER_AST_FUNCTION_NAME, NULL);
     struct function_name *node =
             container_of(self, struct function_name, _astnode);
-    return cypher_ast_function_name(node->p, strlen(node->p), self->range);
+    return construct(node->symbol->name, node->symbol->length,
+            node->symbol->id, cypher_astnode_range(self));
 }
 
 
@@ -74,7 +85,17 @@ const char *cypher_ast_function_name_get_value(const cypher_astnode_t *astnode)
     REQUIRE_TYPE(astnode, CYPHER_AST_FUNCTION_NAME, NULL);
     struct function_name *node =
             container_of(astnode, struct function_name, _astnode);
-    return node->p;
+    return node->symbol->name;
+}
+
+
+unsigned int cypher_ast_function_name_get_symbol(
+        const cypher_astnode_t *astnode)
+{
+    REQUIRE_TYPE(astnode, CYPHER_AST_FUNCTION_NAME, 0);
+    struct function_name *node =
+            container_of(astnode, struct function_name, _astnode);
+    return node->symbol->id;
 }
 
 
@@ -83,5 +104,5 @@ ssize_t detailstr(const cypher_astnode_t *self, char *str, size_t size)
     REQUIRE_TYPE(self, CYPHER_AST_FUNCTION_NAME, -1);
     struct function_name *node =
             container_of(self, struct function_name, _astnode);
-    return snprintf(str, size, "`%s`", node->p);
+    return snprintf(str, size, "`%s`", node->symbol->name);
 }
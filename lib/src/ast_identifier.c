@@ -23,10 +23,12 @@
 struct identifier
 {
     cypher_astnode_t _astnode;
-    char p[];
+    const struct cp_symbol *symbol;
 };
 
 
+static cypher_astnode_t *construct(const char *s, size_t n,
+        unsigned int id, struct cypher_input_range range);
 static cypher_astnode_t *clone(const cypher_astnode_t *self,
         cypher_astnode_t **children);
 static ssize_t detailstr(const cypher_astnode_t *self, char *str, size_t size);
@@ -47,7 +49,16 @@ const struct cypher_astnode_vt cypher_identifier_astnode_vt =
 cypher_astnode_t *cypher_ast_identifier(const char *s, size_t n,
         struct cypher_input_range range)
 {
-    struct identifier *node = calloc(1, sizeof(struct identifier) + n+1);
+    return construct(s, n, 0, range);
+}
+
+
+cypher_astnode_t *construct(const char *s, size_t n, unsigned int id,
+        struct cypher_input_range range)
+{
+    const struct cp_symbol *symbol;
+    struct identifier *node = cypher_astnode_alloc_named(
+            sizeof(struct identifier), s, n, id, &symbol);
     if (node == NULL)
     {
         return NULL;
@@ -55,11 +66,10 @@ cypher_astnode_t *cypher_ast_identifier(const char *s, size_t n,
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_IDENTIFIER,
                 NULL, 0, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
-    memcpy(node->p, s, n);
-    node->p[n] = '\0';
+    node->symbol = symbol;
     return &(node->_astnode);
 }
 
@@ -69,7 +79,8 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
 {
     REQUIRE_TYPE(self, CYPHER_AST_IDENTIFIER, NULL);
     struct identifier *node = container_of(self, struct identifier, _astnode);
-    return cypher_ast_identifier(node->p, strlen(node->p), self->range);
+    return construct(node->symbol->name, node->symbol->length,
+            node->symbol->id, cypher_astnode_range(self));
 }
 
 
@@ -77,7 +88,15 @@ const char *cypher_ast_identifier_get_name(const cypher_astnode_t *astnode)
 {
     REQUIRE_TYPE(astnode, CYPHER_AST_IDENTIFIER, NULL);
     struct identifier *node = container_of(astnode, struct identifier, _astnode);
-    return node->p;
+    return node->symbol->name;
+}
+
+
+unsigned int cypher_ast_identifier_get_symbol(const cypher_astnode_t *astnode)
+{
+    REQUIRE_TYPE(astnode, CYPHER_AST_IDENTIFIER, 0);
+    struct identifier *node = container_of(astnode, struct identifier, _astnode);
+    return node->symbol->id;
 }
 
 
@@ -85,5 +104,5 @@ ssize_t detailstr(const cypher_astnode_t *self, char *str, size_t size)
 {
     REQUIRE_TYPE(self, CYPHER_AST_IDENTIFIER, -1);
     struct identifier *node = container_of(self, struct identifier, _astnode);
-    return snprintf(str, size, "`%s`", node->p);
+    return snprintf(str, size, "`%s`", node->symbol->name);
 }
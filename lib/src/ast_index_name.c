@@ -42,7 +42,8 @@ const struct cypher_astnode_vt cypher_index_name_astnode_vt =
 cypher_astnode_t *cypher_ast_index_name(const char *s, size_t n,
         struct cypher_input_range range)
 {
-    struct index_name *node = calloc(1, sizeof(struct index_name) + n+1);
+    struct index_name *node =
+            cypher_astnode_alloc(sizeof(struct index_name) + n+1);
     if (node == NULL)
     {
         return NULL;
@@ -50,7 +51,7 @@ cypher_astnode_t *cypher_ast_index_name(const char *s, size_t n,
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_INDEX_NAME, NULL, 0,
                 range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     memcpy(node->p, s, n);
@@ -64,7 +65,8 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
 {
     REQUIRE_TYPE(self, CYPHER_AST_INDEX_NAME, NULL);
     struct index_name *node = container_of(self, struct index_name, _astnode);
-    return cypher_ast_index_name(node->p, strlen(node->p), self->range);
+    return cypher_ast_index_name(node->p, strlen(node->p),
+            cypher_astnode_range(self));
 }
 
 
@@ -18,15 +18,19 @@
 #include "astnode.h"
 #include "util.h"
 #include <assert.h>
+#include <errno.h>
 
 
 struct integer
 {
     cypher_astnode_t _astnode;
+    int64_t value;
+    int err; // ERANGE or EINVAL if the literal could not be decoded
     char p[];
 };
 
 
+
 static cypher_astnode_t *clone(const cypher_astnode_t *self,
         cypher_astnode_t **children);
 static ssize_t detailstr(const cypher_astnode_t *self, char *str, size_t size);
@@ -47,7 +51,7 @@ const struct cypher_astnode_vt cypher_integer_astnode_vt =
 cypher_astnode_t *cypher_ast_integer(const char *s, size_t n,
         struct cypher_input_range range)
 {
-    struct integer *node = calloc(1, sizeof(struct integer) + n+1);
+    struct integer *node = cypher_astnode_alloc(sizeof(struct integer) + n+1);
     if (node == NULL)
     {
         return NULL;
@@ -55,21 +59,77 @@ cypher_astnode_t *cypher_ast_integer(const char *s, size_t n,
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_INTEGER, NULL, 0,
                 range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     memcpy(node->p, s, n);
     node->p[n] = '\0';
+    node->err = cypher_ast_decode_integer(s, n, &(node->value));
     return &(node->_astnode);
 }
 
 
+int cypher_ast_decode_integer(const char *s, size_t n, int64_t *value)
+{
+    unsigned int base = 10;
+    size_t i = 0;
+    if (n > 1 && s[0] == '0')
+    {
+        base = (s[1] == 'x')? 16 : 8;
+        i = (s[1] == 'x' || s[1] == 'o')? 2 : 1;
+    }
+    if (i >= n)
+    {
+        return EINVAL;
+    }
+
+    int err = 0;
+    int64_t v = 0;
+    for (; i < n; ++i)
+    {
+        unsigned int d = base;
+        if (s[i] >= '0' && s[i] <= '9')
+        {
+            d = s[i] - '0';
+        }
+        else if (s[i] >= 'a' && s[i] <= 'f')
+        {
+            d = s[i] - 'a' + 10;
+        }
+        else if (s[i] >= 'A' && s[i] <= 'F')
+        {
+            d = s[i] - 'A' + 10;
+        }
+        if (d >= base)
+        {
+            return EINVAL;
+        }
+        // digits following an overflow are still checked, so that invalid
+        // literals are reported as such
+        if (err == 0 && v > (INT64_MAX - (int64_t)d) / (int64_t)base)
+        {
+            err = ERANGE;
+        }
+        if (err == 0)
+        {
+            v = v * base + d;
+        }
+    }
+    if (err == 0)
+    {
+        *value = v;
+    }
+    return err;
+}
+
+
 cypher_astnode_t *clone(const cypher_astnode_t *self,
         cypher_astnode_t **children)
 {
     REQUIRE_TYPE(self, CYPHER_AST_INTEGER, NULL);
     struct integer *node = container_of(self, struct integer, _astnode);
-    return cypher_ast_integer(node->p, strlen(node->p), self->range);
+    return cypher_ast_integer(node->p, strlen(node->p),
+            cypher_astnode_range(self));
 }
 
 
@@ -81,6 +141,21 @@ const char *cypher_ast_integer_get_valuestr(const cypher_astnode_t *astnode)
 }
 
 
+int cypher_ast_integer_get_value(const cypher_astnode_t *astnode,
+        int64_t *value)
+{
+    REQUIRE_TYPE(astnode, CYPHER_AST_INTEGER, -1);
+    struct integer *node = container_of(astnode, struct integer, _astnode);
+    if (node->err != 0)
+    {
+        errno = node->err;
+        return -1;
+    }
+    *value = node->value;
+    return 0;
+}
+
+
 ssize_t detailstr(const cypher_astnode_t *self, char *str, size_t size)
 {
     REQUIRE_TYPE(self, CYPHER_AST_INTEGER, -1);
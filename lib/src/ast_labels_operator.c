@@ -57,8 +57,9 @@ cypher_astnode_t *cypher_ast_labels_operator(const cypher_astnode_t *expression,
     REQUIRE_CHILD_ALL(children, nchildren, labels, nlabels,
             CYPHER_AST_LABEL, NULL);
 
-    struct labels_operator *node = calloc(1, sizeof(struct labels_operator) +
-            nlabels * sizeof(cypher_astnode_t *));
+    struct labels_operator *node =
+            cypher_astnode_alloc(sizeof(struct labels_operator) +
+                nlabels * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
         return NULL;
@@ -76,7 +77,7 @@ cypher_astnode_t *cypher_ast_labels_operator(const cypher_astnode_t *expression,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -90,7 +91,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
         container_of(self, struct labels_operator, _astnode);
 
     cypher_astnode_t *expression = children[child_index(self, node->expression)];
-    cypher_astnode_t **labels = calloc(node->nlabels,
+    cypher_astnode_t **labels = cp_calloc(node->nlabels,
             sizeof(cypher_astnode_t *));
     if (labels == NULL)
     {
@@ -102,9 +103,10 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     }
 
     cypher_astnode_t *clone = cypher_ast_labels_operator(expression,
-            labels, node->nlabels, children, self->nchildren, self->range);
+            labels, node->nlabels, children, self->nchildren,
+            cypher_astnode_range(self));
     int errsv = errno;
-    free(labels);
+    cp_free(labels);
     errno = errsv;
     return clone;
 }
@@ -0,0 +1,149 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "astnode.h"
+#include "alloc.h"
+#include "parser.h"
+#include "util.h"
+#include <assert.h>
+
+
+struct lazy_clause
+{
+    cypher_astnode_t _astnode;
+    cypher_astnode_type_t clause_type;
+    // the allocator to parse the clause with, being that of the AST
+    struct cp_allocator allocator;
+    // the result of parsing the clause, once materialized
+    cypher_parse_result_t *result;
+    const cypher_astnode_t *clause;
+    size_t length;
+    char p[];
+};
+
+
+static cypher_astnode_t *clone(const cypher_astnode_t *self,
+        cypher_astnode_t **children);
+static ssize_t detailstr(const cypher_astnode_t *self, char *str, size_t size);
+static void lazy_clause_release(cypher_astnode_t *self);
+
+
+static const struct cypher_astnode_vt *parents[] =
+    { &cypher_query_clause_astnode_vt };
+
+const struct cypher_astnode_vt cypher_lazy_clause_astnode_vt =
+    { .parents = parents,
+      .nparents = 1,
+      .name = "lazy clause",
+      .detailstr = detailstr,
+      .release = lazy_clause_release,
+      .clone = clone };
+
+
+cypher_astnode_t *cypher_ast_lazy_clause(const char *s, size_t n,
+        cypher_astnode_type_t clause_type, struct cypher_input_range range)
+{
+    REQUIRE(s != NULL && n > 0, NULL);
+    struct lazy_clause *node = cypher_astnode_alloc(
+            sizeof(struct lazy_clause) + n+1);
+    if (node == NULL)
+    {
+        return NULL;
+    }
+    if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_LAZY_CLAUSE,
+                NULL, 0, range))
+    {
+        cypher_astnode_dealloc(node);
+        return NULL;
+    }
+    node->clause_type = clause_type;
+    node->allocator = cp_current_allocator();
+    node->length = n;
+    memcpy(node->p, s, n);
+    node->p[n] = '\0';
+    return &(node->_astnode);
+}
+
+
+cypher_astnode_t *clone(const cypher_astnode_t *self,
+        cypher_astnode_t **children)
+{
+    REQUIRE_TYPE(self, CYPHER_AST_LAZY_CLAUSE, NULL);
+    struct lazy_clause *node =
+            container_of(self, struct lazy_clause, _astnode);
+    return cypher_ast_lazy_clause(node->p, node->length, node->clause_type,
+            cypher_astnode_range(self));
+}
+
+
+void lazy_clause_release(cypher_astnode_t *self)
+{
+    struct lazy_clause *node =
+            container_of(self, struct lazy_clause, _astnode);
+    cypher_parse_result_free(node->result);
+    cypher_astnode_release(self);
+}
+
+
+cypher_astnode_type_t cypher_ast_lazy_clause_get_clause_type(
+        const cypher_astnode_t *astnode)
+{
+    REQUIRE_TYPE(astnode, CYPHER_AST_LAZY_CLAUSE, 0);
+    struct lazy_clause *node =
+            container_of(astnode, struct lazy_clause, _astnode);
+    return node->clause_type;
+}
+
+
+const cypher_astnode_t *cypher_ast_lazy_clause_get_clause(
+        const cypher_astnode_t *astnode)
+{
+    REQUIRE_TYPE(astnode, CYPHER_AST_LAZY_CLAUSE, NULL);
+    struct lazy_clause *node =
+            container_of(astnode, struct lazy_clause, _astnode);
+    if (node->clause != NULL)
+    {
+        return node->clause;
+    }
+
+    // the text was matched as a clause when the query was parsed, so
+    // parsing can only fail due to resource limits
+    cypher_parse_result_t *result = cp_parse_clause(node->p, node->length,
+            cypher_astnode_range(astnode).start, astnode->ordinal,
+            &(node->allocator));
+    if (result == NULL)
+    {
+        return NULL;
+    }
+    const cypher_astnode_t *clause =
+            cypher_parse_result_get_directive(result, 0);
+    assert(clause != NULL &&
+            cypher_astnode_type(clause) == node->clause_type);
+    node->result = result;
+    node->clause = clause;
+    return clause;
+}
+
+
+ssize_t detailstr(const cypher_astnode_t *self, char *str, size_t size)
+{
+    REQUIRE_TYPE(self, CYPHER_AST_LAZY_CLAUSE, -1);
+    struct lazy_clause *node =
+            container_of(self, struct lazy_clause, _astnode);
+    return snprintf(str, size, "%s, %zu bytes",
+            cypher_astnode_typestr(node->clause_type), node->length);
+}
@@ -23,10 +23,14 @@
 struct comment
 {
     cypher_astnode_t _astnode;
-    char p[];
+    size_t length;
+    // the text, following the structure unless referenced
+    const char *p;
 };
 
 
+static cypher_astnode_t *construct(const char *s, size_t n, bool ref,
+        struct cypher_input_range range);
 static cypher_astnode_t *clone(const cypher_astnode_t *self,
         cypher_astnode_t **children);
 static ssize_t detailstr(const cypher_astnode_t *self, char *str, size_t size);
@@ -47,7 +51,23 @@ const struct cypher_astnode_vt cypher_line_comment_astnode_vt =
 cypher_astnode_t *cypher_ast_line_comment(const char *s, size_t n,
         struct cypher_input_range range)
 {
-    struct comment *node = calloc(1, sizeof(struct comment) + n+1);
+    return construct(s, n, false, range);
+}
+
+
+cypher_astnode_t *cypher_ast_line_comment_ref(const char *s, size_t n,
+        struct cypher_input_range range)
+{
+    return construct(s, n, true, range);
+}
+
+
+cypher_astnode_t *construct(const char *s, size_t n, bool ref,
+        struct cypher_input_range range)
+{
+    const char *p;
+    struct comment *node = cypher_astnode_alloc_text(
+            sizeof(struct comment), s, n, ref, &p);
     if (node == NULL)
     {
         return NULL;
@@ -55,11 +75,11 @@ cypher_astnode_t *cypher_ast_line_comment(const char *s, size_t n,
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_LINE_COMMENT,
                 NULL, 0, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
-    memcpy(node->p, s, n);
-    node->p[n] = '\0';
+    node->length = n;
+    node->p = p;
     return &(node->_astnode);
 }
 
@@ -69,7 +89,8 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
 {
     REQUIRE_TYPE(self, CYPHER_AST_LINE_COMMENT, NULL);
     struct comment *node = container_of(self, struct comment, _astnode);
-    return cypher_ast_line_comment(node->p, strlen(node->p), self->range);
+    return cypher_ast_line_comment(node->p, node->length,
+            cypher_astnode_range(self));
 }
 
 
@@ -81,6 +102,14 @@ const char *cypher_ast_line_comment_get_value(const cypher_astnode_t *astnode)
 }
 
 
+size_t cypher_ast_line_comment_get_length(const cypher_astnode_t *astnode)
+{
+    REQUIRE_TYPE(astnode, CYPHER_AST_LINE_COMMENT, 0);
+    struct comment *node = container_of(astnode, struct comment, _astnode);
+    return node->length;
+}
+
+
 ssize_t detailstr(const cypher_astnode_t *self, char *str, size_t size)
 {
     REQUIRE_TYPE(self, CYPHER_AST_LINE_COMMENT, -1);
@@ -93,7 +93,7 @@ cypher_astnode_t *cypher_ast_list_comprehension(
             CYPHER_AST_EXPRESSION, NULL);
 
     struct list_comprehension *node =
-            calloc(1, sizeof(struct list_comprehension));
+            cypher_astnode_alloc(sizeof(struct list_comprehension));
     if (node == NULL)
     {
         return NULL;
@@ -113,7 +113,7 @@ cypher_astnode_t *cypher_ast_list_comprehension(
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -136,7 +136,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
         children[child_index(self, node->eval)];
 
     return cypher_ast_list_comprehension(identifier, expression, predicate,
-            eval, children, self->nchildren, self->range);
+            eval, children, self->nchildren, cypher_astnode_range(self));
 }
 
 
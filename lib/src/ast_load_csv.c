@@ -57,7 +57,7 @@ cypher_astnode_t *cypher_ast_load_csv(bool with_headers,
     REQUIRE_CHILD_OPTIONAL(children, nchildren, field_terminator,
             CYPHER_AST_STRING, NULL);
 
-    struct loadcsv *node = calloc(1, sizeof(struct loadcsv));
+    struct loadcsv *node = cypher_astnode_alloc(sizeof(struct loadcsv));
     if (node == NULL)
     {
         return NULL;
@@ -65,7 +65,7 @@ cypher_astnode_t *cypher_ast_load_csv(bool with_headers,
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_LOAD_CSV,
             children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->with_headers = with_headers;
@@ -88,7 +88,8 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
         children[child_index(self, node->field_terminator)];
 
     return cypher_ast_load_csv(node->with_headers, url, identifier,
-            field_terminator, children, self->nchildren, self->range);
+            field_terminator, children, self->nchildren,
+            cypher_astnode_range(self));
 }
 
 
@@ -16,14 +16,23 @@
  */
 #include "../../config.h"
 #include "astnode.h"
+#include "symbol_table.h"
 #include "util.h"
 #include <assert.h>
 
 
+// maps with fewer entries are searched linearly, without an index
+#define MAP_INDEX_MIN_ENTRIES 8
+
+
 struct map
 {
     cypher_astnode_t _astnode;
-    size_t nentries;
+    unsigned int nentries;
+    // the index + 1 of the first key that repeats an earlier key, if any
+    // (only determined for indexed maps)
+    unsigned int duplicate;
+    // followed by the slots of the index, each the index + 1 of an entry
     const cypher_astnode_t *pairs[];
 };
 
@@ -31,6 +40,7 @@ struct map
 static cypher_astnode_t *clone(const cypher_astnode_t *self,
         cypher_astnode_t **children);
 static ssize_t detailstr(const cypher_astnode_t *self, char *str, size_t size);
+static void build_index(struct map *node);
 
 
 static const struct cypher_astnode_vt *parents[] =
@@ -45,12 +55,35 @@ const struct cypher_astnode_vt cypher_map_astnode_vt =
       .clone = clone };
 
 
+static unsigned int index_capacity(unsigned int nentries)
+{
+    if (nentries < MAP_INDEX_MIN_ENTRIES)
+    {
+        return 0;
+    }
+    unsigned int capacity = MAP_INDEX_MIN_ENTRIES * 2;
+    while (capacity < nentries * 2)
+    {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+
+static inline size_t index_offset(unsigned int nentries)
+{
+    return sizeof(struct map) + nentries * 2 * sizeof(cypher_astnode_t *);
+}
+
+
 static struct map *map_init(unsigned int nentries,
         cypher_astnode_t **children, unsigned int nchildren,
         struct cypher_input_range range)
 {
-    struct map *node = calloc(1, sizeof(struct map) +
-            nentries * 2 * sizeof(cypher_astnode_t *));
+    // the index is allocated with the node, and built once the entries are
+    // set, so the node is never modified after construction
+    struct map *node = cypher_astnode_alloc(index_offset(nentries) +
+            index_capacity(nentries) * sizeof(uint32_t));
     if (node == NULL)
     {
         return NULL;
@@ -66,7 +99,7 @@ static struct map *map_init(unsigned int nentries,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -91,6 +124,7 @@ cypher_astnode_t *cypher_ast_map(cypher_astnode_t * const *keys,
         node->pairs[i*2] = keys[i];
         node->pairs[i*2 + 1] = values[i];
     }
+    build_index(node);
     return &(node->_astnode);
 }
 
@@ -111,6 +145,7 @@ cypher_astnode_t *cypher_ast_pair_map(cypher_astnode_t * const *pairs,
         return NULL;
     }
     memcpy(node->pairs, pairs, nentries * 2 * sizeof(cypher_astnode_t *));
+    build_index(node);
     return &(node->_astnode);
 }
 
@@ -121,21 +156,21 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     REQUIRE_TYPE(self, CYPHER_AST_MAP, NULL);
     struct map *node = container_of(self, struct map, _astnode);
 
-    cypher_astnode_t **pairs = calloc(node->nentries,
+    cypher_astnode_t **pairs = cp_calloc(node->nentries * 2,
             sizeof(cypher_astnode_t *));
     if (pairs == NULL)
     {
         return NULL;
     }
-    for (unsigned int i = 0; i < node->nentries; ++i)
+    for (unsigned int i = 0; i < node->nentries * 2; ++i)
     {
         pairs[i] = children[child_index(self, node->pairs[i])];
     }
 
     cypher_astnode_t *clone = cypher_ast_pair_map(pairs, node->nentries,
-            children, self->nchildren, self->range);
+            children, self->nchildren, cypher_astnode_range(self));
     int errsv = errno;
-    free(pairs);
+    cp_free(pairs);
     errno = errsv;
     return clone;
 }
@@ -175,6 +210,106 @@ const cypher_astnode_t *cypher_ast_map_get_value(const cypher_astnode_t *astnode
 }
 
 
+static bool key_equal(const cypher_astnode_t *key, const char *s, size_t n)
+{
+    const char *name = cypher_ast_prop_name_get_value(key);
+    return strlen(name) == n && memcmp(name, s, n) == 0;
+}
+
+
+// find the slot for a key, being either empty or that of the key
+static unsigned int index_find(const struct map *node, unsigned int capacity,
+        const char *s, size_t n)
+{
+    const uint32_t *slots = (const uint32_t *)(const void *)
+            ((const char *)node + index_offset(node->nentries));
+    unsigned int mask = capacity - 1;
+    unsigned int i = cp_hash_name(s, n) & mask;
+    while (slots[i] != 0 && !key_equal(node->pairs[(slots[i] - 1) * 2], s, n))
+    {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+
+void build_index(struct map *node)
+{
+    unsigned int capacity = index_capacity(node->nentries);
+    if (capacity == 0)
+    {
+        return;
+    }
+    uint32_t *slots = (uint32_t *)(void *)
+            ((char *)node + index_offset(node->nentries));
+    for (unsigned int i = 0; i < node->nentries; ++i)
+    {
+        const char *name = cypher_ast_prop_name_get_value(node->pairs[i*2]);
+        unsigned int j = index_find(node, capacity, name, strlen(name));
+        if (slots[j] != 0 && node->duplicate == 0)
+        {
+            node->duplicate = i + 1;
+        }
+        // the last entry for a key takes precedence
+        slots[j] = i + 1;
+    }
+}
+
+
+const cypher_astnode_t *cypher_ast_map_get_by_key(
+        const cypher_astnode_t *astnode, const char *s, size_t n)
+{
+    REQUIRE_TYPE(astnode, CYPHER_AST_MAP, NULL);
+    struct map *node = container_of(astnode, struct map, _astnode);
+
+    unsigned int capacity = index_capacity(node->nentries);
+    if (capacity == 0)
+    {
+        for (unsigned int i = node->nentries; i-- > 0; )
+        {
+            if (key_equal(node->pairs[i*2], s, n))
+            {
+                return node->pairs[i*2 + 1];
+            }
+        }
+        return NULL;
+    }
+
+    const uint32_t *slots = (const uint32_t *)(const void *)
+            ((const char *)node + index_offset(node->nentries));
+    uint32_t slot = slots[index_find(node, capacity, s, n)];
+    return (slot == 0)? NULL : node->pairs[(slot - 1) * 2 + 1];
+}
+
+
+const cypher_astnode_t *cypher_ast_map_get_duplicate_key(
+        const cypher_astnode_t *astnode)
+{
+    REQUIRE_TYPE(astnode, CYPHER_AST_MAP, NULL);
+    struct map *node = container_of(astnode, struct map, _astnode);
+
+    if (index_capacity(node->nentries) > 0)
+    {
+        return (node->duplicate == 0)? NULL :
+                node->pairs[(node->duplicate - 1) * 2];
+    }
+
+    for (unsigned int i = 1; i < node->nentries; ++i)
+    {
+        const char *name = cypher_ast_prop_name_get_value(node->pairs[i*2]);
+        size_t n = strlen(name);
+        for (unsigned int j = 0; j < i; ++j)
+        {
+            if (key_equal(node->pairs[j*2], name, n))
+            {
+                return node->pairs[i*2];
+            }
+        }
+    }
+    return NULL;
+}
+
+
 ssize_t detailstr(const cypher_astnode_t *self, char *str, size_t size)
 {
     REQUIRE_TYPE(self, CYPHER_AST_MAP, -1);
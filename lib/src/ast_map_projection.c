@@ -55,8 +55,9 @@ cypher_astnode_t *cypher_ast_map_projection(
 {
     REQUIRE_CHILD(children, nchildren, expression, CYPHER_AST_EXPRESSION, NULL);
 
-    struct map_projection *node = calloc(1, sizeof(struct map_projection) +
-            nselectors * sizeof(cypher_astnode_t *));
+    struct map_projection *node =
+            cypher_astnode_alloc(sizeof(struct map_projection) +
+                nselectors * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
         return NULL;
@@ -64,7 +65,7 @@ cypher_astnode_t *cypher_ast_map_projection(
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_MAP_PROJECTION,
             children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->expression = expression;
@@ -82,7 +83,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
             container_of(self, struct map_projection, _astnode);
 
     cypher_astnode_t *expression = children[child_index(self, node->expression)];
-    cypher_astnode_t **selectors = calloc(node->nselectors,
+    cypher_astnode_t **selectors = cp_calloc(node->nselectors,
             sizeof(cypher_astnode_t *));
     if (selectors == NULL)
     {
@@ -95,9 +96,9 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
 
     cypher_astnode_t *clone = cypher_ast_map_projection(expression,
             selectors, node->nselectors, children, self->nchildren,
-            self->range);
+            cypher_astnode_range(self));
     int errsv = errno;
-    free(selectors);
+    cp_free(selectors);
     errno = errsv;
     return clone;
 }
@@ -48,7 +48,7 @@ cypher_astnode_t *cypher_ast_map_projection_all_properties(
         struct cypher_input_range range)
 {
     struct map_projection_all_properties *node =
-            calloc(1, sizeof(struct map_projection_all_properties));
+            cypher_astnode_alloc(sizeof(struct map_projection_all_properties));
     if (node == NULL)
     {
         return NULL;
@@ -57,7 +57,7 @@ cypher_astnode_t *cypher_ast_map_projection_all_properties(
             CYPHER_AST_MAP_PROJECTION_ALL_PROPERTIES,
             children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     return &(node->_astnode);
@@ -69,7 +69,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
 {
     REQUIRE_TYPE(self, CYPHER_AST_MAP_PROJECTION_ALL_PROPERTIES, NULL);
     return cypher_ast_map_projection_all_properties(children, self->nchildren,
-            self->range);
+            cypher_astnode_range(self));
 }
 
 
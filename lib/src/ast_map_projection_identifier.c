@@ -52,7 +52,7 @@ cypher_astnode_t *cypher_ast_map_projection_identifier(
     REQUIRE_CHILD(children, nchildren, identifier, CYPHER_AST_IDENTIFIER, NULL);
 
     struct map_projection_identifier *node =
-            calloc(1, sizeof(struct map_projection_identifier));
+            cypher_astnode_alloc(sizeof(struct map_projection_identifier));
     if (node == NULL)
     {
         return NULL;
@@ -60,7 +60,7 @@ cypher_astnode_t *cypher_ast_map_projection_identifier(
     if (cypher_astnode_init(&(node->_astnode),
             CYPHER_AST_MAP_PROJECTION_IDENTIFIER, children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->identifier = identifier;
@@ -78,7 +78,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *identifier = children[child_index(self, node->identifier)];
 
     return cypher_ast_map_projection_identifier(identifier, children,
-            self->nchildren, self->range);
+            self->nchildren, cypher_astnode_range(self));
 }
 
 
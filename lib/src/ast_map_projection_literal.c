@@ -54,7 +54,7 @@ cypher_astnode_t *cypher_ast_map_projection_literal(
     REQUIRE_CHILD(children, nchildren, expression, CYPHER_AST_EXPRESSION, NULL);
 
     struct map_projection_literal *node =
-            calloc(1, sizeof(struct map_projection_literal));
+            cypher_astnode_alloc(sizeof(struct map_projection_literal));
     if (node == NULL)
     {
         return NULL;
@@ -62,7 +62,7 @@ cypher_astnode_t *cypher_ast_map_projection_literal(
     if (cypher_astnode_init(&(node->_astnode),
             CYPHER_AST_MAP_PROJECTION_LITERAL, children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->prop_name = prop_name;
@@ -82,7 +82,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *expression = children[child_index(self, node->expression)];
 
     return cypher_ast_map_projection_literal(prop_name, expression, children,
-            self->nchildren, self->range);
+            self->nchildren, cypher_astnode_range(self));
 }
 
 
@@ -52,7 +52,7 @@ cypher_astnode_t *cypher_ast_map_projection_property(
     REQUIRE_CHILD(children, nchildren, prop_name, CYPHER_AST_PROP_NAME, NULL);
 
     struct map_projection_property *node =
-            calloc(1, sizeof(struct map_projection_property));
+            cypher_astnode_alloc(sizeof(struct map_projection_property));
     if (node == NULL)
     {
         return NULL;
@@ -60,7 +60,7 @@ cypher_astnode_t *cypher_ast_map_projection_property(
     if (cypher_astnode_init(&(node->_astnode),
             CYPHER_AST_MAP_PROJECTION_PROPERTY, children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->prop_name = prop_name;
@@ -78,7 +78,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *prop_name = children[child_index(self, node->prop_name)];
 
     return cypher_ast_map_projection_property(prop_name, children,
-            self->nchildren, self->range);
+            self->nchildren, cypher_astnode_range(self));
 }
 
 
@@ -60,7 +60,7 @@ cypher_astnode_t *cypher_ast_match(bool optional,
     REQUIRE_CHILD_OPTIONAL(children, nchildren, predicate,
             CYPHER_AST_EXPRESSION, NULL);
 
-    struct match *node = calloc(1, sizeof(struct match) +
+    struct match *node = cypher_astnode_alloc(sizeof(struct match) +
             nhints * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
@@ -81,7 +81,7 @@ cypher_astnode_t *cypher_ast_match(bool optional,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -94,7 +94,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     struct match *node = container_of(self, struct match, _astnode);
 
     cypher_astnode_t *pattern = children[child_index(self, node->pattern)];
-    cypher_astnode_t **hints = calloc(node->nhints,
+    cypher_astnode_t **hints = cp_calloc(node->nhints,
             sizeof(cypher_astnode_t *));
     if (hints == NULL)
     {
@@ -109,9 +109,9 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
 
     cypher_astnode_t *clone = cypher_ast_match(node->optional,
             pattern, hints, node->nhints, predicate, children, self->nchildren,
-            self->range);
+            cypher_astnode_range(self));
     int errsv = errno;
-    free(hints);
+    cp_free(hints);
     errno = errsv;
     return clone;
 }
@@ -55,7 +55,7 @@ cypher_astnode_t *cypher_ast_merge(const cypher_astnode_t *path,
     REQUIRE_CHILD_ALL(children, nchildren, actions, nactions,
             CYPHER_AST_MERGE_ACTION, NULL);
 
-    struct merge *node = calloc(1, sizeof(struct merge) +
+    struct merge *node = cypher_astnode_alloc(sizeof(struct merge) +
             nactions * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
@@ -74,7 +74,7 @@ cypher_astnode_t *cypher_ast_merge(const cypher_astnode_t *path,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -87,7 +87,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     struct merge *node = container_of(self, struct merge, _astnode);
 
     cypher_astnode_t *path = children[child_index(self, node->path)];
-    cypher_astnode_t **actions = calloc(node->nactions,
+    cypher_astnode_t **actions = cp_calloc(node->nactions,
             sizeof(cypher_astnode_t *));
     if (actions == NULL)
     {
@@ -99,9 +99,9 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     }
 
     cypher_astnode_t *clone = cypher_ast_merge(path, actions, node->nactions,
-            children, self->nchildren, self->range);
+            children, self->nchildren, cypher_astnode_range(self));
     int errsv = errno;
-    free(actions);
+    cp_free(actions);
     errno = errsv;
     return clone;
 }
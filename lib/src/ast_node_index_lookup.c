@@ -60,7 +60,8 @@ cypher_astnode_t *cypher_ast_node_index_lookup(
             cypher_astnode_instanceof(lookup, CYPHER_AST_PARAMETER), NULL);
     REQUIRE_CONTAINS(children, nchildren, lookup, NULL);
 
-    struct node_index_lookup *node = calloc(1, sizeof(struct node_index_lookup));
+    struct node_index_lookup *node =
+            cypher_astnode_alloc(sizeof(struct node_index_lookup));
     if (node == NULL)
     {
         return NULL;
@@ -68,7 +69,7 @@ cypher_astnode_t *cypher_ast_node_index_lookup(
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_NODE_INDEX_LOOKUP,
             children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->identifier = identifier;
@@ -92,7 +93,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *lookup = children[child_index(self, node->lookup)];
 
     return cypher_ast_node_index_lookup(identifier, index_name, prop_name,
-            lookup, children, self->nchildren, self->range);
+            lookup, children, self->nchildren, cypher_astnode_range(self));
 }
 
 
@@ -57,7 +57,8 @@ cypher_astnode_t *cypher_ast_node_index_query(
             cypher_astnode_instanceof(query, CYPHER_AST_PARAMETER), NULL);
     REQUIRE_CONTAINS(children, nchildren, query, NULL);
 
-    struct node_index_query *node = calloc(1, sizeof(struct node_index_query));
+    struct node_index_query *node =
+            cypher_astnode_alloc(sizeof(struct node_index_query));
     if (node == NULL)
     {
         return NULL;
@@ -65,7 +66,7 @@ cypher_astnode_t *cypher_ast_node_index_query(
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_NODE_INDEX_QUERY,
             children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->identifier = identifier;
@@ -87,7 +88,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *query = children[child_index(self, node->query)];
 
     return cypher_ast_node_index_query(identifier, index_name, query, children,
-            self->nchildren, self->range);
+            self->nchildren, cypher_astnode_range(self));
 }
 
 
@@ -55,8 +55,9 @@ cypher_astnode_t *cypher_ast_node_pattern(const cypher_astnode_t *identifier,
             cypher_astnode_instanceof(properties, CYPHER_AST_PARAMETER), NULL);
     REQUIRE_CONTAINS_OPTIONAL(children, nchildren, properties, NULL);
 
-    struct node_pattern *node = calloc(1, sizeof(struct node_pattern) +
-            nlabels * sizeof(cypher_astnode_t *));
+    struct node_pattern *node =
+            cypher_astnode_alloc(sizeof(struct node_pattern) +
+                nlabels * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
         return NULL;
@@ -75,7 +76,7 @@ cypher_astnode_t *cypher_ast_node_pattern(const cypher_astnode_t *identifier,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -90,7 +91,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
 
     cypher_astnode_t *identifier = (node->identifier == NULL) ? NULL :
         children[child_index(self, node->identifier)];
-    cypher_astnode_t **labels = calloc(node->nlabels,
+    cypher_astnode_t **labels = cp_calloc(node->nlabels,
             sizeof(cypher_astnode_t *));
     if (labels == NULL)
     {
@@ -104,9 +105,10 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
         children[child_index(self, node->properties)];
 
     cypher_astnode_t *clone = cypher_ast_node_pattern(identifier, labels,
-            node->nlabels, properties, children, self->nchildren, self->range);
+            node->nlabels, properties, children, self->nchildren,
+            cypher_astnode_range(self));
     int errsv = errno;
-    free(labels);
+    cp_free(labels);
     errno = errsv;
     return clone;
 }
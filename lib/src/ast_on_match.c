@@ -53,7 +53,7 @@ cypher_astnode_t *cypher_ast_on_match(cypher_astnode_t * const *items,
     REQUIRE_CHILD_ALL(children, nchildren, items, nitems,
             CYPHER_AST_SET_ITEM, NULL);
 
-    struct on_match *node = calloc(1, sizeof(struct on_match) +
+    struct on_match *node = cypher_astnode_alloc(sizeof(struct on_match) +
             nitems * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
@@ -71,7 +71,7 @@ cypher_astnode_t *cypher_ast_on_match(cypher_astnode_t * const *items,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -83,7 +83,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     REQUIRE_TYPE(self, CYPHER_AST_ON_MATCH, NULL);
     struct on_match *node = container_of(self, struct on_match, _astnode);
 
-    cypher_astnode_t **items = calloc(node->nitems,
+    cypher_astnode_t **items = cp_calloc(node->nitems,
             sizeof(cypher_astnode_t *));
     if (items == NULL)
     {
@@ -95,9 +95,9 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     }
 
     cypher_astnode_t *clone = cypher_ast_on_match(items, node->nitems,
-            children, self->nchildren, self->range);
+            children, self->nchildren, cypher_astnode_range(self));
     int errsv = errno;
-    free(items);
+    cp_free(items);
     errno = errsv;
     return clone;
 }
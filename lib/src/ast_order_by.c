@@ -48,7 +48,7 @@ cypher_astnode_t *cypher_ast_order_by(cypher_astnode_t * const *items,
     REQUIRE_CHILD_ALL(children, nchildren, items, nitems,
             CYPHER_AST_SORT_ITEM, NULL);
 
-    struct order_by *node = calloc(1, sizeof(struct order_by) +
+    struct order_by *node = cypher_astnode_alloc(sizeof(struct order_by) +
             nitems * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
@@ -66,7 +66,7 @@ cypher_astnode_t *cypher_ast_order_by(cypher_astnode_t * const *items,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -78,7 +78,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     REQUIRE_TYPE(self, CYPHER_AST_ORDER_BY, NULL);
     struct order_by *node = container_of(self, struct order_by, _astnode);
 
-    cypher_astnode_t **items = calloc(node->nitems,
+    cypher_astnode_t **items = cp_calloc(node->nitems,
             sizeof(cypher_astnode_t *));
     if (items == NULL)
     {
@@ -90,9 +90,9 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     }
 
     cypher_astnode_t *clone = cypher_ast_order_by(items, node->nitems,
-            children, self->nchildren, self->range);
+            children, self->nchildren, cypher_astnode_range(self));
     int errsv = errno;
-    free(items);
+    cp_free(items);
     errno = errsv;
     return clone;
 }
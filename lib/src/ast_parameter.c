@@ -47,7 +47,8 @@ const struct cypher_astnode_vt cypher_parameter_astnode_vt =
 cypher_astnode_t *cypher_ast_parameter(const char *s, size_t n,
         struct cypher_input_range range)
 {
-    struct parameter *node = calloc(1, sizeof(struct parameter) + n+1);
+    struct parameter *node =
+            cypher_astnode_alloc(sizeof(struct parameter) + n+1);
     if (node == NULL)
     {
         return NULL;
@@ -55,7 +56,7 @@ cypher_astnode_t *cypher_ast_parameter(const char *s, size_t n,
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_PARAMETER,
                 NULL, 0, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     memcpy(node->p, s, n);
@@ -69,7 +70,8 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
 {
     REQUIRE_TYPE(self, CYPHER_AST_PARAMETER, NULL);
     struct parameter *node = container_of(self, struct parameter, _astnode);
-    return cypher_ast_parameter(node->p, strlen(node->p), self->range);
+    return cypher_ast_parameter(node->p, strlen(node->p),
+            cypher_astnode_range(self));
 }
 
 
@@ -48,7 +48,7 @@ cypher_astnode_t *cypher_ast_pattern(cypher_astnode_t * const *paths,
     REQUIRE_CHILD_ALL(children, nchildren, paths, npaths,
             CYPHER_AST_PATTERN_PATH, NULL);
 
-    struct pattern *node = calloc(1, sizeof(struct pattern) +
+    struct pattern *node = cypher_astnode_alloc(sizeof(struct pattern) +
             npaths * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
@@ -66,7 +66,7 @@ cypher_astnode_t *cypher_ast_pattern(cypher_astnode_t * const *paths,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -78,7 +78,8 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     REQUIRE_TYPE(self, CYPHER_AST_PATTERN, NULL);
     struct pattern *node = container_of(self, struct pattern, _astnode);
 
-    cypher_astnode_t **paths = calloc(node->npaths, sizeof(cypher_astnode_t *));
+    cypher_astnode_t **paths = cp_calloc(node->npaths,
+            sizeof(cypher_astnode_t *));
     if (paths == NULL)
     {
         return NULL;
@@ -89,9 +90,9 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     }
 
     cypher_astnode_t *clone = cypher_ast_pattern(paths, node->npaths,
-            children, self->nchildren, self->range);
+            children, self->nchildren, cypher_astnode_range(self));
     int errsv = errno;
-    free(paths);
+    cp_free(paths);
     errno = errsv;
     return clone;
 }
@@ -61,7 +61,7 @@ cypher_astnode_t *cypher_ast_pattern_comprehension(
     REQUIRE_CHILD(children, nchildren, eval, CYPHER_AST_EXPRESSION, NULL);
 
     struct pattern_comprehension *node =
-            calloc(1, sizeof(struct pattern_comprehension));
+            cypher_astnode_alloc(sizeof(struct pattern_comprehension));
     if (node == NULL)
     {
         return NULL;
@@ -69,7 +69,7 @@ cypher_astnode_t *cypher_ast_pattern_comprehension(
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_PATTERN_COMPREHENSION,
                 children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
 
@@ -92,12 +92,12 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *identifier = (node->identifier == NULL) ? NULL :
             children[child_index(self, node->identifier)];
     cypher_astnode_t *pattern = children[child_index(self, node->pattern)];
-    cypher_astnode_t *predicate = (node->predicate != NULL) ? NULL :
+    cypher_astnode_t *predicate = (node->predicate == NULL) ? NULL :
             children[child_index(self, node->predicate)];
     cypher_astnode_t *eval = children[child_index(self, node->eval)];
 
     return cypher_ast_pattern_comprehension(identifier, pattern, predicate,
-            eval, children, self->nchildren, self->range);
+            eval, children, self->nchildren, cypher_astnode_range(self));
 }
 
 
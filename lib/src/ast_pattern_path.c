@@ -81,8 +81,9 @@ cypher_astnode_t *cypher_ast_pattern_path(cypher_astnode_t * const *elements,
                 NULL);
     }
 
-    struct pattern_path *node = calloc(1, sizeof(struct pattern_path) +
-            nelements * sizeof(cypher_astnode_t *));
+    struct pattern_path *node =
+            cypher_astnode_alloc(sizeof(struct pattern_path) +
+                nelements * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
         return NULL;
@@ -99,7 +100,7 @@ cypher_astnode_t *cypher_ast_pattern_path(cypher_astnode_t * const *elements,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -115,7 +116,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
             container_of(ppnode, struct pattern_path, _pattern_path_astnode);
 
     cypher_astnode_t **elements =
-            calloc(node->nelements, sizeof(cypher_astnode_t *));
+            cp_calloc(node->nelements, sizeof(cypher_astnode_t *));
     if (elements == NULL)
     {
         return NULL;
@@ -126,9 +127,9 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     }
 
     cypher_astnode_t *clone = cypher_ast_pattern_path(elements, node->nelements,
-            children, self->nchildren, self->range);
+            children, self->nchildren, cypher_astnode_range(self));
     int errsv = errno;
-    free(elements);
+    cp_free(elements);
     errno = errsv;
     return clone;
 }
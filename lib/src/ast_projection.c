@@ -48,7 +48,7 @@ cypher_astnode_t *cypher_ast_projection(const cypher_astnode_t *expression,
     REQUIRE_CHILD_OPTIONAL(children, nchildren, alias,
             CYPHER_AST_IDENTIFIER, NULL);
 
-    struct projection *node = calloc(1, sizeof(struct projection));
+    struct projection *node = cypher_astnode_alloc(sizeof(struct projection));
     if (node == NULL)
     {
         return NULL;
@@ -56,7 +56,7 @@ cypher_astnode_t *cypher_ast_projection(const cypher_astnode_t *expression,
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_PROJECTION,
             children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->expression = expression;
@@ -76,7 +76,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
             children[child_index(self, node->alias)];
 
     return cypher_ast_projection(expression, alias, children, self->nchildren,
-            self->range);
+            cypher_astnode_range(self));
 }
 
 
@@ -55,7 +55,7 @@ cypher_astnode_t *cypher_ast_property_operator(
     REQUIRE_CHILD(children, nchildren, prop_name, CYPHER_AST_PROP_NAME, NULL);
 
     struct property_operator *node =
-            calloc(1, sizeof(struct property_operator));
+            cypher_astnode_alloc(sizeof(struct property_operator));
     if (node == NULL)
     {
         return NULL;
@@ -63,7 +63,7 @@ cypher_astnode_t *cypher_ast_property_operator(
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_PROPERTY_OPERATOR,
                 children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->expression = expression;
@@ -83,7 +83,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *prop_name = children[child_index(self, node->prop_name)];
 
     return cypher_ast_property_operator(expression, prop_name, children,
-            self->nchildren, self->range);
+            self->nchildren, cypher_astnode_range(self));
 }
 
 
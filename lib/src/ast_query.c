@@ -54,7 +54,7 @@ cypher_astnode_t *cypher_ast_query(cypher_astnode_t * const *options,
     REQUIRE_CHILD_ALL(children, nchildren, clauses, nclauses,
             CYPHER_AST_QUERY_CLAUSE, NULL);
 
-    struct query *node = calloc(1, sizeof(struct query) +
+    struct query *node = cypher_astnode_alloc(sizeof(struct query) +
             nclauses * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
@@ -67,7 +67,8 @@ cypher_astnode_t *cypher_ast_query(cypher_astnode_t * const *options,
     }
     if (noptions > 0)
     {
-        node->options = mdup(options, noptions * sizeof(cypher_astnode_t *));
+        node->options = cypher_astnode_mdup(&(node->_astnode), options,
+                noptions * sizeof(cypher_astnode_t *));
         if (node->options == NULL)
         {
             goto cleanup;
@@ -81,7 +82,7 @@ cypher_astnode_t *cypher_ast_query(cypher_astnode_t * const *options,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -94,7 +95,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     struct query *node = container_of(self, struct query, _astnode);
 
     cypher_astnode_t **options =
-            calloc(node->noptions, sizeof(cypher_astnode_t *));
+            cp_calloc(node->noptions, sizeof(cypher_astnode_t *));
     if (options == NULL)
     {
         return NULL;
@@ -104,7 +105,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
         options[i] = children[child_index(self, node->options[i])];
     }
     cypher_astnode_t **clauses =
-            calloc(node->nclauses, sizeof(cypher_astnode_t *));
+            cp_calloc(node->nclauses, sizeof(cypher_astnode_t *));
     if (clauses == NULL)
     {
         return NULL;
@@ -115,10 +116,11 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     }
 
     cypher_astnode_t *clone = cypher_ast_query(options, node->noptions,
-            clauses, node->nclauses, children, self->nchildren, self->range);
+            clauses, node->nclauses, children, self->nchildren,
+            cypher_astnode_range(self));
     int errsv = errno;
-    free(options);
-    free(clauses);
+    cp_free(options);
+    cp_free(clauses);
     errno = errsv;
     return clone;
 }
@@ -127,7 +129,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
 void query_release(cypher_astnode_t *self)
 {
     struct query *node = container_of(self, struct query, _astnode);
-    free(node->options);
+    cypher_astnode_mfree(self, node->options);
     cypher_astnode_release(self);
 }
 
@@ -170,7 +172,27 @@ const cypher_astnode_t *cypher_ast_query_get_clause(
     {
         return NULL;
     }
-    return node->clauses[index];
+    const cypher_astnode_t *clause = node->clauses[index];
+    if (clause->type == CYPHER_AST_LAZY_CLAUSE)
+    {
+        return cypher_ast_lazy_clause_get_clause(clause);
+    }
+    return clause;
+}
+
+
+cypher_astnode_type_t cypher_ast_query_get_clause_type(
+        const cypher_astnode_t *astnode, unsigned int index)
+{
+    REQUIRE_TYPE(astnode, CYPHER_AST_QUERY, 0);
+    struct query *node = container_of(astnode, struct query, _astnode);
+    REQUIRE(index < node->nclauses, 0);
+    const cypher_astnode_t *clause = node->clauses[index];
+    if (clause->type == CYPHER_AST_LAZY_CLAUSE)
+    {
+        return cypher_ast_lazy_clause_get_clause_type(clause);
+    }
+    return clause->type;
 }
 
 
@@ -48,7 +48,7 @@ cypher_astnode_t *cypher_ast_range(const cypher_astnode_t *start,
     REQUIRE_CHILD_OPTIONAL(children, nchildren, start, CYPHER_AST_INTEGER, NULL);
     REQUIRE_CHILD_OPTIONAL(children, nchildren, end, CYPHER_AST_INTEGER, NULL);
 
-    struct range *node = calloc(1, sizeof(struct range));
+    struct range *node = cypher_astnode_alloc(sizeof(struct range));
     if (node == NULL)
     {
         return NULL;
@@ -56,7 +56,7 @@ cypher_astnode_t *cypher_ast_range(const cypher_astnode_t *start,
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_RANGE,
             children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->start = start;
@@ -76,7 +76,8 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *end = (node->end == NULL) ? NULL :
             children[child_index(self, node->end)];
 
-    return cypher_ast_range(start, end, children, self->nchildren, self->range);
+    return cypher_ast_range(start, end, children, self->nchildren,
+            cypher_astnode_range(self));
 }
 
 
@@ -55,8 +55,9 @@ cypher_astnode_t *cypher_ast_rel_id_lookup(const cypher_astnode_t *identifier,
     REQUIRE(nids > 0, NULL);
     REQUIRE_CHILD_ALL(children, nchildren, ids, nids, CYPHER_AST_INTEGER, NULL);
 
-    struct rel_id_lookup *node = calloc(1, sizeof(struct rel_id_lookup) +
-            nids * sizeof(cypher_astnode_t *));
+    struct rel_id_lookup *node =
+            cypher_astnode_alloc(sizeof(struct rel_id_lookup) +
+                nids * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
         return NULL;
@@ -74,7 +75,7 @@ cypher_astnode_t *cypher_ast_rel_id_lookup(const cypher_astnode_t *identifier,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -88,7 +89,8 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
             container_of(self, struct rel_id_lookup, _astnode);
 
     cypher_astnode_t *identifier = children[child_index(self, node->identifier)];
-    cypher_astnode_t **ids = calloc(node->nids, sizeof(cypher_astnode_t *));
+    cypher_astnode_t **ids = cp_calloc(node->nids,
+            sizeof(cypher_astnode_t *));
     if (ids == NULL)
     {
         return NULL;
@@ -99,9 +101,9 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     }
 
     cypher_astnode_t *clone = cypher_ast_rel_id_lookup(identifier, ids,
-            node->nids, children, self->nchildren, self->range);
+            node->nids, children, self->nchildren, cypher_astnode_range(self));
     int errsv = errno;
-    free(ids);
+    cp_free(ids);
     errno = errsv;
     return clone;
 }
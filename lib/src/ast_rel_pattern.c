@@ -61,7 +61,7 @@ cypher_astnode_t *cypher_ast_rel_pattern(enum cypher_rel_direction direction,
     REQUIRE_CHILD_OPTIONAL(children, nchildren, varlength,
             CYPHER_AST_RANGE, NULL);
 
-    struct rel_pattern *node = calloc(1, sizeof(struct rel_pattern) +
+    struct rel_pattern *node = cypher_astnode_alloc(sizeof(struct rel_pattern) +
             nreltypes * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
@@ -83,7 +83,7 @@ cypher_astnode_t *cypher_ast_rel_pattern(enum cypher_rel_direction direction,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -98,7 +98,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *identifier = (node->identifier == NULL) ? NULL :
             children[child_index(self, node->identifier)];
     cypher_astnode_t **reltypes =
-            calloc(node->nreltypes, sizeof(cypher_astnode_t *));
+            cp_calloc(node->nreltypes, sizeof(cypher_astnode_t *));
     if (reltypes == NULL)
     {
         return NULL;
@@ -114,9 +114,9 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
 
     cypher_astnode_t *clone = cypher_ast_rel_pattern(node->direction,
             identifier, reltypes, node->nreltypes, properties, varlength,
-            children, self->nchildren, self->range);
+            children, self->nchildren, cypher_astnode_range(self));
     int errsv = errno;
-    free(reltypes);
+    cp_free(reltypes);
     errno = errsv;
     return clone;
 }
@@ -23,10 +23,12 @@
 struct reltype
 {
     cypher_astnode_t _astnode;
-    char p[];
+    const struct cp_symbol *symbol;
 };
 
 
+static cypher_astnode_t *construct(const char *s, size_t n,
+        unsigned int id, struct cypher_input_range range);
 static cypher_astnode_t *clone(const cypher_astnode_t *self,
         cypher_astnode_t **children);
 static ssize_t detailstr(const cypher_astnode_t *self, char *str, size_t size);
@@ -42,19 +44,27 @@ const struct cypher_astnode_vt cypher_reltype_astnode_vt =
 cypher_astnode_t *cypher_ast_reltype(const char *s, size_t n,
         struct cypher_input_range range)
 {
-    struct reltype *node = calloc(1, sizeof(struct reltype) + n+1);
+    return construct(s, n, 0, range);
+}
+
+
+cypher_astnode_t *construct(const char *s, size_t n, unsigned int id,
+        struct cypher_input_range range)
+{
+    const struct cp_symbol *symbol;
+    struct reltype *node = cypher_astnode_alloc_named(
+            sizeof(struct reltype), s, n, id, &symbol);
     if (node == NULL)
     {
         return NULL;
     }
-    if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_RELTYPE, NULL, 0,
-                range))
+    if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_RELTYPE,
+                NULL, 0, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
-    memcpy(node->p, s, n);
-    node->p[n] = '\0';
+    node->symbol = symbol;
     return &(node->_astnode);
 }
 
@@ -64,7 +74,8 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
 {
     REQUIRE_TYPE(self, CYPHER_AST_RELTYPE, NULL);
     struct reltype *node = container_of(self, struct reltype, _astnode);
-    return cypher_ast_reltype(node->p, strlen(node->p), self->range);
+    return construct(node->symbol->name, node->symbol->length,
+            node->symbol->id, cypher_astnode_range(self));
 }
 
 
@@ -72,7 +83,15 @@ const char *cypher_ast_reltype_get_name(const cypher_astnode_t *astnode)
 {
     REQUIRE_TYPE(astnode, CYPHER_AST_RELTYPE, NULL);
     struct reltype *node = container_of(astnode, struct reltype, _astnode);
-    return node->p;
+    return node->symbol->name;
+}
+
+
+unsigned int cypher_ast_reltype_get_symbol(const cypher_astnode_t *astnode)
+{
+    REQUIRE_TYPE(astnode, CYPHER_AST_RELTYPE, 0);
+    struct reltype *node = container_of(astnode, struct reltype, _astnode);
+    return node->symbol->id;
 }
 
 
@@ -80,5 +99,5 @@ ssize_t detailstr(const cypher_astnode_t *self, char *str, size_t size)
 {
     REQUIRE_TYPE(self, CYPHER_AST_RELTYPE, -1);
     struct reltype *node = container_of(self, struct reltype, _astnode);
-    return snprintf(str, size, ":`%s`", node->p);
+    return snprintf(str, size, ":`%s`", node->symbol->name);
 }
@@ -53,7 +53,7 @@ cypher_astnode_t *cypher_ast_remove(cypher_astnode_t * const *items,
     REQUIRE_CHILD_ALL(children, nchildren, items, nitems,
             CYPHER_AST_REMOVE_ITEM, NULL);
 
-    struct remove *node = calloc(1, sizeof(struct remove) +
+    struct remove *node = cypher_astnode_alloc(sizeof(struct remove) +
             nitems * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
@@ -71,7 +71,7 @@ cypher_astnode_t *cypher_ast_remove(cypher_astnode_t * const *items,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -83,7 +83,8 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     REQUIRE_TYPE(self, CYPHER_AST_REMOVE, NULL);
     struct remove *node = container_of(self, struct remove, _astnode);
 
-    cypher_astnode_t **items = calloc(node->nitems, sizeof(cypher_astnode_t *));
+    cypher_astnode_t **items = cp_calloc(node->nitems,
+            sizeof(cypher_astnode_t *));
     if (items == NULL)
     {
         return NULL;
@@ -94,9 +95,9 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     }
 
     cypher_astnode_t *clone = cypher_ast_remove(items, node->nitems,
-            children, self->nchildren, self->range);
+            children, self->nchildren, cypher_astnode_range(self));
     int errsv = errno;
-    free(items);
+    cp_free(items);
     errno = errsv;
     return clone;
 }
@@ -56,8 +56,9 @@ cypher_astnode_t *cypher_ast_remove_labels(const cypher_astnode_t *identifier,
     REQUIRE_CHILD_ALL(children, nchildren, labels, nlabels,
             CYPHER_AST_LABEL, NULL);
 
-    struct remove_labels *node = calloc(1, sizeof(struct remove_labels) +
-            nlabels * sizeof(cypher_astnode_t *));
+    struct remove_labels *node =
+            cypher_astnode_alloc(sizeof(struct remove_labels) +
+                nlabels * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
         return NULL;
@@ -75,7 +76,7 @@ cypher_astnode_t *cypher_ast_remove_labels(const cypher_astnode_t *identifier,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -90,7 +91,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
 
     cypher_astnode_t *identifier = children[child_index(self, node->identifier)];
     cypher_astnode_t **labels =
-            calloc(node->nlabels, sizeof(cypher_astnode_t *));
+            cp_calloc(node->nlabels, sizeof(cypher_astnode_t *));
     if (labels == NULL)
     {
         return NULL;
@@ -101,9 +102,10 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     }
 
     cypher_astnode_t *clone = cypher_ast_remove_labels(identifier,
-            labels, node->nlabels, children, self->nchildren, self->range);
+            labels, node->nlabels, children, self->nchildren,
+            cypher_astnode_range(self));
     int errsv = errno;
-    free(labels);
+    cp_free(labels);
     errno = errsv;
     return clone;
 }
@@ -51,7 +51,8 @@ cypher_astnode_t *cypher_ast_remove_property(const cypher_astnode_t *property,
     REQUIRE_CHILD(children, nchildren, property,
             CYPHER_AST_PROPERTY_OPERATOR, NULL);
 
-    struct remove_property *node = calloc(1, sizeof(struct remove_property));
+    struct remove_property *node =
+            cypher_astnode_alloc(sizeof(struct remove_property));
     if (node == NULL)
     {
         return NULL;
@@ -59,7 +60,7 @@ cypher_astnode_t *cypher_ast_remove_property(const cypher_astnode_t *property,
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_REMOVE_PROPERTY,
             children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->property = property;
@@ -77,7 +78,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *property = children[child_index(self, node->property)];
 
     return cypher_ast_remove_property(property, children, self->nchildren,
-            self->range);
+            cypher_astnode_range(self));
 }
 
 
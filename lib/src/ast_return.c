@@ -66,8 +66,9 @@ cypher_astnode_t *cypher_ast_return(bool distinct, bool include_existing,
     REQUIRE_CHILD_OPTIONAL(children, nchildren, limit,
             CYPHER_AST_EXPRESSION, NULL);
 
-    struct return_clause *node = calloc(1, sizeof(struct return_clause) +
-            nprojections * sizeof(cypher_astnode_t *));
+    struct return_clause *node =
+            cypher_astnode_alloc(sizeof(struct return_clause) +
+                nprojections * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
         return NULL;
@@ -90,7 +91,7 @@ cypher_astnode_t *cypher_ast_return(bool distinct, bool include_existing,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -104,7 +105,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
             container_of(self, struct return_clause, _astnode);
 
     cypher_astnode_t **projections =
-            calloc(node->nprojections, sizeof(cypher_astnode_t *));
+            cp_calloc(node->nprojections, sizeof(cypher_astnode_t *));
     if (projections == NULL)
     {
         return NULL;
@@ -115,16 +116,17 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     }
     cypher_astnode_t *order_by = (node->order_by == NULL) ? NULL :
             children[child_index(self, node->order_by)];
-    cypher_astnode_t *skip = (node->skip != NULL) ? NULL :
+    cypher_astnode_t *skip = (node->skip == NULL) ? NULL :
             children[child_index(self, node->skip)];
-    cypher_astnode_t *limit = (node->limit != NULL) ? NULL :
+    cypher_astnode_t *limit = (node->limit == NULL) ? NULL :
             children[child_index(self, node->limit)];
 
     cypher_astnode_t *clone = cypher_ast_return(node->distinct,
             node->include_existing, projections, node->nprojections,
-            order_by, skip, limit, children, self->nchildren, self->range);
+            order_by, skip, limit, children, self->nchildren,
+            cypher_astnode_range(self));
     int errsv = errno;
-    free(projections);
+    cp_free(projections);
     errno = errsv;
     return clone;
 }
@@ -54,7 +54,7 @@ cypher_astnode_t *cypher_ast_set_all_properties(
     REQUIRE_CHILD(children, nchildren, expression, CYPHER_AST_EXPRESSION, NULL);
 
     struct set_all_properties *node =
-            calloc(1, sizeof(struct set_all_properties));
+            cypher_astnode_alloc(sizeof(struct set_all_properties));
     if (node == NULL)
     {
         return NULL;
@@ -62,7 +62,7 @@ cypher_astnode_t *cypher_ast_set_all_properties(
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_SET_ALL_PROPERTIES,
             children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->identifier = identifier;
@@ -82,7 +82,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *expression = children[child_index(self, node->expression)];
 
     return cypher_ast_set_all_properties(identifier, expression, children,
-            self->nchildren, self->range);
+            self->nchildren, cypher_astnode_range(self));
 }
 
 
@@ -56,7 +56,7 @@ cypher_astnode_t *cypher_ast_set_labels(const cypher_astnode_t *identifier,
     REQUIRE_CHILD_ALL(children, nchildren, labels, nlabels,
             CYPHER_AST_LABEL, NULL);
 
-    struct set_labels *node = calloc(1, sizeof(struct set_labels) +
+    struct set_labels *node = cypher_astnode_alloc(sizeof(struct set_labels) +
             nlabels * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
@@ -75,7 +75,7 @@ cypher_astnode_t *cypher_ast_set_labels(const cypher_astnode_t *identifier,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -88,7 +88,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     struct set_labels *node = container_of(self, struct set_labels, _astnode);
 
     cypher_astnode_t *identifier = children[child_index(self, node->identifier)];
-    cypher_astnode_t **labels = calloc(node->nlabels,
+    cypher_astnode_t **labels = cp_calloc(node->nlabels,
             sizeof(cypher_astnode_t *));
     if (labels == NULL)
     {
@@ -100,9 +100,10 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     }
 
     cypher_astnode_t *clone = cypher_ast_set_labels(identifier, labels,
-            node->nlabels, children, self->nchildren, self->range);
+            node->nlabels, children, self->nchildren,
+            cypher_astnode_range(self));
     int errsv = errno;
-    free(labels);
+    cp_free(labels);
     errno = errsv;
     return clone;
 }
@@ -53,7 +53,8 @@ cypher_astnode_t *cypher_ast_set_property(const cypher_astnode_t *property,
             CYPHER_AST_PROPERTY_OPERATOR, NULL);
     REQUIRE_CHILD(children, nchildren, expression, CYPHER_AST_EXPRESSION, NULL);
 
-    struct set_property *node = calloc(1, sizeof(struct set_property));
+    struct set_property *node =
+            cypher_astnode_alloc(sizeof(struct set_property));
     if (node == NULL)
     {
         return NULL;
@@ -61,7 +62,7 @@ cypher_astnode_t *cypher_ast_set_property(const cypher_astnode_t *property,
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_SET_PROPERTY,
             children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->property = property;
@@ -81,7 +82,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *expression = children[child_index(self, node->expression)];
 
     return cypher_ast_set_property(property, expression, children,
-            self->nchildren, self->range);
+            self->nchildren, cypher_astnode_range(self));
 }
 
 
@@ -58,7 +58,8 @@ cypher_astnode_t *cypher_ast_shortest_path(bool single,
 {
     REQUIRE_CHILD(children, nchildren, path, CYPHER_AST_PATTERN_PATH, NULL);
 
-    struct shortest_path *node = calloc(1, sizeof(struct shortest_path));
+    struct shortest_path *node =
+            cypher_astnode_alloc(sizeof(struct shortest_path));
     if (node == NULL)
     {
         return NULL;
@@ -66,7 +67,7 @@ cypher_astnode_t *cypher_ast_shortest_path(bool single,
     if (cypher_pattern_path_astnode_init(&(node->_pattern_path_astnode),
                 CYPHER_AST_SHORTEST_PATH, &pp_vt, children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->single = single;
@@ -87,7 +88,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *path = children[child_index(self, node->path)];
 
     return cypher_ast_shortest_path(node->single, path, children,
-            self->nchildren, self->range);
+            self->nchildren, cypher_astnode_range(self));
 }
 
 
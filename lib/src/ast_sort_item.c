@@ -46,7 +46,7 @@ cypher_astnode_t *cypher_ast_sort_item(const cypher_astnode_t *expression,
 {
     REQUIRE_CHILD(children, nchildren, expression, CYPHER_AST_EXPRESSION, NULL);
 
-    struct sort_item *node = calloc(1, sizeof(struct sort_item));
+    struct sort_item *node = cypher_astnode_alloc(sizeof(struct sort_item));
     if (node == NULL)
     {
         return NULL;
@@ -54,7 +54,7 @@ cypher_astnode_t *cypher_ast_sort_item(const cypher_astnode_t *expression,
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_SORT_ITEM,
             children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->expression = expression;
@@ -72,7 +72,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *expression = children[child_index(self, node->expression)];
 
     return cypher_ast_sort_item(expression, node->ascending, children,
-            self->nchildren, self->range);
+            self->nchildren, cypher_astnode_range(self));
 }
 
 
@@ -57,7 +57,7 @@ cypher_astnode_t *cypher_ast_start(cypher_astnode_t * const *points,
     REQUIRE_CHILD_OPTIONAL(children, nchildren, predicate,
             CYPHER_AST_EXPRESSION, NULL);
 
-    struct start *node = calloc(1, sizeof(struct start) +
+    struct start *node = cypher_astnode_alloc(sizeof(struct start) +
             npoints * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
@@ -76,7 +76,7 @@ cypher_astnode_t *cypher_ast_start(cypher_astnode_t * const *points,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -88,7 +88,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     REQUIRE_TYPE(self, CYPHER_AST_START, NULL);
     struct start *node = container_of(self, struct start, _astnode);
 
-    cypher_astnode_t **points = calloc(node->npoints,
+    cypher_astnode_t **points = cp_calloc(node->npoints,
             sizeof(cypher_astnode_t *));
     if (points == NULL)
     {
@@ -98,13 +98,13 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     {
         points[i] = children[child_index(self, node->points[i])];
     }
-    cypher_astnode_t *predicate = (node->predicate != NULL) ? NULL :
+    cypher_astnode_t *predicate = (node->predicate == NULL) ? NULL :
             children[child_index(self, node->predicate)];
 
     cypher_astnode_t *clone = cypher_ast_start(points, node->npoints,
-            predicate, children, self->nchildren, self->range);
+            predicate, children, self->nchildren, cypher_astnode_range(self));
     int errsv = errno;
-    free(points);
+    cp_free(points);
     errno = errsv;
     return clone;
 }
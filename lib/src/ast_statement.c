@@ -48,10 +48,11 @@ cypher_astnode_t *cypher_ast_statement(cypher_astnode_t * const *options,
     REQUIRE_CHILD_ALL(children, nchildren, options, noptions,
             CYPHER_AST_STATEMENT_OPTION, NULL);
     REQUIRE(cypher_astnode_instanceof(body, CYPHER_AST_QUERY) ||
-            cypher_astnode_instanceof(body, CYPHER_AST_SCHEMA_COMMAND), NULL);
+            cypher_astnode_instanceof(body, CYPHER_AST_SCHEMA_COMMAND) ||
+            cypher_astnode_instanceof(body, CYPHER_AST_DEFERRED_BODY), NULL);
     REQUIRE_CONTAINS(children, nchildren, body, NULL);
 
-    struct statement *node = calloc(1, sizeof(struct statement) +
+    struct statement *node = cypher_astnode_alloc(sizeof(struct statement) +
             noptions * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
@@ -70,7 +71,7 @@ cypher_astnode_t *cypher_ast_statement(cypher_astnode_t * const *options,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -82,7 +83,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     REQUIRE_TYPE(self, CYPHER_AST_STATEMENT, NULL);
     struct statement *node = container_of(self, struct statement, _astnode);
 
-    cypher_astnode_t **options = calloc(node->noptions,
+    cypher_astnode_t **options = cp_calloc(node->noptions,
             sizeof(cypher_astnode_t *));
     if (options == NULL)
     {
@@ -95,9 +96,9 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *body = children[child_index(self, node->body)];
 
     cypher_astnode_t *clone = cypher_ast_statement(options, node->noptions,
-            body, children, self->nchildren, self->range);
+            body, children, self->nchildren, cypher_astnode_range(self));
     int errsv = errno;
-    free(options);
+    cp_free(options);
     errno = errsv;
     return clone;
 }
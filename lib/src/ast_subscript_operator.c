@@ -55,7 +55,7 @@ cypher_astnode_t *cypher_ast_subscript_operator(
     REQUIRE_CHILD(children, nchildren, subscript, CYPHER_AST_EXPRESSION, NULL);
 
     struct subscript_operator *node =
-            calloc(1, sizeof(struct subscript_operator));
+            cypher_astnode_alloc(sizeof(struct subscript_operator));
     if (node == NULL)
     {
         return NULL;
@@ -63,7 +63,7 @@ cypher_astnode_t *cypher_ast_subscript_operator(
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_SUBSCRIPT_OPERATOR,
             children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->expression = expression;
@@ -83,7 +83,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *subscript = children[child_index(self, node->subscript)];
 
     return cypher_ast_subscript_operator(expression, subscript, children,
-            self->nchildren, self->range);
+            self->nchildren, cypher_astnode_range(self));
 }
 
 
@@ -46,7 +46,8 @@ const struct cypher_astnode_vt cypher_true_astnode_vt =
 
 cypher_astnode_t *cypher_ast_true(struct cypher_input_range range)
 {
-    struct true_literal *node = calloc(1, sizeof(struct true_literal));
+    struct true_literal *node =
+            cypher_astnode_alloc(sizeof(struct true_literal));
     if (node == NULL)
     {
         return NULL;
@@ -54,7 +55,7 @@ cypher_astnode_t *cypher_ast_true(struct cypher_input_range range)
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_TRUE,
             NULL, 0, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     return &(node->_astnode);
@@ -65,7 +66,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
         cypher_astnode_t **children)
 {
     REQUIRE_TYPE(self, CYPHER_AST_TRUE, NULL);
-    return cypher_ast_true(self->range);
+    return cypher_ast_true(cypher_astnode_range(self));
 }
 
 
@@ -53,7 +53,8 @@ cypher_astnode_t *cypher_ast_unary_operator(const cypher_operator_t *op,
     REQUIRE(op != NULL, NULL);
     REQUIRE_CHILD(children, nchildren, arg, CYPHER_AST_EXPRESSION, NULL);
 
-    struct unary_operator *node = calloc(1, sizeof(struct unary_operator));
+    struct unary_operator *node =
+            cypher_astnode_alloc(sizeof(struct unary_operator));
     if (node == NULL)
     {
         return NULL;
@@ -61,7 +62,7 @@ cypher_astnode_t *cypher_ast_unary_operator(const cypher_operator_t *op,
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_UNARY_OPERATOR,
             children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->op = op;
@@ -80,7 +81,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *arg = children[child_index(self, node->arg)];
 
     return cypher_ast_unary_operator(node->op, arg, children, self->nchildren,
-            self->range);
+            cypher_astnode_range(self));
 }
 
 
@@ -47,7 +47,8 @@ const struct cypher_astnode_vt cypher_union_astnode_vt =
 cypher_astnode_t *cypher_ast_union(bool all, cypher_astnode_t **children,
         unsigned int nchildren, struct cypher_input_range range)
 {
-    struct union_clause *node = calloc(1, sizeof(struct union_clause));
+    struct union_clause *node =
+            cypher_astnode_alloc(sizeof(struct union_clause));
     if (node == NULL)
     {
         return NULL;
@@ -55,7 +56,7 @@ cypher_astnode_t *cypher_ast_union(bool all, cypher_astnode_t **children,
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_UNION,
             children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->all = all;
@@ -70,7 +71,8 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     struct union_clause *node =
             container_of(self, struct union_clause, _astnode);
 
-    return cypher_ast_union(node->all, children, self->nchildren, self->range);
+    return cypher_ast_union(node->all, children, self->nchildren,
+            cypher_astnode_range(self));
 }
 
 
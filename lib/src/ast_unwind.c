@@ -53,7 +53,7 @@ cypher_astnode_t *cypher_ast_unwind(const cypher_astnode_t *expression,
     REQUIRE_CHILD(children, nchildren, expression, CYPHER_AST_EXPRESSION, NULL);
     REQUIRE_CHILD(children, nchildren, alias, CYPHER_AST_IDENTIFIER, NULL);
 
-    struct unwind *node = calloc(1, sizeof(struct unwind));
+    struct unwind *node = cypher_astnode_alloc(sizeof(struct unwind));
     if (node == NULL)
     {
         return NULL;
@@ -61,7 +61,7 @@ cypher_astnode_t *cypher_ast_unwind(const cypher_astnode_t *expression,
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_UNWIND,
             children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->expression = expression;
@@ -80,7 +80,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *alias = children[child_index(self, node->alias)];
 
     return cypher_ast_unwind(expression, alias, children, self->nchildren,
-            self->range);
+            cypher_astnode_range(self));
 }
 
 
@@ -56,7 +56,7 @@ cypher_astnode_t *cypher_ast_using_index(const cypher_astnode_t *identifier,
     REQUIRE_CHILD(children, nchildren, label, CYPHER_AST_LABEL, NULL);
     REQUIRE_CHILD(children, nchildren, prop_name, CYPHER_AST_PROP_NAME, NULL);
 
-    struct using_index *node = calloc(1, sizeof(struct using_index));
+    struct using_index *node = cypher_astnode_alloc(sizeof(struct using_index));
     if (node == NULL)
     {
         return NULL;
@@ -64,7 +64,7 @@ cypher_astnode_t *cypher_ast_using_index(const cypher_astnode_t *identifier,
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_USING_INDEX,
             children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->identifier = identifier;
@@ -86,7 +86,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *prop_name = children[child_index(self, node->prop_name)];
 
     return cypher_ast_using_index(identifier, label, prop_name, children,
-            self->nchildren, self->range);
+            self->nchildren, cypher_astnode_range(self));
 }
 
 
@@ -55,7 +55,7 @@ cypher_astnode_t *cypher_ast_using_join(
     REQUIRE_CHILD_ALL(children, nchildren, identifiers, nidentifiers,
             CYPHER_AST_IDENTIFIER, NULL);
 
-    struct using_join *node = calloc(1, sizeof(struct using_join) +
+    struct using_join *node = cypher_astnode_alloc(sizeof(struct using_join) +
             nidentifiers * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
@@ -74,7 +74,7 @@ cypher_astnode_t *cypher_ast_using_join(
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -86,7 +86,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     REQUIRE_TYPE(self, CYPHER_AST_USING_JOIN, NULL);
     struct using_join *node = container_of(self, struct using_join, _astnode);
 
-    cypher_astnode_t **identifiers = calloc(node->nidentifiers,
+    cypher_astnode_t **identifiers = cp_calloc(node->nidentifiers,
             sizeof(cypher_astnode_t *));
     if (identifiers == NULL)
     {
@@ -98,9 +98,10 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     }
 
     cypher_astnode_t *clone = cypher_ast_using_join(identifiers,
-            node->nidentifiers, children, self->nchildren, self->range);
+            node->nidentifiers, children, self->nchildren,
+            cypher_astnode_range(self));
     int errsv = errno;
-    free(identifiers);
+    cp_free(identifiers);
     errno = errsv;
     return clone;
 }
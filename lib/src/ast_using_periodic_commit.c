@@ -52,7 +52,7 @@ cypher_astnode_t *cypher_ast_using_periodic_commit(
     REQUIRE_CHILD_OPTIONAL(children, nchildren, limit, CYPHER_AST_INTEGER, NULL);
 
     struct using_periodic_commit *node =
-            calloc(1, sizeof(struct using_periodic_commit));
+            cypher_astnode_alloc(sizeof(struct using_periodic_commit));
     if (node == NULL)
     {
         return NULL;
@@ -60,7 +60,7 @@ cypher_astnode_t *cypher_ast_using_periodic_commit(
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_USING_PERIODIC_COMMIT,
             children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->limit = limit;
@@ -79,7 +79,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
             children[child_index(self, node->limit)];
 
     return cypher_ast_using_periodic_commit(limit, children, self->nchildren,
-            self->range);
+            cypher_astnode_range(self));
 }
 
 
@@ -53,7 +53,7 @@ cypher_astnode_t *cypher_ast_using_scan(const cypher_astnode_t *identifier,
     REQUIRE_CHILD(children, nchildren, identifier, CYPHER_AST_IDENTIFIER, NULL);
     REQUIRE_CHILD(children, nchildren, label, CYPHER_AST_LABEL, NULL);
 
-    struct using_scan *node = calloc(1, sizeof(struct using_scan));
+    struct using_scan *node = cypher_astnode_alloc(sizeof(struct using_scan));
     if (node == NULL)
     {
         return NULL;
@@ -61,7 +61,7 @@ cypher_astnode_t *cypher_ast_using_scan(const cypher_astnode_t *identifier,
     if (cypher_astnode_init(&(node->_astnode), CYPHER_AST_USING_SCAN,
             children, nchildren, range))
     {
-        free(node);
+        cypher_astnode_dealloc(node);
         return NULL;
     }
     node->identifier = identifier;
@@ -81,7 +81,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *label = children[child_index(self, node->label)];
 
     return cypher_ast_using_scan(identifier, label, children, self->nchildren,
-            self->range);
+            cypher_astnode_range(self));
 }
 
 
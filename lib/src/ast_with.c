@@ -68,7 +68,7 @@ cypher_astnode_t *cypher_ast_with(bool distinct, bool include_existing,
     REQUIRE_CHILD_OPTIONAL(children, nchildren, limit,
             CYPHER_AST_EXPRESSION, NULL);
 
-    struct with_clause *node = calloc(1, sizeof(struct with_clause) +
+    struct with_clause *node = cypher_astnode_alloc(sizeof(struct with_clause) +
             nprojections * sizeof(cypher_astnode_t *));
     if (node == NULL)
     {
@@ -93,7 +93,7 @@ cypher_astnode_t *cypher_ast_with(bool distinct, bool include_existing,
     int errsv;
 cleanup:
     errsv = errno;
-    free(node);
+    cypher_astnode_dealloc(node);
     errno = errsv;
     return NULL;
 }
@@ -105,7 +105,7 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     REQUIRE_TYPE(self, CYPHER_AST_WITH, NULL);
     struct with_clause *node = container_of(self, struct with_clause, _astnode);
 
-    cypher_astnode_t **projections = calloc(node->nprojections,
+    cypher_astnode_t **projections = cp_calloc(node->nprojections,
             sizeof(cypher_astnode_t *));
     if (projections == NULL)
     {
@@ -117,9 +117,9 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     }
     cypher_astnode_t *order_by = (node->order_by == NULL) ? NULL :
             children[child_index(self, node->order_by)];
-    cypher_astnode_t *skip = (node->skip != NULL) ? NULL :
+    cypher_astnode_t *skip = (node->skip == NULL) ? NULL :
             children[child_index(self, node->skip)];
-    cypher_astnode_t *limit = (node->limit != NULL) ? NULL :
+    cypher_astnode_t *limit = (node->limit == NULL) ? NULL :
             children[child_index(self, node->limit)];
     cypher_astnode_t *predicate = (node->predicate == NULL) ? NULL :
             children[child_index(self, node->predicate)];
@@ -127,9 +127,9 @@ cypher_astnode_t *clone(const cypher_astnode_t *self,
     cypher_astnode_t *clone = cypher_ast_with(node->distinct,
             node->include_existing, projections, node->nprojections,
             order_by, skip, limit, predicate, children, self->nchildren,
-            self->range);
+            cypher_astnode_range(self));
     int errsv = errno;
-    free(projections);
+    cp_free(projections);
     errno = errsv;
     return clone;
 }
@@ -37,16 +37,31 @@ struct cypher_astnode_vt
 };
 
 
+#define CYPHER_ASTNODE_MAX_CHILDREN ((1u << 23) - 1)
+
 struct cypher_astnode
 {
-    cypher_astnode_type_t type;
-    cypher_astnode_t **children;
-    unsigned int nchildren;
-    struct cypher_input_range range;
+    unsigned int type : 8;
+    unsigned int in_arena : 1;
+    unsigned int nchildren : 23;
     unsigned int ordinal;
+    // offsets of the range, relative to the start of the indexed input, or
+    // CYPHER_ASTNODE_NO_OFFSET when the node has an explicit range
+    uint32_t start;
+    uint32_t end;
+    cypher_astnode_t **children;
+    union
+    {
+        // the index to resolve the offsets from
+        const cp_line_index_t *line_index;
+        // the explicit range, allocated with the node
+        struct cypher_input_range *range;
+    } location;
     struct cypher_astnode_annotation *annotations;
 };
 
+#define CYPHER_ASTNODE_NO_OFFSET UINT32_MAX
+
 
 int cypher_astnode_init(cypher_astnode_t *node, cypher_astnode_type_t type,
         cypher_astnode_t **children, unsigned int nchildren,
@@ -54,6 +69,47 @@ int cypher_astnode_init(cypher_astnode_t *node, cypher_astnode_type_t type,
 
 void cypher_astnode_release(cypher_astnode_t *node);
 
+/*
+ * Allocate zeroed memory for a node structure. When an arena has been set
+ * (via `cypher_ast_set_arena`), the node is allocated from it and will be
+ * released only when the arena is.
+ */
+void *cypher_astnode_alloc(size_t size);
+
+/*
+ * Allocate zeroed memory for a node structure that refers to the symbol for
+ * a name (see `cypher_ast_set_symbol_table`). If no symbol table has been
+ * set, a symbol with the specified id is allocated following the structure.
+ */
+void *cypher_astnode_alloc_named(size_t size, const char *s, size_t n,
+        unsigned int id, const struct cp_symbol **symbol);
+
+/*
+ * Allocate zeroed memory for a node structure that refers to its text. If
+ * the text is not referenced (see `cypher_ast_string_ref`), a null
+ * terminated copy is allocated following the structure.
+ */
+void *cypher_astnode_alloc_text(size_t size, const char *s, size_t n,
+        bool ref, const char **text);
+
+/*
+ * Release memory allocated using `cypher_astnode_alloc`, for use when
+ * node construction fails.
+ */
+void cypher_astnode_dealloc(void *node);
+
+/*
+ * Duplicate memory to be owned by a node, allocating from the same place
+ * as the node itself.
+ */
+void *cypher_astnode_mdup(const cypher_astnode_t *node, const void *src,
+        size_t size);
+
+/*
+ * Release memory obtained from `cypher_astnode_mdup`.
+ */
+void cypher_astnode_mfree(const cypher_astnode_t *node, void *ptr);
+
 ssize_t cypher_astnode_detailstr(const cypher_astnode_t *node, char *str,
         size_t size);
 
@@ -127,7 +183,9 @@ static inline int child_index(const cypher_astnode_t *node,
 {
     unsigned int i = 0;
     while (i < node->nchildren && node->children[i] != child)
-        ;
+    {
+        ++i;
+    }
     assert(i < node->nchildren);
     return i;
 }
@@ -252,6 +310,8 @@ extern const struct cypher_astnode_vt
         cypher_map_projection_identifier_astnode_vt;
 extern const struct cypher_astnode_vt
         cypher_map_projection_all_properties_astnode_vt;
+extern const struct cypher_astnode_vt cypher_deferred_body_astnode_vt;
+extern const struct cypher_astnode_vt cypher_lazy_clause_astnode_vt;
 
 
 typedef struct cypher_list_comprehension_astnode
@@ -0,0 +1,98 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "batch.h"
+#include "util.h"
+#include <assert.h>
+
+
+cypher_parse_batch_t *cypher_parse_batch(unsigned int n)
+{
+    cypher_parse_batch_t *batch = cp_calloc(1, sizeof(cypher_parse_batch_t));
+    if (batch == NULL)
+    {
+        return NULL;
+    }
+    batch->allocator = cp_current_allocator();
+    if (n > 0)
+    {
+        batch->entries = cp_calloc(n, sizeof(struct cypher_parse_batch_entry));
+        if (batch->entries == NULL)
+        {
+            cp_free(batch);
+            return NULL;
+        }
+    }
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        cp_result_init(&(batch->entries[i].result));
+        batch->entries[i].err = 0;
+    }
+    batch->nentries = n;
+    return batch;
+}
+
+
+unsigned int cypher_parse_batch_size(const cypher_parse_batch_t *batch)
+{
+    return batch->nentries;
+}
+
+
+const cypher_parse_result_t *cypher_parse_batch_get_result(
+        const cypher_parse_batch_t *batch, unsigned int index)
+{
+    if (index >= batch->nentries || batch->entries[index].err != 0)
+    {
+        return NULL;
+    }
+    return &(batch->entries[index].result);
+}
+
+
+int cypher_parse_batch_get_errno(const cypher_parse_batch_t *batch,
+        unsigned int index)
+{
+    if (index >= batch->nentries)
+    {
+        return EINVAL;
+    }
+    return batch->entries[index].err;
+}
+
+
+void cypher_parse_batch_free(cypher_parse_batch_t *batch)
+{
+    if (batch == NULL)
+    {
+        return;
+    }
+
+    struct cp_allocator allocator = batch->allocator;
+    const struct cp_allocator *prev = cp_set_allocator(&allocator);
+
+    for (unsigned int i = 0; i < batch->nentries; ++i)
+    {
+        cp_result_cleanup(&(batch->entries[i].result));
+    }
+    cp_free(batch->entries);
+    // nodes allocated from the arena are released along with it
+    cp_arena_cleanup(&(batch->arena));
+    cp_free(batch);
+
+    cp_set_allocator(prev);
+}
@@ -0,0 +1,50 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CYPHER_PARSER_BATCH_H
+#define CYPHER_PARSER_BATCH_H
+
+#include "cypher-parser.h"
+#include "alloc.h"
+#include "arena.h"
+#include "result.h"
+
+
+struct cypher_parse_batch_entry
+{
+    cypher_parse_result_t result;
+    int err; // the error that parsing the query failed with, if any
+};
+
+
+struct cypher_parse_batch
+{
+    struct cypher_parse_batch_entry *entries;
+    unsigned int nentries;
+
+    cp_arena_t arena;
+    struct cp_allocator allocator;
+};
+
+
+/*
+ * Create a batch of empty parse results, which (along with everything
+ * subsequently merged into them) are allocated using the current allocator.
+ */
+cypher_parse_batch_t *cypher_parse_batch(unsigned int n);
+
+
+#endif/*CYPHER_PARSER_BATCH_H*/
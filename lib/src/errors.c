@@ -56,9 +56,9 @@ void cp_errors_vcleanup(cypher_parse_error_t *errors, unsigned int n)
 {
     for (unsigned int i = n; i-- > 0; errors++)
     {
-        free(errors->msg);
+        cp_free(errors->msg);
         errors->msg = NULL;
-        free(errors->context);
+        cp_free(errors->context);
         errors->context = NULL;
     }
 }
@@ -73,6 +73,20 @@ void cp_et_init(cp_error_tracking_t *et,
 }
 
 
+void cp_et_reset(cp_error_tracking_t *et,
+        const struct cypher_parser_colorization *colorization)
+{
+    assert(colorization != NULL);
+    et->colorization = colorization;
+    memset(&(et->last_position), 0, sizeof(struct cypher_input_position));
+    et->last_char = '\0';
+    et->nlabels = 0;
+    cp_errors_vcleanup(et->errors, et->nerrors);
+    et->nerrors = 0;
+    et->last_error_offset = 0;
+}
+
+
 int cp_et_note_potential_error(cp_error_tracking_t *et,
         struct cypher_input_position position, char c, const char *label)
 {
@@ -111,7 +125,7 @@ int cp_et_note_potential_error(cp_error_tracking_t *et,
     {
         unsigned int newcap = (et->labels_capacity == 0)?
             CYPHER_ERROR_LABELS_BLOCK_SIZE : et->labels_capacity * 2;
-        void *labels = realloc(et->labels, newcap * sizeof(const char *));
+        void *labels = cp_realloc(et->labels, newcap * sizeof(const char *));
         if (labels == NULL)
         {
             return -1;
@@ -139,7 +153,7 @@ int cp_et_reify_potentials(cp_error_tracking_t *et)
     {
         unsigned int newcap = (et->errors_capacity == 0)?
             CYPHER_PARSER_ERRORS_BLOCK_SIZE : et->errors_capacity * 2;
-        void *errors = realloc(et->errors,
+        void *errors = cp_realloc(et->errors,
                 newcap * sizeof(cypher_parse_error_t));
         if (errors == NULL)
         {
@@ -236,7 +250,7 @@ char *error_report(cp_error_tracking_t *et, char **buffer, size_t *cap,
     size_t orig_cap = *cap;
     if (orig_cap < len)
     {
-        void *newbuf = realloc(*buffer, len);
+        void *newbuf = cp_realloc(*buffer, len);
         if (newbuf == NULL)
         {
             return NULL;
@@ -304,12 +318,12 @@ cypher_parse_error_t *cp_et_extract_errors(cp_error_tracking_t *et,
 
 void cp_et_cleanup(cp_error_tracking_t *et)
 {
-    free(et->labels);
+    cp_free(et->labels);
     et->labels_capacity = et->nlabels = 0;
     et->labels = NULL;
 
     cp_errors_vcleanup(et->errors, et->nerrors);
-    free(et->errors);
+    cp_free(et->errors);
     et->errors_capacity = et->nerrors = 0;
     et->errors = NULL;
 }
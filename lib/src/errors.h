@@ -53,6 +53,9 @@ struct cp_error_tracking
 void cp_et_init(cp_error_tracking_t *et,
         const struct cypher_parser_colorization *colorization);
 
+void cp_et_reset(cp_error_tracking_t *et,
+        const struct cypher_parser_colorization *colorization);
+
 int cp_et_note_potential_error(cp_error_tracking_t *et,
         struct cypher_input_position position, char c, const char *label);
 
@@ -60,6 +63,7 @@ int cp_et_reify_potentials(cp_error_tracking_t *et);
 
 static inline void cp_et_clear_potentials(cp_error_tracking_t *et)
 {
+    et->last_position = cypher_input_position_zero;
     et->nlabels = 0;
 }
 
@@ -0,0 +1,135 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "input.h"
+#include <assert.h>
+#include <errno.h>
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+
+static bool is_regular_file(FILE *stream)
+{
+#ifdef HAVE_SYS_STAT_H
+    int fd = fileno(stream);
+    struct stat st;
+    return (fd >= 0 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode));
+#else
+    return false;
+#endif
+}
+
+
+void cp_stream_input_init(struct cp_stream_input *input, FILE *stream,
+        bool read_ahead)
+{
+    input->stream = stream;
+    if (!read_ahead)
+    {
+        input->mode = CP_STREAM_READ_CHARS;
+    }
+    else
+    {
+        input->mode = is_regular_file(stream)?
+                CP_STREAM_READ_BLOCKS : CP_STREAM_READ_LINES;
+    }
+}
+
+
+int cp_stream_input_read(void *data, char *buf, int n)
+{
+    struct cp_stream_input *input = data;
+    assert(n > 0);
+
+    if (input->mode == CP_STREAM_READ_BLOCKS)
+    {
+        return fread(buf, 1, n, input->stream);
+    }
+
+    int len = 0;
+    int c;
+    while (len < n && (c = getc(input->stream)) != EOF)
+    {
+        buf[len++] = c;
+        if (input->mode == CP_STREAM_READ_CHARS || c == '\n')
+        {
+            break;
+        }
+    }
+    return len;
+}
+
+
+void *cp_map_stream(FILE *stream, size_t *length)
+{
+#if defined(HAVE_SYS_STAT_H) && defined(HAVE_SYS_MMAN_H)
+    int fd = fileno(stream);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st))
+    {
+        return NULL;
+    }
+    if (!S_ISREG(st.st_mode) || (uintmax_t)st.st_size > SIZE_MAX)
+    {
+        errno = ENOTSUP;
+        return NULL;
+    }
+
+    *length = st.st_size;
+    if (*length == 0)
+    {
+        // mmap does not accept an empty mapping
+        static char empty[1];
+        return empty;
+    }
+
+    void *s = mmap(NULL, *length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (s == MAP_FAILED)
+    {
+        return NULL;
+    }
+#ifdef MADV_SEQUENTIAL
+    madvise(s, *length, MADV_SEQUENTIAL);
+#endif
+    return s;
+#else
+    errno = ENOTSUP;
+    return NULL;
+#endif
+}
+
+
+void cp_unmap_stream(void *mapping, size_t length)
+{
+#if defined(HAVE_SYS_STAT_H) && defined(HAVE_SYS_MMAN_H)
+    if (length > 0)
+    {
+        int errsv = errno;
+        munmap(mapping, length);
+        errno = errsv;
+    }
+#endif
+}
@@ -0,0 +1,100 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CYPHER_PARSER_INPUT_H
+#define CYPHER_PARSER_INPUT_H
+
+#include "cypher-parser.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+
+enum cp_stream_read_mode
+{
+    // read a single character at a time, never consuming more of the
+    // stream than has been requested by the parser
+    CP_STREAM_READ_CHARS,
+    // read up to the end of each line, so an interactive stream is never
+    // waited on for input beyond the current line
+    CP_STREAM_READ_LINES,
+    // read whole blocks
+    CP_STREAM_READ_BLOCKS
+};
+
+
+struct cp_stream_input
+{
+    FILE *stream;
+    enum cp_stream_read_mode mode;
+};
+
+
+/**
+ * Initialize input from a stream.
+ *
+ * @internal
+ *
+ * If `read_ahead` is true, then input may be read from the stream beyond the
+ * point the parser has reached, in blocks if the stream is a regular file or
+ * otherwise a line at a time.
+ *
+ * @param [input] The input to initialize.
+ * @param [stream] The stream to read from.
+ * @param [read_ahead] Whether the stream may be read ahead of the parser.
+ */
+void cp_stream_input_init(struct cp_stream_input *input, FILE *stream,
+        bool read_ahead);
+
+/**
+ * Read from a stream input.
+ *
+ * @internal
+ *
+ * @param [data] A pointer to a `struct cp_stream_input`.
+ * @param [buf] The buffer to read into.
+ * @param [n] The size of the buffer.
+ * @return The number of characters read, or 0 at the end of the stream.
+ */
+int cp_stream_input_read(void *data, char *buf, int n);
+
+/**
+ * Map the contents of a stream into memory.
+ *
+ * @internal
+ *
+ * The stream must be a regular file, positioned at its start, and must not
+ * be modified whilst mapped. The mapping must be released using
+ * cp_unmap_stream().
+ *
+ * @param [stream] The stream to map.
+ * @param [length] A pointer to a `size_t`, which will be set to the length
+ *         of the mapped contents.
+ * @return A pointer to the mapped contents, which are read only, or NULL if
+ *         the stream cannot be mapped (errno will be set).
+ */
+void *cp_map_stream(FILE *stream, size_t *length);
+
+/**
+ * Release a mapping made by cp_map_stream().
+ *
+ * @internal
+ *
+ * @param [mapping] The mapping, as returned by cp_map_stream().
+ * @param [length] The length of the mapped contents.
+ */
+void cp_unmap_stream(void *mapping, size_t length);
+
+#endif/*CYPHER_PARSER_INPUT_H*/
@@ -0,0 +1,186 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "keywords.h"
+#include <assert.h>
+
+#define MIN_WORD_LENGTH 2
+#define MAX_WORD_LENGTH 16
+#define MAX_HASH_VALUE 116
+
+
+#define KEYWORD(s) { s, sizeof(s) - 1 }
+
+const struct cp_keyword_string cp_keywords[] =
+    { { NULL, 0 },
+      KEYWORD("all"),
+      KEYWORD("allshortestpaths"),
+      KEYWORD("and"),
+      KEYWORD("any"),
+      KEYWORD("as"),
+      KEYWORD("asc"),
+      KEYWORD("ascending"),
+      KEYWORD("assert"),
+      KEYWORD("by"),
+      KEYWORD("call"),
+      KEYWORD("case"),
+      KEYWORD("commit"),
+      KEYWORD("constraint"),
+      KEYWORD("contains"),
+      KEYWORD("create"),
+      KEYWORD("csv"),
+      KEYWORD("cypher"),
+      KEYWORD("delete"),
+      KEYWORD("desc"),
+      KEYWORD("descending"),
+      KEYWORD("detach"),
+      KEYWORD("distinct"),
+      KEYWORD("drop"),
+      KEYWORD("else"),
+      KEYWORD("end"),
+      KEYWORD("ends"),
+      KEYWORD("explain"),
+      KEYWORD("extract"),
+      KEYWORD("false"),
+      KEYWORD("fieldterminator"),
+      KEYWORD("filter"),
+      KEYWORD("foreach"),
+      KEYWORD("from"),
+      KEYWORD("headers"),
+      KEYWORD("in"),
+      KEYWORD("index"),
+      KEYWORD("is"),
+      KEYWORD("join"),
+      KEYWORD("limit"),
+      KEYWORD("load"),
+      KEYWORD("match"),
+      KEYWORD("merge"),
+      KEYWORD("node"),
+      KEYWORD("none"),
+      KEYWORD("not"),
+      KEYWORD("null"),
+      KEYWORD("on"),
+      KEYWORD("optional"),
+      KEYWORD("or"),
+      KEYWORD("order"),
+      KEYWORD("periodic"),
+      KEYWORD("profile"),
+      KEYWORD("reduce"),
+      KEYWORD("rel"),
+      KEYWORD("relationship"),
+      KEYWORD("remove"),
+      KEYWORD("return"),
+      KEYWORD("scan"),
+      KEYWORD("set"),
+      KEYWORD("shortestpath"),
+      KEYWORD("single"),
+      KEYWORD("skip"),
+      KEYWORD("start"),
+      KEYWORD("starts"),
+      KEYWORD("then"),
+      KEYWORD("true"),
+      KEYWORD("union"),
+      KEYWORD("unique"),
+      KEYWORD("unwind"),
+      KEYWORD("using"),
+      KEYWORD("when"),
+      KEYWORD("where"),
+      KEYWORD("with"),
+      KEYWORD("xor"),
+      KEYWORD("yield") };
+
+
+// map a character to 0-25 if it is a letter (ignoring case), otherwise 26
+static inline unsigned int letter_index(char c)
+{
+    unsigned int i = (unsigned int)((unsigned char)c | 0x20) - 'a';
+    return (i < 26)? i : 26;
+}
+
+
+/*
+ * A perfect hash of the keywords, in the style of gperf: the hash of a word
+ * is its length plus an associated value for its first, third (if any) and
+ * last letters, which were chosen such that no two keywords collide. Any
+ * non-letter is associated with a value that takes the hash out of range.
+ */
+static const unsigned char asso_values[27] =
+    { 24, 17,  4, 38,  7, 36, 11,  7,  3,  7, 30, 34, 28,
+       1, 16,  3, 22, 38, 31, 14, 12,  0, 15, 37, 20, 36,
+      117 };
+
+// indexed by hash value
+static const unsigned char keyword_table[MAX_HASH_VALUE + 1] =
+    { [6] = CP_KW_IN, [7] = CP_KW_CSV, [13] = CP_KW_NONE, [15] = CP_KW_JOIN,
+      [18] = CP_KW_EXPLAIN, [19] = CP_KW_ON, [21] = CP_KW_UNION,
+      [24] = CP_KW_CREATE, [26] = CP_KW_THEN, [27] = CP_KW_WHEN,
+      [28] = CP_KW_UNIQUE, [29] = CP_KW_CONSTRAINT, [31] = CP_KW_USING,
+      [32] = CP_KW_NOT, [33] = CP_KW_PROFILE, [34] = CP_KW_WHERE,
+      [35] = CP_KW_ASC, [36] = CP_KW_IS, [37] = CP_KW_TRUE, [39] = CP_KW_BY,
+      [40] = CP_KW_WITH, [41] = CP_KW_SKIP, [42] = CP_KW_EXTRACT,
+      [44] = CP_KW_CONTAINS, [45] = CP_KW_SINGLE, [46] = CP_KW_CASE,
+      [48] = CP_KW_ASCENDING, [49] = CP_KW_ELSE, [50] = CP_KW_NODE,
+      [51] = CP_KW_CYPHER, [52] = CP_KW_COMMIT, [53] = CP_KW_PERIODIC,
+      [54] = CP_KW_MATCH, [56] = CP_KW_OR, [57] = CP_KW_AS,
+      [59] = CP_KW_RETURN, [60] = CP_KW_SCAN, [61] = CP_KW_DROP,
+      [62] = CP_KW_SET, [65] = CP_KW_DETACH, [66] = CP_KW_SHORTESTPATH,
+      [67] = CP_KW_ANY, [69] = CP_KW_HEADERS, [70] = CP_KW_YIELD,
+      [71] = CP_KW_UNWIND, [72] = CP_KW_OPTIONAL, [73] = CP_KW_NULL,
+      [74] = CP_KW_START, [75] = CP_KW_ASSERT, [76] = CP_KW_CALL,
+      [77] = CP_KW_DESC, [78] = CP_KW_MERGE, [79] = CP_KW_REMOVE,
+      [80] = CP_KW_ENDS, [81] = CP_KW_LIMIT, [82] = CP_KW_FALSE,
+      [83] = CP_KW_INDEX, [84] = CP_KW_FROM, [85] = CP_KW_DELETE,
+      [86] = CP_KW_END, [87] = CP_KW_RELATIONSHIP, [88] = CP_KW_FOREACH,
+      [89] = CP_KW_REDUCE, [90] = CP_KW_DESCENDING, [91] = CP_KW_DISTINCT,
+      [92] = CP_KW_STARTS, [95] = CP_KW_ALL, [96] = CP_KW_FIELDTERMINATOR,
+      [97] = CP_KW_ORDER, [100] = CP_KW_LOAD, [103] = CP_KW_AND,
+      [105] = CP_KW_ALLSHORTESTPATHS, [109] = CP_KW_REL, [114] = CP_KW_FILTER,
+      [116] = CP_KW_XOR };
+
+
+static inline unsigned int hash(const char *s, size_t n)
+{
+    unsigned int h = (unsigned int)n + asso_values[letter_index(s[0])] +
+            asso_values[letter_index(s[n - 1])];
+    if (n > 2)
+    {
+        h += asso_values[letter_index(s[2])];
+    }
+    return h;
+}
+
+
+enum cp_keyword cp_keyword_lookup(const char *s, size_t n)
+{
+    if (n < MIN_WORD_LENGTH || n > MAX_WORD_LENGTH)
+    {
+        return CP_NO_KEYWORD;
+    }
+    unsigned int h = hash(s, n);
+    if (h > MAX_HASH_VALUE)
+    {
+        return CP_NO_KEYWORD;
+    }
+    enum cp_keyword keyword = keyword_table[h];
+    if (keyword == CP_NO_KEYWORD || cp_keywords[keyword].length != n ||
+            cp_keyword_prefix_length(keyword, s, n) != n)
+    {
+        return CP_NO_KEYWORD;
+    }
+    return keyword;
+}
+
@@ -0,0 +1,153 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CYPHER_PARSER_KEYWORDS_H
+#define CYPHER_PARSER_KEYWORDS_H
+
+#include <assert.h>
+#include <stdlib.h>
+
+
+/*
+ * The words matched as keywords by the grammar.
+ */
+enum cp_keyword
+{
+    CP_NO_KEYWORD = 0,
+    CP_KW_ALL,
+    CP_KW_ALLSHORTESTPATHS,
+    CP_KW_AND,
+    CP_KW_ANY,
+    CP_KW_AS,
+    CP_KW_ASC,
+    CP_KW_ASCENDING,
+    CP_KW_ASSERT,
+    CP_KW_BY,
+    CP_KW_CALL,
+    CP_KW_CASE,
+    CP_KW_COMMIT,
+    CP_KW_CONSTRAINT,
+    CP_KW_CONTAINS,
+    CP_KW_CREATE,
+    CP_KW_CSV,
+    CP_KW_CYPHER,
+    CP_KW_DELETE,
+    CP_KW_DESC,
+    CP_KW_DESCENDING,
+    CP_KW_DETACH,
+    CP_KW_DISTINCT,
+    CP_KW_DROP,
+    CP_KW_ELSE,
+    CP_KW_END,
+    CP_KW_ENDS,
+    CP_KW_EXPLAIN,
+    CP_KW_EXTRACT,
+    CP_KW_FALSE,
+    CP_KW_FIELDTERMINATOR,
+    CP_KW_FILTER,
+    CP_KW_FOREACH,
+    CP_KW_FROM,
+    CP_KW_HEADERS,
+    CP_KW_IN,
+    CP_KW_INDEX,
+    CP_KW_IS,
+    CP_KW_JOIN,
+    CP_KW_LIMIT,
+    CP_KW_LOAD,
+    CP_KW_MATCH,
+    CP_KW_MERGE,
+    CP_KW_NODE,
+    CP_KW_NONE,
+    CP_KW_NOT,
+    CP_KW_NULL,
+    CP_KW_ON,
+    CP_KW_OPTIONAL,
+    CP_KW_OR,
+    CP_KW_ORDER,
+    CP_KW_PERIODIC,
+    CP_KW_PROFILE,
+    CP_KW_REDUCE,
+    CP_KW_REL,
+    CP_KW_RELATIONSHIP,
+    CP_KW_REMOVE,
+    CP_KW_RETURN,
+    CP_KW_SCAN,
+    CP_KW_SET,
+    CP_KW_SHORTESTPATH,
+    CP_KW_SINGLE,
+    CP_KW_SKIP,
+    CP_KW_START,
+    CP_KW_STARTS,
+    CP_KW_THEN,
+    CP_KW_TRUE,
+    CP_KW_UNION,
+    CP_KW_UNIQUE,
+    CP_KW_UNWIND,
+    CP_KW_USING,
+    CP_KW_WHEN,
+    CP_KW_WHERE,
+    CP_KW_WITH,
+    CP_KW_XOR,
+    CP_KW_YIELD,
+};
+
+
+struct cp_keyword_string
+{
+    const char *str;
+    unsigned int length;
+};
+
+/*
+ * The keywords in lower case, indexed by `enum cp_keyword`.
+ */
+extern const struct cp_keyword_string cp_keywords[];
+
+
+/*
+ * Classify a symbolic name, ignoring case.
+ *
+ * @param [s] The symbolic name.
+ * @param [n] The length of the symbolic name.
+ * @return The keyword, or `CP_NO_KEYWORD` if the name is not a keyword.
+ */
+enum cp_keyword cp_keyword_lookup(const char *s, size_t n);
+
+/*
+ * Get the number of leading characters of a string that match a keyword,
+ * ignoring case.
+ *
+ * @param [keyword] The keyword.
+ * @param [s] The string.
+ * @param [n] The length of the string.
+ * @return The number of characters matched, which will be at most the
+ *         length of the keyword.
+ */
+static inline unsigned int cp_keyword_prefix_length(enum cp_keyword keyword,
+        const char *s, size_t n)
+{
+    assert(keyword != CP_NO_KEYWORD);
+    const char *str = cp_keywords[keyword].str;
+    unsigned int i = 0;
+    // keywords contain only lower case letters, and folding the case of any
+    // character other than an upper case letter will not produce one
+    for (; i < n && str[i] != '\0' && (s[i] | 0x20) == str[i]; ++i)
+        ;
+    return i;
+}
+
+
+#endif/*CYPHER_PARSER_KEYWORDS_H*/
@@ -0,0 +1,146 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "line_index.h"
+#include "alloc.h"
+#include <assert.h>
+#include <string.h>
+
+
+cp_line_index_t *cp_line_index(struct cypher_input_position start)
+{
+    cp_line_index_t *index = cp_calloc(1, sizeof(cp_line_index_t));
+    if (index == NULL)
+    {
+        return NULL;
+    }
+    index->start = start;
+    return index;
+}
+
+
+int cp_line_index_build(cp_line_index_t *index, const char *buf, size_t n)
+{
+    assert(index->nline_starts == 0);
+    unsigned int capacity = 0;
+    for (const char *p = buf, *end = buf + n;
+            (p = memchr(p, '\n', end - p)) != NULL; )
+    {
+        ++p;
+        if (index->nline_starts >= capacity)
+        {
+            unsigned int newcap = (capacity == 0)? 8 : capacity * 2;
+            size_t *line_starts = cp_realloc(index->line_starts,
+                    newcap * sizeof(size_t));
+            if (line_starts == NULL)
+            {
+                return -1;
+            }
+            index->line_starts = line_starts;
+            capacity = newcap;
+        }
+        index->line_starts[index->nline_starts++] =
+                index->start.offset + (p - buf);
+    }
+    return 0;
+}
+
+
+char *cp_line_index_retain_input(cp_line_index_t *index, const char *buf,
+        size_t n)
+{
+    assert(index->input == NULL);
+    index->input = cp_malloc(n+1);
+    if (index->input == NULL)
+    {
+        return NULL;
+    }
+    memcpy(index->input, buf, n);
+    index->input[n] = '\0';
+    return index->input;
+}
+
+
+struct cypher_input_position cp_line_index_position(
+        const cp_line_index_t *index, size_t offset)
+{
+    assert(offset >= index->start.offset);
+    // find the number of line starts at or before the offset
+    unsigned int lo = 0, hi = index->nline_starts;
+    while (lo < hi)
+    {
+        unsigned int mid = lo + (hi - lo) / 2;
+        if (index->line_starts[mid] <= offset)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    struct cypher_input_position position =
+        { .line = index->start.line + lo, .offset = offset };
+    if (lo == 0)
+    {
+        position.column = index->start.column +
+                (offset - index->start.offset);
+    }
+    else
+    {
+        position.column = 1 + (offset - index->line_starts[lo - 1]);
+    }
+    return position;
+}
+
+
+struct cypher_input_position cp_position_advance(
+        struct cypher_input_position position, const char *buf, size_t n)
+{
+    const char *line_start = NULL;
+    for (const char *p = buf, *end = buf + n;
+            (p = memchr(p, '\n', end - p)) != NULL; )
+    {
+        line_start = ++p;
+        ++(position.line);
+    }
+
+    if (line_start == NULL)
+    {
+        position.column += n;
+    }
+    else
+    {
+        position.column = 1 + (buf + n - line_start);
+    }
+    position.offset += n;
+    return position;
+}
+
+
+void cp_line_index_free(cp_line_index_t *index)
+{
+    while (index != NULL)
+    {
+        cp_line_index_t *next = index->next;
+        cp_free(index->line_starts);
+        cp_free(index->input);
+        cp_free(index);
+        index = next;
+    }
+}
@@ -0,0 +1,77 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CYPHER_PARSER_LINE_INDEX_H
+#define CYPHER_PARSER_LINE_INDEX_H
+
+#include "cypher-parser.h"
+
+
+/*
+ * An index of the lines in a segment of parsed input, from which the line
+ * and column of any offset in the segment can be resolved. Indexes are
+ * chained together when the segments of a parse result are merged.
+ */
+typedef struct cp_line_index cp_line_index_t;
+struct cp_line_index
+{
+    cp_line_index_t *next;
+    struct cypher_input_position start;
+    size_t *line_starts; // offsets of each line after the first
+    unsigned int nline_starts;
+    // a copy of the input, when retained for nodes that reference it
+    char *input;
+};
+
+
+/*
+ * Create an empty index, for input beginning at the specified position.
+ */
+cp_line_index_t *cp_line_index(struct cypher_input_position start);
+
+/*
+ * Index the lines of the input, which must begin at the start position of
+ * the index. Returns 0 on success, or -1 on failure (and sets errno).
+ */
+int cp_line_index_build(cp_line_index_t *index, const char *buf, size_t n);
+
+/*
+ * Retain a null terminated copy of the input, which must begin at the start
+ * position of the index. Returns the copy, or NULL on failure (and sets
+ * errno).
+ */
+char *cp_line_index_retain_input(cp_line_index_t *index, const char *buf,
+        size_t n);
+
+/*
+ * Resolve the position of an offset in the indexed input.
+ */
+struct cypher_input_position cp_line_index_position(
+        const cp_line_index_t *index, size_t offset);
+
+/*
+ * Advance a position over the input, resolving lines as an index would.
+ */
+struct cypher_input_position cp_position_advance(
+        struct cypher_input_position position, const char *buf, size_t n);
+
+/*
+ * Free an index, along with all those chained after it.
+ */
+void cp_line_index_free(cp_line_index_t *index);
+
+
+#endif/*CYPHER_PARSER_LINE_INDEX_H*/
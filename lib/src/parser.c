@@ -16,9 +16,14 @@
  */
 #include "../../config.h"
 #include "cypher-parser.h"
+#include "arena.h"
 #include "ast.h"
+#include "batch.h"
 #include "errors.h"
+#include "input.h"
+#include "keywords.h"
 #include "operators.h"
+#include "parser.h"
 #include "parser_config.h"
 #include "result.h"
 #include "segment.h"
@@ -27,12 +32,21 @@
 #include "vector.h"
 #include <assert.h>
 #include <ctype.h>
+#include <limits.h>
 #include <setjmp.h>
+#ifdef HAVE_PTHREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
 
 DECLARE_VECTOR(offsets, unsigned int, 0);
 DECLARE_VECTOR(precedences, unsigned int, 0);
 DECLARE_VECTOR(operators, const cypher_operator_t *, NULL);
 DECLARE_VECTOR(astnodes, cypher_astnode_t *, NULL);
+DECLARE_VECTOR(packed_values, union cypher_ast_packed_value,
+        (union cypher_ast_packed_value){ 0 });
+DECLARE_VECTOR(packed_elements, struct cypher_ast_packed_element,
+        (struct cypher_ast_packed_element){ 0 });
 
 struct block
 {
@@ -45,103 +59,214 @@ struct block
 
 DECLARE_VECTOR(blocks, struct block *, NULL);
 
+// the recorded outcome of parsing a memoized rule at a position
+struct memo_entry
+{
+    unsigned int next; // index+1 of the next entry at the same position
+    unsigned int rule;
+    int end; // end position, or -1 if the rule failed to match
+    const cypher_operator_t *op;
+    unsigned int thunks;
+    unsigned int nthunks;
+    struct cypher_input_position error_position;
+    char error_char;
+    unsigned int labels;
+    unsigned int nlabels;
+};
+
+// a memoized rule currently being parsed
+struct memo_frame
+{
+    unsigned int rule;
+    int pos;
+    int thunkpos;
+    struct cypher_input_position error_position;
+    char error_char;
+    unsigned int labels;
+};
+
+DECLARE_VECTOR(memo_entries, struct memo_entry, (struct memo_entry){ 0 });
+DECLARE_VECTOR(memo_frames, struct memo_frame, (struct memo_frame){ 0 });
+DECLARE_VECTOR(labels, const char *, NULL);
+
+enum memo_rule
+{
+    MEMO_EXPRESSION,
+    MEMO_ATOM,
+    MEMO_NODE_PATTERN
+};
+
 typedef struct _yycontext yycontext;
 typedef int (*yyrule)(yycontext *yy);
 typedef int (*source_cb_t)(void *data, char *buf, int n);
 
-static int parse_each(yyrule rule, source_cb_t source, void *sourcedata,
-        cypher_parser_segment_callback_t callback, void *userdata,
+// parse using the supplied context, or a temporary context if NULL
+static int parse_each(yycontext *yy, yyrule rule, source_cb_t source,
+        void *sourcedata, cypher_parser_segment_callback_t callback,
+        void *userdata, struct cypher_input_position *last,
+        cypher_parser_config_t *config, uint_fast32_t flags);
+static cypher_parse_result_t *parse(yycontext *yy, yyrule rule,
+        source_cb_t source, void *sourcedata,
         struct cypher_input_position *last, cypher_parser_config_t *config,
         uint_fast32_t flags);
-static cypher_parse_result_t *parse(yyrule rule, source_cb_t source,
-        void *sourcedata, struct cypher_input_position *last,
+static cypher_parse_result_t *parse_parallel(yyrule rule, const char *s,
+        size_t n, unsigned int nthreads, struct cypher_input_position *last,
+        cypher_parser_config_t *config, uint_fast32_t flags);
+static int fparse_each_parallel(yyrule rule, FILE *stream,
+        cypher_parser_segment_callback_t callback, void *userdata,
+        unsigned int nthreads, struct cypher_input_position *last,
+        cypher_parser_config_t *config, uint_fast32_t flags);
+static cypher_parse_batch_t *parse_batch(yyrule rule, const char **queries,
+        const size_t *lens, unsigned int n, unsigned int nthreads,
+        cypher_parser_config_t *config, uint_fast32_t flags);
+static cypher_parse_result_t *new_result(
+        const cypher_parser_config_t *config);
+static int parse_all_callback(void *data, cypher_parse_segment_t *segment);
+static const struct cp_allocator *config_allocator(
+        const cypher_parser_config_t *config);
+static int context_init(yycontext *yy, const struct cp_allocator *allocator);
+static void context_cleanup(yycontext *yy);
+static int context_parse_each(yycontext *yy, yyrule rule, source_cb_t source,
+        void *sourcedata, cypher_parser_segment_callback_t callback,
+        void *userdata, struct cypher_input_position *last,
         cypher_parser_config_t *config, uint_fast32_t flags);
 static int parse_one(yycontext *yy, yyrule rule);
 static void source(yycontext *yy, char *buf, int *result, int max_size);
 
 
-struct source_from_buffer_data
+// an in-memory input, which is parsed in place when passed as the source
+// data to `parse_each` (or `parse`) with a NULL source callback, unless it
+// is too large (see `in_place_init`)
+struct buffer_input
 {
     const char *buffer;
     size_t length;
 };
 
 
-static int source_from_buffer(void *data, char *buf, int n)
-{
-    struct source_from_buffer_data *input = data;
-    int len = min(input->length, n);
-    input->length -= len;
-    if (len == 0)
-    {
-        return len;
-    }
-    memcpy(buf, input->buffer, len);
-    return len;
-}
+static bool in_place_fits(size_t length);
+static int buffer_input_read(void *data, char *buf, int n);
 
 
-static int uparse_each(yyrule rule, const char *s, size_t n,
-        cypher_parser_segment_callback_t callback, void *userdata,
+static int uparse_each(yycontext *yy, yyrule rule, const char *s,
+        size_t n, cypher_parser_segment_callback_t callback, void *userdata,
         struct cypher_input_position *last, cypher_parser_config_t *config,
         uint_fast32_t flags)
 {
     REQUIRE(s != NULL, -1);
     REQUIRE(callback != NULL, -1);
-    struct source_from_buffer_data sourcedata = { .buffer = s, .length = n };
-    return parse_each(rule, source_from_buffer, &sourcedata, callback,
-            userdata, last, config, flags);
+    struct buffer_input input = { .buffer = s, .length = n };
+    return parse_each(yy, rule, NULL, &input, callback, userdata, last,
+            config, flags);
+}
+
+
+static cypher_parse_result_t *uparse(yycontext *yy, yyrule rule,
+        const char *s, size_t n, struct cypher_input_position *last,
+        cypher_parser_config_t *config, uint_fast32_t flags)
+{
+    REQUIRE(s != NULL, NULL);
+    struct buffer_input input = { .buffer = s, .length = n };
+    return parse(yy, rule, NULL, &input, last, config, flags);
 }
 
 
-static cypher_parse_result_t *uparse(yyrule rule, const char *s, size_t n,
+static int fparse_each(yycontext *yy, yyrule rule, FILE *stream,
+        cypher_parser_segment_callback_t callback, void *userdata,
         struct cypher_input_position *last, cypher_parser_config_t *config,
         uint_fast32_t flags)
 {
-    REQUIRE(s != NULL, NULL);
-    struct source_from_buffer_data sourcedata = { .buffer = s, .length = n };
-    return parse(rule, source_from_buffer, &sourcedata, last, config, flags);
+    REQUIRE(stream != NULL, -1);
+    REQUIRE(callback != NULL, -1);
+    struct cp_stream_input input;
+    cp_stream_input_init(&input, stream, !(flags & CYPHER_PARSE_SINGLE));
+    return parse_each(yy, rule, cp_stream_input_read, &input, callback,
+            userdata, last, config, flags);
 }
 
 
-static int source_from_stream(void *data, char *buf, int n)
+static cypher_parse_result_t *fparse(yycontext *yy, yyrule rule, FILE *stream,
+        struct cypher_input_position *last, cypher_parser_config_t *config,
+        uint_fast32_t flags)
 {
-    FILE *stream = data;
-    int c = getc(stream);
-    if (c == EOF)
-    {
-        return 0;
-    }
-    *buf = c;
-    return 1;
+    REQUIRE(stream != NULL, NULL);
+    struct cp_stream_input input;
+    cp_stream_input_init(&input, stream, !(flags & CYPHER_PARSE_SINGLE));
+    return parse(yy, rule, cp_stream_input_read, &input, last, config, flags);
 }
 
 
-static int fparse_each(yyrule rule, FILE *stream,
+static int file_parse_each(yycontext *yy, yyrule rule, const char *path,
         cypher_parser_segment_callback_t callback, void *userdata,
         struct cypher_input_position *last, cypher_parser_config_t *config,
         uint_fast32_t flags)
 {
-    REQUIRE(stream != NULL, -1);
+    REQUIRE(path != NULL, -1);
     REQUIRE(callback != NULL, -1);
-    return parse_each(rule, source_from_stream, stream, callback, userdata,
-            last, config, flags);
+
+    FILE *stream = fopen(path, "r");
+    if (stream == NULL)
+    {
+        return -1;
+    }
+
+    int result;
+    struct buffer_input input;
+    void *mapping = cp_map_stream(stream, &(input.length));
+    if (mapping != NULL && !in_place_fits(input.length))
+    {
+        // rather than copying from the mapping, read the file as a stream
+        cp_unmap_stream(mapping, input.length);
+        mapping = NULL;
+    }
+    if (mapping != NULL)
+    {
+        input.buffer = mapping;
+        result = parse_each(yy, rule, NULL, &input, callback, userdata, last,
+                config, flags);
+        cp_unmap_stream(mapping, input.length);
+    }
+    else
+    {
+        result = fparse_each(yy, rule, stream, callback, userdata, last,
+                config, flags);
+    }
+
+    int errsv = errno;
+    fclose(stream);
+    errno = errsv;
+    return result;
 }
 
 
-static cypher_parse_result_t *fparse(yyrule rule, FILE *stream,
-        struct cypher_input_position *last, cypher_parser_config_t *config,
-        uint_fast32_t flags)
+static cypher_parse_result_t *file_parse(yycontext *yy, yyrule rule,
+        const char *path, struct cypher_input_position *last,
+        cypher_parser_config_t *config, uint_fast32_t flags)
 {
-    REQUIRE(stream != NULL, NULL);
-    return parse(rule, source_from_stream, stream, last, config, flags);
+    REQUIRE(path != NULL, NULL);
+    cypher_parse_result_t *result = new_result(config);
+    if (result == NULL)
+    {
+        return NULL;
+    }
+
+    if (file_parse_each(yy, rule, path, parse_all_callback, result, last,
+                config, flags))
+    {
+        cypher_parse_result_free(result);
+        return NULL;
+    }
+
+    return result;
 }
 
 
 static void *abort_malloc(yycontext *yy, size_t size);
 static void *abort_realloc(yycontext *yy, void *ptr, size_t size);
 static void finished(yycontext *yy);
-static void line_start(yycontext *yy);
+static void eof_action(yycontext *yy, char *text, int count);
+static void empty_action(yycontext *yy, char *text, int count);
+static int validate_rule(yycontext *yy);
 static void block_start_action(yycontext *yy, char *text, int count);
 static struct block *block_start(yycontext *yy, size_t offset,
         struct cypher_input_position position);
@@ -151,10 +276,24 @@ static void block_merge_action(yycontext *yy, char *text, int pos);
 static struct block *block_end(yycontext *yy, size_t offset,
         struct cypher_input_position position);
 
-#define ERR(label) _err(yy, label)
+#define ERR(label) do { if (!yy->optimistic) _err(yy, label); } while (0)
 static void _err(yycontext *yy, const char *msg);
 static void record_error(yycontext *yy);
 
+static int skip_body(yycontext *yy);
+static int skip_clause(yycontext *yy);
+static bool leading_clause_type(const char *s, size_t n,
+        cypher_astnode_type_t *type);
+
+#define MEMO_ENTER(rule) _memo_enter(yy, MEMO_##rule)
+static int _memo_enter(yycontext *yy, enum memo_rule rule);
+#define MEMO_REPLAYED() _memo_replayed(yy)
+static int _memo_replayed(yycontext *yy);
+#define MEMO_SAVE() (_memo_save(yy), 1)
+static void _memo_save(yycontext *yy);
+#define MEMO_FAIL() _memo_fail(yy)
+static void _memo_fail(yycontext *yy);
+
 #define strbuf_reset() cp_sb_reset(&(yy->string_buffer))
 #define strbuf_append(s, n) _strbuf_append(yy, s, n)
 static void _strbuf_append(yycontext *yy, const char *s, size_t n);
@@ -165,6 +304,20 @@ static void _strbuf_append_block(yycontext *yy);
 static void _sequence_add(yycontext *yy, cypher_astnode_t *node);
 #define collection_literal() _collection_literal(yy)
 static cypher_astnode_t *_collection_literal(yycontext *yy);
+#define packed_reset() _packed_reset(yy)
+static void _packed_reset(yycontext *yy);
+#define PACKED_MARK() _packed_mark(yy)
+static int _packed_mark(yycontext *yy);
+#define PACKED_INTEGER() _packed_number(yy, CYPHER_AST_INTEGER)
+#define PACKED_FLOAT() _packed_number(yy, CYPHER_AST_FLOAT)
+static int _packed_number(yycontext *yy, cypher_astnode_type_t type);
+#define PACKED_STRING() (yyDo(yy, packed_string_action, yy->__pos, 0), 1)
+static void packed_mark_action(yycontext *yy, char *text, int pos);
+static void packed_integer_action(yycontext *yy, char *text, int pos);
+static void packed_float_action(yycontext *yy, char *text, int pos);
+static void packed_string_action(yycontext *yy, char *text, int pos);
+#define packed_collection() _packed_collection(yy)
+static cypher_astnode_t *_packed_collection(yycontext *yy);
 
 #define OP(n) (yy->op = CYPHER_OP_##n, 1)
 #define op_push(n) _op_push(yy, CYPHER_OP_##n)
@@ -191,6 +344,10 @@ static cypher_astnode_t *_cypher_option_param(yycontext *yy,
 static cypher_astnode_t *_explain_option(yycontext *yy);
 #define profile_option() _profile_option(yy)
 static cypher_astnode_t *_profile_option(yycontext *yy);
+#define deferred_body() _deferred_body(yy)
+static cypher_astnode_t *_deferred_body(yycontext *yy);
+#define lazy_clause() _lazy_clause(yy)
+static cypher_astnode_t *_lazy_clause(yycontext *yy);
 #define create_index(l) _create_index(yy, l)
 static cypher_astnode_t *_create_index(yycontext *yy, cypher_astnode_t *label);
 #define drop_index(l) _drop_index(yy, l)
@@ -468,6 +625,8 @@ static cypher_astnode_t *_string(yycontext *yy, const char *s, size_t n);
 static cypher_astnode_t *_block_string(yycontext *yy);
 #define strbuf_string() _strbuf_string(yy)
 static cypher_astnode_t *_strbuf_string(yycontext *yy);
+#define string_literal() _string_literal(yy)
+static cypher_astnode_t *_string_literal(yycontext *yy);
 #define line_comment() _line_comment(yy)
 static cypher_astnode_t *_line_comment(yycontext *yy);
 #define block_comment() _block_comment(yy)
@@ -478,26 +637,60 @@ static cypher_astnode_t *_skip(yycontext *yy);
 
 #define YY_CTX_MEMBERS \
     cypher_parser_config_t *config; \
+    struct cp_allocator allocator; \
     sigjmp_buf abort_env; \
     struct cypher_input_position position_offset; \
-    offsets_t line_start_offsets; \
+    cp_line_index_t *line_index; \
+    cp_symbol_table_t *symbols; \
     blocks_t blocks; \
     struct block *prev_block; /* last "closed" block */ \
+    blocks_t spare_blocks; \
     struct cp_string_buffer string_buffer; \
     const cypher_operator_t *op; \
     operators_t operators; \
     precedences_t precedences; \
     source_cb_t source; \
     void *source_data; \
+    bool in_place; \
+    bool input_exhausted; \
+    bool validate_only; \
+    yyrule validated_rule; \
+    bool shallow; \
+    bool lazy_clauses; \
+    bool packed_lists; \
+    int packed_mark; /* start of the element being matched */ \
+    int packed_start; /* start of the element being constructed */ \
+    cypher_astnode_type_t packed_type; \
+    packed_values_t packed_values; \
+    packed_elements_t packed_elements; \
+    struct cp_string_buffer packed_text; \
+    bool retain_input; \
+    int segment_start; /* buffer offset of the segment being parsed */ \
+    char *stream_buf; \
+    int stream_buflen; \
+    bool active; \
     cypher_astnode_t *result; \
+    bool empty; \
     bool eof; \
+    cp_arena_t arena; \
+    cp_arena_t *shared_arena; \
     cp_error_tracking_t error_tracking; \
-    unsigned int consumed;
+    bool optimistic; \
+    bool error_found; \
+    unsigned int consumed; \
+    memo_entries_t memo_entries; \
+    offsets_t memo_index; \
+    memo_frames_t memo_frames; \
+    struct cp_vector memo_thunks; \
+    labels_t memo_labels; \
+    labels_t memo_frame_labels; \
+    bool memo_replayed;
 
 #define YYSTYPE cypher_astnode_t *
 
 #define YY_MALLOC abort_malloc
 #define YY_REALLOC abort_realloc
+#define YY_FREE(C, P) cp_free(P)
 
 #define YY_BEGIN \
     (yy->__begin = yy->__pos, yyDo(yy, block_start_action, yy->__pos, 0), 1)
@@ -518,24 +711,50 @@ static cypher_astnode_t *_skip(yycontext *yy);
 
 #define abort_parse(yy) \
     do { assert(errno != 0); siglongjmp(yy->abort_env, errno); } while (0)
+static void in_place_init(yycontext *yy, struct buffer_input *input);
+static void in_place_release(yycontext *yy);
 static int safe_yyparsefrom(yycontext *yy, yyrule rule);
-static unsigned int backtrack_lines(yycontext *yy, unsigned int pos);
+static void optimistic_restart(yycontext *yy, int pos);
+static int in_place_yyparsefrom(yycontext *yy, yyrule rule);
 static struct cypher_input_position input_position(yycontext *yy,
         unsigned int pos);
+static void block_release(yycontext *yy, struct block *block);
 static void block_free(struct block *block);
+static void memo_init(yycontext *yy);
+static void memo_clear(yycontext *yy);
+static void memo_cleanup(yycontext *yy);
+static void memo_error(yycontext *yy, unsigned int pos,
+        struct cypher_input_position position, char c, const char *label);
 static cypher_astnode_t *add_terminal(yycontext *yy, cypher_astnode_t *node);
 static cypher_astnode_t *add_child(yycontext *yy, cypher_astnode_t *node);
 
 
 void source(yycontext *yy, char *buf, int *result, int max_size)
 {
-    if (buf == NULL)
+    if (buf == NULL || yy->in_place)
     {
+        // the segment being parsed may depend on any input following
+        yy->input_exhausted = (buf != NULL);
         *result = 0;
         return;
     }
     assert(yy != NULL && yy->source != NULL);
     *result = yy->source(yy->source_data, buf, max_size);
+    if (*result == 0)
+    {
+        yy->input_exhausted = true;
+    }
+}
+
+
+int buffer_input_read(void *data, char *buf, int n)
+{
+    struct buffer_input *input = (struct buffer_input *)data;
+    size_t len = minzu(input->length, (size_t)n);
+    memcpy(buf, input->buffer, len);
+    input->buffer += len;
+    input->length -= len;
+    return (int)len;
 }
 
 
@@ -546,7 +765,8 @@ int cypher_uparse_each(const char *s, size_t n,
 {
     yyrule rule = (flags & CYPHER_PARSE_ONLY_STATEMENTS)?
             yy_statement : yy_directive;
-    return uparse_each(rule, s, n, callback, userdata, last, config, flags);
+    return uparse_each(NULL, rule, s, n, callback, userdata, last, config,
+            flags);
 }
 
 
@@ -556,7 +776,34 @@ cypher_parse_result_t *cypher_uparse(const char *s, size_t n,
 {
     yyrule rule = (flags & CYPHER_PARSE_ONLY_STATEMENTS)?
             yy_statement : yy_directive;
-    return uparse(rule, s, n, last, config, flags);
+    return uparse(NULL, rule, s, n, last, config, flags);
+}
+
+
+cypher_parse_result_t *cypher_parse_deferred_body(const cypher_astnode_t *node,
+        cypher_parser_config_t *config, uint_fast32_t flags)
+{
+    REQUIRE(cypher_astnode_instanceof(node, CYPHER_AST_DEFERRED_BODY), NULL);
+    cypher_parser_config_t body_config = (config != NULL)?
+            *config : cypher_parser_std_config;
+    body_config.initial_position = cypher_astnode_range(node).start;
+    size_t n = 0;
+    const char *s = cypher_ast_deferred_body_get_text(node, &n);
+    flags = (flags & ~CYPHER_PARSE_SHALLOW) | CYPHER_PARSE_SINGLE;
+    return uparse(NULL, yy_statement, s, n, NULL, &body_config, flags);
+}
+
+
+cypher_parse_result_t *cp_parse_clause(const char *s, size_t n,
+        struct cypher_input_position position, unsigned int ordinal,
+        const struct cp_allocator *allocator)
+{
+    cypher_parser_config_t config = cypher_parser_std_config;
+    config.initial_position = position;
+    config.initial_ordinal = ordinal;
+    config.allocator = *allocator;
+    return uparse(NULL, yy_single_clause, s, n, NULL, &config,
+            CYPHER_PARSE_SINGLE);
 }
 
 
@@ -566,7 +813,8 @@ int cypher_fparse_each(FILE *stream, cypher_parser_segment_callback_t callback,
 {
     yyrule rule = (flags & CYPHER_PARSE_ONLY_STATEMENTS)?
             yy_statement : yy_directive;
-    return fparse_each(rule, stream, callback, userdata, last, config, flags);
+    return fparse_each(NULL, rule, stream, callback, userdata, last, config,
+            flags);
 }
 
 
@@ -576,463 +824,2901 @@ cypher_parse_result_t *cypher_fparse(FILE *stream,
 {
     yyrule rule = (flags & CYPHER_PARSE_ONLY_STATEMENTS)?
             yy_statement : yy_directive;
-    return fparse(rule, stream, last, config, flags);
+    return fparse(NULL, rule, stream, last, config, flags);
 }
 
 
-int parse_each(yyrule rule, source_cb_t source, void *sourcedata,
+int cypher_parse_file_each(const char *path,
         cypher_parser_segment_callback_t callback, void *userdata,
         struct cypher_input_position *last, cypher_parser_config_t *config,
         uint_fast32_t flags)
 {
-    int result = -1;
-
-    yycontext yy;
-    memset(&yy, 0, sizeof(yycontext));
-    yy.config = (config != NULL)? config : &cypher_parser_std_config;
-    yy.position_offset = yy.config->initial_position;
-    offsets_init(&(yy.line_start_offsets));
-    blocks_init(&(yy.blocks));
-    operators_init(&(yy.operators));
-    precedences_init(&(yy.precedences));
-    yy.source = source;
-    yy.source_data = sourcedata;
-    cp_et_init(&(yy.error_tracking), yy.config->error_colorization);
+    yyrule rule = (flags & CYPHER_PARSE_ONLY_STATEMENTS)?
+            yy_statement : yy_directive;
+    return file_parse_each(NULL, rule, path, callback, userdata, last,
+            config, flags);
+}
 
-    struct block *top_block = NULL;
 
-    if (offsets_push(&(yy.line_start_offsets), 0))
-    {
-        goto cleanup;
-    }
-    top_block = block_start(&yy, 0, input_position(&yy, 0));
-    if (top_block == NULL)
-    {
-        goto cleanup;
-    }
+cypher_parse_result_t *cypher_parse_file(const char *path,
+        struct cypher_input_position *last, cypher_parser_config_t *config,
+        uint_fast32_t flags)
+{
+    yyrule rule = (flags & CYPHER_PARSE_ONLY_STATEMENTS)?
+            yy_statement : yy_directive;
+    return file_parse(NULL, rule, path, last, config, flags);
+}
 
-    unsigned int ordinal = yy.config->initial_ordinal;
 
-    for (;;)
-    {
-        if (parse_one(&yy, rule))
-        {
-            goto cleanup;
-        }
+cypher_parse_result_t *cypher_uparse_parallel(const char *s, size_t n,
+        unsigned int nthreads, struct cypher_input_position *last,
+        cypher_parser_config_t *config, uint_fast32_t flags)
+{
+    REQUIRE(s != NULL, NULL);
+    yyrule rule = (flags & CYPHER_PARSE_ONLY_STATEMENTS)?
+            yy_statement : yy_directive;
+    return parse_parallel(rule, s, n, nthreads, last, config, flags);
+}
 
-        if (yy.consumed == 0)
-        {
-            assert(yy.result == NULL);
-            assert(cp_et_nerrors(&(yy.error_tracking)) == 0);
-            assert(yy.eof);
-            break;
-        }
 
-        // TODO: last should be set even on parse failure
-        if (last != NULL)
-        {
-            *last = input_position(&yy, yy.consumed);
-        }
+int cypher_fparse_each_parallel(FILE *stream,
+        cypher_parser_segment_callback_t callback, void *userdata,
+        unsigned int nthreads, struct cypher_input_position *last,
+        cypher_parser_config_t *config, uint_fast32_t flags)
+{
+    REQUIRE(stream != NULL, -1);
+    REQUIRE(callback != NULL, -1);
+    yyrule rule = (flags & CYPHER_PARSE_ONLY_STATEMENTS)?
+            yy_statement : yy_directive;
+    return fparse_each_parallel(rule, stream, callback, userdata, nthreads,
+            last, config, flags);
+}
 
-        struct cypher_input_range range =
-            { .start = yy.position_offset,
-              .end = input_position(&yy, yy.consumed) };
 
-        cypher_parse_error_t *errors = cp_et_errors(&(yy.error_tracking));
-        unsigned int nerrors = cp_et_nerrors(&(yy.error_tracking));
-        cypher_astnode_t **roots = astnodes_elements(&(top_block->children));
-        unsigned int nroots = astnodes_size(&(top_block->children));
+cypher_parse_batch_t *cypher_uparse_batch(const char **queries,
+        const size_t *lens, unsigned int n, unsigned int nthreads,
+        cypher_parser_config_t *config, uint_fast32_t flags)
+{
+    REQUIRE(queries != NULL || n == 0, NULL);
+    yyrule rule = (flags & CYPHER_PARSE_ONLY_STATEMENTS)?
+            yy_statement : yy_directive;
+    return parse_batch(rule, queries, lens, n, nthreads, config, flags);
+}
 
-        cypher_parse_segment_t *segment = cypher_parse_segment(ordinal,
-                range, errors, nerrors, roots, nroots, yy.result, yy.eof);
-        if (segment == NULL)
-        {
-            goto cleanup;
-        }
 
-        cp_et_clear_errors(&(yy.error_tracking));
-        astnodes_clear(&(top_block->children));
-        ordinal += segment->nnodes;
+// input fed to a parser, but not yet delivered in a segment
+struct push_input
+{
+    bool started;
+    struct cp_allocator allocator;
+    char *buffer;
+    size_t length;
+    size_t capacity;
+    struct cypher_input_position position;
+    unsigned int ordinal;
+    // finds the ends of statements and commands in the input fed
+    cypher_quick_scanner_t *scanner;
+    size_t origin; // the offset at which the scanner started
+    size_t complete; // the end of the last statement or command found
+    bool pending; // complete segments may remain to be delivered
+    bool deferred; // a segment was withheld until its error contexts end
+    size_t await; // the offset at which the withheld contexts must end
+};
 
-        int err = callback(userdata, segment);
-        cypher_parse_segment_release(segment);
-        if (err > 0)
-        {
-            break;
-        }
-        else if (err)
-        {
-            result = err;
-            goto cleanup;
-        }
 
-        if (yy.eof || flags & CYPHER_PARSE_SINGLE)
-        {
-            break;
-        }
+struct cypher_parser
+{
+    yycontext yy;
+    struct push_input push;
+};
 
-        yy.position_offset = range.end;
 
-        offsets_clear(&(yy.line_start_offsets));
-        if (offsets_push(&(yy.line_start_offsets), 0))
-        {
-            goto cleanup;
-        }
-    }
+static int push_parse(cypher_parser_t *parser, yyrule rule,
+        const char *chunk, size_t n, bool finish,
+        cypher_parser_segment_callback_t callback, void *userdata,
+        struct cypher_input_position *last, cypher_parser_config_t *config,
+        uint_fast32_t flags);
+static void push_reset(struct push_input *push);
 
-    result = 0;
 
-    int errsv;
-cleanup:
-    errsv = errno;
-    offsets_cleanup(&(yy.line_start_offsets));
-    block_free(top_block);
-    blocks_cleanup(&(yy.blocks));
-    operators_cleanup(&(yy.operators));
-    precedences_cleanup(&(yy.precedences));
-    cp_et_cleanup(&(yy.error_tracking));
-    cp_sb_cleanup(&(yy.string_buffer));
-    yyrelease(&yy);
-    errno = errsv;
-    return result;
+cypher_parser_t *cypher_parser_new(void)
+{
+    cypher_parser_t *parser = malloc(sizeof(cypher_parser_t));
+    if (parser == NULL)
+    {
+        return NULL;
+    }
+    if (context_init(&(parser->yy), NULL))
+    {
+        int errsv = errno;
+        free(parser);
+        errno = errsv;
+        return NULL;
+    }
+    memset(&(parser->push), 0, sizeof(struct push_input));
+    return parser;
 }
 
 
-static int parse_all_callback(void *data, cypher_parse_segment_t *segment)
+void cypher_parser_free(cypher_parser_t *parser)
 {
-    cypher_parse_result_t *result = (cypher_parse_result_t *)data;
-    return cp_result_merge_segment(result, segment);
+    if (parser == NULL)
+    {
+        return;
+    }
+    context_cleanup(&(parser->yy));
+    push_reset(&(parser->push));
+    free(parser);
 }
 
 
-cypher_parse_result_t *parse(yyrule rule, source_cb_t source, void *sourcedata,
+int cypher_parser_uparse_each(cypher_parser_t *parser, const char *s,
+        size_t n, cypher_parser_segment_callback_t callback, void *userdata,
         struct cypher_input_position *last, cypher_parser_config_t *config,
         uint_fast32_t flags)
 {
-    cypher_parse_result_t *result = calloc(1, sizeof(cypher_parse_result_t));
-    if (result == NULL)
-    {
-        return NULL;
-    }
+    REQUIRE(parser != NULL, -1);
+    yyrule rule = (flags & CYPHER_PARSE_ONLY_STATEMENTS)?
+            yy_statement : yy_directive;
+    return uparse_each(&(parser->yy), rule, s, n, callback, userdata, last,
+            config, flags);
+}
 
-    if (parse_each(rule, source, sourcedata, parse_all_callback, result,
-                last, config, flags))
-    {
-        cypher_parse_result_free(result);
-        return NULL;
-    }
 
-    return result;
+cypher_parse_result_t *cypher_parser_uparse(cypher_parser_t *parser,
+        const char *s, size_t n, struct cypher_input_position *last,
+        cypher_parser_config_t *config, uint_fast32_t flags)
+{
+    REQUIRE(parser != NULL, NULL);
+    yyrule rule = (flags & CYPHER_PARSE_ONLY_STATEMENTS)?
+            yy_statement : yy_directive;
+    return uparse(&(parser->yy), rule, s, n, last, config, flags);
 }
 
 
-int parse_one(yycontext *yy, yyrule rule)
+int cypher_parser_fparse_each(cypher_parser_t *parser, FILE *stream,
+        cypher_parser_segment_callback_t callback, void *userdata,
+        struct cypher_input_position *last, cypher_parser_config_t *config,
+        uint_fast32_t flags)
 {
-#ifndef NDEBUG
-    struct block *top_block = blocks_last(&(yy->blocks));
-#endif
+    REQUIRE(parser != NULL, -1);
+    yyrule rule = (flags & CYPHER_PARSE_ONLY_STATEMENTS)?
+            yy_statement : yy_directive;
+    return fparse_each(&(parser->yy), rule, stream, callback, userdata, last,
+            config, flags);
+}
 
-    yy->result = NULL;
-    yy->eof = false;
-    if (safe_yyparsefrom(yy, rule) <= 0)
-    {
-        goto failure;
-    }
 
-    assert(blocks_size(&(yy->blocks)) == 1 &&
-            "Mismatched use of `<` and `>` in grammar");
-    assert(blocks_last(&(yy->blocks)) == top_block &&
-            "Top-most block has been replaced");
-    assert(astnodes_size(&(top_block->sequence)) == 0 &&
-            "AST nodes left in top-most block sequence");
-    assert(yy->prev_block == NULL &&
-            "Block closed but not cleared - "
-            "no AST node created after final `>` in grammar");
-    assert(operators_size(&(yy->operators)) == 0 &&
-            "Operator stack not emptied");
-    assert(precedences_size(&(yy->precedences)) == 0 &&
-            "Precedence stack not emptied");
+cypher_parse_result_t *cypher_parser_fparse(cypher_parser_t *parser,
+        FILE *stream, struct cypher_input_position *last,
+        cypher_parser_config_t *config, uint_fast32_t flags)
+{
+    REQUIRE(parser != NULL, NULL);
+    yyrule rule = (flags & CYPHER_PARSE_ONLY_STATEMENTS)?
+            yy_statement : yy_directive;
+    return fparse(&(parser->yy), rule, stream, last, config, flags);
+}
 
-    cp_et_clear_potentials(&(yy->error_tracking));
+
+int cypher_parser_parse_file_each(cypher_parser_t *parser, const char *path,
+        cypher_parser_segment_callback_t callback, void *userdata,
+        struct cypher_input_position *last, cypher_parser_config_t *config,
+        uint_fast32_t flags)
+{
+    REQUIRE(parser != NULL, -1);
+    yyrule rule = (flags & CYPHER_PARSE_ONLY_STATEMENTS)?
+            yy_statement : yy_directive;
+    return file_parse_each(&(parser->yy), rule, path, callback, userdata,
+            last, config, flags);
+}
+
+
+cypher_parse_result_t *cypher_parser_parse_file(cypher_parser_t *parser,
+        const char *path, struct cypher_input_position *last,
+        cypher_parser_config_t *config, uint_fast32_t flags)
+{
+    REQUIRE(parser != NULL, NULL);
+    yyrule rule = (flags & CYPHER_PARSE_ONLY_STATEMENTS)?
+            yy_statement : yy_directive;
+    return file_parse(&(parser->yy), rule, path, last, config, flags);
+}
+
+
+int cypher_parser_feed(cypher_parser_t *parser, const char *chunk, size_t n,
+        cypher_parser_segment_callback_t callback, void *userdata,
+        cypher_parser_config_t *config, uint_fast32_t flags)
+{
+    REQUIRE(parser != NULL, -1);
+    REQUIRE(chunk != NULL || n == 0, -1);
+    REQUIRE(callback != NULL, -1);
+    yyrule rule = (flags & CYPHER_PARSE_ONLY_STATEMENTS)?
+            yy_statement : yy_directive;
+    return push_parse(parser, rule, chunk, n, false, callback, userdata,
+            NULL, config, flags);
+}
+
+
+int cypher_parser_finish(cypher_parser_t *parser,
+        cypher_parser_segment_callback_t callback, void *userdata,
+        struct cypher_input_position *last, cypher_parser_config_t *config,
+        uint_fast32_t flags)
+{
+    REQUIRE(parser != NULL, -1);
+    REQUIRE(callback != NULL, -1);
+    yyrule rule = (flags & CYPHER_PARSE_ONLY_STATEMENTS)?
+            yy_statement : yy_directive;
+    return push_parse(parser, rule, NULL, 0, true, callback, userdata, last,
+            config, flags);
+}
+
+
+/*
+ * Push parsing
+ *
+ * Input fed to a parser is appended to a buffer, and is also supplied to a
+ * quick scanner, which finds the ends of statements and commands without
+ * ever scanning the same input twice. Only when the scanner finds the end of
+ * a statement or command is the buffer parsed in place, from the start of
+ * the first undelivered segment up to and including the segment at that end.
+ * Each segment that is parsed without reading to the end of the buffer is
+ * complete, and can be delivered, as no further input could change it. The
+ * input consumed by delivered segments is then discarded from the buffer.
+ *
+ * The full parser decides the extent of each segment, so error recovery may
+ * end a segment where the scanner does not (e.g. at a semicolon in a
+ * comment). Such a segment is delivered when a later end is found, or when
+ * the input is finished.
+ *
+ * The context of a parse error extends to the end of its line, and so a
+ * segment with errors is withheld until the input fed contains that end, or
+ * enough input for the longest context, to ensure the contexts are the same
+ * as those produced when parsing the input as a whole.
+ */
+
+struct push_parse
+{
+    cypher_parser_t *parser;
+    cypher_parser_segment_callback_t callback;
+    void *userdata;
+    bool finish;
+    struct cypher_input_position end; // the end of the last delivered segment
+    unsigned int ordinal;
+    bool eof;
+    bool stopped; // the callback requested parsing be stopped
+    bool deferred; // a segment was withheld until its error contexts end
+    size_t await;
+};
+
+
+#define PUSH_CONTEXT_LENGTH 80
+
+
+static int push_scanned(void *data,
+        const cypher_quick_parse_segment_t *segment)
+{
+    struct push_input *push = (struct push_input *)data;
+    push->complete = push->origin +
+            cypher_quick_parse_segment_get_range(segment).end.offset;
+    return 0;
+}
+
+
+static bool contains_line_end(const char *s, size_t n)
+{
+    for (const char *end = s + n; s < end; ++s)
+    {
+        if (*s == '\n' || *s == '\r')
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+// determine if the contexts of all errors in a segment are available, or
+// otherwise the offset at which they will be
+static bool contexts_available(const struct push_input *push,
+        const cypher_parse_segment_t *segment, size_t *await)
+{
+    if (segment->nerrors == 0)
+    {
+        return true;
+    }
+    size_t offset = 0;
+    for (unsigned int i = 0; i < segment->nerrors; ++i)
+    {
+        offset = maxzu(offset, segment->errors[i].position.offset);
+    }
+    assert(offset >= push->position.offset);
+    size_t start = offset - push->position.offset;
+    size_t n = minzu(push->length - minzu(start, push->length),
+            PUSH_CONTEXT_LENGTH);
+    if (n == PUSH_CONTEXT_LENGTH ||
+            contains_line_end(push->buffer + start, n))
+    {
+        return true;
+    }
+    *await = offset + PUSH_CONTEXT_LENGTH;
+    return false;
+}
+
+
+static int push_callback(void *data, cypher_parse_segment_t *segment)
+{
+    struct push_parse *pp = (struct push_parse *)data;
+    struct push_input *push = &(pp->parser->push);
+    if (!pp->finish && pp->parser->yy.input_exhausted)
+    {
+        // the segment may depend on input not yet fed
+        return 1;
+    }
+    if (!pp->finish && !contexts_available(push, segment, &(pp->await)))
+    {
+        pp->deferred = true;
+        return 1;
+    }
+    pp->end = segment->range.end;
+    pp->ordinal += segment->nnodes;
+    pp->eof = segment->eof;
+    int err = pp->callback(pp->userdata, segment);
+    pp->stopped = (err > 0);
+    if (err == 0 && !pp->finish && pp->end.offset >= push->complete)
+    {
+        // any further input has not been found to complete a segment
+        return 1;
+    }
+    return err;
+}
+
+
+int push_parse(cypher_parser_t *parser, yyrule rule, const char *chunk,
+        size_t n, bool finish, cypher_parser_segment_callback_t callback,
+        void *userdata, struct cypher_input_position *last,
+        cypher_parser_config_t *config, uint_fast32_t flags)
+{
+    struct push_input *push = &(parser->push);
+    if (parser->yy.active)
+    {
+        // the parser is already in use, e.g. by a callback invoked from it
+        errno = EBUSY;
+        return -1;
+    }
+
+    struct cypher_parser_config push_config = (config != NULL)?
+            *config : cypher_parser_std_config;
+    if (!push->started)
+    {
+        push->scanner = cypher_quick_scanner_new(
+                flags & CYPHER_PARSE_ONLY_STATEMENTS);
+        if (push->scanner == NULL)
+        {
+            return -1;
+        }
+        push->allocator = push_config.allocator;
+        push->position = push_config.initial_position;
+        push->ordinal = push_config.initial_ordinal;
+        push->origin = push->position.offset;
+        push->complete = push->origin;
+        push->started = true;
+    }
+
+    if (n > 0)
+    {
+        if (n > push->capacity - push->length)
+        {
+            size_t capacity = (push->capacity == 0)?
+                    YY_BUFFER_SIZE : push->capacity;
+            while (capacity - push->length < n)
+            {
+                if (capacity > SIZE_MAX / 2)
+                {
+                    errno = ENOMEM;
+                    return -1;
+                }
+                capacity *= 2;
+            }
+            const struct cp_allocator *prev =
+                    cp_set_allocator(&(push->allocator));
+            char *buffer = cp_realloc(push->buffer, capacity);
+            cp_set_allocator(prev);
+            if (buffer == NULL)
+            {
+                return -1;
+            }
+            push->buffer = buffer;
+            push->capacity = capacity;
+        }
+        memcpy(push->buffer + push->length, chunk, n);
+        push->length += n;
+    }
+
+    if (!finish)
+    {
+        size_t complete = push->complete;
+        if (cypher_quick_scanner_feed(push->scanner, chunk, n,
+                    push_scanned, push))
+        {
+            return -1;
+        }
+        bool parse = push->pending || push->complete > complete ||
+            (push->deferred && (contains_line_end(chunk, n) ||
+                push->position.offset + push->length >= push->await));
+        if (!parse)
+        {
+            return 0;
+        }
+    }
+
+    push_config.initial_position = push->position;
+    push_config.initial_ordinal = push->ordinal;
+    struct buffer_input input =
+        { .buffer = (push->buffer != NULL)? push->buffer : "",
+          .length = push->length };
+    struct push_parse pp = { .parser = parser, .callback = callback,
+        .userdata = userdata, .finish = finish, .end = push->position,
+        .ordinal = push->ordinal };
+    int result = context_parse_each(&(parser->yy), rule, NULL, &input,
+            push_callback, &pp, NULL, &push_config, flags);
+
+    // discard the input consumed by the delivered segments
+    size_t consumed = pp.end.offset - push->position.offset;
+    assert(consumed <= push->length);
+    if (consumed > 0)
+    {
+        memmove(push->buffer, push->buffer + consumed,
+                push->length - consumed);
+        push->length -= consumed;
+    }
+    push->position = pp.end;
+    push->ordinal = pp.ordinal;
+    // unless parsing stopped early, no complete segment remains
+    push->pending = (pp.stopped || result);
+    push->deferred = pp.deferred;
+    push->await = pp.await;
+
+    if (finish && !result && (!pp.stopped || pp.eof))
+    {
+        if (last != NULL)
+        {
+            *last = push->position;
+        }
+        push_reset(push);
+    }
+    return result;
+}
+
+
+void push_reset(struct push_input *push)
+{
+    const struct cp_allocator *prev = cp_set_allocator(&(push->allocator));
+    cp_free(push->buffer);
+    cp_set_allocator(prev);
+    cypher_quick_scanner_free(push->scanner);
+    memset(push, 0, sizeof(struct push_input));
+}
+
+
+int parse_each(yycontext *yy, yyrule rule, source_cb_t source,
+        void *sourcedata, cypher_parser_segment_callback_t callback,
+        void *userdata, struct cypher_input_position *last,
+        cypher_parser_config_t *config, uint_fast32_t flags)
+{
+    if (yy != NULL)
+    {
+        return context_parse_each(yy, rule, source, sourcedata, callback,
+                userdata, last, config, flags);
+    }
+
+    yycontext context;
+    if (context_init(&context, config_allocator(config)))
+    {
+        return -1;
+    }
+    int result = context_parse_each(&context, rule, source, sourcedata,
+            callback, userdata, last, config, flags);
+    int errsv = errno;
+    context_cleanup(&context);
+    errno = errsv;
+    return result;
+}
+
+
+/*
+ * Parser contexts
+ *
+ * A context holds all the state used during parsing, including the buffers
+ * of the generated parser and the vectors used for tracking blocks,
+ * operators, errors and memoized results. On completion of each parse this
+ * state is cleared, but the memory allocated for it is retained, so that a
+ * context may be reused for further parsing without repeating the
+ * allocations. Closed blocks are also retained in the context, rather than
+ * being freed, and are reused by subsequent blocks.
+ *
+ * All memory for the context is obtained from the allocator it is created
+ * with (or the standard allocator, if NULL). The same allocator is used for
+ * the AST nodes and segments produced by parsing, and so a context is
+ * recreated if it is used with a config specifying a different allocator.
+ */
+
+const struct cp_allocator *config_allocator(
+        const cypher_parser_config_t *config)
+{
+    return (config != NULL)? &(config->allocator) :
+            &(cypher_parser_std_config.allocator);
+}
+
+
+int context_init(yycontext *yy, const struct cp_allocator *allocator)
+{
+    memset(yy, 0, sizeof(yycontext));
+    if (allocator != NULL)
+    {
+        yy->allocator = *allocator;
+    }
+    const struct cp_allocator *prev = cp_set_allocator(&(yy->allocator));
+    blocks_init(&(yy->blocks));
+    blocks_init(&(yy->spare_blocks));
+    operators_init(&(yy->operators));
+    precedences_init(&(yy->precedences));
+    packed_values_init(&(yy->packed_values));
+    packed_elements_init(&(yy->packed_elements));
+    cp_et_init(&(yy->error_tracking),
+            cypher_parser_std_config.error_colorization);
+    cp_arena_init(&(yy->arena));
+    memo_init(yy);
+
+    // allocate the buffers for the generated parser here, rather than
+    // lazily in `yyparsefrom`, so they are retained between parses
+    yy->__buflen = YY_BUFFER_SIZE;
+    yy->__buf = cp_malloc(yy->__buflen);
+    yy->__textlen = YY_BUFFER_SIZE;
+    yy->__text = cp_malloc(yy->__textlen);
+    yy->__thunkslen = YY_STACK_SIZE;
+    yy->__thunks = cp_malloc(sizeof(yythunk) * yy->__thunkslen);
+    yy->__valslen = YY_STACK_SIZE;
+    yy->__vals = cp_malloc(sizeof(YYSTYPE) * yy->__valslen);
+    if (yy->__buf == NULL || yy->__text == NULL || yy->__thunks == NULL ||
+            yy->__vals == NULL)
+    {
+        int errsv = errno;
+        context_cleanup(yy);
+        cp_set_allocator(prev);
+        errno = errsv;
+        return -1;
+    }
+    cp_set_allocator(prev);
+    return 0;
+}
+
+
+void context_cleanup(yycontext *yy)
+{
+    assert(!yy->active && !yy->in_place);
+    const struct cp_allocator *prev = cp_set_allocator(&(yy->allocator));
+    assert(yy->line_index == NULL);
+    assert(yy->symbols == NULL);
+    assert(blocks_size(&(yy->blocks)) == 0);
+    blocks_cleanup(&(yy->blocks));
+    struct block *block;
+    while ((block = blocks_pop(&(yy->spare_blocks))) != NULL)
+    {
+        block_free(block);
+    }
+    blocks_cleanup(&(yy->spare_blocks));
+    operators_cleanup(&(yy->operators));
+    precedences_cleanup(&(yy->precedences));
+    packed_values_cleanup(&(yy->packed_values));
+    packed_elements_cleanup(&(yy->packed_elements));
+    cp_sb_cleanup(&(yy->packed_text));
+    cp_et_cleanup(&(yy->error_tracking));
+    cp_sb_cleanup(&(yy->string_buffer));
+    cp_arena_cleanup(&(yy->arena));
+    memo_cleanup(yy);
+    yyrelease(yy);
+    cp_set_allocator(prev);
+}
+
+
+int context_parse_each(yycontext *yy, yyrule rule, source_cb_t source,
+        void *sourcedata, cypher_parser_segment_callback_t callback,
+        void *userdata, struct cypher_input_position *last,
+        cypher_parser_config_t *config, uint_fast32_t flags)
+{
+    if (yy->active)
+    {
+        // the context is already in use, e.g. by a callback invoked from it
+        errno = EBUSY;
+        return -1;
+    }
+
+    const struct cp_allocator *allocator = config_allocator(config);
+    if (!cp_allocator_equal(&(yy->allocator), allocator))
+    {
+        yycontext context;
+        if (context_init(&context, allocator))
+        {
+            return -1;
+        }
+        context_cleanup(yy);
+        memcpy(yy, &context, sizeof(yycontext));
+    }
+
+    int result = -1;
+    const struct cp_allocator *prev_allocator =
+            cp_set_allocator(&(yy->allocator));
+
+    yy->active = true;
+    yy->config = (config != NULL)? config : &cypher_parser_std_config;
+    yy->validate_only = flags & CYPHER_PARSE_VALIDATE_ONLY;
+    yy->shallow = flags & CYPHER_PARSE_SHALLOW;
+    // nodes in an arena are never released, which would leak the
+    // materialized clauses
+    yy->lazy_clauses =
+        (flags & CYPHER_PARSE_LAZY_CLAUSES) && !yy->config->arena;
+    // likewise for the elements of packed collections
+    yy->packed_lists =
+        (flags & CYPHER_PARSE_PACKED_LISTS) && !yy->config->arena;
+    yy->retain_input = flags & CYPHER_PARSE_RETAIN_INPUT;
+    yy->position_offset = yy->config->initial_position;
+    yy->source = source;
+    yy->source_data = sourcedata;
+    cp_et_reset(&(yy->error_tracking), yy->config->error_colorization);
+    yy->__begin = yy->__end = yy->__pos = yy->__limit = yy->__thunkpos = 0;
+
+    struct block *top_block = NULL;
+
+    if (source == NULL)
+    {
+        in_place_init(yy, sourcedata);
+    }
+
+    top_block = block_start(yy, 0, input_position(yy, 0));
+    if (top_block == NULL)
+    {
+        goto cleanup;
+    }
+
+    unsigned int ordinal = yy->config->initial_ordinal;
+
+    for (;;)
+    {
+        if (parse_one(yy, rule))
+        {
+            goto cleanup;
+        }
+
+        if (yy->consumed == 0)
+        {
+            assert(yy->result == NULL);
+            assert(cp_et_nerrors(&(yy->error_tracking)) == 0);
+            assert(yy->eof);
+            break;
+        }
+
+        struct cypher_input_range range =
+            { .start = yy->position_offset,
+              .end = cp_line_index_position(yy->line_index,
+                      yy->position_offset.offset + yy->consumed) };
+
+        // TODO: last should be set even on parse failure
+        if (last != NULL)
+        {
+            *last = range.end;
+        }
+
+        cypher_parse_error_t *errors = cp_et_errors(&(yy->error_tracking));
+        unsigned int nerrors = cp_et_nerrors(&(yy->error_tracking));
+        cypher_astnode_t **roots = astnodes_elements(&(top_block->children));
+        unsigned int nroots = astnodes_size(&(top_block->children));
+
+        // nodes allocated from a shared arena remain owned by its owner
+        cypher_parse_segment_t *segment = cypher_parse_segment(ordinal,
+                range, errors, nerrors, roots, nroots, yy->result, yy->empty,
+                yy->eof,
+                (yy->shared_arena != NULL)? NULL : &(yy->arena),
+                yy->line_index, yy->symbols);
+        if (segment == NULL)
+        {
+            goto cleanup;
+        }
+        yy->line_index = NULL;
+        yy->symbols = NULL;
+
+        cp_et_clear_errors(&(yy->error_tracking));
+        astnodes_clear(&(top_block->children));
+        ordinal += segment->nnodes;
+
+        // the callback may allocate (e.g. by cloning nodes) using the
+        // allocator of the caller
+        cp_set_allocator(prev_allocator);
+        int err = callback(userdata, segment);
+        cp_set_allocator(&(yy->allocator));
+        cypher_parse_segment_release(segment);
+        if (err > 0)
+        {
+            break;
+        }
+        else if (err)
+        {
+            result = err;
+            goto cleanup;
+        }
+
+        if (yy->eof || flags & CYPHER_PARSE_SINGLE)
+        {
+            break;
+        }
+
+        yy->position_offset = range.end;
+    }
+
+    result = 0;
+
+    int errsv;
+cleanup:
+    errsv = errno;
+    // the top block remains in the block stack unless parsing failed
+    struct block *block;
+    while ((block = blocks_pop(&(yy->blocks))) != NULL)
+    {
+        block_release(yy, block);
+    }
+    // discard any nodes allocated but not passed on in a segment
+    cp_arena_cleanup(&(yy->arena));
+    cp_line_index_free(yy->line_index);
+    yy->line_index = NULL;
+    cp_symbol_table_free(yy->symbols);
+    yy->symbols = NULL;
+    cp_sb_reset(&(yy->string_buffer));
+    in_place_release(yy);
+    yy->source = NULL;
+    yy->source_data = NULL;
+    yy->active = false;
+    cp_set_allocator(prev_allocator);
+    errno = errsv;
+    return result;
+}
+
+
+cypher_parse_result_t *new_result(const cypher_parser_config_t *config)
+{
+    const struct cp_allocator *prev = cp_set_allocator(
+            config_allocator(config));
+    cypher_parse_result_t *result = cypher_parse_result();
+    cp_set_allocator(prev);
+    return result;
+}
+
+
+static int parse_all_callback(void *data, cypher_parse_segment_t *segment)
+{
+    cypher_parse_result_t *result = (cypher_parse_result_t *)data;
+    return cp_result_merge_segment(result, segment);
+}
+
+
+cypher_parse_result_t *parse(yycontext *yy, yyrule rule, source_cb_t source,
+        void *sourcedata, struct cypher_input_position *last,
+        cypher_parser_config_t *config, uint_fast32_t flags)
+{
+    cypher_parse_result_t *result = new_result(config);
+    if (result == NULL)
+    {
+        return NULL;
+    }
+
+    if (parse_each(yy, rule, source, sourcedata, parse_all_callback, result,
+                last, config, flags))
+    {
+        cypher_parse_result_free(result);
+        return NULL;
+    }
+
+    return result;
+}
+
+
+/*
+ * Parallel parsing
+ *
+ * The input is split into chunks, each of many whole directives, using the
+ * quick parser, and the chunks are parsed by a pool of worker threads with
+ * a context each. The segments produced are delivered to the callback in
+ * input order, on the calling thread, with the ordinals of their nodes
+ * renumbered to follow on from the previous chunk. Only a fixed number of
+ * chunks are in flight (split but not yet delivered) at any time, so the
+ * memory used is bounded regardless of the size of the input.
+ *
+ * Parsing a directive depends only on the input from its start, so the
+ * segments are identical to those of a serial parse, provided each chunk
+ * starts where the last segment of the previous chunk ended:
+ *
+ * - An in-memory input is parsed in place, from the start of each chunk
+ *   until a segment reaches (or passes) the start of the next. Should the
+ *   quick parser have split the input elsewhere (e.g. at a semicolon within
+ *   an escaped name), the next chunk is reparsed from the end of the
+ *   previous one.
+ *
+ * - A stream is read by a reader thread, with each chunk copied into its
+ *   own buffer and parsed in isolation. Chunks are split at the end of a
+ *   line, so that error contexts are unaffected. Should parsing reach the
+ *   end of the buffer, other than at the end of the stream, the segment may
+ *   depend on the input following, and so the remainder of the chunk is
+ *   reparsed along with the next.
+ */
+
+#ifndef HAVE_PTHREADS
+
+cypher_parse_result_t *parse_parallel(yyrule rule, const char *s, size_t n,
+        unsigned int nthreads, struct cypher_input_position *last,
+        cypher_parser_config_t *config, uint_fast32_t flags)
+{
+    struct buffer_input input = { .buffer = s, .length = n };
+    return parse(NULL, rule, NULL, &input, last, config, flags);
+}
+
+
+int fparse_each_parallel(yyrule rule, FILE *stream,
+        cypher_parser_segment_callback_t callback, void *userdata,
+        unsigned int nthreads, struct cypher_input_position *last,
+        cypher_parser_config_t *config, uint_fast32_t flags)
+{
+    return fparse_each(NULL, rule, stream, callback, userdata, last, config,
+            flags);
+}
+
+#else
+
+#define PARALLEL_MIN_CHUNK_SIZE (16*1024)
+#define PARALLEL_CHUNKS_PER_THREAD 8
+#define PARALLEL_STREAM_CHUNK_SIZE (64*1024)
+// without a line end, a stream is split once this many chunks are buffered
+#define PARALLEL_STREAM_MAX_CHUNKS 4
+// the number of chunks in flight for each worker
+#define PARALLEL_DEPTH 4
+
+DECLARE_VECTOR(segments, cypher_parse_segment_t *, NULL);
+
+struct chunk
+{
+    size_t start;
+    size_t limit; // the start of the next chunk
+    struct cypher_input_position position;
+    char *buffer; // the input of the chunk, when read from a stream
+    bool open; // the input following the chunk is not in the buffer
+    bool truncated; // the input following the chunk exceeds the buffer
+    segments_t segments;
+    int err;
+    bool done;
+};
+
+struct parallel_parse
+{
+    yyrule rule;
+    cypher_parser_config_t *config;
+    uint_fast32_t flags;
+    const char *input; // NULL when parsing a stream
+    size_t length;
+    FILE *stream;
+    size_t chunk_size;
+    size_t next_start;
+    struct cypher_input_position next_position;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t cond; // signalled when a chunk is added, parsed or taken
+    struct chunk **chunks; // a ring of the chunks in flight
+    unsigned int depth;
+    size_t nadded;
+    size_t nclaimed;
+    size_t ndelivered;
+    bool split; // all chunks have been added
+    int split_err;
+    bool cancelled;
+
+    cypher_parser_segment_callback_t callback;
+    void *userdata;
+    const struct cp_allocator *caller_allocator;
+    struct cypher_input_position *last;
+    unsigned int ordinal;
+    size_t end; // the end of the last delivered segment
+    struct cypher_input_position end_position;
+    char *carry; // the input following the end, if not yet parsed
+    bool finished;
+    int status;
+    int status_errno;
+    yycontext yy;
+    bool have_context;
+};
+
+struct chunk_parse
+{
+    struct chunk *chunk;
+    yycontext *yy;
+};
+
+
+static int parallel_parse_each(struct parallel_parse *pp,
+        unsigned int nthreads);
+static unsigned int default_nthreads(void);
+static int split_callback(void *data,
+        const cypher_quick_parse_segment_t *segment);
+static void *stream_reader(void *data);
+static size_t stream_split(struct parallel_parse *pp, const char *buf,
+        size_t n);
+static int add_chunk(struct parallel_parse *pp, size_t limit,
+        const char *buf, bool open);
+static void chunk_free(struct chunk *chunk);
+static void *parallel_worker(void *data);
+static int parse_chunk(struct parallel_parse *pp, yycontext *yy,
+        struct chunk *chunk);
+static int chunk_callback(void *data, cypher_parse_segment_t *segment);
+static int deliver_next(struct parallel_parse *pp);
+static int deliver_chunk(struct parallel_parse *pp, struct chunk *chunk);
+static int reparse_chunk(struct parallel_parse *pp, struct chunk *chunk);
+static void parallel_finish(struct parallel_parse *pp, pthread_t *threads,
+        unsigned int nthreads);
+
+
+cypher_parse_result_t *parse_parallel(yyrule rule, const char *s, size_t n,
+        unsigned int nthreads, struct cypher_input_position *last,
+        cypher_parser_config_t *config, uint_fast32_t flags)
+{
+    if (nthreads == 0)
+    {
+        nthreads = default_nthreads();
+    }
+
+    size_t chunk_size = n / ((size_t)nthreads * PARALLEL_CHUNKS_PER_THREAD);
+    if (chunk_size < PARALLEL_MIN_CHUNK_SIZE)
+    {
+        chunk_size = PARALLEL_MIN_CHUNK_SIZE;
+    }
+
+    struct buffer_input input = { .buffer = s, .length = n };
+    if (nthreads == 1 || n <= chunk_size || (flags & CYPHER_PARSE_SINGLE))
+    {
+        return parse(NULL, rule, NULL, &input, last, config, flags);
+    }
+    if (n / chunk_size < nthreads)
+    {
+        nthreads = n / chunk_size + 1;
+    }
+
+    cypher_parse_result_t *result = new_result(config);
+    if (result == NULL)
+    {
+        return NULL;
+    }
+
+    struct parallel_parse pp =
+        { .rule = rule, .config = config, .flags = flags, .input = s,
+          .length = n, .chunk_size = chunk_size,
+          .callback = parse_all_callback, .userdata = result, .last = last };
+    if (parallel_parse_each(&pp, nthreads))
+    {
+        int errsv = errno;
+        cypher_parse_result_free(result);
+        errno = errsv;
+        return NULL;
+    }
+    return result;
+}
+
+
+int fparse_each_parallel(yyrule rule, FILE *stream,
+        cypher_parser_segment_callback_t callback, void *userdata,
+        unsigned int nthreads, struct cypher_input_position *last,
+        cypher_parser_config_t *config, uint_fast32_t flags)
+{
+    if (flags & CYPHER_PARSE_SINGLE)
+    {
+        return fparse_each(NULL, rule, stream, callback, userdata, last,
+                config, flags);
+    }
+
+    struct parallel_parse pp =
+        { .rule = rule, .config = config, .flags = flags, .stream = stream,
+          .chunk_size = PARALLEL_STREAM_CHUNK_SIZE, .callback = callback,
+          .userdata = userdata, .last = last };
+    return parallel_parse_each(&pp,
+            (nthreads == 0)? default_nthreads() : nthreads);
+}
+
+
+unsigned int default_nthreads(void)
+{
+    long nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+    return (nprocs > 0)? (unsigned int)nprocs : 1;
+}
+
+
+int parallel_parse_each(struct parallel_parse *pp, unsigned int nthreads)
+{
+    if (pp->config == NULL)
+    {
+        pp->config = &cypher_parser_std_config;
+    }
+    pp->next_position = pp->config->initial_position;
+    pp->end_position = pp->config->initial_position;
+    pp->ordinal = pp->config->initial_ordinal;
+    pp->depth = nthreads * PARALLEL_DEPTH;
+    pthread_mutex_init(&(pp->mutex), NULL);
+    pthread_cond_init(&(pp->cond), NULL);
+
+    pp->caller_allocator = cp_set_allocator(config_allocator(pp->config));
+    unsigned int nstarted = 0;
+    int result = -1;
+
+    // the workers, and a reader when parsing a stream
+    pthread_t *threads = cp_calloc(nthreads + 1, sizeof(pthread_t));
+    pp->chunks = cp_calloc(pp->depth, sizeof(struct chunk *));
+    if (threads == NULL || pp->chunks == NULL)
+    {
+        goto cleanup;
+    }
+
+    for (; nstarted < nthreads; ++nstarted)
+    {
+        int err = pthread_create(&(threads[nstarted]), NULL,
+                parallel_worker, pp);
+        if (err)
+        {
+            errno = err;
+            goto cleanup;
+        }
+    }
+
+    if (pp->stream != NULL)
+    {
+        int err = pthread_create(&(threads[nstarted]), NULL,
+                stream_reader, pp);
+        if (err)
+        {
+            errno = err;
+            goto cleanup;
+        }
+        ++nstarted;
+    }
+    else
+    {
+        int err = cypher_quick_uparse(pp->input, pp->length, split_callback,
+                pp, pp->flags & CYPHER_PARSE_ONLY_STATEMENTS);
+        if (err == 0 && pp->next_start < pp->length)
+        {
+            err = add_chunk(pp, pp->length, NULL, false);
+        }
+        int errsv = errno;
+        pthread_mutex_lock(&(pp->mutex));
+        pp->split = true;
+        pp->split_err = (err < 0)? errsv : 0;
+        pthread_cond_broadcast(&(pp->cond));
+        pthread_mutex_unlock(&(pp->mutex));
+    }
+
+    while ((result = deliver_next(pp)) == 0)
+        ;
+    if (result > 0)
+    {
+        result = 0;
+    }
+
+    int errsv;
+cleanup:
+    errsv = errno;
+    parallel_finish(pp, threads, nstarted);
+    cp_set_allocator(pp->caller_allocator);
+    errno = errsv;
+    return result;
+}
+
+
+int split_callback(void *data, const cypher_quick_parse_segment_t *segment)
+{
+    struct parallel_parse *pp = (struct parallel_parse *)data;
+    size_t end = cypher_quick_parse_segment_get_next(segment).offset;
+    if (end - pp->next_start < pp->chunk_size)
+    {
+        return 0;
+    }
+    return add_chunk(pp, end, NULL, false);
+}
+
+
+void *stream_reader(void *data)
+{
+    struct parallel_parse *pp = (struct parallel_parse *)data;
+    const struct cp_allocator *prev = cp_set_allocator(
+            config_allocator(pp->config));
+
+    char *buf = NULL;
+    size_t n = 0;
+    size_t cap = 0;
+    bool eof = false;
+    int err = 0;
+
+    while (!eof)
+    {
+        // read at least as much again as is buffered, so that input is not
+        // rescanned repeatedly when splitting a long directive
+        size_t size = (n > pp->chunk_size)? n : pp->chunk_size;
+        if (n + size > cap)
+        {
+            char *nbuf = cp_realloc(buf, n + size);
+            if (nbuf == NULL)
+            {
+                err = errno;
+                break;
+            }
+            buf = nbuf;
+            cap = n + size;
+        }
+
+        size_t nread = fread(buf + n, 1, size, pp->stream);
+        n += nread;
+        if (nread < size)
+        {
+            if (ferror(pp->stream))
+            {
+                err = (errno != 0)? errno : EIO;
+                break;
+            }
+            eof = true;
+        }
+
+        size_t limit = eof? n : stream_split(pp, buf, n);
+        if (limit == 0 && !eof)
+        {
+            continue;
+        }
+
+        if (add_chunk(pp, pp->next_start + limit, buf, !eof))
+        {
+            err = errno;
+            break;
+        }
+        memmove(buf, buf + limit, n - limit);
+        n -= limit;
+    }
+
+    cp_free(buf);
+    pthread_mutex_lock(&(pp->mutex));
+    pp->split = true;
+    pp->split_err = err;
+    pthread_cond_broadcast(&(pp->cond));
+    pthread_mutex_unlock(&(pp->mutex));
+    cp_set_allocator(prev);
+    return NULL;
+}
+
+
+struct stream_scan
+{
+    const char *buf;
+    size_t n;
+    size_t chunk_size;
+    size_t at_line_end; // the last directive end found at a line end
+    size_t any; // the last directive end found
+};
+
+
+static int scan_callback(void *data,
+        const cypher_quick_parse_segment_t *segment)
+{
+    struct stream_scan *scan = (struct stream_scan *)data;
+    size_t end = cypher_quick_parse_segment_get_next(segment).offset;
+    if (cypher_quick_parse_segment_is_eof(segment) || end == 0 ||
+            end >= scan->n)
+    {
+        return 1;
+    }
+
+    char c = scan->buf[end];
+    if (c == '\n' || c == '\r' || scan->buf[end - 1] == '\n')
+    {
+        scan->at_line_end = end;
+    }
+    scan->any = end;
+    return (scan->at_line_end >= scan->chunk_size)? 1 : 0;
+}
+
+
+size_t stream_split(struct parallel_parse *pp, const char *buf, size_t n)
+{
+    if (n < pp->chunk_size)
+    {
+        return 0;
+    }
+
+    struct stream_scan scan =
+        { .buf = buf, .n = n, .chunk_size = pp->chunk_size };
+    if (cypher_quick_uparse(buf, n, scan_callback, &scan,
+                pp->flags & CYPHER_PARSE_ONLY_STATEMENTS) < 0)
+    {
+        return 0;
+    }
+
+    if (scan.at_line_end > 0)
+    {
+        return scan.at_line_end;
+    }
+    // rather than buffer a very long line in full, split it anyway (any
+    // error contexts spanning the split will be cut short)
+    return (n >= PARALLEL_STREAM_MAX_CHUNKS * pp->chunk_size)? scan.any : 0;
+}
+
+
+int add_chunk(struct parallel_parse *pp, size_t limit, const char *buf,
+        bool open)
+{
+    assert(limit >= pp->next_start);
+    size_t n = limit - pp->next_start;
+    struct chunk *chunk = cp_calloc(1, sizeof(struct chunk));
+    if (chunk == NULL)
+    {
+        return -1;
+    }
+    segments_init(&(chunk->segments));
+    if (buf != NULL && n > 0)
+    {
+        chunk->buffer = mdup(buf, n);
+        if (chunk->buffer == NULL)
+        {
+            chunk_free(chunk);
+            return -1;
+        }
+    }
+    chunk->start = pp->next_start;
+    chunk->limit = limit;
+    chunk->position = pp->next_position;
+    chunk->open = open;
+
+    if (pp->stream == NULL)
+    {
+        // chunks are split and delivered by the same thread
+        while (pp->nadded - pp->ndelivered >= pp->depth)
+        {
+            int err = deliver_next(pp);
+            if (err)
+            {
+                chunk_free(chunk);
+                return err;
+            }
+        }
+        pthread_mutex_lock(&(pp->mutex));
+    }
+    else
+    {
+        pthread_mutex_lock(&(pp->mutex));
+        while (pp->nadded - pp->ndelivered >= pp->depth && !pp->cancelled)
+        {
+            pthread_cond_wait(&(pp->cond), &(pp->mutex));
+        }
+        if (pp->cancelled)
+        {
+            pthread_mutex_unlock(&(pp->mutex));
+            chunk_free(chunk);
+            errno = ECANCELED;
+            return -1;
+        }
+    }
+    pp->chunks[pp->nadded % pp->depth] = chunk;
+    ++(pp->nadded);
+    pthread_cond_broadcast(&(pp->cond));
+    pthread_mutex_unlock(&(pp->mutex));
+
+    pp->next_position = cp_position_advance(pp->next_position,
+            (buf != NULL)? buf : pp->input + pp->next_start, n);
+    pp->next_start = limit;
+    return 0;
+}
+
+
+void chunk_free(struct chunk *chunk)
+{
+    if (chunk == NULL)
+    {
+        return;
+    }
+    cypher_parse_segment_t *segment;
+    while (segments_size(&(chunk->segments)) > 0)
+    {
+        segment = segments_pop(&(chunk->segments));
+        cypher_parse_segment_release(segment);
+    }
+    segments_cleanup(&(chunk->segments));
+    cp_free(chunk->buffer);
+    cp_free(chunk);
+}
+
+
+void *parallel_worker(void *data)
+{
+    struct parallel_parse *pp = (struct parallel_parse *)data;
+    const struct cp_allocator *allocator = config_allocator(pp->config);
+    const struct cp_allocator *prev = cp_set_allocator(allocator);
+
+    yycontext yy;
+    int init_err = context_init(&yy, allocator)? errno : 0;
+
+    pthread_mutex_lock(&(pp->mutex));
+    while (!pp->cancelled)
+    {
+        if (pp->nclaimed < pp->nadded)
+        {
+            struct chunk *chunk = pp->chunks[pp->nclaimed % pp->depth];
+            ++(pp->nclaimed);
+            pthread_mutex_unlock(&(pp->mutex));
+
+            if (init_err)
+            {
+                chunk->err = init_err;
+            }
+            else if (parse_chunk(pp, &yy, chunk))
+            {
+                chunk->err = errno;
+            }
+
+            pthread_mutex_lock(&(pp->mutex));
+            chunk->done = true;
+            pthread_cond_broadcast(&(pp->cond));
+        }
+        else if (pp->split)
+        {
+            break;
+        }
+        else
+        {
+            pthread_cond_wait(&(pp->cond), &(pp->mutex));
+        }
+    }
+    pthread_mutex_unlock(&(pp->mutex));
+
+    if (!init_err)
+    {
+        context_cleanup(&yy);
+    }
+    cp_set_allocator(prev);
+    return NULL;
+}
+
+
+int parse_chunk(struct parallel_parse *pp, yycontext *yy, struct chunk *chunk)
+{
+    struct cypher_parser_config config = *(pp->config);
+    config.initial_position = chunk->position;
+
+    struct buffer_input input;
+    if (pp->input == NULL)
+    {
+        input.buffer = (chunk->buffer != NULL)? chunk->buffer : "";
+        input.length = chunk->limit - chunk->start;
+    }
+    else
+    {
+        input.buffer = pp->input + chunk->start;
+        input.length = pp->length - chunk->start;
+    }
+    // the input is parsed in place, and so can be no larger than the buffer
+    chunk->truncated = (input.length > (size_t)(INT_MAX - YY_BUFFER_SIZE));
+    if (chunk->truncated)
+    {
+        input.length = INT_MAX - YY_BUFFER_SIZE;
+    }
+
+    struct chunk_parse cp = { .chunk = chunk, .yy = yy };
+    return context_parse_each(yy, pp->rule, NULL, &input, chunk_callback,
+            &cp, NULL, &config, pp->flags);
+}
+
+
+int chunk_callback(void *data, cypher_parse_segment_t *segment)
+{
+    struct chunk_parse *cp = (struct chunk_parse *)data;
+    struct chunk *chunk = cp->chunk;
+    if (chunk->open && cp->yy->input_exhausted)
+    {
+        // the segment may depend on input following the chunk
+        return 1;
+    }
+    if (segment->eof && chunk->truncated)
+    {
+        errno = EOVERFLOW;
+        return -1;
+    }
+    if (segments_push(&(chunk->segments), segment))
+    {
+        return -1;
+    }
+    cypher_parse_segment_retain(segment);
+    size_t end = chunk->start +
+            (segment->range.end.offset - chunk->position.offset);
+    return (end >= chunk->limit)? 1 : 0;
+}
+
+
+int deliver_next(struct parallel_parse *pp)
+{
+    if (pp->finished)
+    {
+        errno = pp->status_errno;
+        return (pp->status < 0)? pp->status : 1;
+    }
+
+    pthread_mutex_lock(&(pp->mutex));
+    while (pp->ndelivered == pp->nadded && !pp->split)
+    {
+        pthread_cond_wait(&(pp->cond), &(pp->mutex));
+    }
+    if (pp->ndelivered == pp->nadded)
+    {
+        int err = pp->split_err;
+        pthread_mutex_unlock(&(pp->mutex));
+        pp->finished = true;
+        pp->status = (err != 0)? -1 : 0;
+        pp->status_errno = err;
+        errno = err;
+        return (err != 0)? -1 : 1;
+    }
+    struct chunk *chunk = pp->chunks[pp->ndelivered % pp->depth];
+    while (!chunk->done)
+    {
+        pthread_cond_wait(&(pp->cond), &(pp->mutex));
+    }
+    pthread_mutex_unlock(&(pp->mutex));
+
+    int result = deliver_chunk(pp, chunk);
+    int errsv = errno;
+
+    pthread_mutex_lock(&(pp->mutex));
+    pp->chunks[pp->ndelivered % pp->depth] = NULL;
+    ++(pp->ndelivered);
+    pthread_cond_broadcast(&(pp->cond));
+    pthread_mutex_unlock(&(pp->mutex));
+    chunk_free(chunk);
+
+    if (result < 0)
+    {
+        pp->finished = true;
+        pp->status = result;
+        pp->status_errno = errsv;
+    }
+    errno = errsv;
+    return (result < 0)? result : 0;
+}
+
+
+int deliver_chunk(struct parallel_parse *pp, struct chunk *chunk)
+{
+    if (chunk->err)
+    {
+        errno = chunk->err;
+        return -1;
+    }
+
+    if (chunk->start != pp->end)
+    {
+        if (pp->input != NULL)
+        {
+            // the previous chunk ended elsewhere than the quick parser split
+            if (pp->end >= chunk->limit)
+            {
+                return 0;
+            }
+        }
+        else
+        {
+            // prepend the input carried over from the previous chunk
+            assert(pp->end < chunk->start && pp->carry != NULL);
+            size_t ncarry = chunk->start - pp->end;
+            size_t n = chunk->limit - chunk->start;
+            char *buffer = cp_realloc(pp->carry, ncarry + n);
+            if (buffer == NULL)
+            {
+                return -1;
+            }
+            pp->carry = NULL;
+            if (n > 0)
+            {
+                memcpy(buffer + ncarry, chunk->buffer, n);
+            }
+            cp_free(chunk->buffer);
+            chunk->buffer = buffer;
+        }
+        chunk->start = pp->end;
+        chunk->position = pp->end_position;
+        if (reparse_chunk(pp, chunk))
+        {
+            return -1;
+        }
+    }
+
+    // the nodes of each chunk are numbered from the initial ordinal
+    bool renumber = (pp->ordinal != pp->config->initial_ordinal);
+    cypher_parse_segment_t **segments = segments_elements(&(chunk->segments));
+    unsigned int nsegments = segments_size(&(chunk->segments));
+    for (unsigned int i = 0; i < nsegments; ++i)
+    {
+        cypher_parse_segment_t *segment = segments[i];
+        if (renumber)
+        {
+            unsigned int next = pp->ordinal;
+            for (unsigned int j = 0; j < segment->nroots; ++j)
+            {
+                next = cypher_ast_set_ordinals(segment->roots[j], next);
+            }
+            assert(next - pp->ordinal == segment->nnodes);
+        }
+        pp->ordinal += segment->nnodes;
+        pp->end_position = segment->range.end;
+        pp->end = chunk->start +
+                (pp->end_position.offset - chunk->position.offset);
+        if (pp->last != NULL)
+        {
+            *(pp->last) = pp->end_position;
+        }
+
+        // the callback may allocate using the allocator of the caller
+        cp_set_allocator(pp->caller_allocator);
+        int err = pp->callback(pp->userdata, segment);
+        cp_set_allocator(config_allocator(pp->config));
+        bool eof = segment->eof;
+        cypher_parse_segment_release(segment);
+        segments[i] = NULL;
+        if (err || eof)
+        {
+            pp->finished = true;
+            return (err < 0)? err : 0;
+        }
+    }
+
+    if (chunk->open && pp->end < chunk->limit)
+    {
+        // the remainder of the chunk is reparsed along with the next
+        size_t offset = pp->end - chunk->start;
+        memmove(chunk->buffer, chunk->buffer + offset,
+                chunk->limit - pp->end);
+        pp->carry = chunk->buffer;
+        chunk->buffer = NULL;
+    }
+    return 0;
+}
+
+
+int reparse_chunk(struct parallel_parse *pp, struct chunk *chunk)
+{
+    cypher_parse_segment_t *segment;
+    while (segments_size(&(chunk->segments)) > 0)
+    {
+        segment = segments_pop(&(chunk->segments));
+        cypher_parse_segment_release(segment);
+    }
+
+    if (!pp->have_context)
+    {
+        if (context_init(&(pp->yy), config_allocator(pp->config)))
+        {
+            return -1;
+        }
+        pp->have_context = true;
+    }
+    return parse_chunk(pp, &(pp->yy), chunk);
+}
+
+
+void parallel_finish(struct parallel_parse *pp, pthread_t *threads,
+        unsigned int nthreads)
+{
+    pthread_mutex_lock(&(pp->mutex));
+    pp->cancelled = true;
+    pthread_cond_broadcast(&(pp->cond));
+    pthread_mutex_unlock(&(pp->mutex));
+
+    for (unsigned int i = 0; i < nthreads; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    cp_free(threads);
+
+    if (pp->chunks != NULL)
+    {
+        for (; pp->ndelivered < pp->nadded; ++(pp->ndelivered))
+        {
+            chunk_free(pp->chunks[pp->ndelivered % pp->depth]);
+        }
+        cp_free(pp->chunks);
+    }
+    cp_free(pp->carry);
+    if (pp->have_context)
+    {
+        context_cleanup(&(pp->yy));
+    }
+    pthread_cond_destroy(&(pp->cond));
+    pthread_mutex_destroy(&(pp->mutex));
+}
+
+#endif/*HAVE_PTHREADS*/
+
+
+/*
+ * Batch parsing
+ *
+ * Each query of a batch is parsed independently, into a result embedded in
+ * the batch, using a context that is reused for every query parsed by the
+ * same thread (so that its buffers are allocated only once). When arena
+ * allocation is enabled, the nodes of all the queries parsed by a thread are
+ * allocated from a single arena, which is passed to the batch once parsing
+ * is complete, rather than from an arena for each query.
+ *
+ * The queries are claimed by the threads a few at a time, in order. A
+ * failure to parse a query is recorded against that query alone.
+ */
+
+#define BATCH_CLAIM_SIZE 16
+
+struct batch_parse
+{
+    yyrule rule;
+    const char **queries;
+    const size_t *lens;
+    cypher_parser_config_t *config;
+    uint_fast32_t flags;
+    cypher_parse_batch_t *batch;
+    unsigned int next; // the next query to be claimed
+#ifdef HAVE_PTHREADS
+    pthread_mutex_t mutex;
+#endif
+};
+
+
+static int batch_parse_each(struct batch_parse *bp);
+static bool batch_claim(struct batch_parse *bp, unsigned int *start,
+        unsigned int *end);
+static void batch_parse_query(struct batch_parse *bp, yycontext *yy,
+        unsigned int index);
+#ifdef HAVE_PTHREADS
+static void *batch_worker(void *data);
+#endif
+
+
+cypher_parse_batch_t *parse_batch(yyrule rule, const char **queries,
+        const size_t *lens, unsigned int n, unsigned int nthreads,
+        cypher_parser_config_t *config, uint_fast32_t flags)
+{
+    const struct cp_allocator *prev = cp_set_allocator(
+            config_allocator(config));
+    cypher_parse_batch_t *batch = cypher_parse_batch(n);
+    if (batch == NULL)
+    {
+        cp_set_allocator(prev);
+        return NULL;
+    }
+
+    struct batch_parse bp =
+        { .rule = rule, .queries = queries, .lens = lens, .config = config,
+          .flags = flags, .batch = batch };
+
+#ifdef HAVE_PTHREADS
+    if (nthreads == 0)
+    {
+        nthreads = default_nthreads();
+    }
+    nthreads = minu(nthreads, (n + BATCH_CLAIM_SIZE - 1) / BATCH_CLAIM_SIZE);
+    pthread_mutex_init(&(bp.mutex), NULL);
+
+    // the calling thread parses alongside the others, and so the batch is
+    // still parsed should any (or all) of them fail to start
+    pthread_t *threads = NULL;
+    unsigned int nstarted = 0;
+    if (nthreads > 1)
+    {
+        threads = cp_calloc(nthreads - 1, sizeof(pthread_t));
+    }
+    for (; threads != NULL && nstarted < nthreads - 1; ++nstarted)
+    {
+        if (pthread_create(&(threads[nstarted]), NULL, batch_worker, &bp))
+        {
+            break;
+        }
+    }
+#endif
+
+    int result = batch_parse_each(&bp);
+    int errsv = errno;
+
+#ifdef HAVE_PTHREADS
+    for (unsigned int i = 0; i < nstarted; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    cp_free(threads);
+    pthread_mutex_destroy(&(bp.mutex));
+#endif
+
+    if (result)
+    {
+        cypher_parse_batch_free(batch);
+        batch = NULL;
+    }
+    cp_set_allocator(prev);
+    errno = errsv;
+    return batch;
+}
+
+
+#ifdef HAVE_PTHREADS
+void *batch_worker(void *data)
+{
+    struct batch_parse *bp = (struct batch_parse *)data;
+    const struct cp_allocator *prev = cp_set_allocator(
+            config_allocator(bp->config));
+    // should this fail, the queries are parsed by the other threads
+    batch_parse_each(bp);
+    cp_set_allocator(prev);
+    return NULL;
+}
+#endif
+
+
+int batch_parse_each(struct batch_parse *bp)
+{
+    yycontext yy;
+    if (context_init(&yy, config_allocator(bp->config)))
+    {
+        return -1;
+    }
+    cp_arena_t arena;
+    cp_arena_init(&arena);
+    yy.shared_arena = &arena;
+
+    unsigned int start;
+    unsigned int end;
+    while (batch_claim(bp, &start, &end))
+    {
+        for (unsigned int i = start; i < end; ++i)
+        {
+            batch_parse_query(bp, &yy, i);
+        }
+    }
+
+    context_cleanup(&yy);
+#ifdef HAVE_PTHREADS
+    pthread_mutex_lock(&(bp->mutex));
+#endif
+    cp_arena_move(&(bp->batch->arena), &arena);
+#ifdef HAVE_PTHREADS
+    pthread_mutex_unlock(&(bp->mutex));
+#endif
+    return 0;
+}
+
+
+bool batch_claim(struct batch_parse *bp, unsigned int *start,
+        unsigned int *end)
+{
+#ifdef HAVE_PTHREADS
+    pthread_mutex_lock(&(bp->mutex));
+#endif
+    unsigned int n = bp->batch->nentries;
+    *start = bp->next;
+    *end = (n - *start > BATCH_CLAIM_SIZE)? *start + BATCH_CLAIM_SIZE : n;
+    bp->next = *end;
+#ifdef HAVE_PTHREADS
+    pthread_mutex_unlock(&(bp->mutex));
+#endif
+    return *start < *end;
+}
+
+
+void batch_parse_query(struct batch_parse *bp, yycontext *yy,
+        unsigned int index)
+{
+    struct cypher_parse_batch_entry *entry = &(bp->batch->entries[index]);
+    const char *query = bp->queries[index];
+    if (query == NULL)
+    {
+        entry->err = EINVAL;
+        return;
+    }
+
+    struct buffer_input input = { .buffer = query,
+        .length = (bp->lens != NULL)? bp->lens[index] : strlen(query) };
+    if (context_parse_each(yy, bp->rule, NULL, &input, parse_all_callback,
+                &(entry->result), NULL, bp->config, bp->flags))
+    {
+        entry->err = errno;
+        cp_result_cleanup(&(entry->result));
+    }
+}
+
+
+int parse_one(yycontext *yy, yyrule rule)
+{
+#ifndef NDEBUG
+    struct block *top_block = blocks_last(&(yy->blocks));
+#endif
+
+    yy->result = NULL;
+    yy->empty = false;
+    yy->eof = false;
+    yy->input_exhausted = false;
+    yy->optimistic = yy->config->optimistic;
+    yy->error_found = false;
+    memo_clear(yy);
+    assert(yy->line_index == NULL);
+    yy->line_index = cp_line_index(yy->position_offset);
+    if (yy->line_index == NULL)
+    {
+        return -1;
+    }
+    assert(yy->symbols == NULL);
+    yy->symbols = cp_symbol_table();
+    if (yy->symbols == NULL)
+    {
+        return -1;
+    }
+    int start = yy->__pos;
+    yy->segment_start = start;
+    int errsv = errno;
+    // AST nodes constructed in parser actions are allocated from the arena
+    // of the context, if enabled, and have their line and column resolved
+    // from the line index of the segment (built once parsing is finished),
+    // with their names interned in the symbol table of the segment
+    cp_arena_t *prev_arena = cypher_ast_set_arena(!yy->config->arena? NULL :
+            (yy->shared_arena != NULL)? yy->shared_arena : &(yy->arena));
+    const cp_line_index_t *prev_line_index =
+            cypher_ast_set_line_index(yy->line_index);
+    cp_symbol_table_t *prev_symbols = cypher_ast_set_symbol_table(yy->symbols);
+    if (yy->validate_only)
+    {
+        yy->validated_rule = rule;
+        rule = validate_rule;
+    }
+    int result = safe_yyparsefrom(yy, rule);
+    if (result < 0 && yy->error_found)
+    {
+        errno = errsv;
+        optimistic_restart(yy, start);
+        result = safe_yyparsefrom(yy, rule);
+    }
+    cypher_ast_set_symbol_table(prev_symbols);
+    cypher_ast_set_line_index(prev_line_index);
+    cypher_ast_set_arena(prev_arena);
+    if (result <= 0)
+    {
+        goto failure;
+    }
+
+    assert(blocks_size(&(yy->blocks)) == 1 &&
+            "Mismatched use of `<` and `>` in grammar");
+    assert(blocks_last(&(yy->blocks)) == top_block &&
+            "Top-most block has been replaced");
+    assert(astnodes_size(&(top_block->sequence)) == 0 &&
+            "AST nodes left in top-most block sequence");
+    assert(yy->prev_block == NULL &&
+            "Block closed but not cleared - "
+            "no AST node created after final `>` in grammar");
+    assert(operators_size(&(yy->operators)) == 0 &&
+            "Operator stack not emptied");
+    assert(precedences_size(&(yy->precedences)) == 0 &&
+            "Precedence stack not emptied");
+
+    cp_et_clear_potentials(&(yy->error_tracking));
 
     return 0;
 
-    int errsv;
-failure:
-    errsv = errno;
-    offsets_clear(&(yy->line_start_offsets));
-    struct block *block;
-    while ((block = blocks_pop(&(yy->blocks))) != NULL)
+failure:
+    errsv = errno;
+    struct block *block;
+    while ((block = blocks_pop(&(yy->blocks))) != NULL)
+    {
+        block_release(yy, block);
+    }
+    block_release(yy, yy->prev_block);
+    yy->prev_block = NULL;
+    operators_clear(&(yy->operators));
+    precedences_clear(&(yy->precedences));
+    cp_et_clear_potentials(&(yy->error_tracking));
+    errno = errsv;
+    return -1;
+}
+
+
+int safe_yyparsefrom(yycontext *yy, yyrule rule)
+{
+    int err;
+    if ((err = sigsetjmp(yy->abort_env, 0)) != 0)
+    {
+        errno = err;
+        return -1;
+    }
+
+    int result = yy->in_place?
+            in_place_yyparsefrom(yy, rule) : yyparsefrom(yy, rule);
+    memset(yy->abort_env, 0, sizeof(sigjmp_buf));
+    return result;
+}
+
+
+/*
+ * Optimistic parsing
+ *
+ * Potential errors are noted whenever an alternative fails to match, yet
+ * most input contains no errors and the noted errors are discarded. So
+ * unless disabled in the config, each directive is first parsed without
+ * noting potential errors. Should the parser reach an error (see
+ * `_error_` in the grammar), parsing is abandoned and restarted from the
+ * start of the directive, with error tracking. As nothing is committed
+ * until the parse completes, the input remains in the buffer, and no
+ * actions have yet been run.
+ */
+
+void optimistic_restart(yycontext *yy, int pos)
+{
+    assert(yy->optimistic && yy->error_found);
+    yy->optimistic = false;
+    yy->error_found = false;
+    yy->__pos = pos;
+    memo_clear(yy);
+    operators_clear(&(yy->operators));
+    precedences_clear(&(yy->precedences));
+}
+
+
+/*
+ * In-place parsing
+ *
+ * Rather than copying an in-memory input into the buffer of the generated
+ * parser via YY_INPUT, the parser buffer is pointed directly at the input.
+ * The buffer is never written to, nor is it grown: its length is set such
+ * that `yyrefill` will never reallocate it, and YY_INPUT will always report
+ * the end of input. Consumed input is committed by advancing the buffer,
+ * rather than moving the remaining input to the start of it.
+ *
+ * Positions within the buffer are ints, so an input too large to be
+ * addressed by them is instead copied into the buffer via YY_INPUT, as is
+ * done for a stream.
+ */
+
+bool in_place_fits(size_t length)
+{
+    return length <= (size_t)(INT_MAX - YY_BUFFER_SIZE);
+}
+
+
+void in_place_init(yycontext *yy, struct buffer_input *input)
+{
+    if (!in_place_fits(input->length))
+    {
+        yy->source = buffer_input_read;
+        return;
+    }
+
+    // retain the buffer of the context, to be restored on release
+    yy->stream_buf = yy->__buf;
+    yy->stream_buflen = yy->__buflen;
+    yy->__buflen = INT_MAX;
+    yy->__buf = (char *)(uintptr_t)input->buffer;
+    yy->in_place = true;
+    yy->__limit = input->length;
+    yy->__begin = yy->__end = yy->__pos = yy->__thunkpos = 0;
+}
+
+
+void in_place_release(yycontext *yy)
+{
+    if (!yy->in_place)
+    {
+        return;
+    }
+    yy->__buf = yy->stream_buf;
+    yy->__buflen = yy->stream_buflen;
+    yy->__limit = 0;
+    yy->stream_buf = NULL;
+    yy->stream_buflen = 0;
+    yy->in_place = false;
+}
+
+
+int in_place_yyparsefrom(yycontext *yy, yyrule rule)
+{
+    yy->__begin = yy->__end = yy->__pos;
+    yy->__thunkpos = 0;
+    yy->__val = yy->__vals;
+    int result = rule(yy);
+    if (result)
+    {
+        yyDone(yy);
+    }
+
+    yy->__buf += yy->__pos;
+    yy->__limit -= yy->__pos;
+    yy->__begin -= yy->__pos;
+    yy->__end -= yy->__pos;
+    yy->__pos = yy->__thunkpos = 0;
+    return result;
+}
+
+
+void *abort_malloc(yycontext *yy, size_t size)
+{
+    void *m = cp_malloc(size);
+    if (m == NULL)
+    {
+        abort_parse(yy);
+    }
+    return m;
+}
+
+
+void *abort_realloc(yycontext *yy, void *ptr, size_t size)
+{
+    void *m = cp_realloc(ptr, size);
+    if (m == NULL)
+    {
+        abort_parse(yy);
+    }
+    return m;
+}
+
+
+void finished(yycontext *yy)
+{
+    yy->consumed = yy->__pos;
+
+    unsigned int nerrors = cp_et_nerrors(&(yy->error_tracking));
+    unsigned int first_error = nerrors;
+    size_t length = yy->consumed;
+    for (; first_error > 0; --first_error)
+    {
+        cypher_parse_error_t *err = yy->error_tracking.errors +
+                (first_error - 1);
+        if (err->context != NULL)
+        {
+            break;
+        }
+        // errors may be beyond the consumed input (e.g. at the end of input)
+        length = maxzu(length,
+                err->position.offset - yy->position_offset.offset);
+    }
+
+    // the input of the segment is discarded once parsing is complete, so
+    // index its lines now
+    if (cp_line_index_build(yy->line_index, yy->__buf, length))
+    {
+        abort_parse(yy);
+    }
+
+    for (unsigned int i = first_error; i < nerrors; ++i)
+    {
+        cypher_parse_error_t *err = yy->error_tracking.errors + i;
+        err->position = cp_line_index_position(yy->line_index,
+                err->position.offset);
+        size_t ctx_offset = err->position.offset - yy->position_offset.offset;
+        char *ctx = line_context(yy->__buf, yy->__limit, &ctx_offset, 80);
+        if (ctx == NULL)
+        {
+            abort_parse(yy);
+        }
+        err->context = ctx;
+        err->context_offset = ctx_offset;
+    }
+}
+
+
+void eof_action(yycontext *yy, char *text, int count)
+{
+    yy->eof = true;
+}
+
+
+void empty_action(yycontext *yy, char *text, int count)
+{
+    yy->empty = true;
+}
+
+
+// match a directive without running the actions that construct the AST,
+// except those noting an empty directive or the end of input
+int validate_rule(yycontext *yy)
+{
+    if (!yy->validated_rule(yy))
+    {
+        return 0;
+    }
+    int n = 0;
+    for (int i = 0; i < yy->__thunkpos; ++i)
+    {
+        if (yy->__thunks[i].action == eof_action ||
+                yy->__thunks[i].action == empty_action)
+        {
+            yy->__thunks[n++] = yy->__thunks[i];
+        }
+    }
+    yy->__thunkpos = n;
+    finished(yy);
+    return 1;
+}
+
+
+// the position of an offset in the buffer, with the line and column left
+// to be resolved from the line index once parsing is finished
+struct cypher_input_position input_position(yycontext *yy, unsigned int pos)
+{
+    struct cypher_input_position position =
+        { .offset = pos + yy->position_offset.offset };
+    return position;
+}
+
+
+void block_start_action(yycontext *yy, char *text, int pos)
+{
+    assert(pos >= 0);
+    struct cypher_input_position position = input_position(yy, pos);
+    if (block_start(yy, pos, position) == NULL)
+    {
+        abort_parse(yy);
+    }
+    block_release(yy, yy->prev_block);
+    yy->prev_block = NULL;
+}
+
+
+struct block *block_start(yycontext *yy, size_t offset,
+        struct cypher_input_position position)
+{
+    struct block *block = blocks_pop(&(yy->spare_blocks));
+    if (block == NULL)
+    {
+        block = cp_malloc(sizeof(struct block));
+        if (block == NULL)
+        {
+            return NULL;
+        }
+        astnodes_init(&(block->sequence));
+        astnodes_init(&(block->children));
+    }
+    block->buffer_start = offset;
+    block->buffer_end = offset;
+    block->range.start = position;
+    block->range.end = position;
+    if (blocks_push(&(yy->blocks), block))
+    {
+        block_free(block);
+        return NULL;
+    }
+    return block;
+}
+
+
+// close a block (and move to yy->prev_block)
+void block_end_action(yycontext *yy, char *text, int pos)
+{
+    assert(pos >= 0);
+    struct cypher_input_position position = input_position(yy, pos);
+    struct block *block = block_end(yy, pos, position);
+    assert(block != NULL);
+    assert(yy->prev_block == NULL || astnodes_size(&(yy->prev_block->children)) == 0);
+    block_release(yy, yy->prev_block);
+    yy->prev_block = block;
+}
+
+
+// close a block, and start a new block with the same starting input position
+void block_replace_action(yycontext *yy, char *text, int pos)
+{
+    assert(pos >= 0);
+    struct cypher_input_position position = input_position(yy, pos);
+    struct block *block = block_end(yy, pos, position);
+    assert(block != NULL);
+    assert(yy->prev_block == NULL || astnodes_size(&(yy->prev_block->children)) == 0);
+    block_release(yy, yy->prev_block);
+    yy->prev_block = block;
+    if (block_start(yy, pos, block->range.start) == NULL)
     {
-        block_free(block);
+        abort_parse(yy);
     }
-    block_free(yy->prev_block);
-    yy->prev_block = NULL;
-    operators_clear(&(yy->operators));
-    precedences_clear(&(yy->precedences));
-    cp_et_clear_potentials(&(yy->error_tracking));
-    errno = errsv;
-    return -1;
 }
 
 
-int safe_yyparsefrom(yycontext *yy, yyrule rule)
+// close a block, but move all the children to the parent
+void block_merge_action(yycontext *yy, char *text, int pos)
 {
-    int err;
-    if ((err = sigsetjmp(yy->abort_env, 0)) != 0)
+    assert(pos >= 0);
+    struct cypher_input_position position = input_position(yy, pos);
+    struct block *block = block_end(yy, pos, position);
+    assert(block != NULL);
+    assert(yy->prev_block == NULL || astnodes_size(&(yy->prev_block->children)) == 0);
+    block_release(yy, yy->prev_block);
+    yy->prev_block = block;
+
+    unsigned int nchildren = astnodes_size(&(block->children));
+    if (nchildren > 0)
     {
-        errno = err;
-        return -1;
+        struct block *pblock = blocks_last(&(yy->blocks));
+        assert(pblock != NULL);
+        for (unsigned int i = 0; i < nchildren; ++i)
+        {
+            if (astnodes_push(&(pblock->children), astnodes_get(&(block->children), i)))
+            {
+                abort_parse(yy);
+            }
+        }
+        astnodes_clear(&(block->children));
     }
+}
 
-    int result = yyparsefrom(yy, rule);
-    memset(yy->abort_env, 0, sizeof(sigjmp_buf));
-    return result;
+
+struct block *block_end(yycontext *yy, size_t offset,
+        struct cypher_input_position position)
+{
+    assert(blocks_size(&(yy->blocks)) > 0);
+    struct block *block = blocks_pop(&(yy->blocks));
+    assert(block != NULL);
+    block->buffer_end = offset;
+    block->range.end = position;
+    assert(block->buffer_start <= block->buffer_end);
+    assert(block->range.start.offset <= block->range.end.offset);
+    return block;
 }
 
 
-void *abort_malloc(yycontext *yy, size_t size)
+// release a block, retaining it in the context for reuse
+void block_release(yycontext *yy, struct block *block)
 {
-    void *m = malloc(size);
-    if (m == NULL)
+    if (block == NULL)
+    {
+        return;
+    }
+    cypher_astnode_t *child;
+    while ((child = astnodes_pop(&(block->children))) != NULL)
+    {
+        cypher_ast_free(child);
+    }
+    astnodes_clear(&(block->sequence));
+    if (blocks_push(&(yy->spare_blocks), block))
+    {
+        block_free(block);
+    }
+}
+
+
+void block_free(struct block *block)
+{
+    if (block == NULL)
+    {
+        return;
+    }
+    cypher_astnode_t *child;
+    while ((child = astnodes_pop(&(block->children))) != NULL)
+    {
+        cypher_ast_free(child);
+    }
+    astnodes_cleanup(&(block->sequence));
+    astnodes_cleanup(&(block->children));
+    cp_free(block);
+}
+
+
+void _err(yycontext *yy, const char *label)
+{
+    assert(yy->__pos >= 0);
+    unsigned int pos = (unsigned int)yy->__pos;
+
+    struct cypher_input_position position = input_position(yy, pos);
+    char c = (yy->__pos < yy->__limit)? yy->__buf[pos] : '\0';
+    memo_error(yy, pos, position, c, label);
+    if (cp_et_note_potential_error(&(yy->error_tracking), position, c, label))
     {
         abort_parse(yy);
     }
-    return m;
 }
 
 
-void *abort_realloc(yycontext *yy, void *ptr, size_t size)
+void record_error(yycontext *yy)
 {
-    void *m = realloc(ptr, size);
-    if (m == NULL)
+    if (yy->optimistic)
+    {
+        yy->error_found = true;
+        errno = ECANCELED;
+        abort_parse(yy);
+    }
+    if (cp_et_reify_potentials(&(yy->error_tracking)))
     {
         abort_parse(yy);
     }
-    return m;
 }
 
 
-void finished(yycontext *yy)
+static inline bool is_sym_part(char c)
 {
-    yy->consumed = yy->__pos;
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+        (c >= '0' && c <= '9') || c == '_' || c == '$';
+}
+
+
+/*
+ * Deferred statement bodies
+ *
+ * When parsing with CYPHER_PARSE_SHALLOW, the body of a statement is skipped
+ * to the terminating `;` (or the end of input), respecting quotes and
+ * comments, and only the leading keywords are examined to determine the
+ * type of the first clause (or of the schema command). If the body is not
+ * recognized, it is left to be parsed as usual.
+ */
+
+static size_t skip_space(const char *s, size_t n, size_t i);
+static enum cp_keyword next_keyword(const char *s, size_t n, size_t *i);
 
-    for (unsigned int i = cp_et_nerrors(&(yy->error_tracking)); i-- > 0; )
+
+// the character at the current position, refilling the buffer as required,
+// or -1 at the end of input
+static inline int current_char(yycontext *yy)
+{
+    if (yy->__pos >= yy->__limit && !yyrefill(yy))
     {
-        cypher_parse_error_t *err = yy->error_tracking.errors + i;
-        if (err->context != NULL)
+        return -1;
+    }
+    return (unsigned char)yy->__buf[yy->__pos];
+}
+
+
+int skip_body(yycontext *yy)
+{
+    // the buffer can only be refilled at the current position, so the
+    // body is scanned by advancing it
+    int start = yy->__pos;
+    int c;
+    while ((c = current_char(yy)) >= 0 && c != ';')
+    {
+        ++(yy->__pos);
+        if (c == '\'' || c == '"' || c == '`')
         {
-            break;
+            // strings escape with a backslash, while names are unescaped
+            int quote = c;
+            while ((c = current_char(yy)) != quote)
+            {
+                if (c < 0)
+                {
+                    goto failure;
+                }
+                ++(yy->__pos);
+                if (c == '\\' && quote != '`')
+                {
+                    if (current_char(yy) < 0)
+                    {
+                        goto failure;
+                    }
+                    ++(yy->__pos);
+                }
+            }
+            ++(yy->__pos);
         }
-
-        size_t ctx_offset = err->position.offset - yy->position_offset.offset;
-        char *ctx = line_context(yy->__buf, yy->__limit, &ctx_offset, 80);
-        if (ctx == NULL)
+        else if (c == '/' && current_char(yy) == '/')
         {
-            abort_parse(yy);
+            while ((c = current_char(yy)) >= 0 && c != '\n')
+            {
+                ++(yy->__pos);
+            }
+        }
+        else if (c == '/' && current_char(yy) == '*')
+        {
+            ++(yy->__pos);
+            int prev = 0;
+            do
+            {
+                prev = c;
+                if ((c = current_char(yy)) < 0)
+                {
+                    goto failure;
+                }
+                ++(yy->__pos);
+            } while (!(prev == '*' && c == '/'));
         }
-        err->context = ctx;
-        err->context_offset = ctx_offset;
     }
+
+    cypher_astnode_type_t type;
+    if (!leading_clause_type(yy->__buf + start, yy->__pos - start, &type))
+    {
+        goto failure;
+    }
+    return 1;
+
+failure:
+    yy->__pos = start;
+    return 0;
 }
 
 
-void line_start(yycontext *yy)
+bool leading_clause_type(const char *s, size_t n, cypher_astnode_type_t *type)
 {
-    assert(yy->__pos >= 0);
-    unsigned int pos = (unsigned int)yy->__pos;
-    unsigned int line_start_pos = backtrack_lines(yy, pos);
-    if (line_start_pos == pos)
+    size_t i = 0;
+    enum cp_keyword keyword = next_keyword(s, n, &i);
+    if (keyword == CP_KW_USING)
     {
-        return;
+        if (next_keyword(s, n, &i) != CP_KW_PERIODIC ||
+                next_keyword(s, n, &i) != CP_KW_COMMIT)
+        {
+            return false;
+        }
+        i = skip_space(s, n, i);
+        if (i < n && s[i] >= '0' && s[i] <= '9')
+        {
+            for (; i < n && is_sym_part(s[i]); ++i)
+                ;
+        }
+        keyword = next_keyword(s, n, &i);
+    }
+
+    switch (keyword)
+    {
+    case CP_KW_LOAD:
+        *type = CYPHER_AST_LOAD_CSV;
+        return true;
+    case CP_KW_START:
+        *type = CYPHER_AST_START;
+        return true;
+    case CP_KW_OPTIONAL:
+        if (next_keyword(s, n, &i) != CP_KW_MATCH)
+        {
+            return false;
+        }
+        // fall through
+    case CP_KW_MATCH:
+        *type = CYPHER_AST_MATCH;
+        return true;
+    case CP_KW_MERGE:
+        *type = CYPHER_AST_MERGE;
+        return true;
+    case CP_KW_SET:
+        *type = CYPHER_AST_SET;
+        return true;
+    case CP_KW_DETACH:
+    case CP_KW_DELETE:
+        *type = CYPHER_AST_DELETE;
+        return true;
+    case CP_KW_REMOVE:
+        *type = CYPHER_AST_REMOVE;
+        return true;
+    case CP_KW_FOREACH:
+        *type = CYPHER_AST_FOREACH;
+        return true;
+    case CP_KW_WITH:
+        *type = CYPHER_AST_WITH;
+        return true;
+    case CP_KW_UNWIND:
+        *type = CYPHER_AST_UNWIND;
+        return true;
+    case CP_KW_CALL:
+        *type = CYPHER_AST_CALL;
+        return true;
+    case CP_KW_RETURN:
+        *type = CYPHER_AST_RETURN;
+        return true;
+    case CP_KW_CREATE:
+    case CP_KW_DROP:
+        break;
+    default:
+        return false;
     }
-    if (offsets_push(&(yy->line_start_offsets), pos))
+
+    bool create = (keyword == CP_KW_CREATE);
+    size_t j = i;
+    keyword = next_keyword(s, n, &j);
+    if (keyword != CP_KW_INDEX && keyword != CP_KW_CONSTRAINT)
     {
-        abort_parse(yy);
+        *type = CYPHER_AST_CREATE;
+        return create;
+    }
+    if (next_keyword(s, n, &j) != CP_KW_ON)
+    {
+        return false;
     }
+    if (keyword == CP_KW_INDEX)
+    {
+        *type = create?
+            CYPHER_AST_CREATE_NODE_PROPS_INDEX :
+            CYPHER_AST_DROP_NODE_PROPS_INDEX;
+        return true;
+    }
+    // a relationship constraint begins with `()`
+    j = skip_space(s, n, j);
+    bool rel = (j < n && s[j] == '(');
+    j = skip_space(s, n, j + 1);
+    rel = rel && j < n && s[j] == ')';
+    if (create)
+    {
+        *type = rel?
+            CYPHER_AST_CREATE_REL_PROP_CONSTRAINT :
+            CYPHER_AST_CREATE_NODE_PROP_CONSTRAINT;
+    }
+    else
+    {
+        *type = rel?
+            CYPHER_AST_DROP_REL_PROP_CONSTRAINT :
+            CYPHER_AST_DROP_NODE_PROP_CONSTRAINT;
+    }
+    return true;
 }
 
 
-unsigned int backtrack_lines(yycontext *yy, unsigned int pos)
+size_t skip_space(const char *s, size_t n, size_t i)
 {
-    unsigned int top;
-    while ((top = offsets_last(&(yy->line_start_offsets))) > pos)
+    while (i < n)
     {
-        offsets_pop(&(yy->line_start_offsets));
+        if (s[i] == ' ' || s[i] == '\t' || s[i] == '\n' || s[i] == '\r')
+        {
+            ++i;
+        }
+        else if (s[i] == '/' && i + 1 < n && s[i + 1] == '/')
+        {
+            for (i += 2; i < n && s[i] != '\n'; ++i)
+                ;
+        }
+        else if (s[i] == '/' && i + 1 < n && s[i + 1] == '*')
+        {
+            for (i += 3; i < n && !(s[i - 1] == '*' && s[i] == '/'); ++i)
+                ;
+            ++i;
+        }
+        else
+        {
+            break;
+        }
     }
-    return top;
+    return i;
 }
 
 
-struct cypher_input_position input_position(yycontext *yy, unsigned int pos)
+enum cp_keyword next_keyword(const char *s, size_t n, size_t *i)
+{
+    size_t start = skip_space(s, n, *i);
+    size_t end = start;
+    for (; end < n && is_sym_part(s[end]); ++end)
+        ;
+    *i = end;
+    return (end > start)? cp_keyword_lookup(s + start, end - start) :
+            CP_NO_KEYWORD;
+}
+
+
+/*
+ * Lazy clauses
+ *
+ * When parsing with CYPHER_PARSE_LAZY_CLAUSES, each clause of a query is
+ * matched as usual, but the actions that would construct it are discarded
+ * and replaced by a block spanning the clause, from which a
+ * `CYPHER_AST_LAZY_CLAUSE` node is created. The clause is parsed again from
+ * the text of that node when it is first accessed (see cp_parse_clause).
+ */
+
+int skip_clause(yycontext *yy)
 {
-    assert(offsets_size(&(yy->line_start_offsets)) > 0);
+    int thunkpos = yy->__thunkpos;
+    if (!yy_clause(yy))
+    {
+        return 0;
+    }
 
-    unsigned int depth = offsets_size(&(yy->line_start_offsets));
-    unsigned int line_start_pos;
-    do
+    // the clause ends with its outermost block, which may be followed by
+    // whitespace and comments that are left to be matched again
+    unsigned int depth = 0;
+    for (int i = thunkpos; i < yy->__thunkpos; ++i)
     {
-        line_start_pos = offsets_get(&(yy->line_start_offsets), depth-1);
-    } while (line_start_pos > pos && depth > 0 && depth--);
+        yythunk *thunk = yy->__thunks + i;
+        if (thunk->action == block_start_action)
+        {
+            ++depth;
+        }
+        else if (thunk->action == block_end_action ||
+                thunk->action == block_merge_action)
+        {
+            assert(depth > 0);
+            if (--depth == 0)
+            {
+                yy->__pos = thunk->begin;
+                break;
+            }
+        }
+    }
+    yy->__thunkpos = thunkpos;
+    return 1;
+}
 
-    assert(depth > 0);
-    assert(line_start_pos <= pos);
 
-    struct cypher_input_position position =
-        { .line = (depth-1) + yy->position_offset.line,
-          .column = pos - line_start_pos +
-              ((depth == 1)? yy->position_offset.column : 1),
-          .offset = pos + yy->position_offset.offset };
-    return position;
+/*
+ * Memoization
+ *
+ * When enabled in the parser config, memoized rules (see MEMO_ENTER in the
+ * grammar) record the outcome of parsing at each input position. A later
+ * attempt to parse the same rule at the same position replays that outcome
+ * rather than re-parsing the input. The outcome of a rule consists of:
+ *
+ * - the end position (or failure),
+ * - the thunks queued for deferred evaluation,
+ * - the operator last set for precedence checking, and
+ * - the potential errors noted, summarized as those at the furthest
+ *   position (as only these survive in the error tracking).
+ *
+ * Whilst a memoized rule is being parsed, its error summary accumulates at
+ * the top of the `memo_frame_labels` stack, and is folded into the
+ * enclosing rule's summary on completion.
+ */
+
+static void memo_record(yycontext *yy, int end);
+static void memo_replay(yycontext *yy, const struct memo_entry *entry);
+static struct memo_frame *memo_frame(yycontext *yy);
+static void memo_fold_errors(yycontext *yy,
+        struct cypher_input_position position, char c, unsigned int base);
+
+
+void memo_init(yycontext *yy)
+{
+    memo_entries_init(&(yy->memo_entries));
+    offsets_init(&(yy->memo_index));
+    memo_frames_init(&(yy->memo_frames));
+    cp_vector_init(&(yy->memo_thunks), sizeof(yythunk));
+    labels_init(&(yy->memo_labels));
+    labels_init(&(yy->memo_frame_labels));
+    yy->memo_replayed = false;
 }
 
 
-void block_start_action(yycontext *yy, char *text, int pos)
+void memo_clear(yycontext *yy)
 {
-    assert(pos >= 0);
-    struct cypher_input_position position = input_position(yy, pos);
-    if (block_start(yy, pos, position) == NULL)
+    memo_entries_clear(&(yy->memo_entries));
+    offsets_clear(&(yy->memo_index));
+    memo_frames_clear(&(yy->memo_frames));
+    cp_vector_clear(&(yy->memo_thunks));
+    labels_clear(&(yy->memo_labels));
+    labels_clear(&(yy->memo_frame_labels));
+    yy->memo_replayed = false;
+}
+
+
+void memo_cleanup(yycontext *yy)
+{
+    memo_entries_cleanup(&(yy->memo_entries));
+    offsets_cleanup(&(yy->memo_index));
+    memo_frames_cleanup(&(yy->memo_frames));
+    cp_vector_cleanup(&(yy->memo_thunks));
+    labels_cleanup(&(yy->memo_labels));
+    labels_cleanup(&(yy->memo_frame_labels));
+}
+
+
+static const struct memo_entry *memo_lookup(yycontext *yy,
+        enum memo_rule rule, unsigned int pos)
+{
+    struct memo_entry *entries = memo_entries_elements(&(yy->memo_entries));
+    for (unsigned int i = offsets_get(&(yy->memo_index), pos); i > 0;
+            i = entries[i-1].next)
+    {
+        if (entries[i-1].rule == rule)
+        {
+            return entries + (i-1);
+        }
+    }
+    return NULL;
+}
+
+
+int _memo_enter(yycontext *yy, enum memo_rule rule)
+{
+    if (!yy->config->memoize)
+    {
+        return 1;
+    }
+
+    assert(yy->__pos >= 0);
+    const struct memo_entry *entry = memo_lookup(yy, rule, yy->__pos);
+    if (entry != NULL)
+    {
+        memo_replay(yy, entry);
+        yy->memo_replayed = (entry->end >= 0);
+        return yy->memo_replayed;
+    }
+
+    struct memo_frame frame =
+        { .rule = rule,
+          .pos = yy->__pos,
+          .thunkpos = yy->__thunkpos,
+          .labels = labels_size(&(yy->memo_frame_labels)) };
+    if (memo_frames_push(&(yy->memo_frames), frame))
     {
         abort_parse(yy);
     }
-    block_free(yy->prev_block);
-    yy->prev_block = NULL;
+    return 1;
 }
 
 
-struct block *block_start(yycontext *yy, size_t offset,
-        struct cypher_input_position position)
+int _memo_replayed(yycontext *yy)
 {
-    struct block *block = malloc(sizeof(struct block));
-    if (block == NULL)
+    if (!yy->memo_replayed)
     {
-        return NULL;
+        return 0;
     }
-    block->buffer_start = offset;
-    block->buffer_end = offset;
-    block->range.start = position;
-    block->range.end = position;
-    astnodes_init(&(block->sequence));
-    astnodes_init(&(block->children));
-    if (blocks_push(&(yy->blocks), block))
+    yy->memo_replayed = false;
+    return 1;
+}
+
+
+void _memo_save(yycontext *yy)
+{
+    if (yy->config->memoize)
     {
-        free(block);
-        return NULL;
+        memo_record(yy, yy->__pos);
     }
-    return block;
 }
 
 
-// close a block (and move to yy->prev_block)
-void block_end_action(yycontext *yy, char *text, int pos)
+void _memo_fail(yycontext *yy)
 {
-    assert(pos >= 0);
-    struct cypher_input_position position = input_position(yy, pos);
-    struct block *block = block_end(yy, pos, position);
-    assert(block != NULL);
-    assert(yy->prev_block == NULL || astnodes_size(&(yy->prev_block->children)) == 0);
-    block_free(yy->prev_block);
-    yy->prev_block = block;
+    if (yy->config->memoize)
+    {
+        memo_record(yy, -1);
+    }
 }
 
 
-// close a block, and start a new block with the same starting input position
-void block_replace_action(yycontext *yy, char *text, int pos)
-{
-    assert(pos >= 0);
-    struct cypher_input_position position = input_position(yy, pos);
-    struct block *block = block_end(yy, pos, position);
-    assert(block != NULL);
-    assert(yy->prev_block == NULL || astnodes_size(&(yy->prev_block->children)) == 0);
-    block_free(yy->prev_block);
-    yy->prev_block = block;
-    if (block_start(yy, pos, block->range.start) == NULL)
+void memo_record(yycontext *yy, int end)
+{
+    assert(memo_frames_size(&(yy->memo_frames)) > 0);
+    struct memo_frame frame = memo_frames_pop(&(yy->memo_frames));
+    assert(end < 0 || end >= frame.pos);
+    assert(end < 0 || yy->__thunkpos >= frame.thunkpos);
+
+    struct memo_entry entry =
+        { .next = offsets_get(&(yy->memo_index), frame.pos),
+          .rule = frame.rule,
+          .end = end,
+          .op = yy->op,
+          .thunks = cp_vector_size(&(yy->memo_thunks)),
+          .nthunks = (end >= 0)? yy->__thunkpos - frame.thunkpos : 0,
+          .error_position = frame.error_position,
+          .error_char = frame.error_char,
+          .labels = labels_size(&(yy->memo_labels)),
+          .nlabels = labels_size(&(yy->memo_frame_labels)) - frame.labels };
+
+    if (cp_vector_pushn(&(yy->memo_thunks), yy->__thunks + frame.thunkpos,
+                entry.nthunks) ||
+        labels_pushn(&(yy->memo_labels),
+                labels_elements(&(yy->memo_frame_labels)) + frame.labels,
+                entry.nlabels) ||
+        memo_entries_push(&(yy->memo_entries), entry))
     {
         abort_parse(yy);
     }
+
+    while (offsets_size(&(yy->memo_index)) <= (unsigned int)frame.pos)
+    {
+        if (offsets_push(&(yy->memo_index), 0))
+        {
+            abort_parse(yy);
+        }
+    }
+    offsets_elements(&(yy->memo_index))[frame.pos] =
+            memo_entries_size(&(yy->memo_entries));
+
+    memo_fold_errors(yy, frame.error_position, frame.error_char,
+            frame.labels);
 }
 
 
-// close a block, but move all the children to the parent
-void block_merge_action(yycontext *yy, char *text, int pos)
+void memo_replay(yycontext *yy, const struct memo_entry *entry)
 {
-    assert(pos >= 0);
-    struct cypher_input_position position = input_position(yy, pos);
-    struct block *block = block_end(yy, pos, position);
-    assert(block != NULL);
-    assert(yy->prev_block == NULL || astnodes_size(&(yy->prev_block->children)) == 0);
-    block_free(yy->prev_block);
-    yy->prev_block = block;
+    const char **labels = labels_elements(&(yy->memo_labels)) + entry->labels;
 
-    unsigned int nchildren = astnodes_size(&(block->children));
-    if (nchildren > 0)
+    for (unsigned int i = 0; i < entry->nlabels; ++i)
     {
-        struct block *pblock = blocks_last(&(yy->blocks));
-        assert(pblock != NULL);
-        for (unsigned int i = 0; i < nchildren; ++i)
+        if (cp_et_note_potential_error(&(yy->error_tracking),
+                    entry->error_position, entry->error_char, labels[i]))
         {
-            if (astnodes_push(&(pblock->children), astnodes_get(&(block->children), i)))
-            {
-                abort_parse(yy);
-            }
+            abort_parse(yy);
         }
-        astnodes_clear(&(block->children));
     }
-}
 
+    if (memo_frames_size(&(yy->memo_frames)) > 0)
+    {
+        unsigned int base = labels_size(&(yy->memo_frame_labels));
+        if (labels_pushn(&(yy->memo_frame_labels), labels, entry->nlabels))
+        {
+            abort_parse(yy);
+        }
+        memo_fold_errors(yy, entry->error_position, entry->error_char, base);
+    }
 
-struct block *block_end(yycontext *yy, size_t offset,
-        struct cypher_input_position position)
-{
-    assert(blocks_size(&(yy->blocks)) > 0);
-    struct block *block = blocks_pop(&(yy->blocks));
-    assert(block != NULL);
-    block->buffer_end = offset;
-    block->range.end = position;
-    assert(block->buffer_start <= block->buffer_end);
-    assert(block->range.start.offset <= block->range.end.offset);
-    return block;
+    if (entry->nthunks > 0)
+    {
+        while (yy->__thunkslen - yy->__thunkpos < (int)entry->nthunks)
+        {
+            yy->__thunkslen *= 2;
+            yy->__thunks = abort_realloc(yy, yy->__thunks,
+                    sizeof(yythunk) * yy->__thunkslen);
+        }
+        const yythunk *thunks = (yythunk *)cp_vector_elements(
+                &(yy->memo_thunks)) + entry->thunks;
+        memcpy(yy->__thunks + yy->__thunkpos, thunks,
+                entry->nthunks * sizeof(yythunk));
+        yy->__thunkpos += entry->nthunks;
+    }
+
+    yy->op = entry->op;
+    if (entry->end >= 0)
+    {
+        yy->__pos = entry->end;
+    }
 }
 
 
-void block_free(struct block *block)
+void memo_error(yycontext *yy, unsigned int pos,
+        struct cypher_input_position position, char c, const char *label)
 {
-    if (block == NULL)
+    if (memo_frames_size(&(yy->memo_frames)) == 0)
     {
         return;
     }
-    cypher_astnode_t *child;
-    while ((child = astnodes_pop(&(block->children))) != NULL)
+    unsigned int base = labels_size(&(yy->memo_frame_labels));
+    if (labels_push(&(yy->memo_frame_labels), label))
     {
-        cypher_ast_free(child);
+        abort_parse(yy);
     }
-    astnodes_cleanup(&(block->sequence));
-    astnodes_cleanup(&(block->children));
-    free(block);
+    memo_fold_errors(yy, position, c, base);
 }
 
 
-void _err(yycontext *yy, const char *label)
+struct memo_frame *memo_frame(yycontext *yy)
 {
-    assert(yy->__pos >= 0);
-    unsigned int pos = (unsigned int)yy->__pos;
-    backtrack_lines(yy, pos);
+    unsigned int depth = memo_frames_size(&(yy->memo_frames));
+    return (depth > 0)?
+        memo_frames_elements(&(yy->memo_frames)) + (depth - 1) : NULL;
+}
 
-    struct cypher_input_position position = input_position(yy, pos);
-    char c = (yy->__pos < yy->__limit)? yy->__buf[pos] : '\0';
-    if (cp_et_note_potential_error(&(yy->error_tracking), position, c, label))
+
+// fold an error summary (a position, and the labels on the top of the
+// `memo_frame_labels` stack from `base`) into the innermost frame
+void memo_fold_errors(yycontext *yy, struct cypher_input_position position,
+        char c, unsigned int base)
+{
+    const char **labels = labels_elements(&(yy->memo_frame_labels));
+    unsigned int n = labels_size(&(yy->memo_frame_labels));
+    struct memo_frame *frame = memo_frame(yy);
+    if (frame == NULL)
     {
-        abort_parse(yy);
+        labels_npop(&(yy->memo_frame_labels), n - base);
+        return;
     }
-}
+    assert(frame->labels <= base && base <= n);
 
+    if (n == base)
+    {
+        return;
+    }
 
-void record_error(yycontext *yy)
-{
-    if (cp_et_reify_potentials(&(yy->error_tracking)))
+    unsigned int end = base;
+    if (base == frame->labels ||
+            position.offset > frame->error_position.offset)
     {
-        abort_parse(yy);
+        memmove(labels + frame->labels, labels + base,
+                (n - base) * sizeof(const char *));
+        end = frame->labels + (n - base);
+        frame->error_position = position;
+        frame->error_char = c;
+    }
+    else if (position.offset == frame->error_position.offset)
+    {
+        for (unsigned int i = base; i < n; ++i)
+        {
+            unsigned int j = frame->labels;
+            for (; j < end && strcmp(labels[j], labels[i]) != 0; ++j)
+                ;
+            if (j == end)
+            {
+                labels[end++] = labels[i];
+            }
+        }
     }
+    labels_npop(&(yy->memo_frame_labels), n - end);
 }
 
 
@@ -1115,7 +3801,7 @@ cypher_astnode_t *_statement(yycontext *yy, cypher_astnode_t *body)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1137,7 +3823,7 @@ cypher_astnode_t *_cypher_option(yycontext *yy, cypher_astnode_t *version)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1157,7 +3843,7 @@ cypher_astnode_t *_cypher_option_param(yycontext *yy, cypher_astnode_t *name,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1181,6 +3867,40 @@ cypher_astnode_t *_profile_option(yycontext *yy)
 }
 
 
+cypher_astnode_t *_deferred_body(yycontext *yy)
+{
+    assert(yy->prev_block != NULL &&
+            "An AST node can only be created immediately after a `>` in the grammar");
+    char *s = yy->__buf + yy->prev_block->buffer_start;
+    size_t n = yy->prev_block->buffer_end - yy->prev_block->buffer_start;
+    cypher_astnode_type_t type;
+    bool recognized = leading_clause_type(s, n, &type);
+    assert(recognized);
+    (void)recognized;
+    struct cypher_input_range range = yy->prev_block->range;
+    return add_terminal(yy, cypher_ast_deferred_body(s, n, type, range));
+}
+
+
+cypher_astnode_t *_lazy_clause(yycontext *yy)
+{
+    assert(yy->prev_block != NULL &&
+            "An AST node can only be created immediately after a `>` in the grammar");
+    char *s = yy->__buf + yy->prev_block->buffer_start;
+    size_t n = yy->prev_block->buffer_end - yy->prev_block->buffer_start;
+    cypher_astnode_type_t type = CYPHER_AST_UNION;
+    size_t i = 0;
+    if (next_keyword(s, n, &i) != CP_KW_UNION)
+    {
+        bool recognized = leading_clause_type(s, n, &type);
+        assert(recognized);
+        (void)recognized;
+    }
+    struct cypher_input_range range = yy->prev_block->range;
+    return add_terminal(yy, cypher_ast_lazy_clause(s, n, type, range));
+}
+
+
 cypher_astnode_t *_create_index(yycontext *yy, cypher_astnode_t *label)
 {
     assert(yy->prev_block != NULL &&
@@ -1197,7 +3917,7 @@ cypher_astnode_t *_create_index(yycontext *yy, cypher_astnode_t *label)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1219,7 +3939,7 @@ cypher_astnode_t *_drop_index(yycontext *yy, cypher_astnode_t *label)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1241,7 +3961,7 @@ cypher_astnode_t *_create_node_prop_constraint(yycontext *yy,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1263,7 +3983,7 @@ cypher_astnode_t *_drop_node_prop_constraint(yycontext *yy,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1285,7 +4005,7 @@ cypher_astnode_t *_create_rel_prop_constraint(yycontext *yy,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1307,7 +4027,7 @@ cypher_astnode_t *_drop_rel_prop_constraint(yycontext *yy,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1339,7 +4059,7 @@ cypher_astnode_t *_query(yycontext *yy)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1358,7 +4078,7 @@ cypher_astnode_t *_using_periodic_commit(yycontext *yy, cypher_astnode_t *limit)
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1380,7 +4100,7 @@ cypher_astnode_t *_load_csv(yycontext *yy, bool with_headers,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1402,7 +4122,7 @@ cypher_astnode_t *_start_clause(yycontext *yy, cypher_astnode_t *predicate)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1423,7 +4143,7 @@ cypher_astnode_t *_node_index_lookup(yycontext *yy,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1444,7 +4164,7 @@ cypher_astnode_t *_node_index_query(yycontext *yy,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1466,7 +4186,7 @@ cypher_astnode_t *_node_id_lookup(yycontext *yy, cypher_astnode_t *identifier)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1485,7 +4205,7 @@ cypher_astnode_t *_all_nodes_scan(yycontext *yy, cypher_astnode_t *identifier)
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1506,7 +4226,7 @@ cypher_astnode_t *_rel_index_lookup(yycontext *yy,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1527,7 +4247,7 @@ cypher_astnode_t *_rel_index_query(yycontext *yy,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1549,7 +4269,7 @@ cypher_astnode_t *_rel_id_lookup(yycontext *yy, cypher_astnode_t *identifier)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1568,7 +4288,7 @@ cypher_astnode_t *_all_rels_scan(yycontext *yy, cypher_astnode_t *identifier)
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1591,7 +4311,7 @@ cypher_astnode_t *_match_clause(yycontext *yy, bool optional,
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1611,7 +4331,7 @@ cypher_astnode_t *_using_index(yycontext *yy, cypher_astnode_t *identifier,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1633,7 +4353,7 @@ cypher_astnode_t *_using_join(yycontext *yy)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1653,7 +4373,7 @@ cypher_astnode_t *_using_scan(yycontext *yy, cypher_astnode_t *identifier,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1675,7 +4395,7 @@ cypher_astnode_t *_merge_clause(yycontext *yy, cypher_astnode_t *pattern_part)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1697,7 +4417,7 @@ cypher_astnode_t *_on_match(yycontext *yy)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1719,7 +4439,7 @@ cypher_astnode_t *_on_create(yycontext *yy)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1739,7 +4459,7 @@ cypher_astnode_t *_create_clause(yycontext *yy, bool unique,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1761,7 +4481,7 @@ cypher_astnode_t *_set_clause(yycontext *yy)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1781,7 +4501,7 @@ cypher_astnode_t *_set_property(yycontext *yy, cypher_astnode_t *prop_name,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1801,7 +4521,7 @@ cypher_astnode_t *_set_all_properties(yycontext *yy,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1821,7 +4541,7 @@ cypher_astnode_t *_merge_properties(yycontext *yy,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1843,7 +4563,7 @@ cypher_astnode_t *_set_labels(yycontext *yy, cypher_astnode_t *identifier)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1865,7 +4585,7 @@ cypher_astnode_t *_delete(yycontext *yy, bool detach)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1887,7 +4607,7 @@ cypher_astnode_t *_remove_clause(yycontext *yy)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1906,7 +4626,7 @@ cypher_astnode_t *_remove_property(yycontext *yy, cypher_astnode_t *prop_name)
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1928,7 +4648,7 @@ cypher_astnode_t *_remove_labels(yycontext *yy, cypher_astnode_t *identifier)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1951,7 +4671,7 @@ cypher_astnode_t *_foreach_clause(yycontext *yy, cypher_astnode_t *identifier,
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1977,7 +4697,7 @@ cypher_astnode_t *_with_clause(yycontext *yy, bool distinct,
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -1997,7 +4717,7 @@ cypher_astnode_t *_unwind_clause(yycontext *yy, cypher_astnode_t *expression,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2030,7 +4750,7 @@ cypher_astnode_t *_call_clause(yycontext *yy, cypher_astnode_t *proc_name,
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2054,7 +4774,7 @@ cypher_astnode_t *_return_clause(yycontext *yy, bool distinct,
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2074,7 +4794,7 @@ cypher_astnode_t *_projection(yycontext *yy, cypher_astnode_t *expression,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2096,7 +4816,7 @@ cypher_astnode_t *_order_by(yycontext *yy)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2116,7 +4836,7 @@ cypher_astnode_t *_sort_item(yycontext *yy, cypher_astnode_t *expression,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2135,7 +4855,7 @@ cypher_astnode_t *_union_clause(yycontext *yy, bool all)
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2155,7 +4875,7 @@ cypher_astnode_t *_unary_operator(yycontext *yy, const cypher_operator_t *op,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2175,7 +4895,7 @@ cypher_astnode_t *_binary_operator(yycontext *yy, const cypher_operator_t *op,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2206,7 +4926,7 @@ cypher_astnode_t *_comparison_operator(yycontext *yy)
     operators_npop(&(yy->operators), chain_length);
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2229,7 +4949,7 @@ cypher_astnode_t *_apply_operator(yycontext *yy, cypher_astnode_t *left,
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2249,7 +4969,7 @@ cypher_astnode_t *_apply_all_operator(yycontext *yy, cypher_astnode_t *left,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2269,7 +4989,7 @@ cypher_astnode_t *_subscript_operator(yycontext *yy,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2289,7 +5009,7 @@ cypher_astnode_t *_property_operator(yycontext *yy, cypher_astnode_t *map,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2309,7 +5029,7 @@ cypher_astnode_t *_slice_operator(yycontext *yy, cypher_astnode_t *expression,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2331,7 +5051,7 @@ cypher_astnode_t *_map_projection(yycontext *yy, cypher_astnode_t *expression)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2352,7 +5072,7 @@ cypher_astnode_t *_map_projection_literal(yycontext *yy,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2372,7 +5092,7 @@ cypher_astnode_t *_map_projection_property(yycontext *yy,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2392,7 +5112,7 @@ cypher_astnode_t *_map_projection_identifier(yycontext *yy,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2411,7 +5131,7 @@ cypher_astnode_t *_map_projection_all_properties(yycontext *yy)
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2433,7 +5153,7 @@ cypher_astnode_t *_labels_operator(yycontext *yy, cypher_astnode_t *left)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2455,7 +5175,7 @@ cypher_astnode_t *_list_comprehension(yycontext *yy,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2477,7 +5197,7 @@ cypher_astnode_t *_pattern_comprehension(yycontext *yy,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2500,7 +5220,7 @@ cypher_astnode_t *_case_expression(yycontext *yy, cypher_astnode_t *expression,
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2520,7 +5240,7 @@ cypher_astnode_t *_filter(yycontext *yy, cypher_astnode_t *identifier,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2540,7 +5260,7 @@ cypher_astnode_t *_extract(yycontext *yy, cypher_astnode_t *identifier,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2561,7 +5281,7 @@ cypher_astnode_t *_reduce(yycontext *yy, cypher_astnode_t *accumulator,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2581,7 +5301,7 @@ cypher_astnode_t *_all_predicate(yycontext *yy, cypher_astnode_t *identifier,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2601,7 +5321,7 @@ cypher_astnode_t *_any_predicate(yycontext *yy, cypher_astnode_t *identifier,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2621,7 +5341,7 @@ cypher_astnode_t *_single_predicate(yycontext *yy, cypher_astnode_t *identifier,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2641,7 +5361,7 @@ cypher_astnode_t *_none_predicate(yycontext *yy, cypher_astnode_t *identifier,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2663,12 +5383,189 @@ cypher_astnode_t *_collection_literal(yycontext *yy)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
 
 
+void _packed_reset(yycontext *yy)
+{
+    packed_values_clear(&(yy->packed_values));
+    packed_elements_clear(&(yy->packed_elements));
+    cp_sb_reset(&(yy->packed_text));
+}
+
+
+int _packed_mark(yycontext *yy)
+{
+    yy->packed_mark = yy->__pos;
+    yyDo(yy, packed_mark_action, yy->__pos, 0);
+    return 1;
+}
+
+
+void packed_mark_action(yycontext *yy, char *text, int pos)
+{
+    yy->packed_start = pos;
+}
+
+
+static inline bool packed_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+
+// the start of the literal of a packed element, following any '-'
+static int packed_literal_start(yycontext *yy, int pos)
+{
+    if (yy->__buf[pos] != '-')
+    {
+        return pos;
+    }
+    for (++pos; packed_space(yy->__buf[pos]); ++pos)
+        ;
+    return pos;
+}
+
+
+// decode a number from the buffer, via a null terminated copy at the end of
+// the packed text
+static int packed_decode(yycontext *yy, cypher_astnode_type_t type,
+        int start, int end, union cypher_ast_packed_value *value)
+{
+    struct cp_string_buffer *sb = &(yy->packed_text);
+    size_t offset = cp_sb_length(sb);
+    if (cp_sb_append(sb, yy->__buf + start, end - start) ||
+            cp_sb_append(sb, "", 1))
+    {
+        abort_parse(yy);
+    }
+    char *s = sb->buffer + offset;
+    if (type == CYPHER_AST_INTEGER)
+    {
+        return cypher_ast_decode_integer(s, end - start, &(value->integer));
+    }
+    return cypher_ast_decode_float(s, end - start, &(value->flt));
+}
+
+
+// only numbers that can be decoded are packed, as the element nodes would
+// otherwise hold an error that cannot be represented packed
+int _packed_number(yycontext *yy, cypher_astnode_type_t type)
+{
+    union cypher_ast_packed_value value;
+    size_t length = cp_sb_length(&(yy->packed_text));
+    int err = packed_decode(yy, type, packed_literal_start(yy, yy->packed_mark),
+            yy->__pos, &value);
+    yy->packed_text.length = length;
+    if (err)
+    {
+        return 0;
+    }
+    yyDo(yy, (type == CYPHER_AST_INTEGER)?
+            packed_integer_action : packed_float_action, yy->__pos, 0);
+    return 1;
+}
+
+
+static void packed_add(yycontext *yy, cypher_astnode_type_t type, int pos)
+{
+    struct cypher_ast_packed_element element =
+        { .start = yy->packed_start,
+          .literal_start = packed_literal_start(yy, yy->packed_start),
+          .literal_end = pos,
+          .end = pos,
+          .text = cp_sb_length(&(yy->packed_text)) };
+
+    if (type == CYPHER_AST_STRING)
+    {
+        if (cp_sb_append(&(yy->packed_text), cp_sb_data(&(yy->string_buffer)),
+                    cp_sb_length(&(yy->string_buffer))) ||
+                cp_sb_append(&(yy->packed_text), "", 1))
+        {
+            abort_parse(yy);
+        }
+    }
+    else
+    {
+        // the literal was checked to decode when matched
+        union cypher_ast_packed_value value;
+        if (packed_decode(yy, type, element.literal_start, pos, &value))
+        {
+            abort_parse(yy);
+        }
+        if (element.start != element.literal_start)
+        {
+            if (type == CYPHER_AST_INTEGER)
+            {
+                value.integer = -value.integer;
+            }
+            else
+            {
+                value.flt = -value.flt;
+            }
+            // a negation includes the whitespace following the literal
+            for (; packed_space(yy->__buf[element.end]); ++(element.end))
+                ;
+        }
+        if (packed_values_push(&(yy->packed_values), value))
+        {
+            abort_parse(yy);
+        }
+    }
+
+    yy->packed_type = type;
+    if (packed_elements_push(&(yy->packed_elements), element))
+    {
+        abort_parse(yy);
+    }
+}
+
+
+void packed_integer_action(yycontext *yy, char *text, int pos)
+{
+    packed_add(yy, CYPHER_AST_INTEGER, pos);
+}
+
+
+void packed_float_action(yycontext *yy, char *text, int pos)
+{
+    packed_add(yy, CYPHER_AST_FLOAT, pos);
+}
+
+
+void packed_string_action(yycontext *yy, char *text, int pos)
+{
+    packed_add(yy, CYPHER_AST_STRING, pos);
+}
+
+
+cypher_astnode_t *_packed_collection(yycontext *yy)
+{
+    assert(yy->prev_block != NULL &&
+            "An AST node can only be created immediately after a `>` in the grammar");
+    struct block *block = yy->prev_block;
+    unsigned int n = packed_elements_size(&(yy->packed_elements));
+    struct cypher_ast_packed_element *elements =
+            packed_elements_elements(&(yy->packed_elements));
+    // element offsets are relative to the start of the collection
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        elements[i].start -= block->buffer_start;
+        elements[i].literal_start -= block->buffer_start;
+        elements[i].literal_end -= block->buffer_start;
+        elements[i].end -= block->buffer_start;
+    }
+    cypher_astnode_t *node = cypher_ast_packed_collection(yy->packed_type,
+            packed_values_elements(&(yy->packed_values)), elements, n,
+            cp_sb_data(&(yy->packed_text)), cp_sb_length(&(yy->packed_text)),
+            block->range);
+    return add_terminal(yy, node);
+}
+
+
 cypher_astnode_t *_map_literal(yycontext *yy)
 {
     assert(yy->prev_block != NULL &&
@@ -2686,7 +5583,7 @@ cypher_astnode_t *_map_literal(yycontext *yy)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2856,7 +5753,7 @@ cypher_astnode_t *_pattern(yycontext *yy)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2876,7 +5773,7 @@ cypher_astnode_t *_named_path(yycontext *yy,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2896,7 +5793,7 @@ cypher_astnode_t *_shortest_path(yycontext *yy, bool single,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2918,7 +5815,7 @@ cypher_astnode_t *_pattern_path(yycontext *yy)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2941,7 +5838,7 @@ cypher_astnode_t *_node_pattern(yycontext *yy, cypher_astnode_t *identifier,
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2965,7 +5862,7 @@ cypher_astnode_t *_rel_pattern(yycontext *yy,
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -2985,7 +5882,7 @@ cypher_astnode_t *_range(yycontext *yy, cypher_astnode_t *start,
         abort_parse(yy);
     }
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -3009,7 +5906,7 @@ cypher_astnode_t *_command(yycontext *yy, cypher_astnode_t *name)
     }
     astnodes_clear(&(yy->prev_block->sequence));
     astnodes_clear(&(yy->prev_block->children));
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
@@ -3045,6 +5942,61 @@ cypher_astnode_t *_strbuf_string(yycontext *yy)
 }
 
 
+/*
+ * Retained input
+ *
+ * When enabled, the input of each segment is copied (once, by the first
+ * action that needs it) to the line index of the segment, which is retained
+ * for as long as the nodes constructed from it. Nodes whose text is
+ * unchanged from the input then reference it there, rather than holding a
+ * copy. Each referenced text is null terminated by overwriting the character
+ * following it in the copy: the closing quote of a string, the `*` closing a
+ * block comment, or the line end following a line comment. Referenced texts
+ * only ever begin after a quote or the opening of a comment, so none of
+ * these characters is part of another. Errors may begin with any character
+ * (including the line end following a comment, or the character following
+ * another error), so are always copied.
+ */
+
+// the text at a buffer offset, null terminated within the retained input
+static const char *retained_text(yycontext *yy, int pos, size_t n)
+{
+    assert(yy->retain_input && pos >= yy->segment_start);
+    char *input = yy->line_index->input;
+    if (input == NULL)
+    {
+        // actions are run once the segment is matched in full
+        input = cp_line_index_retain_input(yy->line_index,
+                yy->__buf + yy->segment_start, yy->__pos - yy->segment_start);
+        if (input == NULL)
+        {
+            abort_parse(yy);
+        }
+    }
+    char *s = input + (pos - yy->segment_start);
+    s[n] = '\0';
+    return s;
+}
+
+
+cypher_astnode_t *_string_literal(yycontext *yy)
+{
+    assert(yy->prev_block != NULL &&
+            "An AST node can only be created immediately after a `>` in the grammar");
+    struct block *block = yy->prev_block;
+    size_t n = cp_sb_length(&(yy->string_buffer));
+    // every escape is longer than the character it represents, so the
+    // value is the text between the quotes when only they were dropped
+    if (!yy->retain_input ||
+            (size_t)(block->buffer_end - block->buffer_start) != n + 2)
+    {
+        return strbuf_string();
+    }
+    const char *s = retained_text(yy, block->buffer_start + 1, n);
+    return add_terminal(yy, cypher_ast_string_ref(s, n, block->range));
+}
+
+
 cypher_astnode_t *_line_comment(yycontext *yy)
 {
     assert(yy->prev_block != NULL &&
@@ -3052,6 +6004,12 @@ cypher_astnode_t *_line_comment(yycontext *yy)
     char *s = yy->__buf + yy->prev_block->buffer_start;
     size_t n = yy->prev_block->buffer_end - yy->prev_block->buffer_start;
     struct cypher_input_range range = yy->prev_block->range;
+    if (yy->retain_input)
+    {
+        return add_terminal(yy, cypher_ast_line_comment_ref(
+                    retained_text(yy, yy->prev_block->buffer_start, n), n,
+                    range));
+    }
     return add_terminal(yy, cypher_ast_line_comment(s, n, range));
 }
 
@@ -3063,6 +6021,12 @@ cypher_astnode_t *_block_comment(yycontext *yy)
     char *s = yy->__buf + yy->prev_block->buffer_start;
     size_t n = yy->prev_block->buffer_end - yy->prev_block->buffer_start;
     struct cypher_input_range range = yy->prev_block->range;
+    if (yy->retain_input)
+    {
+        return add_terminal(yy, cypher_ast_block_comment_ref(
+                    retained_text(yy, yy->prev_block->buffer_start, n), n,
+                    range));
+    }
     return add_terminal(yy, cypher_ast_block_comment(s, n, range));
 }
 
@@ -3085,7 +6049,7 @@ cypher_astnode_t *add_terminal(yycontext *yy, cypher_astnode_t *node)
     assert(astnodes_size(&(yy->prev_block->children)) == 0 &&
             "terminal AST nodes should have no children created in the "
             "preceeding block");
-    block_free(yy->prev_block);
+    block_release(yy, yy->prev_block);
     yy->prev_block = NULL;
     return add_child(yy, node);
 }
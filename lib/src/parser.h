@@ -0,0 +1,35 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CYPHER_PARSER_PARSER_H
+#define CYPHER_PARSER_PARSER_H
+
+#include "cypher-parser.h"
+#include "alloc.h"
+
+
+/*
+ * Parse the text of a single clause, as deferred when parsing with
+ * CYPHER_PARSE_LAZY_CLAUSES. The nodes are numbered from the ordinal and
+ * positioned from the start of the text, and the clause is the only
+ * directive of the result.
+ */
+cypher_parse_result_t *cp_parse_clause(const char *s, size_t n,
+        struct cypher_input_position position, unsigned int ordinal,
+        const struct cp_allocator *allocator);
+
+
+#endif/*CYPHER_PARSER_PARSER_H*/
@@ -16,6 +16,7 @@
  */
 #include "../../config.h"
 #include "parser_config.h"
+#include <assert.h>
 
 #define ANSI_COLOR_RESET "\x1b[0m"
 #define ANSI_COLOR_BOLD "\x1b[1m"
@@ -61,7 +62,10 @@ const struct cypher_parser_colorization *cypher_parser_ansi_colorization =
 struct cypher_parser_config cypher_parser_std_config =
     { .initial_position = { 1, 1, 0 },
       .initial_ordinal = 0,
-      .error_colorization = &_cypher_parser_no_colorization };
+      .error_colorization = &_cypher_parser_no_colorization,
+      .memoize = false,
+      .arena = false,
+      .optimistic = true };
 
 
 const char *libcypher_parser_version(void)
@@ -107,3 +111,38 @@ void cypher_parser_config_set_error_colorization(cypher_parser_config_t *config,
 {
     config->error_colorization = colorization;
 }
+
+
+void cypher_parser_config_set_memoization(cypher_parser_config_t *config,
+        bool enable)
+{
+    config->memoize = enable;
+}
+
+
+void cypher_parser_config_set_arena_allocation(cypher_parser_config_t *config,
+        bool enable)
+{
+    config->arena = enable;
+}
+
+
+void cypher_parser_config_set_optimistic_parsing(
+        cypher_parser_config_t *config, bool enable)
+{
+    config->optimistic = enable;
+}
+
+
+void cypher_parser_config_set_allocator(cypher_parser_config_t *config,
+        void *(*malloc_fn)(void *userdata, size_t size),
+        void *(*realloc_fn)(void *userdata, void *ptr, size_t size),
+        void (*free_fn)(void *userdata, void *ptr), void *userdata)
+{
+    assert((malloc_fn == NULL && realloc_fn == NULL && free_fn == NULL) ||
+            (malloc_fn != NULL && realloc_fn != NULL && free_fn != NULL));
+    config->allocator.malloc = malloc_fn;
+    config->allocator.realloc = realloc_fn;
+    config->allocator.free = free_fn;
+    config->allocator.userdata = (malloc_fn != NULL)? userdata : NULL;
+}
@@ -18,12 +18,17 @@
 #define CYPHER_PARSER_CONFIG_H
 
 #include "cypher-parser.h"
+#include "alloc.h"
 
 struct cypher_parser_config
 {
     struct cypher_input_position initial_position;
     unsigned int initial_ordinal;
     const struct cypher_parser_colorization *error_colorization;
+    bool memoize;
+    bool arena;
+    bool optimistic;
+    struct cp_allocator allocator;
 };
 
 
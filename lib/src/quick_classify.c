@@ -0,0 +1,376 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "cypher-parser.h"
+#include "keywords.h"
+#include "util.h"
+#include <assert.h>
+#include <stdint.h>
+
+
+/*
+ * Keywords are also valid symbolic names (e.g. `WITH 1 AS set`), so a
+ * keyword is only taken to begin a clause where a clause could follow the
+ * preceding token: at the start of a statement, after the end of an
+ * expression, or after a keyword that precedes a clause (e.g. `OPTIONAL`).
+ */
+enum preceding
+{
+    PRECEDING_EXPRESSION,
+    PRECEDING_OPERATOR,
+    PRECEDING_ACCESSOR
+};
+
+// the state of `CREATE`, which begins a schema command when followed by
+// `INDEX ON` or `CONSTRAINT ON`
+enum schema_state
+{
+    SCHEMA_NONE,
+    SCHEMA_CREATE,
+    SCHEMA_CREATE_OBJECT
+};
+
+struct classifier
+{
+    unsigned int result;
+    enum preceding preceding;
+    enum cp_keyword keyword;
+    enum schema_state schema;
+    bool started;
+    bool foreach;
+    unsigned int depth;
+    // the bracket depths at which the body of a `FOREACH` is open
+    uint64_t foreach_depths;
+};
+
+
+static int classify_segment(void *data,
+        const cypher_quick_parse_segment_t *segment);
+static void classify_statement(struct classifier *c, const char *s,
+        size_t n);
+static void classify_word(struct classifier *c, const char *s, size_t n);
+static void classify_punctuation(struct classifier *c, char ch);
+static bool resolve_schema(struct classifier *c, enum cp_keyword keyword);
+
+
+int cypher_quick_classify(const char *s, size_t n, unsigned int *classes,
+        uint_fast32_t flags)
+{
+    REQUIRE(s != NULL, -1);
+    REQUIRE(classes != NULL, -1);
+    unsigned int result = 0;
+    if (cypher_quick_uparse(s, n, classify_segment, &result, flags))
+    {
+        return -1;
+    }
+    *classes = result;
+    return 0;
+}
+
+
+int classify_segment(void *data, const cypher_quick_parse_segment_t *segment)
+{
+    if (!cypher_quick_parse_segment_is_statement(segment))
+    {
+        return 0;
+    }
+    size_t n;
+    const char *s = cypher_quick_parse_segment_get_text(segment, &n);
+    struct classifier c =
+        { .preceding = PRECEDING_EXPRESSION, .keyword = CP_NO_KEYWORD };
+    classify_statement(&c, s, n);
+    if (c.schema != SCHEMA_NONE)
+    {
+        c.result |= CYPHER_QUICK_CLASS_WRITES;
+    }
+    *(unsigned int *)data |= c.result;
+    return 0;
+}
+
+
+static inline bool is_word_start(char ch)
+{
+    return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') ||
+        ch == '_' || (unsigned char)ch >= 0x80;
+}
+
+
+static inline bool is_word_part(char ch)
+{
+    return is_word_start(ch) || (ch >= '0' && ch <= '9');
+}
+
+
+void classify_statement(struct classifier *c, const char *s, size_t n)
+{
+    size_t i = 0;
+    while (i < n)
+    {
+        char ch = s[i];
+        char next = (i + 1 < n)? s[i + 1] : '\0';
+        if (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r')
+        {
+            ++i;
+        }
+        else if (ch == '/' && next == '/')
+        {
+            for (i += 2; i < n && s[i] != '\n'; ++i)
+                ;
+        }
+        else if (ch == '/' && next == '*')
+        {
+            for (i += 2; i < n && !(s[i] == '*' && i + 1 < n &&
+                        s[i + 1] == '/'); ++i)
+                ;
+            i += 2;
+        }
+        else if (ch == '\'' || ch == '"' || ch == '`')
+        {
+            // strings escape with a backslash, while names are unescaped
+            for (++i; i < n && s[i] != ch; ++i)
+            {
+                i += (s[i] == '\\' && ch != '`');
+            }
+            ++i;
+            resolve_schema(c, CP_NO_KEYWORD);
+            c->preceding = PRECEDING_EXPRESSION;
+            c->keyword = CP_NO_KEYWORD;
+        }
+        else if (is_word_start(ch))
+        {
+            size_t start = i;
+            for (++i; i < n && is_word_part(s[i]); ++i)
+                ;
+            classify_word(c, s + start, i - start);
+        }
+        else if (ch >= '0' && ch <= '9')
+        {
+            for (++i; i < n && (is_word_part(s[i]) || (s[i] == '.' &&
+                        i + 1 < n && s[i + 1] >= '0' && s[i + 1] <= '9'));
+                    ++i)
+                ;
+            resolve_schema(c, CP_NO_KEYWORD);
+            c->preceding = PRECEDING_EXPRESSION;
+            c->keyword = CP_NO_KEYWORD;
+        }
+        else
+        {
+            classify_punctuation(c, ch);
+            ++i;
+        }
+    }
+}
+
+
+void classify_word(struct classifier *c, const char *s, size_t n)
+{
+    enum cp_keyword keyword = (c->preceding == PRECEDING_ACCESSOR ||
+            c->keyword == CP_KW_AS)? CP_NO_KEYWORD : cp_keyword_lookup(s, n);
+    if (resolve_schema(c, keyword))
+    {
+        return;
+    }
+
+    bool clause = (c->preceding == PRECEDING_EXPRESSION);
+    enum cp_keyword prev = c->keyword;
+    c->keyword = keyword;
+    c->preceding = PRECEDING_OPERATOR;
+
+    switch (keyword)
+    {
+    case CP_KW_MATCH:
+    case CP_KW_CREATE:
+        if (prev == CP_KW_ON)
+        {
+            // `ON MATCH` or `ON CREATE` in `MERGE`
+            c->preceding = PRECEDING_EXPRESSION;
+            return;
+        }
+        if (!clause)
+        {
+            break;
+        }
+        if (keyword == CP_KW_MATCH)
+        {
+            c->result |= CYPHER_QUICK_CLASS_READS;
+        }
+        else
+        {
+            c->schema = SCHEMA_CREATE;
+        }
+        c->started = true;
+        return;
+    case CP_KW_START:
+        if (!clause)
+        {
+            break;
+        }
+        c->result |= CYPHER_QUICK_CLASS_READS;
+        c->started = true;
+        return;
+    case CP_KW_MERGE:
+    case CP_KW_SET:
+    case CP_KW_DELETE:
+    case CP_KW_REMOVE:
+    case CP_KW_FOREACH:
+        if (!clause)
+        {
+            break;
+        }
+        c->result |= CYPHER_QUICK_CLASS_WRITES;
+        c->foreach = (keyword == CP_KW_FOREACH);
+        c->started = true;
+        return;
+    case CP_KW_CALL:
+        if (!clause)
+        {
+            break;
+        }
+        c->result |= CYPHER_QUICK_CLASS_CALLS;
+        c->started = true;
+        return;
+    case CP_KW_DROP:
+        if (!clause)
+        {
+            break;
+        }
+        c->result |= CYPHER_QUICK_CLASS_SCHEMA;
+        c->started = true;
+        return;
+    case CP_KW_PERIODIC:
+        if (prev == CP_KW_USING)
+        {
+            c->result |= CYPHER_QUICK_CLASS_PERIODIC_COMMIT;
+        }
+        return;
+    case CP_KW_EXPLAIN:
+    case CP_KW_PROFILE:
+        if (clause && !c->started)
+        {
+            c->result |= (keyword == CP_KW_EXPLAIN)?
+                    CYPHER_QUICK_CLASS_EXPLAIN : CYPHER_QUICK_CLASS_PROFILE;
+            c->preceding = PRECEDING_EXPRESSION;
+            return;
+        }
+        break;
+    case CP_KW_CYPHER:
+    case CP_KW_OPTIONAL:
+    case CP_KW_DETACH:
+    case CP_KW_UNION:
+    case CP_KW_ALL:
+    case CP_KW_COMMIT:
+    case CP_KW_NULL:
+    case CP_KW_TRUE:
+    case CP_KW_FALSE:
+    case CP_KW_END:
+    case CP_KW_ASC:
+    case CP_KW_ASCENDING:
+    case CP_KW_DESC:
+    case CP_KW_DESCENDING:
+        c->started |= (keyword != CP_KW_CYPHER);
+        c->preceding = PRECEDING_EXPRESSION;
+        return;
+    case CP_NO_KEYWORD:
+        c->preceding = PRECEDING_EXPRESSION;
+        return;
+    default:
+        c->started |= clause;
+        return;
+    }
+
+    // a keyword used as a name
+    c->keyword = CP_NO_KEYWORD;
+    c->preceding = PRECEDING_EXPRESSION;
+}
+
+
+void classify_punctuation(struct classifier *c, char ch)
+{
+    resolve_schema(c, CP_NO_KEYWORD);
+    c->keyword = CP_NO_KEYWORD;
+    uint64_t bit = (c->depth < 64)? (uint64_t)1 << c->depth : 0;
+    switch (ch)
+    {
+    case '(':
+    case '[':
+    case '{':
+        ++(c->depth);
+        if (c->foreach && ch == '(')
+        {
+            c->foreach_depths |= bit << 1;
+        }
+        c->foreach = false;
+        c->preceding = PRECEDING_OPERATOR;
+        return;
+    case ')':
+    case ']':
+    case '}':
+        c->foreach_depths &= ~bit;
+        c->depth -= (c->depth > 0);
+        c->preceding = PRECEDING_EXPRESSION;
+        return;
+    case '|':
+        // the clauses of a `FOREACH` follow the `|`
+        c->preceding = (c->foreach_depths & bit)?
+                PRECEDING_EXPRESSION : PRECEDING_OPERATOR;
+        return;
+    case '*':
+        c->preceding = PRECEDING_EXPRESSION;
+        return;
+    case '.':
+    case ':':
+    case '$':
+        c->preceding = PRECEDING_ACCESSOR;
+        return;
+    default:
+        c->preceding = PRECEDING_OPERATOR;
+        return;
+    }
+}
+
+
+// advance the state of a preceding `CREATE`, returning true if the keyword
+// has been consumed as part of a schema command
+bool resolve_schema(struct classifier *c, enum cp_keyword keyword)
+{
+    switch (c->schema)
+    {
+    case SCHEMA_NONE:
+        return false;
+    case SCHEMA_CREATE:
+        if (keyword == CP_KW_INDEX || keyword == CP_KW_CONSTRAINT)
+        {
+            c->schema = SCHEMA_CREATE_OBJECT;
+            c->keyword = keyword;
+            return true;
+        }
+        break;
+    case SCHEMA_CREATE_OBJECT:
+        if (keyword == CP_KW_ON)
+        {
+            c->schema = SCHEMA_NONE;
+            c->result |= CYPHER_QUICK_CLASS_SCHEMA;
+            c->keyword = keyword;
+            c->preceding = PRECEDING_OPERATOR;
+            return true;
+        }
+        break;
+    }
+    c->schema = SCHEMA_NONE;
+    c->result |= CYPHER_QUICK_CLASS_WRITES;
+    return false;
+}
@@ -16,11 +16,16 @@
  */
 #include "../../config.h"
 #include "cypher-parser.h"
+#include "input.h"
+#include "line_index.h"
 #include "util.h"
 #include "vector.h"
 #include <assert.h>
 #include <errno.h>
 #include <setjmp.h>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 DECLARE_VECTOR(offsets, unsigned int, 0);
 
@@ -34,54 +39,13 @@ static int parse(source_cb_t source, void *sourcedata,
 static void source(yycontext *yy, char *buf, int *result, int max_size);
 
 
-struct source_from_buffer_data
-{
-    const char *buffer;
-    size_t length;
-};
-
-
-static int source_from_buffer(void *data, char *buf, int n)
-{
-    struct source_from_buffer_data *input = data;
-    int len = min(input->length, n);
-    input->length -= len;
-    if (len == 0)
-    {
-        return len;
-    }
-    memcpy(buf, input->buffer, len);
-    return len;
-}
-
-
-static int source_from_stream(void *data, char *buf, int n)
-{
-    FILE *stream = data;
-    int c = getc(stream);
-    if (c == EOF)
-    {
-        return 0;
-    }
-    *buf = c;
-    return 1;
-}
-
-
-int cypher_quick_uparse(const char *s, size_t n,
-        cypher_parser_quick_segment_callback_t callback, void *userdata,
-        uint_fast32_t flags)
-{
-    struct source_from_buffer_data sourcedata = { .buffer = s, .length = n };
-    return parse(source_from_buffer, &sourcedata, callback, userdata, flags);
-}
-
-
 int cypher_quick_fparse(FILE *stream,
         cypher_parser_quick_segment_callback_t callback, void *userdata,
         uint_fast32_t flags)
 {
-    return parse(source_from_stream, stream, callback, userdata, flags);
+    struct cp_stream_input input;
+    cp_stream_input_init(&input, stream, !(flags & CYPHER_PARSE_SINGLE));
+    return parse(cp_stream_input_read, &input, callback, userdata, flags);
 }
 
 
@@ -378,3 +342,675 @@ struct cypher_input_position input_position(yycontext *yy, unsigned int pos)
           .offset = pos + yy->position_offset.offset };
     return position;
 }
+
+
+enum quick_scan_mode
+{
+    SCAN_LEADING,       // whitespace and comments before a segment
+    SCAN_BODY,          // the body of a statement or command
+    SCAN_TRAILING,      // whitespace and comments that may end the body
+    SCAN_CONTINUATION,  // a backslash that may continue a command line
+    SCAN_QUOTE,
+    SCAN_BLOCK_COMMENT,
+    SCAN_LINE_COMMENT,
+    SCAN_LINE_END       // a line comment terminating a command
+};
+
+
+struct cypher_quick_scanner
+{
+    bool commands;
+    bool single;
+    // a segment has been delivered, and no more will be before a reset
+    bool done;
+    bool active;
+    // the input being scanned, either the buffer or the caller's string
+    const char *input;
+    size_t length;
+    // input retained from the start of the current segment
+    char *buffer;
+    size_t capacity;
+    size_t base;
+    size_t scanned;
+    struct cypher_input_position position;
+    enum quick_scan_mode mode;
+    enum quick_scan_mode resume;
+    char quote;
+    bool is_statement;
+    size_t begin;
+    struct cypher_input_position begin_position;
+    size_t end;
+    struct cypher_input_position end_position;
+};
+
+
+static int scan(cypher_quick_scanner_t *scanner, bool finish,
+        cypher_parser_quick_segment_callback_t callback, void *userdata);
+static bool scan_plain(cypher_quick_scanner_t *scanner);
+static int scan_eof(cypher_quick_scanner_t *scanner,
+        cypher_parser_quick_segment_callback_t callback, void *userdata);
+static void scan_advance(cypher_quick_scanner_t *scanner, size_t n);
+static void scan_mark_end(cypher_quick_scanner_t *scanner);
+static int scan_deliver(cypher_quick_scanner_t *scanner, bool eof,
+        cypher_parser_quick_segment_callback_t callback, void *userdata);
+static void scan_compact(cypher_quick_scanner_t *scanner);
+static void scan_reset(cypher_quick_scanner_t *scanner);
+static size_t scan_span(const char *s, size_t n, const char *stops,
+        unsigned int nstops);
+
+
+int cypher_quick_uparse(const char *s, size_t n,
+        cypher_parser_quick_segment_callback_t callback, void *userdata,
+        uint_fast32_t flags)
+{
+    struct cypher_quick_scanner scanner;
+    memset(&scanner, 0, sizeof(scanner));
+    scanner.commands = !(flags & CYPHER_PARSE_ONLY_STATEMENTS);
+    scanner.single = flags & CYPHER_PARSE_SINGLE;
+    scan_reset(&scanner);
+    scanner.input = s;
+    scanner.length = n;
+    return scan(&scanner, true, callback, userdata);
+}
+
+
+cypher_quick_scanner_t *cypher_quick_scanner_new(uint_fast32_t flags)
+{
+    cypher_quick_scanner_t *scanner =
+            calloc(1, sizeof(cypher_quick_scanner_t));
+    if (scanner == NULL)
+    {
+        return NULL;
+    }
+    scanner->commands = !(flags & CYPHER_PARSE_ONLY_STATEMENTS);
+    scanner->single = flags & CYPHER_PARSE_SINGLE;
+    scan_reset(scanner);
+    return scanner;
+}
+
+
+void cypher_quick_scanner_free(cypher_quick_scanner_t *scanner)
+{
+    if (scanner == NULL)
+    {
+        return;
+    }
+    free(scanner->buffer);
+    free(scanner);
+}
+
+
+int cypher_quick_scanner_feed(cypher_quick_scanner_t *scanner,
+        const char *s, size_t n,
+        cypher_parser_quick_segment_callback_t callback, void *userdata)
+{
+    REQUIRE(scanner != NULL, -1);
+    if (scanner->active)
+    {
+        errno = EBUSY;
+        return -1;
+    }
+    if (scanner->done)
+    {
+        return 0;
+    }
+
+    // only compact when that frees at least as much as remains pending
+    if (n > scanner->capacity - scanner->length &&
+            scanner->base >= scanner->length - scanner->base)
+    {
+        scan_compact(scanner);
+    }
+    if (n > scanner->capacity - scanner->length)
+    {
+        size_t capacity = (scanner->capacity == 0)?
+                YY_BUFFER_SIZE : scanner->capacity;
+        while (capacity - scanner->length < n)
+        {
+            if (capacity > SIZE_MAX / 2)
+            {
+                errno = ENOMEM;
+                return -1;
+            }
+            capacity *= 2;
+        }
+        char *buffer = realloc(scanner->buffer, capacity);
+        if (buffer == NULL)
+        {
+            return -1;
+        }
+        scanner->buffer = buffer;
+        scanner->capacity = capacity;
+    }
+    if (n > 0)
+    {
+        memcpy(scanner->buffer + scanner->length, s, n);
+        scanner->length += n;
+    }
+    scanner->input = scanner->buffer;
+
+    return scan(scanner, false, callback, userdata);
+}
+
+
+int cypher_quick_scanner_finish(cypher_quick_scanner_t *scanner,
+        cypher_parser_quick_segment_callback_t callback, void *userdata)
+{
+    REQUIRE(scanner != NULL, -1);
+    if (scanner->active)
+    {
+        errno = EBUSY;
+        return -1;
+    }
+    return scan(scanner, true, callback, userdata);
+}
+
+
+unsigned int cypher_quick_scanner_state(
+        const cypher_quick_scanner_t *scanner)
+{
+    REQUIRE(scanner != NULL, 0);
+    if (scanner->done)
+    {
+        return 0;
+    }
+    unsigned int state = 0;
+    enum quick_scan_mode mode = scanner->mode;
+    if (scanner->scanned < scanner->length)
+    {
+        state |= CYPHER_QUICK_SCAN_PENDING;
+        if (scanner->input[scanner->scanned] == '\\')
+        {
+            state |= CYPHER_QUICK_SCAN_IN_ESCAPE;
+        }
+    }
+    if (mode == SCAN_BLOCK_COMMENT || mode == SCAN_LINE_COMMENT)
+    {
+        mode = scanner->resume;
+        state |= CYPHER_QUICK_SCAN_IN_COMMENT;
+    }
+    switch (mode)
+    {
+    case SCAN_LEADING:
+        break;
+    case SCAN_QUOTE:
+        state |= CYPHER_QUICK_SCAN_IN_QUOTE;
+        state |= CYPHER_QUICK_SCAN_PENDING;
+        break;
+    case SCAN_CONTINUATION:
+        state |= CYPHER_QUICK_SCAN_IN_ESCAPE;
+        state |= CYPHER_QUICK_SCAN_PENDING;
+        break;
+    case SCAN_LINE_END:
+        state |= CYPHER_QUICK_SCAN_IN_COMMENT;
+        state |= CYPHER_QUICK_SCAN_PENDING;
+        break;
+    default:
+        state |= CYPHER_QUICK_SCAN_PENDING;
+        break;
+    }
+    return state;
+}
+
+
+struct cypher_input_position cypher_quick_scanner_position(
+        const cypher_quick_scanner_t *scanner)
+{
+    REQUIRE(scanner != NULL, cypher_input_position_zero);
+    return scanner->position;
+}
+
+
+static inline bool is_hws(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+
+static inline bool is_escapable(char c)
+{
+    switch (c)
+    {
+    case 'a': case 'b': case 'f': case 'n': case 'r': case 't': case 'v':
+    case '"': case '\'': case '?': case '\\':
+        return true;
+    default:
+        return false;
+    }
+}
+
+
+static inline bool needs_lookahead(char c)
+{
+    return c == '/' || c == '*' || c == '\\' || c == '\r';
+}
+
+
+int scan(cypher_quick_scanner_t *scanner, bool finish,
+        cypher_parser_quick_segment_callback_t callback, void *userdata)
+{
+    const char *buffer = scanner->input;
+    int result = 0;
+
+    while (!scanner->done && scanner->scanned < scanner->length)
+    {
+        if (scan_plain(scanner))
+        {
+            continue;
+        }
+
+        size_t i = scanner->scanned;
+        char c = buffer[i];
+        bool more = (i + 1) < scanner->length;
+        if (!more && !finish && needs_lookahead(c))
+        {
+            break;
+        }
+        char next = more? buffer[i + 1] : '\0';
+        size_t eol = (c == '\n')? 1 : (c == '\r' && next == '\n')? 2 : 0;
+        bool block_comment = (c == '/' && next == '*');
+        bool line_comment = (c == '/' && next == '/');
+        bool ended = false;
+
+        switch (scanner->mode)
+        {
+        case SCAN_LEADING:
+            if (is_hws(c) || eol > 0)
+            {
+                scan_advance(scanner, (eol > 0)? eol : 1);
+                break;
+            }
+            scanner->begin = i;
+            scanner->begin_position = scanner->position;
+            if (block_comment || line_comment)
+            {
+                // an unclosed block comment begins the body
+                scanner->resume = SCAN_LEADING;
+                scanner->mode = block_comment?
+                        SCAN_BLOCK_COMMENT : SCAN_LINE_COMMENT;
+                scan_advance(scanner, 2);
+                break;
+            }
+            scanner->is_statement = !(scanner->commands && c == ':');
+            scanner->mode = SCAN_BODY;
+            if (!scanner->is_statement)
+            {
+                scan_advance(scanner, 1);
+            }
+            break;
+        case SCAN_BODY:
+            if (block_comment || (line_comment && scanner->is_statement))
+            {
+                scanner->resume = SCAN_BODY;
+                scanner->mode = block_comment?
+                        SCAN_BLOCK_COMMENT : SCAN_LINE_COMMENT;
+                scan_advance(scanner, 2);
+            }
+            else if (c == '\'' || c == '"')
+            {
+                scanner->quote = c;
+                scanner->mode = SCAN_QUOTE;
+                scan_advance(scanner, 1);
+            }
+            else if (c == '\\' && more &&
+                    (is_escapable(next) ||
+                     (next == ';' && !scanner->is_statement)))
+            {
+                scan_advance(scanner, 2);
+            }
+            else if (c == '\\' && !scanner->is_statement)
+            {
+                scanner->mode = SCAN_CONTINUATION;
+                scan_advance(scanner, 1);
+            }
+            else if (c == ';' || (!scanner->is_statement && eol > 0))
+            {
+                scan_mark_end(scanner);
+                scan_advance(scanner, (eol > 0)? eol : 1);
+                ended = true;
+            }
+            else if (line_comment)
+            {
+                scan_mark_end(scanner);
+                scanner->mode = SCAN_LINE_END;
+                scan_advance(scanner, 2);
+            }
+            else if (is_hws(c) || (scanner->is_statement && eol > 0))
+            {
+                scan_mark_end(scanner);
+                scanner->mode = SCAN_TRAILING;
+                scan_advance(scanner, (eol > 0)? eol : 1);
+            }
+            else
+            {
+                scan_advance(scanner, 1);
+            }
+            break;
+        case SCAN_TRAILING:
+            if (is_hws(c) || (scanner->is_statement && eol > 0))
+            {
+                scan_advance(scanner, (eol > 0)? eol : 1);
+            }
+            else if (block_comment ||
+                    (line_comment && scanner->is_statement))
+            {
+                scanner->resume = SCAN_TRAILING;
+                scanner->mode = block_comment?
+                        SCAN_BLOCK_COMMENT : SCAN_LINE_COMMENT;
+                scan_advance(scanner, 2);
+            }
+            else if (line_comment)
+            {
+                scanner->mode = SCAN_LINE_END;
+                scan_advance(scanner, 2);
+            }
+            else if ((c == ';' && scanner->is_statement) ||
+                    (eol > 0 && !scanner->is_statement))
+            {
+                scan_advance(scanner, (eol > 0)? eol : 1);
+                ended = true;
+            }
+            else
+            {
+                // not the end of the body after all
+                scanner->mode = SCAN_BODY;
+            }
+            break;
+        case SCAN_CONTINUATION:
+            if (is_hws(c))
+            {
+                scan_advance(scanner, 1);
+            }
+            else if (block_comment || line_comment)
+            {
+                scanner->resume = block_comment?
+                        SCAN_CONTINUATION : SCAN_BODY;
+                scanner->mode = block_comment?
+                        SCAN_BLOCK_COMMENT : SCAN_LINE_COMMENT;
+                scan_advance(scanner, 2);
+            }
+            else
+            {
+                scanner->mode = SCAN_BODY;
+                scan_advance(scanner, eol);
+            }
+            break;
+        case SCAN_QUOTE:
+            if (c == '\\' && is_escapable(next))
+            {
+                scan_advance(scanner, 2);
+                break;
+            }
+            if (c == scanner->quote)
+            {
+                scanner->mode = SCAN_BODY;
+            }
+            scan_advance(scanner, 1);
+            break;
+        case SCAN_BLOCK_COMMENT:
+            if (c == '*' && next == '/')
+            {
+                scanner->mode = scanner->resume;
+                scan_advance(scanner, 2);
+                break;
+            }
+            scan_advance(scanner, 1);
+            break;
+        case SCAN_LINE_COMMENT:
+        case SCAN_LINE_END:
+            if (c == '\n')
+            {
+                ended = (scanner->mode == SCAN_LINE_END);
+                scanner->mode = scanner->resume;
+            }
+            scan_advance(scanner, 1);
+            break;
+        }
+
+        if (!ended)
+        {
+            continue;
+        }
+        if ((result = scan_deliver(scanner, false, callback, userdata)) != 0)
+        {
+            break;
+        }
+    }
+
+    if (finish && result == 0 &&
+            (scanner->done || scanner->scanned == scanner->length))
+    {
+        if (!scanner->done)
+        {
+            result = scan_eof(scanner, callback, userdata);
+        }
+        if (result >= 0)
+        {
+            scan_reset(scanner);
+        }
+    }
+    return (result > 0)? 0 : result;
+}
+
+
+// bytes that may end a run of plain input within the body
+static const char body_stops[] = { ';', '\'', '"', '\\', '/', '\n', '\r' };
+
+
+bool scan_plain(cypher_quick_scanner_t *scanner)
+{
+    const char *s = scanner->input + scanner->scanned;
+    size_t n = scanner->length - scanner->scanned;
+    const char *stop;
+    size_t span;
+
+    switch (scanner->mode)
+    {
+    case SCAN_BODY:
+        span = scan_span(s, n, body_stops, sizeof(body_stops));
+        break;
+    case SCAN_QUOTE:
+        {
+            const char stops[2] = { scanner->quote, '\\' };
+            span = scan_span(s, n, stops, 2);
+        }
+        break;
+    case SCAN_BLOCK_COMMENT:
+        stop = memchr(s, '*', n);
+        span = (stop != NULL)? (size_t)(stop - s) : n;
+        break;
+    case SCAN_LINE_COMMENT:
+    case SCAN_LINE_END:
+        stop = memchr(s, '\n', n);
+        span = (stop != NULL)? (size_t)(stop - s) : n;
+        break;
+    default:
+        return false;
+    }
+
+    if (span == 0)
+    {
+        return false;
+    }
+    if (scanner->mode != SCAN_BODY)
+    {
+        scan_advance(scanner, span);
+        return true;
+    }
+
+    // whitespace before the stop may be trailing the body
+    size_t body = span;
+    for (; body > 0 && is_hws(s[body - 1]); --body)
+        ;
+    scan_advance(scanner, body);
+    if (body < span)
+    {
+        scan_mark_end(scanner);
+        scanner->mode = SCAN_TRAILING;
+        scan_advance(scanner, span - body);
+    }
+    return true;
+}
+
+
+int scan_eof(cypher_quick_scanner_t *scanner,
+        cypher_parser_quick_segment_callback_t callback, void *userdata)
+{
+    enum quick_scan_mode mode = scanner->mode;
+    if (mode == SCAN_LINE_COMMENT && scanner->resume == SCAN_LEADING)
+    {
+        mode = SCAN_LEADING;
+    }
+
+    if (mode == SCAN_LEADING)
+    {
+        if (scanner->scanned == scanner->base)
+        {
+            return 0;
+        }
+        scanner->is_statement = true;
+        scanner->begin = scanner->scanned;
+        scanner->begin_position = scanner->position;
+    }
+    else if (mode == SCAN_BLOCK_COMMENT &&
+            scanner->resume == SCAN_LEADING)
+    {
+        scanner->is_statement = true;
+    }
+
+    if (!((mode == SCAN_TRAILING && !scanner->is_statement) ||
+            mode == SCAN_LINE_END))
+    {
+        scan_mark_end(scanner);
+    }
+    return scan_deliver(scanner, true, callback, userdata);
+}
+
+
+void scan_advance(cypher_quick_scanner_t *scanner, size_t n)
+{
+    assert(scanner->scanned + n <= scanner->length);
+    const char *s = scanner->input + scanner->scanned;
+    if (n == 1)
+    {
+        bool eol = (*s == '\n');
+        scanner->position.line += eol;
+        scanner->position.column = eol? 1 : scanner->position.column + 1;
+        ++(scanner->position.offset);
+    }
+    else
+    {
+        scanner->position = cp_position_advance(scanner->position, s, n);
+    }
+    scanner->scanned += n;
+}
+
+
+void scan_mark_end(cypher_quick_scanner_t *scanner)
+{
+    scanner->end = scanner->scanned;
+    scanner->end_position = scanner->position;
+}
+
+
+int scan_deliver(cypher_quick_scanner_t *scanner, bool eof,
+        cypher_parser_quick_segment_callback_t callback, void *userdata)
+{
+    struct cypher_quick_parse_segment segment =
+        { .is_statement = scanner->is_statement,
+          .ptr = scanner->input + scanner->begin,
+          .length = scanner->end - scanner->begin,
+          .range = { .start = scanner->begin_position,
+                     .end = scanner->end_position },
+          .next = scanner->position,
+          .eof = eof };
+
+    scanner->base = scanner->scanned;
+    scanner->mode = SCAN_LEADING;
+    scanner->done = scanner->single;
+    scanner->active = true;
+    int result = callback(userdata, &segment);
+    scanner->active = false;
+    return result;
+}
+
+
+void scan_compact(cypher_quick_scanner_t *scanner)
+{
+    size_t base = scanner->base;
+    if (base == 0)
+    {
+        return;
+    }
+    memmove(scanner->buffer, scanner->buffer + base,
+            scanner->length - base);
+    scanner->length -= base;
+    scanner->scanned -= base;
+    scanner->begin -= min(scanner->begin, base);
+    scanner->end -= min(scanner->end, base);
+    scanner->base = 0;
+}
+
+
+void scan_reset(cypher_quick_scanner_t *scanner)
+{
+    scanner->length = 0;
+    scanner->base = 0;
+    scanner->scanned = 0;
+    scanner->position = cypher_input_position_zero;
+    scanner->mode = SCAN_LEADING;
+    scanner->resume = SCAN_LEADING;
+    scanner->done = false;
+}
+
+
+size_t scan_span(const char *s, size_t n, const char *stops,
+        unsigned int nstops)
+{
+    size_t i = 0;
+#ifdef __AVX2__
+    for (; (n - i) >= 32; i += 32)
+    {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)(s + i));
+        __m256i hits = _mm256_setzero_si256();
+        for (unsigned int j = 0; j < nstops; ++j)
+        {
+            hits = _mm256_or_si256(hits,
+                    _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(stops[j])));
+        }
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(hits);
+        if (mask != 0)
+        {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#endif
+#ifdef __SSE2__
+    for (; (n - i) >= 16; i += 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(s + i));
+        __m128i hits = _mm_setzero_si128();
+        for (unsigned int j = 0; j < nstops; ++j)
+        {
+            hits = _mm_or_si128(hits,
+                    _mm_cmpeq_epi8(chunk, _mm_set1_epi8(stops[j])));
+        }
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(hits);
+        if (mask != 0)
+        {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        for (unsigned int j = 0; j < nstops; ++j)
+        {
+            if (s[i] == stops[j])
+            {
+                return i;
+            }
+        }
+    }
+    return n;
+}
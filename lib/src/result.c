@@ -22,6 +22,29 @@
 #include <assert.h>
 
 
+static int merge_segment(cypher_parse_result_t *result,
+        cypher_parse_segment_t *segment);
+
+
+cypher_parse_result_t *cypher_parse_result(void)
+{
+    cypher_parse_result_t *result = cp_malloc(sizeof(cypher_parse_result_t));
+    if (result == NULL)
+    {
+        return NULL;
+    }
+    cp_result_init(result);
+    return result;
+}
+
+
+void cp_result_init(cypher_parse_result_t *result)
+{
+    memset(result, 0, sizeof(cypher_parse_result_t));
+    result->allocator = cp_current_allocator();
+}
+
+
 unsigned int cypher_parse_result_nroots(const cypher_parse_result_t *result)
 {
     return result->nroots;
@@ -88,9 +111,19 @@ bool cypher_parse_result_eof(const cypher_parse_result_t *result)
 
 int cp_result_merge_segment(cypher_parse_result_t *result,
         cypher_parse_segment_t *segment)
+{
+    const struct cp_allocator *prev = cp_set_allocator(&(result->allocator));
+    int err = merge_segment(result, segment);
+    cp_set_allocator(prev);
+    return err;
+}
+
+
+int merge_segment(cypher_parse_result_t *result,
+        cypher_parse_segment_t *segment)
 {
     if (!result->eof && segment->eof &&
-            (segment->directive != NULL || segment->nerrors > 0))
+            (!segment->empty || segment->nerrors > 0))
     {
         result->eof = true;
     }
@@ -98,7 +131,7 @@ int cp_result_merge_segment(cypher_parse_result_t *result,
     if (segment->nerrors > 0)
     {
         unsigned int n = result->nerrors + segment->nerrors;
-        cypher_parse_error_t *errors = realloc(result->errors,
+        cypher_parse_error_t *errors = cp_realloc(result->errors,
                 n * sizeof(cypher_parse_error_t));
         if (errors == NULL)
         {
@@ -114,17 +147,42 @@ int cp_result_merge_segment(cypher_parse_result_t *result,
     if (segment->nroots > 0)
     {
         unsigned int n = result->nroots + segment->nroots;
-        cypher_astnode_t **roots = realloc(result->roots,
+        cypher_astnode_t **roots = cp_realloc(result->roots,
                 n * sizeof(cypher_astnode_t *));
         if (roots == NULL)
         {
             return -1;
         }
+        result->roots = roots;
+        // the ids of the names of the nodes are made consistent with those
+        // of nodes already in the result
+        if (segment->symbols != NULL)
+        {
+            if (result->symbols == NULL)
+            {
+                result->symbols = segment->symbols;
+            }
+            else if (cp_symbol_table_merge(result->symbols, segment->symbols))
+            {
+                return -1;
+            }
+            segment->symbols = NULL;
+        }
         memcpy(roots + result->nroots, segment->roots,
                 segment->nroots * sizeof(cypher_astnode_t *));
         segment->nroots = 0;
-        result->roots = roots;
         result->nroots = n;
+        cp_arena_move(&(result->arena), &(segment->arena));
+        // the nodes resolve their positions from the line index
+        if (segment->line_index != NULL)
+        {
+            cp_line_index_t *last = segment->line_index;
+            for (; last->next != NULL; last = last->next)
+                ;
+            last->next = result->line_index;
+            result->line_index = segment->line_index;
+            segment->line_index = NULL;
+        }
     }
 
     result->nnodes += segment->nnodes;
@@ -136,7 +194,7 @@ int cp_result_merge_segment(cypher_parse_result_t *result,
         {
             unsigned int n = (result->directives_cap == 0)?
                     8 : result->directives_cap * 2;
-            const cypher_astnode_t **directives = realloc(result->directives,
+            const cypher_astnode_t **directives = cp_realloc(result->directives,
                     n * sizeof(const cypher_astnode_t *));
             if (directives == NULL)
             {
@@ -177,10 +235,25 @@ void cypher_parse_result_free(cypher_parse_result_t *result)
         return;
     }
 
+    struct cp_allocator allocator = result->allocator;
+    const struct cp_allocator *prev = cp_set_allocator(&allocator);
+    cp_result_cleanup(result);
+    cp_free(result);
+    cp_set_allocator(prev);
+}
+
+
+void cp_result_cleanup(cypher_parse_result_t *result)
+{
+    const struct cp_allocator *prev = cp_set_allocator(&(result->allocator));
     cp_errors_vcleanup(result->errors, result->nerrors);
-    free(result->errors);
+    cp_free(result->errors);
     cypher_ast_vfree(result->roots, result->nroots);
-    free(result->roots);
-    free(result->directives);
-    free(result);
+    cp_free(result->roots);
+    cp_free(result->directives);
+    cp_arena_cleanup(&(result->arena));
+    cp_line_index_free(result->line_index);
+    cp_symbol_table_free(result->symbols);
+    cp_set_allocator(prev);
+    cp_result_init(result);
 }
@@ -18,7 +18,11 @@
 #define CYPHER_PARSER_RESULT_H
 
 #include "cypher-parser.h"
+#include "alloc.h"
+#include "arena.h"
 #include "errors.h"
+#include "line_index.h"
+#include "symbol_table.h"
 
 
 struct cypher_parse_result
@@ -35,9 +39,32 @@ struct cypher_parse_result
     unsigned int directives_cap;
 
     bool eof;
+
+    cp_arena_t arena;
+    cp_line_index_t *line_index;
+    cp_symbol_table_t *symbols;
+    struct cp_allocator allocator;
 };
 
 
+/*
+ * Create an empty parse result, which (along with everything subsequently
+ * merged into it) is allocated using the current allocator.
+ */
+cypher_parse_result_t *cypher_parse_result(void);
+
+/*
+ * Initialize a parse result, e.g. one embedded in another structure, to be
+ * empty and allocated using the current allocator.
+ */
+void cp_result_init(cypher_parse_result_t *result);
+
+/*
+ * Release everything merged into a parse result (but not the result itself),
+ * leaving it empty.
+ */
+void cp_result_cleanup(cypher_parse_result_t *result);
+
 int cp_result_merge_segment(cypher_parse_result_t *result,
         cypher_parse_segment_t *segment);
 
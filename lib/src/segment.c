@@ -24,9 +24,11 @@
 cypher_parse_segment_t *cypher_parse_segment(unsigned int ordinal,
         struct cypher_input_range range, cypher_parse_error_t *errors,
         unsigned int nerrors, cypher_astnode_t **roots, unsigned int nroots,
-        const cypher_astnode_t *directive, bool eof)
+        const cypher_astnode_t *directive, bool empty, bool eof,
+        cp_arena_t *arena, cp_line_index_t *line_index,
+        cp_symbol_table_t *symbols)
 {
-    struct cypher_parse_segment *segment = calloc(1,
+    struct cypher_parse_segment *segment = cp_calloc(1,
             sizeof(cypher_parse_segment_t));
     if (segment == NULL)
     {
@@ -34,6 +36,7 @@ cypher_parse_segment_t *cypher_parse_segment(unsigned int ordinal,
     }
 
     segment->refcount = 1;
+    segment->allocator = cp_current_allocator();
     segment->range = range;
     if (nerrors > 0)
     {
@@ -54,6 +57,7 @@ cypher_parse_segment_t *cypher_parse_segment(unsigned int ordinal,
         segment->nroots = nroots;
     }
     segment->directive = directive;
+    segment->empty = empty;
     segment->eof = eof;
 
     unsigned int initial_ordinal = ordinal;
@@ -63,6 +67,14 @@ cypher_parse_segment_t *cypher_parse_segment(unsigned int ordinal,
     }
     segment->nnodes = ordinal - initial_ordinal;
 
+    cp_arena_init(&(segment->arena));
+    if (arena != NULL)
+    {
+        cp_arena_move(&(segment->arena), arena);
+    }
+    segment->line_index = line_index;
+    segment->symbols = symbols;
+
     return segment;
 
     int errsv;
@@ -70,10 +82,10 @@ failure:
     errsv = errno;
     if (segment != NULL)
     {
-        free(segment->errors);
-        free(segment->roots);
+        cp_free(segment->errors);
+        cp_free(segment->roots);
     }
-    free(segment);
+    cp_free(segment);
     errno = errsv;
     return NULL;
 }
@@ -99,13 +111,21 @@ void cypher_parse_segment_release(cypher_parse_segment_t* segment)
         return;
     }
 
+    struct cp_allocator allocator = segment->allocator;
+    const struct cp_allocator *prev = cp_set_allocator(&allocator);
+
     cp_errors_vcleanup(segment->errors, segment->nerrors);
-    free(segment->errors);
+    cp_free(segment->errors);
     cypher_ast_vfree(segment->roots, segment->nroots);
-    free(segment->roots);
+    cp_free(segment->roots);
+    cp_arena_cleanup(&(segment->arena));
+    cp_line_index_free(segment->line_index);
+    cp_symbol_table_free(segment->symbols);
 
     memset(segment, 0, sizeof(cypher_parse_segment_t));
-    free(segment);
+    cp_free(segment);
+
+    cp_set_allocator(prev);
 }
 
 
@@ -18,7 +18,11 @@
 #define CYPHER_PARSER_SEGMENT_H
 
 #include "cypher-parser.h"
+#include "alloc.h"
+#include "arena.h"
 #include "errors.h"
+#include "line_index.h"
+#include "symbol_table.h"
 
 
 struct cypher_parse_segment
@@ -35,14 +39,26 @@ struct cypher_parse_segment
     unsigned int nnodes;
 
     const cypher_astnode_t *directive;
+    bool empty;
     bool eof;
+
+    cp_arena_t arena;
+    cp_line_index_t *line_index;
+    cp_symbol_table_t *symbols;
+    struct cp_allocator allocator;
 };
 
 
+/*
+ * Create a segment, which takes ownership of the nodes, of all memory in the
+ * arena (if not NULL) and of the line index and symbol table (if not NULL).
+ */
 cypher_parse_segment_t *cypher_parse_segment(unsigned int ordinal,
         struct cypher_input_range range, cypher_parse_error_t *errors,
         unsigned int nerrors, cypher_astnode_t **roots, unsigned int nroots,
-        const cypher_astnode_t *directive, bool eof);
+        const cypher_astnode_t *directive, bool empty, bool eof,
+        cp_arena_t *arena, cp_line_index_t *line_index,
+        cp_symbol_table_t *symbols);
 
 
 #endif/*CYPHER_PARSER_SEGMENT_H*/
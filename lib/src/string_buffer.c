@@ -16,6 +16,7 @@
  */
 #include "../../config.h"
 #include "string_buffer.h"
+#include "alloc.h"
 #include <assert.h>
 #include <string.h>
 
@@ -31,7 +32,7 @@ int cp_sb_append(struct cp_string_buffer* sb, const char *s, size_t n)
                 (3*CYPHER_PARSER_STRING_BUFFER_BLOCK_SIZE/2)) /
                 CYPHER_PARSER_STRING_BUFFER_BLOCK_SIZE
                 ) * CYPHER_PARSER_STRING_BUFFER_BLOCK_SIZE;
-        void *buf = realloc(sb->buffer, newcap);
+        void *buf = cp_realloc(sb->buffer, newcap);
         if (buf == NULL)
         {
             return -1;
@@ -48,6 +49,6 @@ int cp_sb_append(struct cp_string_buffer* sb, const char *s, size_t n)
 
 void cp_sb_cleanup(struct cp_string_buffer *sb)
 {
-    free(sb->buffer);
+    cp_free(sb->buffer);
     memset(sb, 0, sizeof(struct cp_string_buffer));
 }
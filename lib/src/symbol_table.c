@@ -0,0 +1,172 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "symbol_table.h"
+#include "alloc.h"
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+
+#define CYPHER_PARSER_SYMBOL_TABLE_MIN_CAPACITY 32
+
+
+static int grow(cp_symbol_table_t *table);
+
+
+cp_symbol_table_t *cp_symbol_table(void)
+{
+    cp_symbol_table_t *table = cp_calloc(1, sizeof(cp_symbol_table_t));
+    if (table == NULL)
+    {
+        return NULL;
+    }
+    cp_arena_init(&(table->arena));
+    return table;
+}
+
+
+const struct cp_symbol *cp_symbol_table_intern(cp_symbol_table_t *table,
+        const char *s, size_t n)
+{
+    // keep the load factor at most 1/2
+    if (table->nsymbols >= table->capacity / 2 && grow(table))
+    {
+        return NULL;
+    }
+
+    unsigned int hash = cp_hash_name(s, n);
+    unsigned int mask = table->capacity - 1;
+    unsigned int i = hash & mask;
+    for (; table->slots[i] != NULL; i = (i + 1) & mask)
+    {
+        const struct cp_symbol *symbol = table->slots[i];
+        if (symbol->hash == hash && symbol->length == n &&
+                memcmp(symbol->name, s, n) == 0)
+        {
+            return symbol;
+        }
+    }
+
+    if (table->nsymbols >= UINT_MAX - 1)
+    {
+        errno = EOVERFLOW;
+        return NULL;
+    }
+    struct cp_symbol *symbol = cp_arena_alloc(&(table->arena),
+            sizeof(struct cp_symbol) + n + 1);
+    if (symbol == NULL)
+    {
+        return NULL;
+    }
+    symbol->id = ++(table->nsymbols);
+    symbol->hash = hash;
+    symbol->length = n;
+    memcpy(symbol->name, s, n);
+    symbol->name[n] = '\0';
+    table->slots[i] = symbol;
+    return symbol;
+}
+
+
+int grow(cp_symbol_table_t *table)
+{
+    unsigned int capacity = (table->capacity == 0)?
+            CYPHER_PARSER_SYMBOL_TABLE_MIN_CAPACITY : table->capacity * 2;
+    if (capacity <= table->capacity)
+    {
+        errno = EOVERFLOW;
+        return -1;
+    }
+    struct cp_symbol **slots = cp_calloc(capacity, sizeof(struct cp_symbol *));
+    if (slots == NULL)
+    {
+        return -1;
+    }
+    unsigned int mask = capacity - 1;
+    for (unsigned int j = 0; j < table->capacity; ++j)
+    {
+        struct cp_symbol *symbol = table->slots[j];
+        if (symbol == NULL)
+        {
+            continue;
+        }
+        unsigned int i = symbol->hash & mask;
+        for (; slots[i] != NULL; i = (i + 1) & mask)
+            ;
+        slots[i] = symbol;
+    }
+    cp_free(table->slots);
+    table->slots = slots;
+    table->capacity = capacity;
+    return 0;
+}
+
+
+int cp_symbol_table_merge(cp_symbol_table_t *table, cp_symbol_table_t *from)
+{
+    assert(from->next == NULL);
+    for (unsigned int j = 0; j < from->capacity; ++j)
+    {
+        struct cp_symbol *symbol = from->slots[j];
+        if (symbol == NULL)
+        {
+            continue;
+        }
+        const struct cp_symbol *interned = cp_symbol_table_intern(table,
+                symbol->name, symbol->length);
+        if (interned == NULL)
+        {
+            return -1;
+        }
+        symbol->id = interned->id;
+    }
+    // the lookup of names is only required in the first table
+    cp_free(from->slots);
+    from->slots = NULL;
+    from->capacity = 0;
+    from->next = table->next;
+    table->next = from;
+    return 0;
+}
+
+
+void cp_symbol_table_free(cp_symbol_table_t *table)
+{
+    while (table != NULL)
+    {
+        cp_symbol_table_t *next = table->next;
+        cp_free(table->slots);
+        cp_arena_cleanup(&(table->arena));
+        cp_free(table);
+        table = next;
+    }
+}
+
+
+// FNV-1a
+unsigned int cp_hash_name(const char *s, size_t n)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < n; ++i)
+    {
+        hash ^= (unsigned char)s[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
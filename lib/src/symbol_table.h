@@ -0,0 +1,84 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CYPHER_PARSER_SYMBOL_TABLE_H
+#define CYPHER_PARSER_SYMBOL_TABLE_H
+
+#include "arena.h"
+#include <stdlib.h>
+
+
+/*
+ * An interned name, identified by an id that is unique within its table
+ * (and never 0).
+ */
+struct cp_symbol
+{
+    unsigned int id;
+    unsigned int hash;
+    size_t length;
+    char name[];
+};
+
+
+/*
+ * A table of the names used in a segment of parsed input, each stored once.
+ * When the segments of a parse result are merged, the symbols of each
+ * segment are renumbered to those of the first, and the tables are chained
+ * together.
+ */
+typedef struct cp_symbol_table cp_symbol_table_t;
+struct cp_symbol_table
+{
+    cp_symbol_table_t *next;
+    struct cp_symbol **slots;
+    unsigned int capacity;
+    unsigned int nsymbols;
+    cp_arena_t arena;
+};
+
+
+/*
+ * Create an empty table.
+ */
+cp_symbol_table_t *cp_symbol_table(void);
+
+/*
+ * Get the symbol for a name, adding it to the table if not already present.
+ * Returns NULL on failure (and sets errno).
+ */
+const struct cp_symbol *cp_symbol_table_intern(cp_symbol_table_t *table,
+        const char *s, size_t n);
+
+/*
+ * Renumber the symbols of a table to those of another (adding any that
+ * are not present), and chain it after that table. Returns 0 on success,
+ * or -1 on failure (and sets errno).
+ */
+int cp_symbol_table_merge(cp_symbol_table_t *table, cp_symbol_table_t *from);
+
+/*
+ * Free a table, along with all those chained after it.
+ */
+void cp_symbol_table_free(cp_symbol_table_t *table);
+
+/*
+ * Hash a name, as for the symbols of a table.
+ */
+unsigned int cp_hash_name(const char *s, size_t n);
+
+
+#endif/*CYPHER_PARSER_SYMBOL_TABLE_H*/
@@ -36,7 +36,7 @@ ssize_t snprintf_realloc(char ** restrict buf, size_t *bufcap,
     }
     if ((size_t)width > *bufcap)
     {
-        char *newbuf = realloc(*buf, (size_t)width+1);
+        char *newbuf = cp_realloc(*buf, (size_t)width+1);
         if (newbuf == NULL)
         {
             return -1;
@@ -113,7 +113,7 @@ char *line_context(const char *buf, size_t bufsize, size_t *offset,
 
     assert((unsigned int)(endp - startp) == n);
     assert(n <= max_length);
-    char *context = malloc(n + 1);
+    char *context = cp_malloc(n + 1);
     if (context == NULL)
     {
         return NULL;
@@ -18,6 +18,7 @@
 #define CYPHER_PARSER_UTIL_H
 
 #include "cypher-parser.h"
+#include "alloc.h"
 #include <errno.h>
 #include <stddef.h>
 
@@ -144,7 +145,7 @@ static inline void *mdup(const void *src, size_t n)
         return NULL;
     }
 
-    void *dst = malloc(n);
+    void *dst = cp_malloc(n);
     if (dst == NULL)
     {
         return NULL;
@@ -26,7 +26,7 @@
 struct cp_vector *cp_vector(size_t element_size)
 {
     assert(element_size > 0);
-    struct cp_vector *vec = calloc(1, sizeof(struct cp_vector));
+    struct cp_vector *vec = cp_calloc(1, sizeof(struct cp_vector));
     if (vec == NULL)
     {
         return NULL;
@@ -39,7 +39,7 @@ struct cp_vector *cp_vector(size_t element_size)
 void cp_vector_free(struct cp_vector *vec)
 {
     cp_vector_cleanup(vec);
-    free(vec);
+    cp_free(vec);
 }
 
 
@@ -54,7 +54,7 @@ void cp_vector_init(struct cp_vector *vec, size_t element_size)
 
 void cp_vector_cleanup(struct cp_vector *vec)
 {
-    free(vec->elements);
+    cp_free(vec->elements);
     vec->capacity = 0;
     vec->length = 0;
 }
@@ -67,8 +67,8 @@ int cp_vector_push(struct cp_vector *vec, void *element)
     {
         unsigned int newcap = (vec->capacity == 0)?
             CYPHER_VECTOR_BLOCK_SIZE : vec->capacity * 2;
-        void *elements = realloc(vec->elements, newcap * vec->element_size);
-        if (element == NULL)
+        void *elements = cp_realloc(vec->elements, newcap * vec->element_size);
+        if (elements == NULL)
         {
             return -1;
         }
@@ -81,3 +81,34 @@ int cp_vector_push(struct cp_vector *vec, void *element)
     ++(vec->length);
     return 0;
 }
+
+
+int cp_vector_pushn(struct cp_vector *vec, const void *elements,
+        unsigned int n)
+{
+    assert(vec->length <= vec->capacity);
+    if (n > vec->capacity - vec->length)
+    {
+        unsigned int newcap = (vec->capacity == 0)?
+            CYPHER_VECTOR_BLOCK_SIZE : vec->capacity;
+        while (n > newcap - vec->length)
+        {
+            newcap *= 2;
+        }
+        void *nelements = cp_realloc(vec->elements, newcap * vec->element_size);
+        if (nelements == NULL)
+        {
+            return -1;
+        }
+        vec->elements = nelements;
+        vec->capacity = newcap;
+    }
+    assert(n <= vec->capacity - vec->length);
+    if (n > 0)
+    {
+        memcpy(vec->elements + (vec->length * vec->element_size), elements,
+                n * vec->element_size);
+    }
+    vec->length += n;
+    return 0;
+}
@@ -50,6 +50,11 @@
     static inline int name##_push(struct name *s, type element) \
     { return cp_vector_push(&(s->vec), &element); } \
     \
+    __cypherlang_unused __cypherlang_must_check \
+    static inline int name##_pushn(struct name *s, const type *elements, \
+            unsigned int n) \
+    { return cp_vector_pushn(&(s->vec), elements, n); } \
+    \
     __cypherlang_unused \
     static inline type name##_pop(struct name *s) \
     { type *r = cp_vector_pop(&(s->vec)); return (r == NULL)? def:*r; } \
@@ -100,6 +105,9 @@ void cp_vector_cleanup(struct cp_vector *vec);
 
 int cp_vector_push(struct cp_vector *vec, void *element);
 
+int cp_vector_pushn(struct cp_vector *vec, const void *elements,
+        unsigned int n);
+
 static inline void *cp_vector_pop(struct cp_vector *vec)
 {
     return (vec->length > 0)?
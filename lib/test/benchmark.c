@@ -0,0 +1,1364 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "../../lib/src/cypher-parser.h"
+#include <errno.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Parser benchmarks.
+ *
+ * These are not run as part of the test suite. Build using
+ * `make benchmark` in this directory, and run with the name of one or more
+ * benchmarks (or with no arguments to run them all).
+ */
+
+
+struct buffer
+{
+    char *data;
+    size_t length;
+    size_t capacity;
+};
+
+
+static void buffer_printf(struct buffer *buf, const char *fmt, ...)
+{
+    for (;;)
+    {
+        va_list ap;
+        va_start(ap, fmt);
+        size_t avail = buf->capacity - buf->length;
+        int n = vsnprintf(buf->data + buf->length, avail, fmt, ap);
+        va_end(ap);
+        if (n < 0)
+        {
+            perror("vsnprintf");
+            exit(EXIT_FAILURE);
+        }
+        if ((size_t)n < avail)
+        {
+            buf->length += n;
+            return;
+        }
+        size_t capacity = (buf->capacity == 0)? 4096 : buf->capacity * 2;
+        while (capacity - buf->length <= (size_t)n)
+        {
+            capacity *= 2;
+        }
+        char *data = realloc(buf->data, capacity);
+        if (data == NULL)
+        {
+            perror("realloc");
+            exit(EXIT_FAILURE);
+        }
+        buf->data = data;
+        buf->capacity = capacity;
+    }
+}
+
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+
+/*
+ * Run repeatedly (for at least the specified duration) and return the mean
+ * time per run, in seconds.
+ */
+static double time_run(void (*run)(void *data), void *data, double duration)
+{
+    unsigned int iterations = 0;
+    double start = now();
+    double elapsed;
+    do
+    {
+        run(data);
+        ++iterations;
+        elapsed = now() - start;
+    } while (elapsed < duration);
+    return elapsed / iterations;
+}
+
+
+static void check_result(cypher_parse_result_t *result, const char *fname)
+{
+    if (result == NULL)
+    {
+        perror(fname);
+        exit(EXIT_FAILURE);
+    }
+    if (cypher_parse_result_nerrors(result) > 0)
+    {
+        fprintf(stderr, "%s: unexpected parse errors\n", fname);
+        exit(EXIT_FAILURE);
+    }
+    cypher_parse_result_free(result);
+}
+
+
+struct uparse_args
+{
+    const char *s;
+    size_t n;
+    cypher_parser_config_t *config;
+    uint_fast32_t flags;
+};
+
+
+static void run_uparse(void *data)
+{
+    struct uparse_args *args = data;
+    check_result(cypher_uparse(args->s, args->n, NULL, args->config,
+                args->flags), "cypher_uparse");
+}
+
+
+static double time_parse(const char *s, size_t n,
+        cypher_parser_config_t *config, double duration)
+{
+    struct uparse_args args = { .s = s, .n = n, .config = config };
+    return time_run(run_uparse, &args, duration);
+}
+
+
+static void nested_lists(struct buffer *buf, unsigned int depth)
+{
+    buffer_printf(buf, "RETURN ");
+    for (unsigned int i = 0; i < depth; ++i)
+    {
+        buffer_printf(buf, "[");
+    }
+    buffer_printf(buf, "1");
+    for (unsigned int i = 0; i < depth; ++i)
+    {
+        buffer_printf(buf, "]");
+    }
+}
+
+
+static void generated_query(struct buffer *buf, unsigned int nclauses)
+{
+    for (unsigned int i = 0; i < nclauses; ++i)
+    {
+        buffer_printf(buf, "MATCH (n%u:Label {id: $id%u})-[:REL*1..3]->"
+                "(m%u) WHERE n%u.x IN [1, 2, [3, (m%u.y)]] AND "
+                "NOT exists((n%u)-->(:Other))\n", i, i, i, i, i, i);
+        buffer_printf(buf, "WITH DISTINCT n%u, m%u, collect(DISTINCT "
+                "{a: (n%u.a + 1) * 2, b: [x IN m%u.list WHERE x > 0 | "
+                "coalesce(x.v, 0)]}) AS c%u ORDER BY n%u.name SKIP 1 "
+                "LIMIT 10\n", i, i, i, i, i, i);
+    }
+    buffer_printf(buf, "RETURN *;\n");
+}
+
+
+static void report(const char *name, size_t n, double plain, double memo)
+{
+    printf("%-24s %8zu %12.3f %12.3f %9.1fx\n", name, n, plain * 1e3,
+            memo * 1e3, plain / memo);
+}
+
+
+static void memoization(void)
+{
+    cypher_parser_config_t *config = cypher_parser_new_config();
+    if (config == NULL)
+    {
+        perror("cypher_parser_new_config");
+        exit(EXIT_FAILURE);
+    }
+    cypher_parser_config_set_memoization(config, true);
+
+    printf("%-24s %8s %12s %12s %10s\n", "input", "bytes", "plain (ms)",
+            "memo (ms)", "speedup");
+
+    for (unsigned int depth = 4; depth <= 16; depth += 4)
+    {
+        struct buffer buf = { NULL, 0, 0 };
+        nested_lists(&buf, depth);
+        char name[32];
+        snprintf(name, sizeof(name), "nested lists (%u)", depth);
+        report(name, buf.length,
+                time_parse(buf.data, buf.length, NULL, 0.5),
+                time_parse(buf.data, buf.length, config, 0.5));
+        free(buf.data);
+    }
+
+    for (unsigned int nclauses = 10; nclauses <= 1000; nclauses *= 10)
+    {
+        struct buffer buf = { NULL, 0, 0 };
+        generated_query(&buf, nclauses);
+        char name[32];
+        snprintf(name, sizeof(name), "generated (%u clauses)", nclauses * 2);
+        report(name, buf.length,
+                time_parse(buf.data, buf.length, NULL, 0.5),
+                time_parse(buf.data, buf.length, config, 0.5));
+        free(buf.data);
+    }
+
+    cypher_parser_config_free(config);
+}
+
+
+static void run_fparse(void *data)
+{
+    FILE *stream = fopen(data, "r");
+    if (stream == NULL)
+    {
+        perror("fopen");
+        exit(EXIT_FAILURE);
+    }
+    check_result(cypher_fparse(stream, NULL, NULL, 0), "cypher_fparse");
+    fclose(stream);
+}
+
+
+static void run_parse_file(void *data)
+{
+    check_result(cypher_parse_file(data, NULL, NULL, 0), "cypher_parse_file");
+}
+
+
+static int quick_parse_callback(void *data,
+        const cypher_quick_parse_segment_t *segment)
+{
+    return 0;
+}
+
+
+static void run_quick_uparse(void *data)
+{
+    struct uparse_args *args = data;
+    if (cypher_quick_uparse(args->s, args->n, quick_parse_callback, NULL, 0))
+    {
+        perror("cypher_quick_uparse");
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+static void run_quick_fparse(void *data)
+{
+    FILE *stream = fopen(data, "r");
+    if (stream == NULL)
+    {
+        perror("fopen");
+        exit(EXIT_FAILURE);
+    }
+    if (cypher_quick_fparse(stream, quick_parse_callback, NULL, 0))
+    {
+        perror("cypher_quick_fparse");
+        exit(EXIT_FAILURE);
+    }
+    fclose(stream);
+}
+
+
+static void report_throughput(const char *name, size_t n, double t)
+{
+    printf("%-24s %10.3f %10.1f\n", name, t * 1e3, n / t / (1024 * 1024));
+}
+
+
+static void input(void)
+{
+    struct buffer buf = { NULL, 0, 0 };
+    for (unsigned int i = 0; i < 50000; ++i)
+    {
+        buffer_printf(&buf, "MATCH (n%u:Label {id: $id})-[:REL]->(m) "
+                "WHERE n%u.x > %u RETURN m.name, n%u.y AS y;\n", i, i, i, i);
+    }
+
+    char path[] = "/tmp/cypher-benchmark.XXXXXX";
+    int fd = mkstemp(path);
+    FILE *stream = (fd >= 0)? fdopen(fd, "w") : NULL;
+    if (stream == NULL || fwrite(buf.data, 1, buf.length, stream) !=
+                buf.length || fclose(stream))
+    {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%zu bytes\n", buf.length);
+    printf("%-24s %10s %10s\n", "input", "time (ms)", "MiB/s");
+
+    struct uparse_args args = { .s = buf.data, .n = buf.length };
+    report_throughput("cypher_uparse", buf.length,
+            time_run(run_uparse, &args, 2));
+    report_throughput("cypher_fparse", buf.length,
+            time_run(run_fparse, path, 2));
+    report_throughput("cypher_parse_file", buf.length,
+            time_run(run_parse_file, path, 2));
+    report_throughput("cypher_quick_uparse", buf.length,
+            time_run(run_quick_uparse, &args, 2));
+    report_throughput("cypher_quick_fparse", buf.length,
+            time_run(run_quick_fparse, path, 2));
+
+    unlink(path);
+    free(buf.data);
+}
+
+
+struct parser_args
+{
+    cypher_parser_t *parser;
+    const char **queries;
+    unsigned int nqueries;
+};
+
+
+static void run_uparse_queries(void *data)
+{
+    struct parser_args *args = data;
+    for (unsigned int i = 0; i < args->nqueries; ++i)
+    {
+        const char *s = args->queries[i];
+        check_result(cypher_uparse(s, strlen(s), NULL, NULL, 0),
+                "cypher_uparse");
+    }
+}
+
+
+static void run_parser_uparse_queries(void *data)
+{
+    struct parser_args *args = data;
+    for (unsigned int i = 0; i < args->nqueries; ++i)
+    {
+        const char *s = args->queries[i];
+        check_result(cypher_parser_uparse(args->parser, s, strlen(s), NULL,
+                    NULL, 0), "cypher_parser_uparse");
+    }
+}
+
+
+static void parser(void)
+{
+    static const char *queries[] =
+        { "RETURN 1",
+          "MATCH (n) RETURN n",
+          "MATCH (n:Person {name: $name}) RETURN n.age",
+          "MATCH (a)-[:KNOWS]->(b) WHERE a.x > 1 RETURN b LIMIT 10",
+          "CREATE (n:Foo {x: [1, 2, 3]})",
+          "UNWIND $list AS x WITH x WHERE x <> 0 RETURN sum(x)" };
+    struct parser_args args =
+        { .parser = cypher_parser_new(),
+          .queries = queries,
+          .nqueries = sizeof(queries) / sizeof(const char *) };
+    if (args.parser == NULL)
+    {
+        perror("cypher_parser_new");
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%-24s %12s %10s\n", "input", "time (us)", "speedup");
+    double plain = time_run(run_uparse_queries, &args, 2) / args.nqueries;
+    printf("%-24s %12.3f\n", "cypher_uparse", plain * 1e6);
+    double reused = time_run(run_parser_uparse_queries, &args, 2) /
+            args.nqueries;
+    printf("%-24s %12.3f %9.1fx\n", "cypher_parser_uparse", reused * 1e6,
+            plain / reused);
+
+    cypher_parser_free(args.parser);
+}
+
+
+static void arena(void)
+{
+    cypher_parser_config_t *config = cypher_parser_new_config();
+    if (config == NULL)
+    {
+        perror("cypher_parser_new_config");
+        exit(EXIT_FAILURE);
+    }
+    cypher_parser_config_set_arena_allocation(config, true);
+
+    printf("%-24s %8s %12s %12s %10s\n", "input", "bytes", "plain (ms)",
+            "arena (ms)", "speedup");
+
+    for (unsigned int nclauses = 10; nclauses <= 1000; nclauses *= 10)
+    {
+        struct buffer buf = { NULL, 0, 0 };
+        generated_query(&buf, nclauses);
+        char name[32];
+        snprintf(name, sizeof(name), "generated (%u clauses)", nclauses * 2);
+        report(name, buf.length,
+                time_parse(buf.data, buf.length, NULL, 1),
+                time_parse(buf.data, buf.length, config, 1));
+        free(buf.data);
+    }
+
+    struct buffer buf = { NULL, 0, 0 };
+    for (unsigned int i = 0; i < 10000; ++i)
+    {
+        buffer_printf(&buf, "MATCH (n%u:Label {id: $id})-[:REL]->(m) "
+                "WHERE n%u.x > %u RETURN m.name, n%u.y AS y;\n", i, i, i, i);
+    }
+    report("statements (10000)", buf.length,
+            time_parse(buf.data, buf.length, NULL, 1),
+            time_parse(buf.data, buf.length, config, 1));
+    free(buf.data);
+
+    cypher_parser_config_free(config);
+}
+
+
+static void optimistic(void)
+{
+    cypher_parser_config_t *config = cypher_parser_new_config();
+    if (config == NULL)
+    {
+        perror("cypher_parser_new_config");
+        exit(EXIT_FAILURE);
+    }
+    cypher_parser_config_set_optimistic_parsing(config, false);
+
+    printf("%-24s %8s %12s %12s %10s\n", "input", "bytes", "tracked (ms)",
+            "optim. (ms)", "speedup");
+
+    for (unsigned int nclauses = 10; nclauses <= 1000; nclauses *= 10)
+    {
+        struct buffer buf = { NULL, 0, 0 };
+        generated_query(&buf, nclauses);
+        char name[32];
+        snprintf(name, sizeof(name), "generated (%u clauses)", nclauses * 2);
+        report(name, buf.length,
+                time_parse(buf.data, buf.length, config, 1),
+                time_parse(buf.data, buf.length, NULL, 1));
+        free(buf.data);
+    }
+
+    struct buffer buf = { NULL, 0, 0 };
+    for (unsigned int i = 0; i < 10000; ++i)
+    {
+        buffer_printf(&buf, "MATCH (n%u:Label {id: $id})-[:REL]->(m) "
+                "WHERE n%u.x > %u RETURN m.name, n%u.y AS y;\n", i, i, i, i);
+    }
+    report("statements (10000)", buf.length,
+            time_parse(buf.data, buf.length, config, 1),
+            time_parse(buf.data, buf.length, NULL, 1));
+    free(buf.data);
+
+    cypher_parser_config_free(config);
+}
+
+
+static void keywords(void)
+{
+    struct buffer buf = { NULL, 0, 0 };
+    for (unsigned int i = 0; i < 5000; ++i)
+    {
+        buffer_printf(&buf, "OPTIONAL MATCH (n%u:Label)-[r:REL]->(m) "
+                "USING INDEX n%u:Label(id) WHERE n%u.x IS NOT NULL AND "
+                "m.name STARTS WITH 'a' OR m.name ENDS WITH 'z' "
+                "UNWIND range(1, 10) AS x "
+                "MERGE (p:Person {id: x}) ON CREATE SET p.created = true "
+                "ON MATCH SET p.seen = false "
+                "WITH DISTINCT n%u, p ORDER BY p.id DESCENDING SKIP 1 "
+                "LIMIT 5 "
+                "FOREACH (y IN [1, 2] | CREATE (:Foo {y: y})) "
+                "DETACH DELETE m REMOVE p:Old SET p:New "
+                "RETURN CASE WHEN n%u IS NULL THEN 'none' ELSE 'some' END "
+                "AS state ORDER BY state ASC;\n", i, i, i, i, i);
+    }
+
+    printf("%zu bytes\n", buf.length);
+    printf("%-24s %10s %10s\n", "input", "time (ms)", "MiB/s");
+    struct uparse_args args = { .s = buf.data, .n = buf.length };
+    report_throughput("clause keywords", buf.length,
+            time_run(run_uparse, &args, 2));
+    free(buf.data);
+}
+
+
+struct parallel_args
+{
+    const char *s;
+    size_t n;
+    unsigned int nthreads;
+};
+
+
+static void run_uparse_parallel(void *data)
+{
+    struct parallel_args *args = data;
+    check_result(cypher_uparse_parallel(args->s, args->n, args->nthreads,
+                NULL, NULL, 0), "cypher_uparse_parallel");
+}
+
+
+static int fparse_each_callback(void *data, cypher_parse_segment_t *segment)
+{
+    return 0;
+}
+
+
+static void run_fparse_each(void *data)
+{
+    FILE *stream = fopen(data, "r");
+    if (stream == NULL)
+    {
+        perror("fopen");
+        exit(EXIT_FAILURE);
+    }
+    if (cypher_fparse_each(stream, fparse_each_callback, NULL, NULL, NULL, 0))
+    {
+        perror("cypher_fparse_each");
+        exit(EXIT_FAILURE);
+    }
+    fclose(stream);
+}
+
+
+struct fparse_parallel_args
+{
+    const char *path;
+    unsigned int nthreads;
+};
+
+
+static void run_fparse_each_parallel(void *data)
+{
+    struct fparse_parallel_args *args = data;
+    FILE *stream = fopen(args->path, "r");
+    if (stream == NULL)
+    {
+        perror("fopen");
+        exit(EXIT_FAILURE);
+    }
+    if (cypher_fparse_each_parallel(stream, fparse_each_callback, NULL,
+                args->nthreads, NULL, NULL, 0))
+    {
+        perror("cypher_fparse_each_parallel");
+        exit(EXIT_FAILURE);
+    }
+    fclose(stream);
+}
+
+
+static void parallel(void)
+{
+    struct buffer buf = { NULL, 0, 0 };
+    for (unsigned int i = 0; i < 50000; ++i)
+    {
+        buffer_printf(&buf, "MATCH (n%u:Label {id: $id})-[:REL]->(m) "
+                "WHERE n%u.x > %u RETURN m.name, n%u.y AS y;\n", i, i, i, i);
+    }
+
+    printf("%zu bytes\n", buf.length);
+    printf("%-24s %10s %10s\n", "threads", "time (ms)", "MiB/s");
+    struct uparse_args args = { .s = buf.data, .n = buf.length };
+    report_throughput("serial", buf.length, time_run(run_uparse, &args, 2));
+    for (unsigned int nthreads = 1; nthreads <= 8; nthreads *= 2)
+    {
+        struct parallel_args pargs =
+            { .s = buf.data, .n = buf.length, .nthreads = nthreads };
+        char name[32];
+        snprintf(name, sizeof(name), "%u", nthreads);
+        report_throughput(name, buf.length,
+                time_run(run_uparse_parallel, &pargs, 2));
+    }
+
+    char path[] = "/tmp/cypher-benchmark.XXXXXX";
+    int fd = mkstemp(path);
+    FILE *stream = (fd >= 0)? fdopen(fd, "w") : NULL;
+    if (stream == NULL || fwrite(buf.data, 1, buf.length, stream) !=
+                buf.length || fclose(stream))
+    {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%-24s %10s %10s\n", "stream threads", "time (ms)", "MiB/s");
+    report_throughput("serial", buf.length,
+            time_run(run_fparse_each, path, 2));
+    for (unsigned int nthreads = 1; nthreads <= 8; nthreads *= 2)
+    {
+        struct fparse_parallel_args fargs =
+            { .path = path, .nthreads = nthreads };
+        char name[32];
+        snprintf(name, sizeof(name), "%u", nthreads);
+        report_throughput(name, buf.length,
+                time_run(run_fparse_each_parallel, &fargs, 2));
+    }
+
+    unlink(path);
+    free(buf.data);
+}
+
+
+struct batch_args
+{
+    const char **queries;
+    unsigned int nqueries;
+    unsigned int nthreads;
+    cypher_parser_config_t *config;
+};
+
+
+static void run_uparse_each_query(void *data)
+{
+    struct batch_args *args = data;
+    for (unsigned int i = 0; i < args->nqueries; ++i)
+    {
+        const char *s = args->queries[i];
+        check_result(cypher_uparse(s, strlen(s), NULL, args->config, 0),
+                "cypher_uparse");
+    }
+}
+
+
+static void run_uparse_batch(void *data)
+{
+    struct batch_args *args = data;
+    cypher_parse_batch_t *batch = cypher_uparse_batch(args->queries, NULL,
+            args->nqueries, args->nthreads, args->config, 0);
+    if (batch == NULL)
+    {
+        perror("cypher_uparse_batch");
+        exit(EXIT_FAILURE);
+    }
+    cypher_parse_batch_free(batch);
+}
+
+
+static void batch(void)
+{
+    static const char *queries[] =
+        { "RETURN 1",
+          "MATCH (n) RETURN n",
+          "MATCH (n:Person {name: $name}) RETURN n.age",
+          "MATCH (a)-[:KNOWS]->(b) WHERE a.x > 1 RETURN b LIMIT 10",
+          "CREATE (n:Foo {x: [1, 2, 3]})",
+          "UNWIND $list AS x WITH x WHERE x <> 0 RETURN sum(x)" };
+    const unsigned int n = 60000;
+    const char **batch_queries = malloc(n * sizeof(const char *));
+    cypher_parser_config_t *config = cypher_parser_new_config();
+    if (batch_queries == NULL || config == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        batch_queries[i] = queries[i % (sizeof(queries) / sizeof(char *))];
+    }
+    cypher_parser_config_set_arena_allocation(config, true);
+
+    printf("%-24s %12s %12s\n", "input", "plain (us)", "arena (us)");
+    struct batch_args args = { .queries = batch_queries, .nqueries = n };
+    double plain = time_run(run_uparse_each_query, &args, 2) / n;
+    args.config = config;
+    double arena = time_run(run_uparse_each_query, &args, 2) / n;
+    printf("%-24s %12.3f %12.3f\n", "cypher_uparse", plain * 1e6,
+            arena * 1e6);
+    for (unsigned int nthreads = 1; nthreads <= 4; nthreads *= 2)
+    {
+        args.nthreads = nthreads;
+        args.config = NULL;
+        plain = time_run(run_uparse_batch, &args, 2) / n;
+        args.config = config;
+        arena = time_run(run_uparse_batch, &args, 2) / n;
+        char name[32];
+        snprintf(name, sizeof(name), "batch (%u threads)", nthreads);
+        printf("%-24s %12.3f %12.3f\n", name, plain * 1e6, arena * 1e6);
+    }
+
+    cypher_parser_config_free(config);
+    free(batch_queries);
+}
+
+
+struct push_args
+{
+    cypher_parser_t *parser;
+    const char *s;
+    size_t n;
+    size_t chunk_size;
+};
+
+
+static int push_callback(void *data, cypher_parse_segment_t *segment)
+{
+    return 0;
+}
+
+
+static void run_uparse_each(void *data)
+{
+    struct push_args *args = data;
+    if (cypher_parser_uparse_each(args->parser, args->s, args->n,
+                push_callback, NULL, NULL, NULL, 0))
+    {
+        perror("cypher_parser_uparse_each");
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+static void run_feed(void *data)
+{
+    struct push_args *args = data;
+    for (size_t i = 0; i < args->n; i += args->chunk_size)
+    {
+        size_t n = args->n - i;
+        if (n > args->chunk_size)
+        {
+            n = args->chunk_size;
+        }
+        if (cypher_parser_feed(args->parser, args->s + i, n, push_callback,
+                    NULL, NULL, 0))
+        {
+            perror("cypher_parser_feed");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (cypher_parser_finish(args->parser, push_callback, NULL, NULL, NULL,
+                0))
+    {
+        perror("cypher_parser_finish");
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+static void push(void)
+{
+    struct buffer buf = { NULL, 0, 0 };
+    for (unsigned int i = 0; i < 50000; ++i)
+    {
+        buffer_printf(&buf, "MATCH (n%u:Label {id: $id})-[:REL]->(m) "
+                "WHERE n%u.x > %u RETURN m.name, n%u.y AS y;\n", i, i, i, i);
+    }
+
+    struct push_args args =
+        { .parser = cypher_parser_new(), .s = buf.data, .n = buf.length };
+    if (args.parser == NULL)
+    {
+        perror("cypher_parser_new");
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%zu bytes\n", buf.length);
+    printf("%-24s %10s %10s\n", "input", "time (ms)", "MiB/s");
+    report_throughput("uparse_each", buf.length,
+            time_run(run_uparse_each, &args, 2));
+    for (size_t chunk_size = 16; chunk_size <= 16384; chunk_size *= 8)
+    {
+        args.chunk_size = chunk_size;
+        char name[32];
+        snprintf(name, sizeof(name), "feed (%zu bytes)", chunk_size);
+        report_throughput(name, buf.length, time_run(run_feed, &args, 2));
+    }
+
+    // a single statement fed a line at a time, with semicolons in strings
+    buf.length = 0;
+    buffer_printf(&buf, "RETURN [\n");
+    for (unsigned int i = 0; i < 20000; ++i)
+    {
+        buffer_printf(&buf, "'%u;%u',\n", i, i);
+    }
+    buffer_printf(&buf, "0];\n");
+    args.s = buf.data;
+    args.n = buf.length;
+    args.chunk_size = 9;
+    report_throughput("feed (long statement)", buf.length,
+            time_run(run_feed, &args, 2));
+
+    cypher_parser_free(args.parser);
+    free(buf.data);
+}
+
+
+struct keystroke_args
+{
+    const char *s;
+    size_t n;
+};
+
+
+static void run_quick_uparse_keystrokes(void *data)
+{
+    struct keystroke_args *args = data;
+    for (size_t i = 1; i <= args->n; ++i)
+    {
+        if (cypher_quick_uparse(args->s, i, quick_parse_callback, NULL, 0))
+        {
+            perror("cypher_quick_uparse");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+
+static void run_quick_scanner_keystrokes(void *data)
+{
+    struct keystroke_args *args = data;
+    cypher_quick_scanner_t *scanner = cypher_quick_scanner_new(0);
+    if (scanner == NULL)
+    {
+        perror("cypher_quick_scanner_new");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < args->n; ++i)
+    {
+        if (cypher_quick_scanner_feed(scanner, args->s + i, 1,
+                    quick_parse_callback, NULL))
+        {
+            perror("cypher_quick_scanner_feed");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (cypher_quick_scanner_finish(scanner, quick_parse_callback, NULL))
+    {
+        perror("cypher_quick_scanner_finish");
+        exit(EXIT_FAILURE);
+    }
+    cypher_quick_scanner_free(scanner);
+}
+
+
+static void quick_scan(void)
+{
+    printf("%-10s %14s %14s\n", "bytes", "rescan (ms)", "scanner (ms)");
+    for (unsigned int nlines = 16; nlines <= 256; nlines *= 4)
+    {
+        struct buffer buf = { NULL, 0, 0 };
+        for (unsigned int i = 0; i < nlines; ++i)
+        {
+            buffer_printf(&buf, "MATCH (n%u:Label {name: 'n;%u'}) "
+                    "/* line %u */\n", i, i, i);
+        }
+        buffer_printf(&buf, "RETURN *;\n");
+
+        // input typed one character at a time, checking for a complete
+        // statement after each
+        struct keystroke_args args = { .s = buf.data, .n = buf.length };
+        double rescan = time_run(run_quick_uparse_keystrokes, &args, 2);
+        double scanner = time_run(run_quick_scanner_keystrokes, &args, 2);
+        printf("%-10zu %14.3f %14.3f\n", buf.length, rescan * 1e3,
+                scanner * 1e3);
+        free(buf.data);
+    }
+}
+
+
+static double time_validate(const char *s, size_t n, double duration)
+{
+    struct uparse_args args =
+        { .s = s, .n = n, .flags = CYPHER_PARSE_VALIDATE_ONLY };
+    return time_run(run_uparse, &args, duration);
+}
+
+
+static void validate(void)
+{
+    printf("%-24s %8s %12s %12s %10s\n", "input", "bytes", "parse (ms)",
+            "valid. (ms)", "speedup");
+
+    for (unsigned int nclauses = 10; nclauses <= 1000; nclauses *= 10)
+    {
+        struct buffer buf = { NULL, 0, 0 };
+        generated_query(&buf, nclauses);
+        char name[32];
+        snprintf(name, sizeof(name), "generated (%u clauses)", nclauses * 2);
+        report(name, buf.length,
+                time_parse(buf.data, buf.length, NULL, 1),
+                time_validate(buf.data, buf.length, 1));
+        free(buf.data);
+    }
+
+    struct buffer buf = { NULL, 0, 0 };
+    for (unsigned int i = 0; i < 10000; ++i)
+    {
+        buffer_printf(&buf, "MATCH (n%u:Label {id: $id})-[:REL]->(m) "
+                "WHERE n%u.x > %u RETURN m.name, n%u.y AS y;\n", i, i, i, i);
+    }
+    report("statements (10000)", buf.length,
+            time_parse(buf.data, buf.length, NULL, 1),
+            time_validate(buf.data, buf.length, 1));
+    free(buf.data);
+}
+
+
+static volatile unsigned int classification;
+
+
+static void run_classify_queries(void *data)
+{
+    struct parser_args *args = data;
+    for (unsigned int i = 0; i < args->nqueries; ++i)
+    {
+        const char *s = args->queries[i];
+        unsigned int classes;
+        if (cypher_quick_classify(s, strlen(s), &classes, 0))
+        {
+            perror("cypher_quick_classify");
+            exit(EXIT_FAILURE);
+        }
+        classification = classes;
+    }
+}
+
+
+static void classify(void)
+{
+    static const char *queries[] =
+        { "MATCH (n:Person {name: $name}) RETURN n.age",
+          "MATCH (a)-[:KNOWS]->(b) WHERE a.x > 1 RETURN b LIMIT 10",
+          "MERGE (n:Foo {id: $id}) ON CREATE SET n.created = timestamp()",
+          "MATCH (n) WHERE n.name = 'CREATE (m)' DETACH DELETE n",
+          "CALL db.labels() YIELD label RETURN label",
+          "UNWIND $list AS x WITH x WHERE x <> 0 RETURN sum(x)" };
+    struct parser_args args =
+        { .queries = queries,
+          .nqueries = sizeof(queries) / sizeof(const char *) };
+
+    printf("%-24s %12s %10s\n", "input", "time (us)", "speedup");
+    double parse = time_run(run_uparse_queries, &args, 2) / args.nqueries;
+    printf("%-24s %12.3f\n", "cypher_uparse", parse * 1e6);
+    double classify = time_run(run_classify_queries, &args, 2) /
+            args.nqueries;
+    printf("%-24s %12.3f %9.1fx\n", "cypher_quick_classify",
+            classify * 1e6, parse / classify);
+}
+
+
+static double time_shallow(const char *s, size_t n, double duration)
+{
+    struct uparse_args args =
+        { .s = s, .n = n, .flags = CYPHER_PARSE_SHALLOW };
+    return time_run(run_uparse, &args, duration);
+}
+
+
+static void shallow(void)
+{
+    printf("%-24s %8s %12s %12s %10s\n", "input", "bytes", "parse (ms)",
+            "shallow (ms)", "speedup");
+
+    for (unsigned int nclauses = 10; nclauses <= 1000; nclauses *= 10)
+    {
+        struct buffer buf = { NULL, 0, 0 };
+        buffer_printf(&buf, "CYPHER 3.5 planner=cost EXPLAIN ");
+        generated_query(&buf, nclauses);
+        char name[32];
+        snprintf(name, sizeof(name), "generated (%u clauses)", nclauses * 2);
+        report(name, buf.length,
+                time_parse(buf.data, buf.length, NULL, 1),
+                time_shallow(buf.data, buf.length, 1));
+        free(buf.data);
+    }
+}
+
+
+static void run_lazy_last_clause(void *data)
+{
+    struct uparse_args *args = data;
+    cypher_parse_result_t *result = cypher_uparse(args->s, args->n, NULL,
+            NULL, CYPHER_PARSE_LAZY_CLAUSES);
+    if (result == NULL)
+    {
+        perror("cypher_uparse");
+        exit(EXIT_FAILURE);
+    }
+    const cypher_astnode_t *query = cypher_ast_statement_get_body(
+            cypher_parse_result_get_directive(result, 0));
+    unsigned int nclauses = cypher_ast_query_nclauses(query);
+    if (cypher_ast_query_get_clause(query, nclauses - 1) == NULL)
+    {
+        perror("cypher_ast_query_get_clause");
+        exit(EXIT_FAILURE);
+    }
+    check_result(result, "cypher_uparse");
+}
+
+
+static void lazy(void)
+{
+    printf("%-24s %8s %12s %12s %10s\n", "input", "bytes", "parse (ms)",
+            "lazy (ms)", "speedup");
+
+    for (unsigned int nclauses = 10; nclauses <= 1000; nclauses *= 10)
+    {
+        struct buffer buf = { NULL, 0, 0 };
+        generated_query(&buf, nclauses);
+        char name[32];
+        snprintf(name, sizeof(name), "generated (%u clauses)", nclauses * 2);
+        struct uparse_args args = { .s = buf.data, .n = buf.length };
+        report(name, buf.length,
+                time_parse(buf.data, buf.length, NULL, 1),
+                time_run(run_lazy_last_clause, &args, 1));
+        free(buf.data);
+    }
+}
+
+
+struct memory_usage
+{
+    size_t live;
+    size_t peak;
+};
+
+
+// each allocation is prefixed by its size, so that live memory is tracked
+#define ALLOC_HEADER_SIZE sizeof(max_align_t)
+
+
+static void *counting_malloc(void *userdata, size_t size)
+{
+    struct memory_usage *usage = userdata;
+    size_t *p = malloc(ALLOC_HEADER_SIZE + size);
+    if (p == NULL)
+    {
+        return NULL;
+    }
+    *p = size;
+    usage->live += size;
+    usage->peak = (usage->live > usage->peak)? usage->live : usage->peak;
+    return (char *)p + ALLOC_HEADER_SIZE;
+}
+
+
+static void counting_free(void *userdata, void *ptr)
+{
+    if (ptr == NULL)
+    {
+        return;
+    }
+    struct memory_usage *usage = userdata;
+    size_t *p = (size_t *)((char *)ptr - ALLOC_HEADER_SIZE);
+    usage->live -= *p;
+    free(p);
+}
+
+
+static void *counting_realloc(void *userdata, void *ptr, size_t size)
+{
+    if (ptr == NULL)
+    {
+        return counting_malloc(userdata, size);
+    }
+    struct memory_usage *usage = userdata;
+    size_t *p = (size_t *)((char *)ptr - ALLOC_HEADER_SIZE);
+    size_t prev = *p;
+    p = realloc(p, ALLOC_HEADER_SIZE + size);
+    if (p == NULL)
+    {
+        return NULL;
+    }
+    *p = size;
+    usage->live = usage->live - prev + size;
+    usage->peak = (usage->live > usage->peak)? usage->live : usage->peak;
+    return (char *)p + ALLOC_HEADER_SIZE;
+}
+
+
+static unsigned int count_nodes(const cypher_astnode_t *node)
+{
+    unsigned int n = 1;
+    for (unsigned int i = 0; i < cypher_astnode_nchildren(node); ++i)
+    {
+        n += count_nodes(cypher_astnode_get_child(node, i));
+    }
+    return n;
+}
+
+
+static void node_memory(void)
+{
+    struct memory_usage usage = { 0, 0 };
+    cypher_parser_config_t *config = cypher_parser_new_config();
+    if (config == NULL)
+    {
+        perror("cypher_parser_new_config");
+        exit(EXIT_FAILURE);
+    }
+    cypher_parser_config_set_allocator(config, counting_malloc,
+            counting_realloc, counting_free, &usage);
+
+    printf("%-24s %8s %10s %12s %12s\n", "input", "bytes", "nodes",
+            "live (KiB)", "bytes/node");
+
+    for (unsigned int nclauses = 10; nclauses <= 1000; nclauses *= 10)
+    {
+        struct buffer buf = { NULL, 0, 0 };
+        generated_query(&buf, nclauses);
+        cypher_parse_result_t *result = cypher_uparse(buf.data, buf.length,
+                NULL, config, 0);
+        if (result == NULL)
+        {
+            perror("cypher_uparse");
+            exit(EXIT_FAILURE);
+        }
+        unsigned int nnodes = 0;
+        for (unsigned int i = 0; i < cypher_parse_result_nroots(result); ++i)
+        {
+            nnodes += count_nodes(cypher_parse_result_get_root(result, i));
+        }
+        char name[32];
+        snprintf(name, sizeof(name), "generated (%u clauses)", nclauses * 2);
+        printf("%-24s %8zu %10u %12.1f %12.1f\n", name, buf.length, nnodes,
+                usage.live / 1024.0, (double)usage.live / nnodes);
+        check_result(result, "cypher_uparse");
+        free(buf.data);
+    }
+    cypher_parser_config_free(config);
+}
+
+
+static void integer_list(struct buffer *buf, unsigned int n)
+{
+    buffer_printf(buf, "UNWIND [");
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        buffer_printf(buf, (i > 0)? ", %u" : "%u", i * 7919);
+    }
+    buffer_printf(buf, "] AS x RETURN x");
+}
+
+
+static size_t live_memory(const char *s, size_t n, uint_fast32_t flags)
+{
+    struct memory_usage usage = { 0, 0 };
+    cypher_parser_config_t *config = cypher_parser_new_config();
+    if (config == NULL)
+    {
+        perror("cypher_parser_new_config");
+        exit(EXIT_FAILURE);
+    }
+    cypher_parser_config_set_allocator(config, counting_malloc,
+            counting_realloc, counting_free, &usage);
+    cypher_parse_result_t *result = cypher_uparse(s, n, NULL, config, flags);
+    if (result == NULL)
+    {
+        perror("cypher_uparse");
+        exit(EXIT_FAILURE);
+    }
+    size_t live = usage.live;
+    check_result(result, "cypher_uparse");
+    cypher_parser_config_free(config);
+    return live;
+}
+
+
+static void packed_lists(void)
+{
+    printf("%-24s %8s %12s %12s %10s %10s %10s\n", "input", "bytes",
+            "parse (ms)", "packed (ms)", "speedup", "live (KiB)",
+            "packed");
+
+    for (unsigned int n = 100; n <= 100000; n *= 10)
+    {
+        struct buffer buf = { NULL, 0, 0 };
+        integer_list(&buf, n);
+        struct uparse_args args = { .s = buf.data, .n = buf.length,
+            .flags = CYPHER_PARSE_PACKED_LISTS };
+        double plain = time_parse(buf.data, buf.length, NULL, 1);
+        double packed = time_run(run_uparse, &args, 1);
+        char name[32];
+        snprintf(name, sizeof(name), "list (%u integers)", n);
+        printf("%-24s %8zu %12.3f %12.3f %9.1fx %10.1f %10.1f\n", name,
+                buf.length, plain * 1e3, packed * 1e3, plain / packed,
+                live_memory(buf.data, buf.length, 0) / 1024.0,
+                live_memory(buf.data, buf.length,
+                    CYPHER_PARSE_PACKED_LISTS) / 1024.0);
+        free(buf.data);
+    }
+}
+
+
+struct map_lookup_args
+{
+    const cypher_astnode_t *map;
+    unsigned int nentries;
+};
+
+
+static void run_map_scan(void *data)
+{
+    struct map_lookup_args *args = data;
+    for (unsigned int i = 0; i < args->nentries; ++i)
+    {
+        char key[16];
+        snprintf(key, sizeof(key), "key%u", i);
+        const cypher_astnode_t *value = NULL;
+        for (unsigned int j = 0; j < args->nentries; ++j)
+        {
+            const cypher_astnode_t *k = cypher_ast_map_get_key(args->map, j);
+            if (strcmp(cypher_ast_prop_name_get_value(k), key) == 0)
+            {
+                value = cypher_ast_map_get_value(args->map, j);
+            }
+        }
+        if (value == NULL)
+        {
+            abort();
+        }
+    }
+}
+
+
+static void run_map_get_by_key(void *data)
+{
+    struct map_lookup_args *args = data;
+    for (unsigned int i = 0; i < args->nentries; ++i)
+    {
+        char key[16];
+        int n = snprintf(key, sizeof(key), "key%u", i);
+        if (cypher_ast_map_get_by_key(args->map, key, n) == NULL)
+        {
+            abort();
+        }
+    }
+}
+
+
+static void map_lookup(void)
+{
+    printf("%-24s %12s %12s %10s\n", "input", "scan (us)", "index (us)",
+            "speedup");
+
+    for (unsigned int n = 10; n <= 1000; n *= 10)
+    {
+        struct buffer buf = { NULL, 0, 0 };
+        buffer_printf(&buf, "RETURN {");
+        for (unsigned int i = 0; i < n; ++i)
+        {
+            buffer_printf(&buf, "%skey%u: %u", (i > 0)? ", " : "", i, i);
+        }
+        buffer_printf(&buf, "}");
+        cypher_parse_result_t *result = cypher_uparse(buf.data, buf.length,
+                NULL, NULL, 0);
+        if (result == NULL)
+        {
+            perror("cypher_uparse");
+            exit(EXIT_FAILURE);
+        }
+        const cypher_astnode_t *clause = cypher_ast_query_get_clause(
+                cypher_ast_statement_get_body(
+                    cypher_parse_result_get_directive(result, 0)), 0);
+        struct map_lookup_args args =
+            { .map = cypher_ast_projection_get_expression(
+                    cypher_ast_return_get_projection(clause, 0)),
+              .nentries = n };
+        double scan = time_run(run_map_scan, &args, 1) / n;
+        double index = time_run(run_map_get_by_key, &args, 1) / n;
+        char name[32];
+        snprintf(name, sizeof(name), "map (%u entries)", n);
+        printf("%-24s %12.3f %12.3f %9.1fx\n", name, scan * 1e6,
+                index * 1e6, scan / index);
+        check_result(result, "cypher_uparse");
+        free(buf.data);
+    }
+}
+
+
+static void string_literals(struct buffer *buf, unsigned int n)
+{
+    buffer_printf(buf, "// properties\nCREATE (n:Doc {");
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        buffer_printf(buf, "%sp%u: 'value of property number %u' /* %u */",
+                (i > 0)? ", " : "", i, i, i);
+    }
+    buffer_printf(buf, "})");
+}
+
+
+static void retain_input(void)
+{
+    printf("%-24s %8s %12s %12s %10s %10s %10s\n", "input", "bytes",
+            "parse (ms)", "retain (ms)", "speedup", "live (KiB)",
+            "retain");
+
+    for (unsigned int n = 10; n <= 10000; n *= 10)
+    {
+        struct buffer buf = { NULL, 0, 0 };
+        string_literals(&buf, n);
+        struct uparse_args args = { .s = buf.data, .n = buf.length,
+            .flags = CYPHER_PARSE_RETAIN_INPUT };
+        double plain = time_parse(buf.data, buf.length, NULL, 1);
+        double retain = time_run(run_uparse, &args, 1);
+        char name[32];
+        snprintf(name, sizeof(name), "strings (%u)", n);
+        printf("%-24s %8zu %12.3f %12.3f %9.1fx %10.1f %10.1f\n", name,
+                buf.length, plain * 1e3, retain * 1e3, plain / retain,
+                live_memory(buf.data, buf.length, 0) / 1024.0,
+                live_memory(buf.data, buf.length,
+                    CYPHER_PARSE_RETAIN_INPUT) / 1024.0);
+        free(buf.data);
+    }
+}
+
+
+static struct benchmark
+{
+    const char *name;
+    void (*run)(void);
+} benchmarks[] =
+    { { "memoization", memoization },
+      { "input", input },
+      { "parser", parser },
+      { "arena", arena },
+      { "keywords", keywords },
+      { "optimistic", optimistic },
+      { "parallel", parallel },
+      { "batch", batch },
+      { "push", push },
+      { "quick_scan", quick_scan },
+      { "validate", validate },
+      { "classify", classify },
+      { "shallow", shallow },
+      { "lazy", lazy },
+      { "node_memory", node_memory },
+      { "packed_lists", packed_lists },
+      { "map_lookup", map_lookup },
+      { "retain_input", retain_input } };
+static const unsigned int nbenchmarks =
+    sizeof(benchmarks) / sizeof(struct benchmark);
+
+
+int main(int argc, char *argv[])
+{
+    for (unsigned int i = 0; i < nbenchmarks; ++i)
+    {
+        bool run = (argc <= 1);
+        for (int j = 1; !run && j < argc; ++j)
+        {
+            run = (strcmp(argv[j], benchmarks[i].name) == 0);
+        }
+        if (!run)
+        {
+            continue;
+        }
+        printf("== %s ==\n", benchmarks[i].name);
+        benchmarks[i].run();
+        printf("\n");
+    }
+    return EXIT_SUCCESS;
+}
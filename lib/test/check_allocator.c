@@ -0,0 +1,289 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "../../lib/src/cypher-parser.h"
+#include "memstream.h"
+#include "util.h"
+#include <check.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+
+#define MAGIC 0x5ca1ab1eu
+
+/*
+ * An allocator that tracks the memory it has allocated (and, by checking a
+ * header on each allocation, that it only releases memory it allocated).
+ */
+struct accounting
+{
+    size_t allocated;
+    size_t limit;
+    unsigned int nallocs;
+};
+
+union header
+{
+    struct
+    {
+        unsigned int magic;
+        size_t size;
+    } h;
+    long double align;
+};
+
+
+static void *accounting_malloc(void *userdata, size_t size)
+{
+    struct accounting *acct = userdata;
+    if (acct->limit > 0 && acct->allocated + size > acct->limit)
+    {
+        return NULL;
+    }
+    union header *m = malloc(sizeof(union header) + size);
+    if (m == NULL)
+    {
+        return NULL;
+    }
+    m->h.magic = MAGIC;
+    m->h.size = size;
+    acct->allocated += size;
+    ++(acct->nallocs);
+    return m + 1;
+}
+
+
+static void accounting_free(void *userdata, void *ptr)
+{
+    struct accounting *acct = userdata;
+    if (ptr == NULL)
+    {
+        return;
+    }
+    union header *m = (union header *)ptr - 1;
+    ck_assert_uint_eq(m->h.magic, MAGIC);
+    ck_assert(acct->allocated >= m->h.size);
+    acct->allocated -= m->h.size;
+    m->h.magic = 0;
+    free(m);
+}
+
+
+static void *accounting_realloc(void *userdata, void *ptr, size_t size)
+{
+    if (ptr == NULL)
+    {
+        return accounting_malloc(userdata, size);
+    }
+    union header *m = (union header *)ptr - 1;
+    ck_assert_uint_eq(m->h.magic, MAGIC);
+    void *n = accounting_malloc(userdata, size);
+    if (n == NULL)
+    {
+        return NULL;
+    }
+    memcpy(n, ptr, (m->h.size < size)? m->h.size : size);
+    accounting_free(userdata, ptr);
+    return n;
+}
+
+
+static struct accounting usage;
+static cypher_parser_config_t *config;
+static cypher_parse_result_t *result;
+static char *memstream_buffer;
+static size_t memstream_size;
+static FILE *memstream;
+
+
+static void setup(void)
+{
+    memset(&usage, 0, sizeof(usage));
+    result = NULL;
+    config = cypher_parser_new_config();
+    ck_assert_ptr_ne(config, NULL);
+    cypher_parser_config_set_allocator(config, accounting_malloc,
+            accounting_realloc, accounting_free, &usage);
+    memstream = open_memstream(&memstream_buffer, &memstream_size);
+}
+
+
+static void teardown(void)
+{
+    cypher_parse_result_free(result);
+    cypher_parser_config_free(config);
+    ck_assert_uint_eq(usage.allocated, 0);
+    fclose(memstream);
+    free(memstream_buffer);
+}
+
+
+static const char *query =
+    "MATCH (n:Person {name: 'Bob'})-[r:KNOWS*1..3]->(m)\n"
+    "WHERE n.age > 3 < 5 RETURN [x IN [[1, 2], [3]] | x[0]];\n"
+    "CALL db.labels() YIELD label RETURN label;\n"
+    "RETURN [1, 2;";
+
+
+START_TEST (parse_uses_allocator)
+{
+    result = cypher_parse(query, NULL, config, 0);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_uint_gt(usage.nallocs, 0);
+    ck_assert_uint_gt(usage.allocated, 0);
+
+    cypher_parse_result_t *expected = cypher_parse(query, NULL, NULL, 0);
+    ASSERT_SAME_DESCRIPTION(describe_result(memstream, expected),
+            describe_result(memstream, result));
+    cypher_parse_result_free(expected);
+
+    cypher_parse_result_free(result);
+    result = NULL;
+    ck_assert_uint_eq(usage.allocated, 0);
+}
+END_TEST
+
+
+START_TEST (parse_with_arena_uses_allocator)
+{
+    cypher_parser_config_set_arena_allocation(config, true);
+    result = cypher_parse(query, NULL, config, 0);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_uint_gt(usage.allocated, 0);
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 1);
+}
+END_TEST
+
+
+static int clone_callback(void *data, cypher_parse_segment_t *segment)
+{
+    const cypher_astnode_t *directive =
+            cypher_parse_segment_get_directive(segment);
+    if (directive != NULL)
+    {
+        // allocated using the standard allocator, so freed in the same way
+        cypher_ast_free(cypher_ast_clone(directive));
+    }
+    cypher_parse_segment_retain(segment);
+    *(cypher_parse_segment_t **)data = segment;
+    return 1;
+}
+
+
+START_TEST (segments_use_allocator)
+{
+    cypher_parse_segment_t *segment = NULL;
+    int r = cypher_parse_each(query, clone_callback, &segment, NULL,
+            config, 0);
+    ck_assert_int_eq(r, 0);
+    ck_assert_ptr_ne(segment, NULL);
+    ck_assert_uint_gt(usage.allocated, 0);
+    cypher_parse_segment_release(segment);
+}
+END_TEST
+
+
+START_TEST (parser_uses_allocator)
+{
+    cypher_parser_t *parser = cypher_parser_new();
+    ck_assert_ptr_ne(parser, NULL);
+
+    result = cypher_parser_parse(parser, query, NULL, config, 0);
+    ck_assert_ptr_ne(result, NULL);
+    cypher_parse_result_free(result);
+    result = NULL;
+    // the parser retains memory allocated when parsing
+    ck_assert_uint_gt(usage.allocated, 0);
+
+    result = cypher_parser_parse(parser, query, NULL, NULL, 0);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_uint_eq(usage.allocated, 0);
+    cypher_parse_result_free(result);
+
+    result = cypher_parser_parse(parser, query, NULL, config, 0);
+    ck_assert_ptr_ne(result, NULL);
+    cypher_parser_free(parser);
+}
+END_TEST
+
+
+START_TEST (parse_fails_when_allocation_fails)
+{
+    usage.limit = 64 * 1024;
+    char *input = malloc(64 * 1024);
+    ck_assert_ptr_ne(input, NULL);
+    char *p = input;
+    for (unsigned int i = 0; i < 1000; ++i)
+    {
+        p += sprintf(p, "RETURN %u;", i);
+    }
+
+    errno = 0;
+    result = cypher_parse(input, NULL, config, 0);
+    ck_assert_ptr_eq(result, NULL);
+    ck_assert_int_eq(errno, ENOMEM);
+    ck_assert_uint_eq(usage.allocated, 0);
+    free(input);
+}
+END_TEST
+
+
+START_TEST (batch_uses_allocator)
+{
+    const char *queries[] = { query, "RETURN 1;", "RETURN [1, 2;" };
+    cypher_parser_config_set_arena_allocation(config, true);
+    cypher_parse_batch_t *batch = cypher_uparse_batch(queries, NULL, 3, 1,
+            config, 0);
+    ck_assert_ptr_ne(batch, NULL);
+    ck_assert_uint_gt(usage.allocated, 0);
+    ck_assert_int_eq(cypher_parse_result_nerrors(
+                cypher_parse_batch_get_result(batch, 0)), 1);
+    cypher_parse_batch_free(batch);
+}
+END_TEST
+
+
+START_TEST (validate_only_allocates_less)
+{
+    result = cypher_parse(query, NULL, config, 0);
+    ck_assert_ptr_ne(result, NULL);
+    unsigned int nallocs = usage.nallocs;
+    cypher_parse_result_free(result);
+
+    usage.nallocs = 0;
+    result = cypher_parse(query, NULL, config, CYPHER_PARSE_VALIDATE_ONLY);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 1);
+    ck_assert_uint_lt(usage.nallocs * 4, nallocs);
+}
+END_TEST
+
+
+TCase* allocator_tcase(void)
+{
+    TCase *tc = tcase_create("allocator");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, parse_uses_allocator);
+    tcase_add_test(tc, parse_with_arena_uses_allocator);
+    tcase_add_test(tc, segments_use_allocator);
+    tcase_add_test(tc, parser_uses_allocator);
+    tcase_add_test(tc, parse_fails_when_allocation_fails);
+    tcase_add_test(tc, batch_uses_allocator);
+    tcase_add_test(tc, validate_only_allocates_less);
+    return tc;
+}
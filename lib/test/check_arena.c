@@ -0,0 +1,213 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "../../lib/src/cypher-parser.h"
+#include "memstream.h"
+#include "util.h"
+#include <check.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+
+static cypher_parser_config_t *config;
+static cypher_parse_result_t *result;
+static unsigned int released;
+static char *memstream_buffer;
+static size_t memstream_size;
+static FILE *memstream;
+
+
+static void setup(void)
+{
+    result = NULL;
+    released = 0;
+    config = cypher_parser_new_config();
+    ck_assert_ptr_ne(config, NULL);
+    cypher_parser_config_set_arena_allocation(config, true);
+    memstream = open_memstream(&memstream_buffer, &memstream_size);
+}
+
+
+static void teardown(void)
+{
+    cypher_parse_result_free(result);
+    cypher_parser_config_free(config);
+    fclose(memstream);
+    free(memstream_buffer);
+}
+
+
+static void describe(const char *s, cypher_parser_config_t *c)
+{
+    cypher_parse_result_t *r = cypher_parse(s, NULL, c, 0);
+    describe_result(memstream, r);
+    cypher_parse_result_free(r);
+}
+
+
+static const char *inputs[] =
+    { "MATCH (n:Person {name: 'Bob'})-[r:KNOWS*1..3]->(m)\n"
+        "WHERE n.age > 3 RETURN [x IN [[1, 2], [3]] | x[0]];",
+      "RETURN [[[1], 2]",
+      ":schema\nMATCH (n) RETURN n;\n:help",
+      "CALL db.labels() YIELD label WHERE label <> 'x' RETURN label",
+      "CYPHER 3.0 PROFILE MATCH (n) WHERE 1 < n.x <= 3 RETURN n",
+      "CREATE (n:Foo {x: [1, 2}) RETURN n.x",
+      "/* comment */ MATCH (n) // line\nRETURN n" };
+static const unsigned int ninputs = sizeof(inputs) / sizeof(const char *);
+
+
+START_TEST (parse_same_as_without_arena)
+{
+    for (unsigned int i = 0; i < ninputs; ++i)
+    {
+        ASSERT_SAME_DESCRIPTION(describe(inputs[i], NULL),
+                describe(inputs[i], config));
+    }
+}
+END_TEST
+
+
+START_TEST (parse_large_input)
+{
+    char *input = malloc(16384);
+    ck_assert_ptr_ne(input, NULL);
+    char *p = input;
+    for (unsigned int i = 0; i < 200; ++i)
+    {
+        p += sprintf(p, "MATCH (n%u:Foo) RETURN n%u.x;\n", i, i);
+    }
+
+    result = cypher_parse(input, NULL, config, 0);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 0);
+    ck_assert_int_eq(cypher_parse_result_ndirectives(result), 200);
+
+    ASSERT_SAME_DESCRIPTION(describe(input, NULL),
+            describe_result(memstream, result));
+    free(input);
+}
+END_TEST
+
+
+START_TEST (clone_outlives_result)
+{
+    result = cypher_parse("MATCH (n) WHERE n.x > 1 < 2 RETURN n.y AS y",
+            NULL, config, 0);
+    ck_assert_ptr_ne(result, NULL);
+    const cypher_astnode_t *ast = cypher_parse_result_get_directive(result, 0);
+    ck_assert_ptr_ne(ast, NULL);
+
+    cypher_astnode_t *clone = cypher_ast_clone(ast);
+    ck_assert_ptr_ne(clone, NULL);
+
+    ck_assert(cypher_ast_fprint(clone, memstream, 0, NULL, 0) == 0);
+    fflush(memstream);
+    size_t mid = memstream_size;
+
+    cypher_parse_result_free(result);
+    result = NULL;
+
+    ck_assert(cypher_ast_fprint(clone, memstream, 0, NULL, 0) == 0);
+    fflush(memstream);
+    assert_same_descriptions(memstream_buffer, 0, mid, memstream_size);
+
+    cypher_ast_free(clone);
+}
+END_TEST
+
+
+static void release_handler(void *userdata, const cypher_astnode_t *node,
+        void *annotation)
+{
+    released++;
+}
+
+
+START_TEST (annotations_are_released_on_result_free)
+{
+    result = cypher_parse("MATCH (n:Label) RETURN n", NULL, config, 0);
+    ck_assert_ptr_ne(result, NULL);
+    const cypher_astnode_t *ast = cypher_parse_result_get_directive(result, 0);
+    const cypher_astnode_t *query = cypher_ast_statement_get_body(ast);
+    const cypher_astnode_t *match = cypher_ast_query_get_clause(query, 0);
+
+    cypher_ast_annotation_context_t *ctx = cypher_ast_annotation_context();
+    ck_assert_ptr_ne(ctx, NULL);
+    cypher_ast_annotation_context_set_release_handler(ctx, release_handler,
+            NULL);
+    ck_assert_int_eq(cypher_astnode_attach_annotation(ctx, query,
+                (void *)"foo", NULL), 0);
+    ck_assert_int_eq(cypher_astnode_attach_annotation(ctx, match,
+                (void *)"bar", NULL), 0);
+
+    cypher_parse_result_free(result);
+    result = NULL;
+    ck_assert_int_eq(released, 2);
+
+    cypher_ast_annotation_context_free(ctx);
+    ck_assert_int_eq(released, 2);
+}
+END_TEST
+
+
+static int segment_callback(void *data, cypher_parse_segment_t *segment)
+{
+    cypher_parse_segment_retain(segment);
+    cypher_parse_segment_t **segments = data;
+    for (; *segments != NULL; ++segments)
+        ;
+    *segments = segment;
+    return 0;
+}
+
+
+START_TEST (segments_outlive_parse)
+{
+    cypher_parse_segment_t *segments[4] = { NULL, NULL, NULL, NULL };
+    int r = cypher_parse_each("RETURN 1; MATCH (n) RETURN n; RETURN [1, 2",
+            segment_callback, segments, NULL, config, 0);
+    ck_assert_int_eq(r, 0);
+    ck_assert_ptr_ne(segments[2], NULL);
+    ck_assert_ptr_eq(segments[3], NULL);
+
+    const cypher_astnode_t *ast =
+            cypher_parse_segment_get_directive(segments[1]);
+    ck_assert_ptr_ne(ast, NULL);
+    ck_assert_int_eq(cypher_astnode_type(ast), CYPHER_AST_STATEMENT);
+    ck_assert_int_eq(cypher_parse_segment_nerrors(segments[2]), 1);
+
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        cypher_parse_segment_release(segments[i]);
+    }
+}
+END_TEST
+
+
+TCase* arena_tcase(void)
+{
+    TCase *tc = tcase_create("arena");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, parse_same_as_without_arena);
+    tcase_add_test(tc, parse_large_input);
+    tcase_add_test(tc, clone_outlives_result);
+    tcase_add_test(tc, annotations_are_released_on_result_free);
+    tcase_add_test(tc, segments_outlive_parse);
+    return tc;
+}
@@ -0,0 +1,204 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "../../lib/src/cypher-parser.h"
+#include "memstream.h"
+#include "util.h"
+#include <check.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+
+static const char *queries[] =
+    { "MATCH (n:Person {name: 'Bob'})-[r:KNOWS*1..3]->(m)\n"
+      "WHERE n.age > 3 < 5 RETURN [x IN [[1, 2], [3]] | x[0]];",
+      "CREATE (n {x: 'a;b'}); RETURN 1;",
+      ":help match\nRETURN 2",
+      "RETURN 1 +;",
+      "",
+      "MATCH (n) WHERE n.name = \"it's; here\" RETURN n",
+      "RETURN [1, 2;\nRETURN 3;" };
+#define NQUERIES (sizeof(queries) / sizeof(queries[0]))
+
+
+static cypher_parser_config_t *config;
+static cypher_parse_batch_t *batch;
+static char *memstream_buffer;
+static size_t memstream_size;
+static FILE *memstream;
+
+
+static void setup(void)
+{
+    batch = NULL;
+    config = cypher_parser_new_config();
+    ck_assert_ptr_ne(config, NULL);
+    memstream = open_memstream(&memstream_buffer, &memstream_size);
+    fputc('\n', memstream);
+}
+
+
+static void teardown(void)
+{
+    cypher_parse_batch_free(batch);
+    cypher_parser_config_free(config);
+    fclose(memstream);
+    free(memstream_buffer);
+}
+
+
+static void describe(const char *s, size_t len, cypher_parser_config_t *c,
+        uint_fast32_t flags)
+{
+    cypher_parse_result_t *r = cypher_uparse(s, len, NULL, c, flags);
+    describe_result(memstream, r);
+    cypher_parse_result_free(r);
+}
+
+
+static void assert_matches_uparse(const char **qs, const size_t *lens,
+        unsigned int n, cypher_parser_config_t *c, uint_fast32_t flags)
+{
+    ck_assert_uint_eq(cypher_parse_batch_size(batch), n);
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        size_t len = (lens != NULL)? lens[i] : strlen(qs[i]);
+        ck_assert_int_eq(cypher_parse_batch_get_errno(batch, i), 0);
+        ASSERT_SAME_DESCRIPTION(describe(qs[i], len, c, flags),
+                describe_result(memstream,
+                        cypher_parse_batch_get_result(batch, i)));
+    }
+    ck_assert_ptr_eq(cypher_parse_batch_get_result(batch, n), NULL);
+}
+
+
+START_TEST (parse_batch)
+{
+    batch = cypher_uparse_batch(queries, NULL, NQUERIES, 1, NULL, 0);
+    ck_assert_ptr_ne(batch, NULL);
+    assert_matches_uparse(queries, NULL, NQUERIES, NULL, 0);
+}
+END_TEST
+
+
+START_TEST (parse_batch_with_lengths)
+{
+    size_t lens[NQUERIES];
+    for (unsigned int i = 0; i < NQUERIES; ++i)
+    {
+        // the final character of each query is not parsed
+        size_t len = strlen(queries[i]);
+        lens[i] = (len > 0)? len - 1 : 0;
+    }
+    batch = cypher_uparse_batch(queries, lens, NQUERIES, 1, NULL,
+            CYPHER_PARSE_ONLY_STATEMENTS);
+    ck_assert_ptr_ne(batch, NULL);
+    assert_matches_uparse(queries, lens, NQUERIES, NULL,
+            CYPHER_PARSE_ONLY_STATEMENTS);
+}
+END_TEST
+
+
+START_TEST (parse_empty_batch)
+{
+    batch = cypher_uparse_batch(NULL, NULL, 0, 4, NULL, 0);
+    ck_assert_ptr_ne(batch, NULL);
+    ck_assert_uint_eq(cypher_parse_batch_size(batch), 0);
+    ck_assert_ptr_eq(cypher_parse_batch_get_result(batch, 0), NULL);
+}
+END_TEST
+
+
+START_TEST (parse_batch_isolates_failed_queries)
+{
+    const char *qs[] = { "RETURN 1;", NULL, "RETURN 2;" };
+    batch = cypher_uparse_batch(qs, NULL, 3, 1, NULL, 0);
+    ck_assert_ptr_ne(batch, NULL);
+    ck_assert_uint_eq(cypher_parse_batch_size(batch), 3);
+
+    ck_assert_ptr_eq(cypher_parse_batch_get_result(batch, 1), NULL);
+    ck_assert_int_eq(cypher_parse_batch_get_errno(batch, 1), EINVAL);
+    for (unsigned int i = 0; i < 3; i += 2)
+    {
+        ck_assert_int_eq(cypher_parse_batch_get_errno(batch, i), 0);
+        const cypher_parse_result_t *result =
+                cypher_parse_batch_get_result(batch, i);
+        ck_assert_ptr_ne(result, NULL);
+        ck_assert_uint_eq(cypher_parse_result_ndirectives(result), 1);
+        ck_assert_uint_eq(cypher_parse_result_nerrors(result), 0);
+    }
+}
+END_TEST
+
+
+static const char **generate(unsigned int n)
+{
+    const char **qs = malloc(n * sizeof(const char *));
+    ck_assert_ptr_ne(qs, NULL);
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        qs[i] = queries[i % NQUERIES];
+    }
+    return qs;
+}
+
+
+START_TEST (parse_batch_in_parallel)
+{
+    const char **qs = generate(1000);
+    batch = cypher_uparse_batch(qs, NULL, 1000, 4, NULL, 0);
+    ck_assert_ptr_ne(batch, NULL);
+    assert_matches_uparse(qs, NULL, 1000, NULL, 0);
+    cypher_parse_batch_free(batch);
+
+    batch = cypher_uparse_batch(qs, NULL, 1000, 0, NULL, 0);
+    ck_assert_ptr_ne(batch, NULL);
+    assert_matches_uparse(qs, NULL, 1000, NULL, 0);
+    free(qs);
+}
+END_TEST
+
+
+START_TEST (parse_batch_with_config)
+{
+    const char **qs = generate(1000);
+    struct cypher_input_position position = { .line = 10, .column = 3,
+        .offset = 1000 };
+    cypher_parser_config_set_initial_position(config, position);
+    cypher_parser_config_set_initial_ordinal(config, 42);
+    cypher_parser_config_set_arena_allocation(config, true);
+    batch = cypher_uparse_batch(qs, NULL, 1000, 4, config, 0);
+    ck_assert_ptr_ne(batch, NULL);
+    assert_matches_uparse(qs, NULL, 1000, config, 0);
+    free(qs);
+}
+END_TEST
+
+
+TCase* batch_tcase(void)
+{
+    TCase *tc = tcase_create("batch");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, parse_batch);
+    tcase_add_test(tc, parse_batch_with_lengths);
+    tcase_add_test(tc, parse_empty_batch);
+    tcase_add_test(tc, parse_batch_isolates_failed_queries);
+    tcase_add_test(tc, parse_batch_in_parallel);
+    tcase_add_test(tc, parse_batch_with_config);
+    return tc;
+}
@@ -230,6 +230,36 @@ START_TEST (track_error_position_over_embedded_newline)
 END_TEST
 
 
+START_TEST (track_error_position_over_escaped_newline)
+{
+    result = cypher_parse("RETURN `foo\nbar` MA TCH (n)",
+            NULL, NULL, CYPHER_PARSE_SINGLE);
+    ck_assert_ptr_ne(result, NULL);
+
+    const cypher_astnode_t *ast = cypher_parse_result_get_directive(result, 0);
+    const cypher_astnode_t *query = cypher_ast_statement_get_body(ast);
+    const cypher_astnode_t *clause = cypher_ast_query_get_clause(query, 0);
+    const cypher_astnode_t *proj = cypher_ast_return_get_projection(clause, 0);
+    const cypher_astnode_t *id = cypher_ast_projection_get_expression(proj);
+    ck_assert_int_eq(cypher_astnode_type(id), CYPHER_AST_IDENTIFIER);
+    struct cypher_input_range range = cypher_astnode_range(id);
+    ck_assert_int_eq(range.start.line, 1);
+    ck_assert_int_eq(range.start.column, 8);
+    ck_assert_int_eq(range.start.offset, 7);
+    ck_assert_int_eq(range.end.line, 2);
+    ck_assert_int_eq(range.end.column, 5);
+    ck_assert_int_eq(range.end.offset, 16);
+
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 1);
+    const cypher_parse_error_t *err = cypher_parse_result_get_error(result, 0);
+    struct cypher_input_position pos = cypher_parse_error_position(err);
+    ck_assert_int_eq(pos.line, 2);
+    ck_assert_int_eq(pos.column, 8);
+    ck_assert_int_eq(pos.offset, 19);
+}
+END_TEST
+
+
 START_TEST (track_error_position_across_statements)
 {
     struct cypher_input_position last = cypher_input_position_zero;
@@ -300,6 +330,81 @@ START_TEST (track_error_position_across_statements)
 END_TEST
 
 
+START_TEST (track_errors_independently_of_earlier_segments)
+{
+    // recovering from the first error ends the segment at the semicolon in
+    // the comment, after the parser has looked ahead beyond the error in
+    // the next segment
+    struct cypher_input_position last = cypher_input_position_zero;
+    result = cypher_parse(":\nhunter /*;s\n*/thompson\n", &last, NULL, 0);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(last.offset, 25);
+
+    ck_assert(cypher_parse_result_fprint_ast(result, memstream, 0, NULL, 0) == 0);
+    fflush(memstream);
+    const char *expected = "\n"
+"@0   0..11  error  >>:\\nhunter /*<<\n"
+"@1  12..25  error  >>s\\n*/thompson\\n<<\n";
+    ck_assert_str_eq(memstream_buffer, expected);
+    ck_assert(cypher_parse_result_eof(result));
+
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 2);
+
+    const cypher_parse_error_t *err = cypher_parse_result_get_error(result, 0);
+    struct cypher_input_position pos = cypher_parse_error_position(err);
+    ck_assert_int_eq(pos.line, 1);
+    ck_assert_int_eq(pos.column, 2);
+    ck_assert_int_eq(pos.offset, 1);
+    ck_assert_str_eq(cypher_parse_error_message(err),
+            "Invalid input '\\n': expected a command name");
+
+    err = cypher_parse_result_get_error(result, 1);
+    pos = cypher_parse_error_position(err);
+    ck_assert_int_eq(pos.line, 2);
+    ck_assert_int_eq(pos.column, 12);
+    ck_assert_int_eq(pos.offset, 13);
+    ck_assert_str_eq(cypher_parse_error_message(err),
+            "Invalid input '\\n': expected SET or START");
+}
+END_TEST
+
+
+static unsigned int nsegments;
+static unsigned int segment_nerrors[8];
+static bool segment_eof[8];
+
+
+static int segment_callback(void *data, cypher_parse_segment_t *segment)
+{
+    ck_assert_int_lt(nsegments, 8);
+    segment_nerrors[nsegments] = cypher_parse_segment_nerrors(segment);
+    segment_eof[nsegments] = cypher_parse_segment_is_eof(segment);
+    ++nsegments;
+    return 0;
+}
+
+
+START_TEST (report_errors_in_each_segment)
+{
+    // the same input, parsed one segment at a time: the errors of each
+    // segment must not depend on how far the parser looked ahead while
+    // parsing the segments before it
+    nsegments = 0;
+    struct cypher_input_position last = cypher_input_position_zero;
+    int r = cypher_parse_each(":\nhunter /*;s\n*/thompson\n",
+            segment_callback, NULL, &last, NULL, 0);
+    ck_assert_int_eq(r, 0);
+    ck_assert_int_eq(last.offset, 25);
+
+    ck_assert_int_eq(nsegments, 2);
+    ck_assert_int_eq(segment_nerrors[0], 1);
+    ck_assert(!segment_eof[0]);
+    ck_assert_int_eq(segment_nerrors[1], 1);
+    ck_assert(segment_eof[1]);
+}
+END_TEST
+
+
 TCase* errors_tcase(void)
 {
     TCase *tc = tcase_create("errors");
@@ -310,6 +415,9 @@ TCase* errors_tcase(void)
     tcase_add_test(tc, parse_invalid_query_and_resync);
     tcase_add_test(tc, parse_single_invalid_query);
     tcase_add_test(tc, track_error_position_over_embedded_newline);
+    tcase_add_test(tc, track_error_position_over_escaped_newline);
     tcase_add_test(tc, track_error_position_across_statements);
+    tcase_add_test(tc, track_errors_independently_of_earlier_segments);
+    tcase_add_test(tc, report_errors_in_each_segment);
     return tc;
 }
@@ -695,6 +695,134 @@ START_TEST (parse_subscript_list_with_in_operator)
 }
 END_TEST
 
+
+START_TEST (parse_numeric_literals)
+{
+    result = cypher_parse(
+            "RETURN [42, 0x1F, 0o17, 017, 0, 9223372036854775807, "
+            "9223372036854775808, 0x1FFFFFFFFFFFFFFFF, 08, 0x, 12abc], "
+            "[1.5, .5e1, 3E-2, 1e400, 1e-400, 1.5x, 0e-400, 2.5e-308];",
+            NULL, NULL, 0);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 0);
+
+    const cypher_astnode_t *ast = cypher_parse_result_get_directive(result, 0);
+    const cypher_astnode_t *query = cypher_ast_statement_get_body(ast);
+    const cypher_astnode_t *clause = cypher_ast_query_get_clause(query, 0);
+    const cypher_astnode_t *proj = cypher_ast_return_get_projection(clause, 0);
+    const cypher_astnode_t *list = cypher_ast_projection_get_expression(proj);
+    ck_assert_int_eq(cypher_ast_collection_length(list), 11);
+
+    const int64_t ivalues[] = { 42, 31, 15, 15, 0, INT64_MAX };
+    for (unsigned int i = 0; i < 6; ++i)
+    {
+        const cypher_astnode_t *node = cypher_ast_collection_get(list, i);
+        ck_assert_int_eq(cypher_astnode_type(node), CYPHER_AST_INTEGER);
+        int64_t value = -1;
+        ck_assert_int_eq(cypher_ast_integer_get_value(node, &value), 0);
+        ck_assert(value == ivalues[i]);
+    }
+    for (unsigned int i = 6; i < 11; ++i)
+    {
+        const cypher_astnode_t *node = cypher_ast_collection_get(list, i);
+        ck_assert_int_eq(cypher_astnode_type(node), CYPHER_AST_INTEGER);
+        int64_t value = -1;
+        ck_assert_int_eq(cypher_ast_integer_get_value(node, &value), -1);
+        ck_assert_int_eq(errno, (i < 8)? ERANGE : EINVAL);
+        ck_assert(value == -1);
+    }
+
+    proj = cypher_ast_return_get_projection(clause, 1);
+    list = cypher_ast_projection_get_expression(proj);
+    ck_assert_int_eq(cypher_ast_collection_length(list), 8);
+
+    const double fvalues[] = { 1.5, 5.0, 0.03 };
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        const cypher_astnode_t *node = cypher_ast_collection_get(list, i);
+        ck_assert_int_eq(cypher_astnode_type(node), CYPHER_AST_FLOAT);
+        double value = -1;
+        ck_assert_int_eq(cypher_ast_float_get_value(node, &value), 0);
+        ck_assert(value == fvalues[i]);
+    }
+    double value = -1;
+    const cypher_astnode_t *node = cypher_ast_collection_get(list, 3);
+    ck_assert_int_eq(cypher_ast_float_get_value(node, &value), -1);
+    ck_assert_int_eq(errno, ERANGE);
+    node = cypher_ast_collection_get(list, 4);
+    value = -1;
+    ck_assert_int_eq(cypher_ast_float_get_value(node, &value), -1);
+    ck_assert_int_eq(errno, ERANGE);
+    ck_assert(value == -1);
+    node = cypher_ast_collection_get(list, 5);
+    ck_assert_str_eq(cypher_ast_float_get_valuestr(node), "1.5x");
+    ck_assert_int_eq(cypher_ast_float_get_value(node, &value), -1);
+    ck_assert_int_eq(errno, EINVAL);
+    node = cypher_ast_collection_get(list, 6);
+    ck_assert_int_eq(cypher_ast_float_get_value(node, &value), 0);
+    ck_assert(value == 0);
+    node = cypher_ast_collection_get(list, 7);
+    ck_assert_int_eq(cypher_ast_float_get_value(node, &value), 0);
+    ck_assert(value == 2.5e-308);
+}
+END_TEST
+
+
+START_TEST (parse_map_key_lookup)
+{
+    result = cypher_parse("RETURN {a: 1, ab: 2, `a b`: 3, a: 4}, "
+            "{k0: 0, k1: 1, k2: 2, k3: 3, k4: 4, k5: 5, k6: 6, k7: 7, "
+            "k8: 8, k9: 9, k10: 10, k11: 11}, "
+            "{k0: 0, k1: 1, k2: 2, k3: 3, k4: 4, k5: 5, k6: 6, k7: 7, "
+            "k1: 8}", NULL, NULL, 0);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 0);
+
+    const cypher_astnode_t *ast = cypher_parse_result_get_directive(result, 0);
+    const cypher_astnode_t *query = cypher_ast_statement_get_body(ast);
+    const cypher_astnode_t *clause = cypher_ast_query_get_clause(query, 0);
+    const cypher_astnode_t *proj = cypher_ast_return_get_projection(clause, 0);
+    const cypher_astnode_t *map = cypher_ast_projection_get_expression(proj);
+    ck_assert_int_eq(cypher_astnode_type(map), CYPHER_AST_MAP);
+
+    const cypher_astnode_t *value = cypher_ast_map_get_by_key(map, "a", 1);
+    ck_assert_ptr_eq(value, cypher_ast_map_get_value(map, 3));
+    value = cypher_ast_map_get_by_key(map, "ab", 2);
+    ck_assert_ptr_eq(value, cypher_ast_map_get_value(map, 1));
+    value = cypher_ast_map_get_by_key(map, "a b", 3);
+    ck_assert_ptr_eq(value, cypher_ast_map_get_value(map, 2));
+    ck_assert_ptr_eq(cypher_ast_map_get_by_key(map, "abc", 2),
+            cypher_ast_map_get_value(map, 1));
+    ck_assert_ptr_eq(cypher_ast_map_get_by_key(map, "b", 1), NULL);
+    ck_assert_ptr_eq(cypher_ast_map_get_duplicate_key(map),
+            cypher_ast_map_get_key(map, 3));
+
+    proj = cypher_ast_return_get_projection(clause, 1);
+    map = cypher_ast_projection_get_expression(proj);
+    ck_assert_int_eq(cypher_ast_map_nentries(map), 12);
+    for (unsigned int i = 0; i < 12; ++i)
+    {
+        char key[8];
+        int n = snprintf(key, sizeof(key), "k%u", i);
+        value = cypher_ast_map_get_by_key(map, key, n);
+        ck_assert_ptr_eq(value, cypher_ast_map_get_value(map, i));
+    }
+    ck_assert_ptr_eq(cypher_ast_map_get_by_key(map, "k12", 3), NULL);
+    ck_assert_ptr_eq(cypher_ast_map_get_by_key(map, "k", 1), NULL);
+    ck_assert_ptr_eq(cypher_ast_map_get_duplicate_key(map), NULL);
+
+    proj = cypher_ast_return_get_projection(clause, 2);
+    map = cypher_ast_projection_get_expression(proj);
+    ck_assert_ptr_eq(cypher_ast_map_get_duplicate_key(map),
+            cypher_ast_map_get_key(map, 8));
+    value = cypher_ast_map_get_by_key(map, "k1", 2);
+    ck_assert_ptr_eq(value, cypher_ast_map_get_value(map, 8));
+    value = cypher_ast_map_get_by_key(map, "k7", 2);
+    ck_assert_ptr_eq(value, cypher_ast_map_get_value(map, 7));
+}
+END_TEST
+
+
 TCase* expression_tcase(void)
 {
     TCase *tc = tcase_create("expression");
@@ -708,5 +836,7 @@ TCase* expression_tcase(void)
     tcase_add_test(tc, parse_subscript);
     tcase_add_test(tc, parse_slice);
     tcase_add_test(tc, parse_subscript_list_with_in_operator);
+    tcase_add_test(tc, parse_numeric_literals);
+    tcase_add_test(tc, parse_map_key_lookup);
     return tc;
 }
@@ -0,0 +1,252 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "../../lib/src/cypher-parser.h"
+#include "memstream.h"
+#include "util.h"
+#include <check.h>
+#include <errno.h>
+#include <unistd.h>
+
+
+static cypher_parse_result_t *result;
+static char path[] = "/tmp/check_fparse.XXXXXX";
+static char *memstream_buffer;
+static size_t memstream_size;
+static FILE *memstream;
+
+
+static void setup(void)
+{
+    result = NULL;
+    strcpy(path, "/tmp/check_fparse.XXXXXX");
+    int fd = mkstemp(path);
+    ck_assert(fd >= 0);
+    close(fd);
+    memstream = open_memstream(&memstream_buffer, &memstream_size);
+    fputc('\n', memstream);
+}
+
+
+static void teardown(void)
+{
+    cypher_parse_result_free(result);
+    unlink(path);
+    fclose(memstream);
+    free(memstream_buffer);
+}
+
+
+static const char *multiline_input =
+    "MATCH (n:Person)\nRETURN n.name;\n"
+    "MATCH (n)-[:KNOWS]->(m) WHERE n.age > 3\nRETURN m\n;";
+
+static const char *multiline_expected = "\n"
+" @0   0..31  statement               body=@1\n"
+" @1   0..31  > query                 clauses=[@2, @8]\n"
+" @2   0..17  > > MATCH               pattern=@3\n"
+" @3   6..16  > > > pattern           paths=[@4]\n"
+" @4   6..16  > > > > pattern path    (@5)\n"
+" @5   6..16  > > > > > node pattern  (@6:@7)\n"
+" @6   7..8   > > > > > > identifier  `n`\n"
+" @7   8..15  > > > > > > label       :`Person`\n"
+" @8  17..30  > > RETURN              projections=[@9]\n"
+" @9  24..30  > > > projection        expression=@10, alias=@13\n"
+"@10  24..30  > > > > property        @11.@12\n"
+"@11  24..25  > > > > > identifier    `n`\n"
+"@12  26..30  > > > > > prop name     `name`\n"
+"@13  24..30  > > > > identifier      `n.name`\n"
+"@14  32..82  statement               body=@15\n"
+"@15  32..82  > query                 clauses=[@16, @30]\n"
+"@16  32..72  > > MATCH               pattern=@17, where=@25\n"
+"@17  38..55  > > > pattern           paths=[@18]\n"
+"@18  38..55  > > > > pattern path    (@19)-[@21]-(@23)\n"
+"@19  38..41  > > > > > node pattern  (@20)\n"
+"@20  39..40  > > > > > > identifier  `n`\n"
+"@21  41..52  > > > > > rel pattern   -[:@22]->\n"
+"@22  43..49  > > > > > > rel type    :`KNOWS`\n"
+"@23  52..55  > > > > > node pattern  (@24)\n"
+"@24  53..54  > > > > > > identifier  `m`\n"
+"@25  62..72  > > > comparison        @26 > @29\n"
+"@26  62..68  > > > > property        @27.@28\n"
+"@27  62..63  > > > > > identifier    `n`\n"
+"@28  64..67  > > > > > prop name     `age`\n"
+"@29  70..71  > > > > integer         3\n"
+"@30  72..81  > > RETURN              projections=[@31]\n"
+"@31  79..81  > > > projection        expression=@32\n"
+"@32  79..80  > > > > identifier      `m`\n";
+
+
+START_TEST (fparse_from_pipe)
+{
+    FILE *in = open_pipe_input("RETURN 1;\nRETURN [1,\n2];");
+
+    result = cypher_fparse(in, NULL, NULL, 0);
+    ck_assert_ptr_ne(result, NULL);
+    close_input(in);
+
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 0);
+    ck_assert_int_eq(cypher_parse_result_ndirectives(result), 2);
+    const cypher_astnode_t *last = cypher_parse_result_get_directive(result, 1);
+    struct cypher_input_range range = cypher_astnode_range(last);
+    ck_assert_int_eq(range.start.line, 2);
+    ck_assert_int_eq(range.end.line, 3);
+    ck_assert_int_eq(range.end.offset, 24);
+}
+END_TEST
+
+
+START_TEST (fparse_from_file)
+{
+    write_file(path, multiline_input);
+
+    FILE *in = fopen(path, "r");
+    ck_assert_ptr_ne(in, NULL);
+    result = cypher_fparse(in, NULL, NULL, 0);
+    ck_assert_ptr_ne(result, NULL);
+    close_input(in);
+
+    cypher_parse_result_t *expected = cypher_parse(multiline_input,
+            NULL, NULL, 0);
+    ASSERT_SAME_DESCRIPTION(describe_result(memstream, expected),
+            describe_result(memstream, result));
+    cypher_parse_result_free(expected);
+}
+END_TEST
+
+
+START_TEST (fparse_single_does_not_read_ahead)
+{
+    FILE *in = open_pipe_input("RETURN 1; RETURN 2;\nRETURN 3;");
+
+    result = cypher_fparse(in, NULL, NULL, CYPHER_PARSE_SINGLE);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(cypher_parse_result_ndirectives(result), 1);
+    cypher_parse_result_free(result);
+
+    result = cypher_fparse(in, NULL, NULL, 0);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(cypher_parse_result_ndirectives(result), 2);
+    close_input(in);
+}
+END_TEST
+
+
+START_TEST (parse_file)
+{
+    write_file(path, multiline_input);
+
+    struct cypher_input_position last = cypher_input_position_zero;
+    result = cypher_parse_file(path, &last, NULL, 0);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(last.offset, 82);
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 0);
+    ck_assert_int_eq(cypher_parse_result_ndirectives(result), 2);
+
+    ck_assert(cypher_parse_result_fprint_ast(result, memstream, 0, NULL, 0) == 0);
+    fflush(memstream);
+    ck_assert_str_eq(memstream_buffer, multiline_expected);
+}
+END_TEST
+
+
+START_TEST (parse_empty_file)
+{
+    write_file(path, "");
+
+    struct cypher_input_position last = cypher_input_position_zero;
+    result = cypher_parse_file(path, &last, NULL, 0);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(last.offset, 0);
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 0);
+    ck_assert_int_eq(cypher_parse_result_ndirectives(result), 0);
+}
+END_TEST
+
+
+START_TEST (parse_large_file)
+{
+    char *input = malloc(8192);
+    ck_assert_ptr_ne(input, NULL);
+    char *p = input;
+    for (unsigned int i = 0; i < 100; ++i)
+    {
+        p += sprintf(p, "MATCH (n%u:Foo) RETURN n%u.x;\n", i, i);
+    }
+    sprintf(p, "RETURN [1, 2;\n");
+    write_file(path, input);
+
+    result = cypher_parse_file(path, NULL, NULL, 0);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(cypher_parse_result_ndirectives(result), 100);
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 1);
+
+    cypher_parse_result_t *expected = cypher_parse(input, NULL, NULL, 0);
+    ASSERT_SAME_DESCRIPTION(describe_result(memstream, expected),
+            describe_result(memstream, result));
+    cypher_parse_result_free(expected);
+    free(input);
+}
+END_TEST
+
+
+static int count_callback(void *data, cypher_parse_segment_t *segment)
+{
+    unsigned int *n = data;
+    ++(*n);
+    return 0;
+}
+
+
+START_TEST (parse_file_each)
+{
+    write_file(path, multiline_input);
+
+    unsigned int nsegments = 0;
+    int r = cypher_parse_file_each(path, count_callback, &nsegments, NULL,
+            NULL, 0);
+    ck_assert_int_eq(r, 0);
+    ck_assert_int_eq(nsegments, 2);
+}
+END_TEST
+
+
+START_TEST (parse_nonexistent_file)
+{
+    unlink(path);
+    errno = 0;
+    result = cypher_parse_file(path, NULL, NULL, 0);
+    ck_assert_ptr_eq(result, NULL);
+    ck_assert_int_eq(errno, ENOENT);
+}
+END_TEST
+
+
+TCase* fparse_tcase(void)
+{
+    TCase *tc = tcase_create("fparse");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, fparse_from_pipe);
+    tcase_add_test(tc, fparse_from_file);
+    tcase_add_test(tc, fparse_single_does_not_read_ahead);
+    tcase_add_test(tc, parse_file);
+    tcase_add_test(tc, parse_empty_file);
+    tcase_add_test(tc, parse_large_file);
+    tcase_add_test(tc, parse_file_each);
+    tcase_add_test(tc, parse_nonexistent_file);
+    return tc;
+}
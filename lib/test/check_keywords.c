@@ -0,0 +1,106 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "../../lib/src/cypher-parser.h"
+#include "../../lib/src/keywords.h"
+#include <check.h>
+#include <ctype.h>
+#include <string.h>
+
+
+static enum cp_keyword lookup(const char *s)
+{
+    return cp_keyword_lookup(s, strlen(s));
+}
+
+
+START_TEST (lookup_all_keywords)
+{
+    char buf[32];
+    for (int k = CP_KW_ALL; k <= CP_KW_YIELD; ++k)
+    {
+        const char *str = cp_keywords[k].str;
+        ck_assert_uint_eq(cp_keywords[k].length, strlen(str));
+        ck_assert_int_eq(lookup(str), k);
+
+        for (unsigned int i = 0; i <= cp_keywords[k].length; ++i)
+        {
+            buf[i] = toupper(str[i]);
+        }
+        ck_assert_int_eq(lookup(buf), k);
+
+        buf[0] = str[0];
+        ck_assert_int_eq(lookup(buf), k);
+    }
+}
+END_TEST
+
+
+START_TEST (lookup_non_keywords)
+{
+    ck_assert_int_eq(cp_keyword_lookup("match", 0), CP_NO_KEYWORD);
+    ck_assert_int_eq(lookup("n"), CP_NO_KEYWORD);
+    ck_assert_int_eq(lookup("matc"), CP_NO_KEYWORD);
+    ck_assert_int_eq(lookup("matches"), CP_NO_KEYWORD);
+    ck_assert_int_eq(lookup("match_"), CP_NO_KEYWORD);
+    ck_assert_int_eq(lookup("$match"), CP_NO_KEYWORD);
+    ck_assert_int_eq(lookup("m4tch"), CP_NO_KEYWORD);
+    ck_assert_int_eq(lookup("node1"), CP_NO_KEYWORD);
+    ck_assert_int_eq(lookup("nonE"), CP_KW_NONE);
+    ck_assert_int_eq(lookup("remove"), CP_KW_REMOVE);
+    ck_assert_int_eq(lookup("reduce"), CP_KW_REDUCE);
+    ck_assert_int_eq(lookup("allshortestpathsx"), CP_NO_KEYWORD);
+    ck_assert_int_eq(lookup("returned"), CP_NO_KEYWORD);
+    ck_assert_int_eq(lookup("r\xc3\xa9turn"), CP_NO_KEYWORD);
+}
+END_TEST
+
+
+START_TEST (keyword_prefix_length)
+{
+    ck_assert_uint_eq(cp_keyword_prefix_length(CP_KW_MATCH, "MATCH", 5), 5);
+    ck_assert_uint_eq(cp_keyword_prefix_length(CP_KW_MATCH, "matches", 7), 5);
+    ck_assert_uint_eq(cp_keyword_prefix_length(CP_KW_MATCH, "MAT", 3), 3);
+    ck_assert_uint_eq(cp_keyword_prefix_length(CP_KW_MATCH, "Merge", 5), 1);
+    ck_assert_uint_eq(cp_keyword_prefix_length(CP_KW_MATCH, "n", 1), 0);
+    ck_assert_uint_eq(cp_keyword_prefix_length(CP_KW_MATCH, "M@", 2), 1);
+}
+END_TEST
+
+
+START_TEST (parse_names_prefixed_by_keywords)
+{
+    cypher_parse_result_t *result = cypher_parse(
+            "mAtCh (ordering) WITH ordering AS asserted "
+            "RETURN asserted AS returned, ordering.order AS orDer;",
+            NULL, NULL, 0);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 0);
+    cypher_parse_result_free(result);
+}
+END_TEST
+
+
+TCase* keywords_tcase(void)
+{
+    TCase *tc = tcase_create("keywords");
+    tcase_add_test(tc, lookup_all_keywords);
+    tcase_add_test(tc, lookup_non_keywords);
+    tcase_add_test(tc, keyword_prefix_length);
+    tcase_add_test(tc, parse_names_prefixed_by_keywords);
+    return tc;
+}
@@ -0,0 +1,220 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "../../lib/src/cypher-parser.h"
+#include "memstream.h"
+#include <check.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+
+static cypher_parse_result_t *result;
+static char *memstream_buffer;
+static size_t memstream_size;
+static FILE *memstream;
+
+
+static void setup(void)
+{
+    result = NULL;
+    memstream = open_memstream(&memstream_buffer, &memstream_size);
+    fputc('\n', memstream);
+}
+
+
+static void teardown(void)
+{
+    cypher_parse_result_free(result);
+    fclose(memstream);
+    free(memstream_buffer);
+}
+
+
+static const cypher_astnode_t *query(unsigned int i)
+{
+    const cypher_astnode_t *ast = cypher_parse_result_get_directive(result, i);
+    ck_assert_int_eq(cypher_astnode_type(ast), CYPHER_AST_STATEMENT);
+    const cypher_astnode_t *body = cypher_ast_statement_get_body(ast);
+    ck_assert_int_eq(cypher_astnode_type(body), CYPHER_AST_QUERY);
+    return body;
+}
+
+
+START_TEST (parse_lazy_clauses)
+{
+    struct cypher_input_position last = cypher_input_position_zero;
+    result = cypher_parse(
+            "MATCH (n) /* c */ WITH n\nUNION ALL\nRETURN n.x AS y;",
+            &last, NULL, CYPHER_PARSE_LAZY_CLAUSES);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(last.offset, 51);
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 0);
+
+    ck_assert(cypher_parse_result_fprint_ast(result, memstream, 0, NULL, 0) == 0);
+    fflush(memstream);
+    const char *expected = "\n"
+"@0   0..51  statement        body=@1\n"
+"@1   0..51  > query          clauses=[@2, @3, @4, @5]\n"
+"@2   0..18  > > lazy clause  MATCH, 18 bytes\n"
+"@3  18..25  > > lazy clause  WITH, 7 bytes\n"
+"@4  25..35  > > lazy clause  UNION, 10 bytes\n"
+"@5  35..50  > > lazy clause  RETURN, 15 bytes\n";
+    ck_assert_str_eq(memstream_buffer, expected);
+
+    const cypher_astnode_t *q = query(0);
+    ck_assert_int_eq(cypher_ast_query_nclauses(q), 4);
+    ck_assert_int_eq(cypher_ast_query_get_clause_type(q, 0), CYPHER_AST_MATCH);
+    ck_assert_int_eq(cypher_ast_query_get_clause_type(q, 1), CYPHER_AST_WITH);
+    ck_assert_int_eq(cypher_ast_query_get_clause_type(q, 2), CYPHER_AST_UNION);
+    ck_assert_int_eq(cypher_ast_query_get_clause_type(q, 3),
+            CYPHER_AST_RETURN);
+}
+END_TEST
+
+
+START_TEST (materialize_lazy_clause)
+{
+    result = cypher_parse("MATCH (n)\nWITH n\nRETURN n.x AS y",
+            NULL, NULL, CYPHER_PARSE_LAZY_CLAUSES);
+    ck_assert_ptr_ne(result, NULL);
+    const cypher_astnode_t *q = query(0);
+
+    const cypher_astnode_t *clause = cypher_ast_query_get_clause(q, 2);
+    ck_assert_ptr_ne(clause, NULL);
+    ck_assert_int_eq(cypher_astnode_type(clause), CYPHER_AST_RETURN);
+    ck_assert_ptr_eq(cypher_ast_query_get_clause(q, 2), clause);
+    ck_assert_ptr_eq(cypher_astnode_get_child(q, 2), clause);
+
+    struct cypher_input_range range = cypher_astnode_range(clause);
+    ck_assert_int_eq(range.start.offset, 17);
+    ck_assert_int_eq(range.start.line, 3);
+    ck_assert_int_eq(range.start.column, 1);
+    ck_assert_int_eq(range.end.offset, 32);
+    ck_assert_int_eq(range.end.line, 3);
+    ck_assert_int_eq(range.end.column, 16);
+
+    ck_assert_int_eq(cypher_ast_return_nprojections(clause), 1);
+    const cypher_astnode_t *proj = cypher_ast_return_get_projection(clause, 0);
+    const cypher_astnode_t *alias = cypher_ast_projection_get_alias(proj);
+    ck_assert_str_eq(cypher_ast_identifier_get_name(alias), "y");
+    range = cypher_astnode_range(alias);
+    ck_assert_int_eq(range.start.offset, 31);
+    ck_assert_int_eq(range.start.line, 3);
+    ck_assert_int_eq(range.start.column, 15);
+
+    clause = cypher_astnode_get_child(q, 0);
+    ck_assert_ptr_ne(clause, NULL);
+    ck_assert_int_eq(cypher_astnode_type(clause), CYPHER_AST_MATCH);
+    ck_assert_ptr_eq(cypher_ast_query_get_clause(q, 0), clause);
+    ck_assert(cypher_ast_fprint(clause, memstream, 0, NULL, 0) == 0);
+    fflush(memstream);
+    const char *expected = "\n"
+"@2  0..10  MATCH               pattern=@3\n"
+"@3  6..9   > pattern           paths=[@4]\n"
+"@4  6..9   > > pattern path    (@5)\n"
+"@5  6..9   > > > node pattern  (@6)\n"
+"@6  7..8   > > > > identifier  `n`\n";
+    ck_assert_str_eq(memstream_buffer, expected);
+}
+END_TEST
+
+
+START_TEST (parse_lazy_clauses_with_comments)
+{
+    result = cypher_parse("MERGE (n) // a\nRETURN /* b */ n",
+            NULL, NULL, CYPHER_PARSE_LAZY_CLAUSES);
+    ck_assert_ptr_ne(result, NULL);
+
+    ck_assert(cypher_parse_result_fprint_ast(result, memstream, 0, NULL, 0) == 0);
+    fflush(memstream);
+    const char *expected = "\n"
+"@0   0..31  statement        body=@1\n"
+"@1   0..31  > query          clauses=[@2, @3]\n"
+"@2   0..15  > > lazy clause  MERGE, 15 bytes\n"
+"@3  15..31  > > lazy clause  RETURN, 16 bytes\n";
+    ck_assert_str_eq(memstream_buffer, expected);
+
+    const cypher_astnode_t *clause = cypher_ast_query_get_clause(query(0), 0);
+    ck_assert_int_eq(cypher_astnode_type(clause), CYPHER_AST_MERGE);
+    ck_assert_int_eq(cypher_astnode_nchildren(clause), 2);
+    ck_assert_int_eq(cypher_astnode_type(cypher_astnode_get_child(clause, 1)),
+            CYPHER_AST_LINE_COMMENT);
+
+    clause = cypher_ast_query_get_clause(query(0), 1);
+    ck_assert_int_eq(cypher_astnode_type(clause), CYPHER_AST_RETURN);
+    ck_assert_int_eq(cypher_astnode_nchildren(clause), 2);
+    ck_assert_int_eq(cypher_astnode_type(cypher_astnode_get_child(clause, 0)),
+            CYPHER_AST_BLOCK_COMMENT);
+}
+END_TEST
+
+
+START_TEST (parse_lazy_clauses_with_errors)
+{
+    struct cypher_input_position last = cypher_input_position_zero;
+    result = cypher_parse("MATCH (n) RETRUN n; RETURN 1;", &last, NULL,
+            CYPHER_PARSE_LAZY_CLAUSES);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(last.offset, 29);
+
+    ck_assert(cypher_parse_result_fprint_ast(result, memstream, 0, NULL, 0) == 0);
+    fflush(memstream);
+    const char *expected = "\n"
+"@0   0..19  statement        body=@1\n"
+"@1   0..19  > query          clauses=[@2]\n"
+"@2   0..10  > > lazy clause  MATCH, 10 bytes\n"
+"@3  10..18  > > error        >>RETRUN n<<\n"
+"@4  20..29  statement        body=@5\n"
+"@5  20..29  > query          clauses=[@6]\n"
+"@6  20..28  > > lazy clause  RETURN, 8 bytes\n";
+    ck_assert_str_eq(memstream_buffer, expected);
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 1);
+}
+END_TEST
+
+
+START_TEST (parse_lazy_clauses_with_arena)
+{
+    cypher_parser_config_t *config = cypher_parser_new_config();
+    ck_assert_ptr_ne(config, NULL);
+    cypher_parser_config_set_arena_allocation(config, true);
+    result = cypher_parse("MATCH (n) RETURN n", NULL, config,
+            CYPHER_PARSE_LAZY_CLAUSES);
+    cypher_parser_config_free(config);
+    ck_assert_ptr_ne(result, NULL);
+
+    const cypher_astnode_t *q = query(0);
+    ck_assert_int_eq(cypher_astnode_type(cypher_astnode_get_child(q, 0)),
+            CYPHER_AST_MATCH);
+    ck_assert_int_eq(cypher_astnode_type(cypher_astnode_get_child(q, 1)),
+            CYPHER_AST_RETURN);
+}
+END_TEST
+
+
+TCase* lazy_clauses_tcase(void)
+{
+    TCase *tc = tcase_create("lazy_clauses");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, parse_lazy_clauses);
+    tcase_add_test(tc, materialize_lazy_clause);
+    tcase_add_test(tc, parse_lazy_clauses_with_comments);
+    tcase_add_test(tc, parse_lazy_clauses_with_errors);
+    tcase_add_test(tc, parse_lazy_clauses_with_arena);
+    return tc;
+}
@@ -0,0 +1,180 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "../../lib/src/cypher-parser.h"
+#include "memstream.h"
+#include "util.h"
+#include <check.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+
+static cypher_parser_config_t *config;
+static cypher_parse_result_t *result;
+static char *memstream_buffer;
+static size_t memstream_size;
+static FILE *memstream;
+
+
+static void setup(void)
+{
+    result = NULL;
+    config = cypher_parser_new_config();
+    cypher_parser_config_set_memoization(config, true);
+    memstream = open_memstream(&memstream_buffer, &memstream_size);
+    fputc('\n', memstream);
+}
+
+
+static void teardown(void)
+{
+    cypher_parse_result_free(result);
+    cypher_parser_config_free(config);
+    fclose(memstream);
+    free(memstream_buffer);
+}
+
+
+static void describe(const char *s, cypher_parser_config_t *c)
+{
+    struct cypher_input_position last = cypher_input_position_zero;
+    cypher_parse_result_t *r = cypher_parse(s, &last, c, 0);
+    describe_last(memstream, last);
+    describe_result(memstream, r);
+    cypher_parse_result_free(r);
+}
+
+
+static void assert_same_parse(const char *s)
+{
+    ASSERT_SAME_DESCRIPTION(describe(s, NULL), describe(s, config));
+}
+
+
+START_TEST (parse_nested_list_literal)
+{
+    struct cypher_input_position last = cypher_input_position_zero;
+    result = cypher_parse("RETURN [[[[1]], 2]]", &last, config, 0);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(last.offset, 19);
+
+    ck_assert(cypher_parse_result_fprint_ast(result, memstream, 0, NULL, 0) == 0);
+    fflush(memstream);
+    const char *expected = "\n"
+" @0   0..19  statement                 body=@1\n"
+" @1   0..19  > query                   clauses=[@2]\n"
+" @2   0..19  > > RETURN                projections=[@3]\n"
+" @3   7..19  > > > projection          expression=@4, alias=@10\n"
+" @4   7..19  > > > > collection        [@5]\n"
+" @5   8..18  > > > > > collection      [@6, @9]\n"
+" @6   9..14  > > > > > > collection    [@7]\n"
+" @7  10..13  > > > > > > > collection  [@8]\n"
+" @8  11..12  > > > > > > > > integer   1\n"
+" @9  16..17  > > > > > > integer       2\n"
+"@10   7..19  > > > > identifier        `[[[[1]], 2]]`\n";
+    ck_assert_str_eq(memstream_buffer, expected);
+}
+END_TEST
+
+
+START_TEST (parse_deeply_nested_expression)
+{
+    unsigned int depth = 200;
+    char *query = malloc(7 + (depth * 2) + 2);
+    ck_assert_ptr_ne(query, NULL);
+    char *p = query;
+    p += sprintf(p, "RETURN ");
+    memset(p, '[', depth);
+    p += depth;
+    *(p++) = '1';
+    memset(p, ']', depth);
+    p += depth;
+    *p = '\0';
+
+    result = cypher_parse(query, NULL, config, 0);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 0);
+    ck_assert_int_eq(cypher_parse_result_ndirectives(result), 1);
+
+    const cypher_astnode_t *ast = cypher_parse_result_get_directive(result, 0);
+    const cypher_astnode_t *query_node = cypher_ast_statement_get_body(ast);
+    const cypher_astnode_t *clause = cypher_ast_query_get_clause(query_node, 0);
+    const cypher_astnode_t *proj = cypher_ast_return_get_projection(clause, 0);
+    const cypher_astnode_t *exp = cypher_ast_projection_get_expression(proj);
+    for (unsigned int i = 0; i < depth; ++i)
+    {
+        ck_assert_int_eq(cypher_astnode_type(exp), CYPHER_AST_COLLECTION);
+        ck_assert_int_eq(cypher_ast_collection_length(exp), 1);
+        exp = cypher_ast_collection_get(exp, 0);
+    }
+    ck_assert_int_eq(cypher_astnode_type(exp), CYPHER_AST_INTEGER);
+    free(query);
+}
+END_TEST
+
+
+START_TEST (parse_same_as_without_memoization)
+{
+    assert_same_parse("MATCH (n:Person {name: 'Bob'})-[r:KNOWS*1..3]->(m)\n"
+            "WHERE n.age > 3 AND (m)-->() RETURN [x IN [[1, 2], [3]] | x[0]];");
+    assert_same_parse("RETURN [(a)-->(b:Foo) WHERE b.x | b.y], {k: [[1]]}");
+    assert_same_parse("WITH [1, [2, (3 + 4) * 5]] AS l\n"
+            "UNWIND l AS x RETURN CASE x WHEN 1 THEN [[x]] ELSE x END");
+    assert_same_parse("MATCH p = shortestPath((a)-[*]-(b)) "
+            "RETURN reduce(s = 0, n IN nodes(p) | s + n.v)");
+}
+END_TEST
+
+
+START_TEST (parse_same_errors_as_without_memoization)
+{
+    assert_same_parse("RETURN [[[1], 2]");
+    assert_same_parse("MATCH (n:Person {name: 'Bob'})-[r:KNOWS*1..3]->(m\n"
+            "RETURN n;\nRETURN [[1, 2], [3 +]];");
+    assert_same_parse("RETURN 1; [1,2,3]\nMATCH (n) RETURN (n)-[:R]->;");
+    assert_same_parse("CREATE (n:Foo {x: [1, 2}) RETURN n.x");
+}
+END_TEST
+
+
+START_TEST (parse_long_input)
+{
+    char query[4096];
+    char *p = query;
+    for (unsigned int i = 0; i < 60; ++i)
+    {
+        p += sprintf(p, "MATCH (n%u:Foo {x: [%u]})\n", i, i);
+    }
+    sprintf(p, "RETURN [[n0.x]], n59.x + ;");
+    ck_assert(strlen(query) > 1024);
+    assert_same_parse(query);
+}
+END_TEST
+
+
+TCase* memoization_tcase(void)
+{
+    TCase *tc = tcase_create("memoization");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, parse_nested_list_literal);
+    tcase_add_test(tc, parse_deeply_nested_expression);
+    tcase_add_test(tc, parse_same_as_without_memoization);
+    tcase_add_test(tc, parse_same_errors_as_without_memoization);
+    tcase_add_test(tc, parse_long_input);
+    return tc;
+}
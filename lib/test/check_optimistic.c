@@ -0,0 +1,140 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "../../lib/src/cypher-parser.h"
+#include "memstream.h"
+#include "util.h"
+#include <check.h>
+#include <errno.h>
+#include <string.h>
+
+
+static cypher_parser_config_t *optimistic;
+static cypher_parser_config_t *pessimistic;
+static char *memstream_buffer;
+static size_t memstream_size;
+static FILE *memstream;
+
+
+static void setup(void)
+{
+    optimistic = cypher_parser_new_config();
+    ck_assert_ptr_ne(optimistic, NULL);
+    cypher_parser_config_set_optimistic_parsing(optimistic, true);
+    pessimistic = cypher_parser_new_config();
+    ck_assert_ptr_ne(pessimistic, NULL);
+    cypher_parser_config_set_optimistic_parsing(pessimistic, false);
+    memstream = open_memstream(&memstream_buffer, &memstream_size);
+}
+
+
+static void teardown(void)
+{
+    cypher_parser_config_free(optimistic);
+    cypher_parser_config_free(pessimistic);
+    fclose(memstream);
+    free(memstream_buffer);
+}
+
+
+static void describe(const char *s, cypher_parser_config_t *c, bool stream)
+{
+    struct cypher_input_position last = cypher_input_position_zero;
+    cypher_parse_result_t *r;
+    if (stream)
+    {
+        FILE *in = open_file_input(s, strlen(s));
+        r = cypher_fparse(in, &last, c, 0);
+        close_input(in);
+    }
+    else
+    {
+        r = cypher_parse(s, &last, c, 0);
+    }
+    describe_last(memstream, last);
+    describe_result(memstream, r);
+    cypher_parse_result_free(r);
+}
+
+
+static void assert_same_parse(const char *s)
+{
+    for (int stream = 0; stream < 2; ++stream)
+    {
+        ASSERT_SAME_DESCRIPTION(describe(s, pessimistic, stream),
+                describe(s, optimistic, stream));
+    }
+}
+
+
+START_TEST (parse_same_as_pessimistic)
+{
+    assert_same_parse("MATCH (n:Person {name: 'Bob'})-[r:KNOWS*1..3]->(m)\n"
+            "WHERE n.age > 3 AND (m)-->() RETURN [x IN [[1, 2], [3]] | x[0]];");
+    assert_same_parse("CREATE INDEX ON :Foo(bar);\n:schema\n"
+            "RETURN CASE x WHEN 1 THEN [[x]] ELSE x END");
+}
+END_TEST
+
+
+START_TEST (parse_same_errors_as_pessimistic)
+{
+    assert_same_parse("RETURN [[[1], 2]");
+    assert_same_parse("MATCH (n:Person {name: 'Bob'})-[r:KNOWS*1..3]->(m\n"
+            "RETURN n;\nRETURN [[1, 2], [3 +]];");
+    assert_same_parse("RETURN 1; [1,2,3]\nMATCH (n) RETURN (n)-[:R]->;");
+    assert_same_parse("MATCH (n)\nWHERE n.x > 1\nRETRUN n;\n"
+            "MATCH (m) RETURN m;\nCREATE (n:Foo {x: [1, 2}) RETURN n.x");
+}
+END_TEST
+
+
+START_TEST (parse_same_errors_as_pessimistic_in_long_input)
+{
+    char query[8192];
+    char *p = query;
+    for (unsigned int i = 0; i < 200; ++i)
+    {
+        p += sprintf(p, "MATCH (n%u:Foo {x: [%u]})\n", i, i);
+    }
+    sprintf(p, "RETURN [[n0.x]], n199.x + ;\nRETURN 1;");
+    ck_assert(strlen(query) > 4096);
+    assert_same_parse(query);
+}
+END_TEST
+
+
+START_TEST (parse_same_errors_with_memoization)
+{
+    cypher_parser_config_set_memoization(optimistic, true);
+    assert_same_parse("RETURN [[[1], 2]");
+    assert_same_parse("MATCH (n:Person {name: 'Bob'})-[r:KNOWS*1..3]->(m\n"
+            "RETURN n;\nRETURN [[1, 2], [3 +]];");
+}
+END_TEST
+
+
+TCase* optimistic_tcase(void)
+{
+    TCase *tc = tcase_create("optimistic");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, parse_same_as_pessimistic);
+    tcase_add_test(tc, parse_same_errors_as_pessimistic);
+    tcase_add_test(tc, parse_same_errors_as_pessimistic_in_long_input);
+    tcase_add_test(tc, parse_same_errors_with_memoization);
+    return tc;
+}
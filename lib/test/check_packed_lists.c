@@ -0,0 +1,270 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "../../lib/src/cypher-parser.h"
+#include "memstream.h"
+#include <check.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+
+static cypher_parse_result_t *result;
+static char *memstream_buffer;
+static size_t memstream_size;
+static FILE *memstream;
+
+
+static void setup(void)
+{
+    result = NULL;
+    memstream = open_memstream(&memstream_buffer, &memstream_size);
+    fputc('\n', memstream);
+}
+
+
+static void teardown(void)
+{
+    cypher_parse_result_free(result);
+    fclose(memstream);
+    free(memstream_buffer);
+}
+
+
+static const cypher_astnode_t *returned(void)
+{
+    const cypher_astnode_t *ast = cypher_parse_result_get_directive(result, 0);
+    ck_assert_int_eq(cypher_astnode_type(ast), CYPHER_AST_STATEMENT);
+    const cypher_astnode_t *query = cypher_ast_statement_get_body(ast);
+    const cypher_astnode_t *clause = cypher_ast_query_get_clause(query, 0);
+    ck_assert_int_eq(cypher_astnode_type(clause), CYPHER_AST_RETURN);
+    const cypher_astnode_t *proj = cypher_ast_return_get_projection(clause, 0);
+    return cypher_ast_projection_get_expression(proj);
+}
+
+
+START_TEST (parse_packed_integers)
+{
+    struct cypher_input_position last = cypher_input_position_zero;
+    result = cypher_parse("RETURN [1, -2 , - 3,\n0x1F] AS l",
+            &last, NULL, CYPHER_PARSE_PACKED_LISTS);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(last.offset, 31);
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 0);
+
+    ck_assert(cypher_parse_result_fprint_ast(result, memstream, 0, NULL, 0) == 0);
+    fflush(memstream);
+    const char *expected = "\n"
+"@0   0..31  statement           body=@1\n"
+"@1   0..31  > query             clauses=[@2]\n"
+"@2   0..31  > > RETURN          projections=[@3]\n"
+"@3   7..31  > > > projection    expression=@4, alias=@5\n"
+"@4   7..26  > > > > collection  packed, 4 integers\n"
+"@5  30..31  > > > > identifier  `l`\n";
+    ck_assert_str_eq(memstream_buffer, expected);
+
+    const cypher_astnode_t *list = returned();
+    ck_assert_int_eq(cypher_ast_collection_length(list), 4);
+    ck_assert_int_eq(cypher_astnode_nchildren(list), 0);
+    const int64_t *values = cypher_ast_collection_get_integers(list);
+    ck_assert_ptr_ne(values, NULL);
+    ck_assert_int_eq(values[0], 1);
+    ck_assert_int_eq(values[1], -2);
+    ck_assert_int_eq(values[2], -3);
+    ck_assert_int_eq(values[3], 31);
+    ck_assert_ptr_eq(cypher_ast_collection_get_floats(list), NULL);
+    ck_assert_ptr_eq(cypher_ast_collection_get_string(list, 0), NULL);
+}
+END_TEST
+
+
+START_TEST (materialize_packed_elements)
+{
+    result = cypher_parse("RETURN [1, -2 , - 3,\n0x1F] AS l",
+            NULL, NULL, CYPHER_PARSE_PACKED_LISTS);
+    ck_assert_ptr_ne(result, NULL);
+    const cypher_astnode_t *list = returned();
+
+    const cypher_astnode_t *element = cypher_ast_collection_get(list, 0);
+    ck_assert_ptr_ne(element, NULL);
+    ck_assert_int_eq(cypher_astnode_type(element), CYPHER_AST_INTEGER);
+    ck_assert_str_eq(cypher_ast_integer_get_valuestr(element), "1");
+    ck_assert_ptr_eq(cypher_ast_collection_get(list, 0), element);
+
+    element = cypher_ast_collection_get(list, 2);
+    ck_assert_int_eq(cypher_astnode_type(element), CYPHER_AST_UNARY_OPERATOR);
+    ck_assert_ptr_eq(cypher_ast_unary_operator_get_operator(element),
+            CYPHER_OP_UNARY_MINUS);
+    struct cypher_input_range range = cypher_astnode_range(element);
+    ck_assert_int_eq(range.start.offset, 16);
+    ck_assert_int_eq(range.end.offset, 19);
+    const cypher_astnode_t *arg =
+            cypher_ast_unary_operator_get_argument(element);
+    ck_assert_int_eq(cypher_astnode_type(arg), CYPHER_AST_INTEGER);
+    ck_assert_str_eq(cypher_ast_integer_get_valuestr(arg), "3");
+    range = cypher_astnode_range(arg);
+    ck_assert_int_eq(range.start.offset, 18);
+    ck_assert_int_eq(range.end.offset, 19);
+
+    element = cypher_ast_collection_get(list, 3);
+    ck_assert_str_eq(cypher_ast_integer_get_valuestr(element), "0x1F");
+    int64_t value;
+    ck_assert(cypher_ast_integer_get_value(element, &value) == 0);
+    ck_assert_int_eq(value, 31);
+    range = cypher_astnode_range(element);
+    ck_assert_int_eq(range.start.offset, 21);
+    ck_assert_int_eq(range.start.line, 2);
+    ck_assert_int_eq(range.start.column, 1);
+    ck_assert_int_eq(range.end.offset, 25);
+
+    ck_assert_ptr_eq(cypher_ast_collection_get(list, 4), NULL);
+}
+END_TEST
+
+
+START_TEST (parse_packed_floats_and_strings)
+{
+    result = cypher_parse("RETURN [1.5e3, -.5], ['a\\n', \"b\"]",
+            NULL, NULL, CYPHER_PARSE_PACKED_LISTS);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 0);
+
+    ck_assert(cypher_parse_result_fprint_ast(result, memstream, 0, NULL, 0) == 0);
+    fflush(memstream);
+    const char *expected = "\n"
+"@0   0..33  statement           body=@1\n"
+"@1   0..33  > query             clauses=[@2]\n"
+"@2   0..33  > > RETURN          projections=[@3, @6]\n"
+"@3   7..19  > > > projection    expression=@4, alias=@5\n"
+"@4   7..19  > > > > collection  packed, 2 floats\n"
+"@5   7..19  > > > > identifier  `[1.5e3, -.5]`\n"
+"@6  21..33  > > > projection    expression=@7, alias=@8\n"
+"@7  21..33  > > > > collection  packed, 2 strings\n"
+"@8  21..33  > > > > identifier  `['a\\n', \"b\"]`\n";
+    ck_assert_str_eq(memstream_buffer, expected);
+
+    const cypher_astnode_t *list = returned();
+    const double *floats = cypher_ast_collection_get_floats(list);
+    ck_assert_ptr_ne(floats, NULL);
+    ck_assert(floats[0] == 1500.0);
+    ck_assert(floats[1] == -0.5);
+    ck_assert_ptr_eq(cypher_ast_collection_get_integers(list), NULL);
+    const cypher_astnode_t *element = cypher_ast_collection_get(list, 1);
+    ck_assert_int_eq(cypher_astnode_type(element), CYPHER_AST_UNARY_OPERATOR);
+    element = cypher_ast_unary_operator_get_argument(element);
+    ck_assert_str_eq(cypher_ast_float_get_valuestr(element), ".5");
+
+    const cypher_astnode_t *clause = cypher_ast_query_get_clause(
+            cypher_ast_statement_get_body(
+                cypher_parse_result_get_directive(result, 0)), 0);
+    list = cypher_ast_projection_get_expression(
+            cypher_ast_return_get_projection(clause, 1));
+    ck_assert_str_eq(cypher_ast_collection_get_string(list, 0), "a\n");
+    ck_assert_str_eq(cypher_ast_collection_get_string(list, 1), "b");
+    ck_assert_ptr_eq(cypher_ast_collection_get_string(list, 2), NULL);
+    element = cypher_ast_collection_get(list, 1);
+    ck_assert_int_eq(cypher_astnode_type(element), CYPHER_AST_STRING);
+    ck_assert_str_eq(cypher_ast_string_get_value(element), "b");
+    struct cypher_input_range range = cypher_astnode_range(element);
+    ck_assert_int_eq(range.start.offset, 29);
+    ck_assert_int_eq(range.end.offset, 32);
+}
+END_TEST
+
+
+START_TEST (parse_unpackable_lists)
+{
+    result = cypher_parse("RETURN [1, 'a'], [1 /* c */, 2], "
+            "[99999999999999999999], [x, 1], []",
+            NULL, NULL, CYPHER_PARSE_PACKED_LISTS);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 0);
+
+    const cypher_astnode_t *clause = cypher_ast_query_get_clause(
+            cypher_ast_statement_get_body(
+                cypher_parse_result_get_directive(result, 0)), 0);
+    ck_assert_int_eq(cypher_ast_return_nprojections(clause), 5);
+    for (unsigned int i = 0; i < 5; ++i)
+    {
+        const cypher_astnode_t *list = cypher_ast_projection_get_expression(
+                cypher_ast_return_get_projection(clause, i));
+        ck_assert_int_eq(cypher_astnode_type(list), CYPHER_AST_COLLECTION);
+        ck_assert_ptr_eq(cypher_ast_collection_get_integers(list), NULL);
+        ck_assert_ptr_eq(cypher_ast_collection_get_floats(list), NULL);
+        ck_assert_int_ge(cypher_astnode_nchildren(list),
+                cypher_ast_collection_length(list));
+    }
+}
+END_TEST
+
+
+START_TEST (clone_packed_collection)
+{
+    result = cypher_parse("RETURN [-1, 2]", NULL, NULL,
+            CYPHER_PARSE_PACKED_LISTS);
+    ck_assert_ptr_ne(result, NULL);
+    const cypher_astnode_t *list = returned();
+
+    cypher_astnode_t *clone = cypher_ast_clone(list);
+    ck_assert_ptr_ne(clone, NULL);
+    ck_assert_int_eq(cypher_ast_collection_length(clone), 2);
+    ck_assert_int_eq(cypher_astnode_nchildren(clone), 2);
+    ck_assert_ptr_eq(cypher_ast_collection_get_integers(clone), NULL);
+
+    const cypher_astnode_t *element = cypher_ast_collection_get(clone, 0);
+    ck_assert_ptr_eq(cypher_astnode_get_child(clone, 0), element);
+    ck_assert_int_eq(cypher_astnode_type(element), CYPHER_AST_UNARY_OPERATOR);
+    struct cypher_input_range range = cypher_astnode_range(element);
+    ck_assert_int_eq(range.start.offset, 8);
+    ck_assert_int_eq(range.end.offset, 10);
+    element = cypher_ast_collection_get(clone, 1);
+    ck_assert_int_eq(cypher_astnode_type(element), CYPHER_AST_INTEGER);
+    ck_assert_str_eq(cypher_ast_integer_get_valuestr(element), "2");
+    cypher_ast_free(clone);
+}
+END_TEST
+
+
+START_TEST (parse_packed_lists_with_arena)
+{
+    cypher_parser_config_t *config = cypher_parser_new_config();
+    ck_assert_ptr_ne(config, NULL);
+    cypher_parser_config_set_arena_allocation(config, true);
+    result = cypher_parse("RETURN [1, 2]", NULL, config,
+            CYPHER_PARSE_PACKED_LISTS);
+    cypher_parser_config_free(config);
+    ck_assert_ptr_ne(result, NULL);
+
+    const cypher_astnode_t *list = returned();
+    ck_assert_int_eq(cypher_astnode_nchildren(list), 2);
+    ck_assert_ptr_eq(cypher_ast_collection_get_integers(list), NULL);
+}
+END_TEST
+
+
+TCase* packed_lists_tcase(void)
+{
+    TCase *tc = tcase_create("packed_lists");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, parse_packed_integers);
+    tcase_add_test(tc, materialize_packed_elements);
+    tcase_add_test(tc, parse_packed_floats_and_strings);
+    tcase_add_test(tc, parse_unpackable_lists);
+    tcase_add_test(tc, clone_packed_collection);
+    tcase_add_test(tc, parse_packed_lists_with_arena);
+    return tc;
+}
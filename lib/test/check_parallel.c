@@ -0,0 +1,300 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "../../lib/src/cypher-parser.h"
+#include "memstream.h"
+#include "util.h"
+#include <check.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+
+static const char *directives[] =
+    { "MATCH (n:Person {name: 'Bob'})-[r:KNOWS*1..3]->(m)\n"
+      "WHERE n.age > 3 < 5 RETURN [x IN [[1, 2], [3]] | x[0]];\n",
+      "/* a comment; with a semicolon */ CREATE (n {x: 'a;b'});\n",
+      ":help match\n",
+      "UNWIND range(1, 10) AS x\n  RETURN `a\nb`, x; // trailing\n",
+      "RETURN 1 +;\n",
+      "MATCH (n) WHERE n.name = \"it's; here\" RETURN n;",
+      "  \n\n",
+      "MERGE (n)-[:R]->(m) ON CREATE SET n.x = 1;\n",
+      "RETURN [1, 2;\n" };
+#define NDIRECTIVES (sizeof(directives) / sizeof(directives[0]))
+
+
+static char *input;
+static cypher_parser_config_t *config;
+static char *memstream_buffer;
+static size_t memstream_size;
+static FILE *memstream;
+
+
+static char *generate(unsigned int n, const char *tail)
+{
+    size_t len = 0;
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        len += strlen(directives[i % NDIRECTIVES]);
+    }
+    char *s = malloc(len + strlen(tail) + 1);
+    ck_assert_ptr_ne(s, NULL);
+    char *p = s;
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        p = stpcpy(p, directives[i % NDIRECTIVES]);
+    }
+    strcpy(p, tail);
+    return s;
+}
+
+
+static void setup(void)
+{
+    input = NULL;
+    config = cypher_parser_new_config();
+    ck_assert_ptr_ne(config, NULL);
+    memstream = open_memstream(&memstream_buffer, &memstream_size);
+}
+
+
+static void teardown(void)
+{
+    free(input);
+    cypher_parser_config_free(config);
+    fclose(memstream);
+    free(memstream_buffer);
+}
+
+
+static void describe(cypher_parse_result_t *r,
+        const struct cypher_input_position *last)
+{
+    describe_last(memstream, *last);
+    describe_result(memstream, r);
+    cypher_parse_result_free(r);
+}
+
+
+static void assert_matches_serial(const char *s, unsigned int nthreads,
+        cypher_parser_config_t *c, uint_fast32_t flags)
+{
+    struct cypher_input_position last = cypher_input_position_zero;
+    ASSERT_SAME_DESCRIPTION(
+            describe(cypher_parse(s, &last, c, flags), &last),
+            describe(cypher_parse_parallel(s, nthreads, &last, c, flags),
+                &last));
+}
+
+
+START_TEST (parse_small_input)
+{
+    assert_matches_serial("RETURN 1; MATCH (n) RETURN n;", 4, NULL, 0);
+}
+END_TEST
+
+
+START_TEST (parse_matches_serial)
+{
+    input = generate(3000, "");
+    ck_assert_uint_gt(strlen(input), 64 * 1024);
+    assert_matches_serial(input, 1, NULL, 0);
+    assert_matches_serial(input, 2, NULL, 0);
+    assert_matches_serial(input, 4, NULL, 0);
+    assert_matches_serial(input, 0, NULL, 0);
+}
+END_TEST
+
+
+START_TEST (parse_only_statements_matches_serial)
+{
+    input = generate(3000, "");
+    assert_matches_serial(input, 4, NULL, CYPHER_PARSE_ONLY_STATEMENTS);
+}
+END_TEST
+
+
+START_TEST (parse_single_matches_serial)
+{
+    input = generate(3000, "");
+    assert_matches_serial(input, 4, NULL, CYPHER_PARSE_SINGLE);
+}
+END_TEST
+
+
+START_TEST (parse_with_unterminated_input_matches_serial)
+{
+    input = generate(3000, "RETURN 'unterminated; MATCH (n) RETURN n;");
+    assert_matches_serial(input, 4, NULL, 0);
+}
+END_TEST
+
+
+START_TEST (parse_with_misaligned_chunks_matches_serial)
+{
+    // the quick parser splits at the semicolons in the escaped names
+    const char *directive = "RETURN `a;b`;\n";
+    size_t len = strlen(directive);
+    input = malloc(5000 * len + 1);
+    ck_assert_ptr_ne(input, NULL);
+    for (unsigned int i = 0; i < 5000; ++i)
+    {
+        memcpy(input + i * len, directive, len);
+    }
+    input[5000 * len] = '\0';
+    assert_matches_serial(input, 4, NULL, 0);
+}
+END_TEST
+
+
+START_TEST (parse_with_config_matches_serial)
+{
+    input = generate(3000, "");
+    struct cypher_input_position position = { .line = 10, .column = 3,
+        .offset = 1000 };
+    cypher_parser_config_set_initial_position(config, position);
+    cypher_parser_config_set_initial_ordinal(config, 42);
+    cypher_parser_config_set_arena_allocation(config, true);
+    assert_matches_serial(input, 4, config, 0);
+}
+END_TEST
+
+
+struct segments_description
+{
+    unsigned int limit;
+    unsigned int n;
+};
+
+
+static int segment_callback(void *data, cypher_parse_segment_t *segment)
+{
+    struct segments_description *d = (struct segments_description *)data;
+    describe_segment(memstream, segment, true);
+    return (++(d->n) == d->limit)? 1 : 0;
+}
+
+
+static void describe_stream(FILE *in, unsigned int nthreads,
+        unsigned int limit, uint_fast32_t flags)
+{
+    struct segments_description d = { .limit = limit };
+    struct cypher_input_position last = cypher_input_position_zero;
+    int r = (nthreads > 0)?
+        cypher_fparse_each_parallel(in, segment_callback, &d, nthreads,
+                &last, NULL, flags) :
+        cypher_fparse_each(in, segment_callback, &d, &last, NULL, flags);
+    ck_assert_int_eq(r, 0);
+    describe_last(memstream, last);
+    close_input(in);
+}
+
+
+static void assert_stream_matches_serial(const char *s, unsigned int limit,
+        uint_fast32_t flags)
+{
+    size_t len = strlen(s);
+    ASSERT_SAME_DESCRIPTION(
+            describe_stream(open_file_input(s, len), 0, limit, flags),
+            describe_stream(open_file_input(s, len), 4, limit, flags));
+    ASSERT_SAME_DESCRIPTION(
+            describe_stream(open_file_input(s, len), 0, limit, flags),
+            describe_stream(open_file_input(s, len), 2, limit, flags));
+}
+
+
+START_TEST (parse_stream_matches_serial)
+{
+    assert_stream_matches_serial("RETURN 1; MATCH (n) RETURN n;", 0, 0);
+    input = generate(20000, "RETURN 'unterminated;\nMATCH (n) RETURN n;");
+    ck_assert_uint_gt(strlen(input), 512 * 1024);
+    assert_stream_matches_serial(input, 0, 0);
+    assert_stream_matches_serial(input, 0, CYPHER_PARSE_ONLY_STATEMENTS);
+}
+END_TEST
+
+
+START_TEST (parse_stream_with_misaligned_chunks_matches_serial)
+{
+    // the quick parser splits at the semicolons in the escaped names, and
+    // the long lines must eventually be split other than at a line end
+    const char *repeated[] = { "RETURN `a;\nb`;\n", "RETURN 1;" };
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+        size_t len = strlen(repeated[i]);
+        input = malloc(50000 * len + 1);
+        ck_assert_ptr_ne(input, NULL);
+        for (unsigned int j = 0; j < 50000; ++j)
+        {
+            memcpy(input + j * len, repeated[i], len);
+        }
+        input[50000 * len] = '\0';
+        assert_stream_matches_serial(input, 0, 0);
+        free(input);
+        input = NULL;
+    }
+}
+END_TEST
+
+
+START_TEST (parse_stream_stops_when_callback_returns)
+{
+    input = generate(20000, "");
+    assert_stream_matches_serial(input, 10000, 0);
+    assert_stream_matches_serial(input, 1, 0);
+}
+END_TEST
+
+
+static int fail_callback(void *data, cypher_parse_segment_t *segment)
+{
+    return (++(*(unsigned int *)data) == 5000)? -2 : 0;
+}
+
+
+START_TEST (parse_stream_fails_when_callback_fails)
+{
+    input = generate(20000, "");
+    FILE *in = open_file_input(input, strlen(input));
+    unsigned int n = 0;
+    int r = cypher_fparse_each_parallel(in, fail_callback, &n, 4, NULL, NULL,
+            0);
+    ck_assert_int_eq(r, -2);
+    ck_assert_uint_eq(n, 5000);
+    close_input(in);
+}
+END_TEST
+
+
+TCase* parallel_tcase(void)
+{
+    TCase *tc = tcase_create("parallel");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, parse_small_input);
+    tcase_add_test(tc, parse_matches_serial);
+    tcase_add_test(tc, parse_only_statements_matches_serial);
+    tcase_add_test(tc, parse_single_matches_serial);
+    tcase_add_test(tc, parse_with_unterminated_input_matches_serial);
+    tcase_add_test(tc, parse_with_misaligned_chunks_matches_serial);
+    tcase_add_test(tc, parse_with_config_matches_serial);
+    tcase_add_test(tc, parse_stream_matches_serial);
+    tcase_add_test(tc, parse_stream_with_misaligned_chunks_matches_serial);
+    tcase_add_test(tc, parse_stream_stops_when_callback_returns);
+    tcase_add_test(tc, parse_stream_fails_when_callback_fails);
+    return tc;
+}
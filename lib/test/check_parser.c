@@ -0,0 +1,224 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "../../lib/src/cypher-parser.h"
+#include "memstream.h"
+#include "util.h"
+#include <check.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+
+static cypher_parser_t *parser;
+static cypher_parse_result_t *result;
+static char *memstream_buffer;
+static size_t memstream_size;
+static FILE *memstream;
+
+
+static void setup(void)
+{
+    result = NULL;
+    parser = cypher_parser_new();
+    ck_assert_ptr_ne(parser, NULL);
+    memstream = open_memstream(&memstream_buffer, &memstream_size);
+}
+
+
+static void teardown(void)
+{
+    cypher_parse_result_free(result);
+    cypher_parser_free(parser);
+    fclose(memstream);
+    free(memstream_buffer);
+}
+
+
+static void describe(cypher_parser_t *p, const char *s,
+        cypher_parser_config_t *config, uint_fast32_t flags)
+{
+    struct cypher_input_position last = cypher_input_position_zero;
+    cypher_parse_result_t *r = (p != NULL)?
+            cypher_parser_parse(p, s, &last, config, flags) :
+            cypher_parse(s, &last, config, flags);
+    describe_last(memstream, last);
+    describe_result(memstream, r);
+    cypher_parse_result_free(r);
+}
+
+
+static void assert_same_parse(const char *s, cypher_parser_config_t *config,
+        uint_fast32_t flags)
+{
+    ASSERT_SAME_DESCRIPTION(describe(NULL, s, config, flags),
+            describe(parser, s, config, flags));
+}
+
+
+static const char *inputs[] =
+    { "MATCH (n:Person {name: 'Bob'})-[r:KNOWS*1..3]->(m)\n"
+        "WHERE n.age > 3 RETURN [x IN [[1, 2], [3]] | x[0]];",
+      "RETURN [[[1], 2]",
+      ":schema\nMATCH (n) RETURN n;\n:help",
+      "RETURN 1; [1,2,3]\nMATCH (n) RETURN (n)-[:R]->;",
+      "",
+      "CREATE (n:Foo {x: [1, 2}) RETURN n.x",
+      "/* comment */ MATCH (n) // line\nRETURN n" };
+static const unsigned int ninputs = sizeof(inputs) / sizeof(const char *);
+
+
+START_TEST (parse_same_as_without_parser)
+{
+    for (unsigned int i = 0; i < ninputs; ++i)
+    {
+        assert_same_parse(inputs[i], NULL, 0);
+    }
+    // and again, reusing state from all the previous inputs
+    for (unsigned int i = ninputs; i-- > 0; )
+    {
+        assert_same_parse(inputs[i], NULL, 0);
+        assert_same_parse(inputs[i], NULL, CYPHER_PARSE_ONLY_STATEMENTS);
+        assert_same_parse(inputs[i], NULL, CYPHER_PARSE_SINGLE);
+    }
+}
+END_TEST
+
+
+START_TEST (parse_with_config)
+{
+    cypher_parser_config_t *config = cypher_parser_new_config();
+    ck_assert_ptr_ne(config, NULL);
+    struct cypher_input_position position = { 10, 3, 97 };
+    cypher_parser_config_set_initial_position(config, position);
+    cypher_parser_config_set_initial_ordinal(config, 5);
+    cypher_parser_config_set_memoization(config, true);
+
+    for (unsigned int i = 0; i < ninputs; ++i)
+    {
+        assert_same_parse(inputs[i], config, 0);
+        assert_same_parse(inputs[i], NULL, 0);
+    }
+
+    cypher_parser_config_free(config);
+}
+END_TEST
+
+
+START_TEST (parse_errors_are_not_retained)
+{
+    result = cypher_parser_parse(parser, "RETURN [1, 2;\nMATCH (n) RETURN",
+            NULL, NULL, 0);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 2);
+    cypher_parse_result_free(result);
+
+    result = cypher_parser_parse(parser, "RETURN 1", NULL, NULL, 0);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 0);
+    ck_assert_int_eq(cypher_parse_result_ndirectives(result), 1);
+}
+END_TEST
+
+
+START_TEST (parse_stream_then_string)
+{
+    FILE *in = open_pipe_input("RETURN 1; RETURN 2;\nRETURN 3;");
+
+    result = cypher_parser_fparse(parser, in, NULL, NULL,
+            CYPHER_PARSE_SINGLE);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(cypher_parse_result_ndirectives(result), 1);
+    cypher_parse_result_free(result);
+
+    // input read ahead from the stream must not be parsed with the string
+    assert_same_parse("MATCH (n) RETURN n", NULL, 0);
+
+    result = cypher_parser_fparse(parser, in, NULL, NULL, 0);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(cypher_parse_result_ndirectives(result), 2);
+    close_input(in);
+
+    assert_same_parse("MATCH (n) RETURN n", NULL, 0);
+}
+END_TEST
+
+
+static int reentrant_callback(void *data, cypher_parse_segment_t *segment)
+{
+    errno = 0;
+    cypher_parse_result_t *r = cypher_parser_parse(parser, "RETURN 1",
+            NULL, NULL, 0);
+    ck_assert_ptr_eq(r, NULL);
+    ck_assert_int_eq(errno, EBUSY);
+    ++(*(unsigned int *)data);
+    return 0;
+}
+
+
+START_TEST (clone_retains_range)
+{
+    result = cypher_parser_parse(parser, "RETURN 1;\n\nMATCH (n)\n  RETURN n",
+            NULL, NULL, 0);
+    ck_assert_ptr_ne(result, NULL);
+    const cypher_astnode_t *ast = cypher_parse_result_get_directive(result, 1);
+    ck_assert_ptr_ne(ast, NULL);
+    struct cypher_input_range range = cypher_astnode_range(ast);
+    ck_assert_int_eq(range.start.line, 3);
+    ck_assert_int_eq(range.start.column, 1);
+    ck_assert_int_eq(range.start.offset, 11);
+    ck_assert_int_eq(range.end.line, 4);
+    ck_assert_int_eq(range.end.column, 11);
+    ck_assert_int_eq(range.end.offset, 31);
+
+    cypher_astnode_t *clone = cypher_ast_clone(ast);
+    ck_assert_ptr_ne(clone, NULL);
+    cypher_parse_result_free(result);
+    result = NULL;
+
+    struct cypher_input_range clone_range = cypher_astnode_range(clone);
+    ck_assert(memcmp(&clone_range, &range, sizeof(range)) == 0);
+    cypher_ast_free(clone);
+}
+END_TEST
+
+
+START_TEST (parse_reentrantly_fails)
+{
+    unsigned int nsegments = 0;
+    int r = cypher_parser_parse_each(parser, "RETURN 1; RETURN 2;",
+            reentrant_callback, &nsegments, NULL, NULL, 0);
+    ck_assert_int_eq(r, 0);
+    ck_assert_int_eq(nsegments, 2);
+
+    assert_same_parse("RETURN 1; RETURN 2;", NULL, 0);
+}
+END_TEST
+
+
+TCase* parser_tcase(void)
+{
+    TCase *tc = tcase_create("parser");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, parse_same_as_without_parser);
+    tcase_add_test(tc, parse_with_config);
+    tcase_add_test(tc, parse_errors_are_not_retained);
+    tcase_add_test(tc, parse_stream_then_string);
+    tcase_add_test(tc, clone_retains_range);
+    tcase_add_test(tc, parse_reentrantly_fails);
+    return tc;
+}
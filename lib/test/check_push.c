@@ -0,0 +1,260 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "../../lib/src/cypher-parser.h"
+#include "memstream.h"
+#include "util.h"
+#include <check.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+
+static const char *input =
+    "MATCH (n:Person {name: 'Bob'})-[r:KNOWS*1..3]->(m)\n"
+    "WHERE n.age > 3 < 5 RETURN [x IN [[1, 2], [3]] | x[0]];\n"
+    "/* a comment; with a semicolon */ CREATE (n {x: 'a;b'});\n"
+    ":help match\n"
+    "UNWIND range(1, 10) AS x\n  RETURN `a\nb`, x; // trailing\n"
+    "RETURN 1 +;\n"
+    "MATCH (n) WHERE n.name = \"it's; here\" RETURN n;\n"
+    "RETURN [1, 2;\n"
+    "RETURN 'unterminated; MATCH (n) RETURN n;";
+
+
+// inputs with errors, where error recovery may end a segment at a semicolon
+// within a comment or string
+static const char *error_inputs[] =
+    { ":\nhunter /*;s\n*/thompson\n",
+      "RETURN 1 +; RETURN 2\n",
+      "MATCH (n) /* ; */ RETRUN n; RETURN 'a;b' +;x",
+      "RETURN [1, 2 // ;\n; :help /* ; */\nRETURN 1 +",
+      "CREATE (n) SET n.x = ; /* unclosed ;\n",
+      "RETURN 1; RETURN 2 +; RETURN 3\n",
+      "RETURN 1 +; RETURN 2; RETURN 3; RETURN 4; RETURN 5; RETURN 6; "
+          "RETURN 7; RETURN 8; RETURN 9\n" };
+
+
+static cypher_parser_t *parser;
+static char *memstream_buffer;
+static size_t memstream_size;
+static FILE *memstream;
+
+
+static void setup(void)
+{
+    parser = cypher_parser_new();
+    ck_assert_ptr_ne(parser, NULL);
+    memstream = open_memstream(&memstream_buffer, &memstream_size);
+    ck_assert_ptr_ne(memstream, NULL);
+}
+
+
+static void teardown(void)
+{
+    cypher_parser_free(parser);
+    fclose(memstream);
+    free(memstream_buffer);
+}
+
+
+struct description
+{
+    unsigned int n;
+    unsigned int limit;
+};
+
+
+static int segment_callback(void *data, cypher_parse_segment_t *segment)
+{
+    struct description *d = (struct description *)data;
+    describe_segment(memstream, segment, true);
+    ++(d->n);
+    return (d->limit > 0 && d->n % d->limit == 0)? 1 : 0;
+}
+
+
+static void describe_serial(const char *s, cypher_parser_config_t *config,
+        uint_fast32_t flags)
+{
+    struct description d = { .limit = 0 };
+    struct cypher_input_position last = cypher_input_position_zero;
+    ck_assert_int_eq(cypher_uparse_each(s, strlen(s), segment_callback, &d,
+                &last, config, flags), 0);
+    describe_last(memstream, last);
+}
+
+
+static void describe_fed(const char *s, size_t chunk_size,
+        cypher_parser_config_t *config, uint_fast32_t flags)
+{
+    struct description d = { .limit = 0 };
+    size_t len = strlen(s);
+    for (size_t i = 0; i < len; i += chunk_size)
+    {
+        size_t n = (len - i < chunk_size)? len - i : chunk_size;
+        ck_assert_int_eq(cypher_parser_feed(parser, s + i, n,
+                    segment_callback, &d, config, flags), 0);
+    }
+    struct cypher_input_position last = cypher_input_position_zero;
+    ck_assert_int_eq(cypher_parser_finish(parser, segment_callback, &d,
+                &last, config, flags), 0);
+    describe_last(memstream, last);
+}
+
+
+static void assert_fed_matches_serial(const char *s, size_t chunk_size,
+        cypher_parser_config_t *config, uint_fast32_t flags)
+{
+    ASSERT_SAME_DESCRIPTION(describe_serial(s, config, flags),
+            describe_fed(s, chunk_size, config, flags));
+}
+
+
+START_TEST (feed_whole_input)
+{
+    assert_fed_matches_serial(input, strlen(input), NULL, 0);
+    // the parser can be reused once the input is finished
+    assert_fed_matches_serial(input, strlen(input), NULL, 0);
+}
+END_TEST
+
+
+START_TEST (feed_input_in_pieces)
+{
+    for (size_t n = 1; n <= 16; ++n)
+    {
+        assert_fed_matches_serial(input, n, NULL, 0);
+    }
+    assert_fed_matches_serial(input, 7, NULL,
+            CYPHER_PARSE_ONLY_STATEMENTS);
+}
+END_TEST
+
+
+START_TEST (feed_errors_in_pieces)
+{
+    unsigned int ninputs = sizeof(error_inputs) / sizeof(error_inputs[0]);
+    for (unsigned int i = 0; i < ninputs; ++i)
+    {
+        const char *s = error_inputs[i];
+        for (size_t n = 1; n <= strlen(s); ++n)
+        {
+            assert_fed_matches_serial(s, n, NULL, 0);
+            assert_fed_matches_serial(s, n, NULL,
+                    CYPHER_PARSE_ONLY_STATEMENTS);
+        }
+    }
+}
+END_TEST
+
+
+START_TEST (feed_input_with_config)
+{
+    cypher_parser_config_t *config = cypher_parser_new_config();
+    ck_assert_ptr_ne(config, NULL);
+    struct cypher_input_position position = { .line = 10, .column = 3,
+        .offset = 1000 };
+    cypher_parser_config_set_initial_position(config, position);
+    cypher_parser_config_set_initial_ordinal(config, 42);
+    cypher_parser_config_set_arena_allocation(config, true);
+    assert_fed_matches_serial(input, 5, config, 0);
+    cypher_parser_config_free(config);
+}
+END_TEST
+
+
+START_TEST (feed_delivers_complete_segments)
+{
+    struct description d = { .limit = 0 };
+    ck_assert_int_eq(cypher_parser_feed(parser, "RETURN 1; RET", 13,
+                segment_callback, &d, NULL, 0), 0);
+    ck_assert_uint_eq(d.n, 1);
+    ck_assert_int_eq(cypher_parser_feed(parser, "URN 2", 5,
+                segment_callback, &d, NULL, 0), 0);
+    ck_assert_uint_eq(d.n, 1);
+    ck_assert_int_eq(cypher_parser_feed(parser, ";\n:help\n", 8,
+                segment_callback, &d, NULL, 0), 0);
+    ck_assert_uint_eq(d.n, 3);
+    ck_assert_int_eq(cypher_parser_feed(parser, "RETURN", 6,
+                segment_callback, &d, NULL, 0), 0);
+    ck_assert_uint_eq(d.n, 3);
+    struct cypher_input_position last = cypher_input_position_zero;
+    ck_assert_int_eq(cypher_parser_finish(parser, segment_callback, &d,
+                &last, NULL, 0), 0);
+    ck_assert_uint_eq(d.n, 4);
+    ck_assert_uint_eq(last.offset, 32);
+    describe_last(memstream, last);
+    fflush(memstream);
+
+    size_t mid = memstream_size;
+    describe_serial("RETURN 1; RETURN 2;\n:help\nRETURN", NULL, 0);
+    fflush(memstream);
+    assert_same_descriptions(memstream_buffer, 0, mid, memstream_size);
+}
+END_TEST
+
+
+START_TEST (feed_stops_when_callback_returns)
+{
+    struct description d = { .limit = 2 };
+    const char *s = "RETURN 1; RETURN 2; RETURN 3; RETURN 4; RETURN";
+    ck_assert_int_eq(cypher_parser_feed(parser, s, strlen(s),
+                segment_callback, &d, NULL, 0), 0);
+    ck_assert_uint_eq(d.n, 2);
+    // the remaining input is parsed even without any further input
+    ck_assert_int_eq(cypher_parser_feed(parser, "", 0,
+                segment_callback, &d, NULL, 0), 0);
+    ck_assert_uint_eq(d.n, 4);
+    ck_assert_int_eq(cypher_parser_finish(parser, segment_callback, &d,
+                NULL, NULL, 0), 0);
+    ck_assert_uint_eq(d.n, 5);
+}
+END_TEST
+
+
+static int feed_callback(void *data, cypher_parse_segment_t *segment)
+{
+    errno = 0;
+    ck_assert_int_eq(cypher_parser_feed(parser, "RETURN 2;", 9,
+                feed_callback, NULL, NULL, 0), -1);
+    ck_assert_int_eq(errno, EBUSY);
+    return -2;
+}
+
+
+START_TEST (feed_from_callback_fails)
+{
+    ck_assert_int_eq(cypher_parser_feed(parser, "RETURN 1;", 9,
+                feed_callback, NULL, NULL, 0), -2);
+}
+END_TEST
+
+
+TCase* push_tcase(void)
+{
+    TCase *tc = tcase_create("push");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, feed_whole_input);
+    tcase_add_test(tc, feed_input_in_pieces);
+    tcase_add_test(tc, feed_errors_in_pieces);
+    tcase_add_test(tc, feed_input_with_config);
+    tcase_add_test(tc, feed_delivers_complete_segments);
+    tcase_add_test(tc, feed_stops_when_callback_returns);
+    tcase_add_test(tc, feed_from_callback_fails);
+    return tc;
+}
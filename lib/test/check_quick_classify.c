@@ -0,0 +1,240 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "../../lib/src/cypher-parser.h"
+#include <check.h>
+#include <string.h>
+
+
+#define READS CYPHER_QUICK_CLASS_READS
+#define WRITES CYPHER_QUICK_CLASS_WRITES
+#define SCHEMA CYPHER_QUICK_CLASS_SCHEMA
+#define CALLS CYPHER_QUICK_CLASS_CALLS
+
+
+static unsigned int classify_clauses(const cypher_astnode_t *query)
+{
+    unsigned int result = 0;
+    unsigned int noptions = cypher_ast_query_noptions(query);
+    for (unsigned int i = 0; i < noptions; ++i)
+    {
+        if (cypher_astnode_type(cypher_ast_query_get_option(query, i)) ==
+                CYPHER_AST_USING_PERIODIC_COMMIT)
+        {
+            result |= CYPHER_QUICK_CLASS_PERIODIC_COMMIT;
+        }
+    }
+    unsigned int nclauses = cypher_ast_query_nclauses(query);
+    for (unsigned int i = 0; i < nclauses; ++i)
+    {
+        cypher_astnode_type_t type =
+                cypher_astnode_type(cypher_ast_query_get_clause(query, i));
+        if (type == CYPHER_AST_MATCH || type == CYPHER_AST_START)
+        {
+            result |= READS;
+        }
+        else if (type == CYPHER_AST_CREATE || type == CYPHER_AST_MERGE ||
+                type == CYPHER_AST_SET || type == CYPHER_AST_DELETE ||
+                type == CYPHER_AST_REMOVE || type == CYPHER_AST_FOREACH)
+        {
+            result |= WRITES;
+        }
+        else if (type == CYPHER_AST_CALL)
+        {
+            result |= CALLS;
+        }
+    }
+    return result;
+}
+
+
+static unsigned int classify(const char *s, uint_fast32_t flags)
+{
+    unsigned int classes;
+    ck_assert_int_eq(cypher_quick_classify(s, strlen(s), &classes, flags), 0);
+    return classes;
+}
+
+
+// the classification of statements from a full parse
+static unsigned int classify_parsed(const char *s)
+{
+    cypher_parse_result_t *result = cypher_parse(s, NULL, NULL, 0);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_msg(cypher_parse_result_nerrors(result) == 0,
+            "unexpected errors parsing: %s", s);
+
+    unsigned int classification = 0;
+    unsigned int ndirectives = cypher_parse_result_ndirectives(result);
+    for (unsigned int i = 0; i < ndirectives; ++i)
+    {
+        const cypher_astnode_t *directive =
+                cypher_parse_result_get_directive(result, i);
+        if (cypher_astnode_type(directive) != CYPHER_AST_STATEMENT)
+        {
+            continue;
+        }
+        unsigned int noptions = cypher_ast_statement_noptions(directive);
+        for (unsigned int j = 0; j < noptions; ++j)
+        {
+            cypher_astnode_type_t type = cypher_astnode_type(
+                    cypher_ast_statement_get_option(directive, j));
+            if (type == CYPHER_AST_EXPLAIN_OPTION)
+            {
+                classification |= CYPHER_QUICK_CLASS_EXPLAIN;
+            }
+            else if (type == CYPHER_AST_PROFILE_OPTION)
+            {
+                classification |= CYPHER_QUICK_CLASS_PROFILE;
+            }
+        }
+        const cypher_astnode_t *body =
+                cypher_ast_statement_get_body(directive);
+        if (cypher_astnode_instanceof(body, CYPHER_AST_SCHEMA_COMMAND))
+        {
+            classification |= SCHEMA;
+        }
+        else
+        {
+            classification |= classify_clauses(body);
+        }
+    }
+    cypher_parse_result_free(result);
+    return classification;
+}
+
+
+static const char *queries[] =
+    { "MATCH (n) RETURN n",
+      "OPTIONAL MATCH (n)-[r:KNOWS*1..3]->(m) WHERE n.age > 3 RETURN m",
+      "START n=node(1) RETURN n",
+      "CREATE (n:Person {name: 'Bob'})",
+      "MATCH (n) SET n.x = 1, n:Foo",
+      "MATCH (n) DETACH DELETE n",
+      "MATCH (n) REMOVE n.x, n:Foo",
+      "MERGE (n:Foo {id: 1}) ON CREATE SET n.x = 1 ON MATCH SET n.y = 2",
+      "UNWIND [1, 2] AS x FOREACH (y IN [x] | CREATE (:Foo {v: y}))",
+      "MATCH p=(a)-->(b) FOREACH (n IN nodes(p) | SET n.marked = true "
+          "REMOVE n:Old)",
+      "CALL db.labels() YIELD label RETURN label",
+      "CALL db.index.create('x')",
+      "EXPLAIN MATCH (n) RETURN n",
+      "PROFILE CREATE (n)",
+      "CYPHER 2.3 EXPLAIN MATCH (n) RETURN n",
+      "USING PERIODIC COMMIT 500 LOAD CSV FROM 'f' AS line CREATE (n)",
+      "LOAD CSV WITH HEADERS FROM 'f' AS row MERGE (n {x: row.x})",
+      "CREATE INDEX ON :Person(name)",
+      "CREATE INDEX ON:Person(name)",
+      "DROP INDEX ON :Person(name)",
+      "CREATE CONSTRAINT ON (p:Person) ASSERT p.name IS UNIQUE",
+      "DROP CONSTRAINT ON (p:Person) ASSERT exists(p.name)",
+      "CREATE index=(a)-->(b)",
+      "CREATE constraint=(a)-->(b) RETURN constraint",
+      "MATCH (set) RETURN set",
+      "WITH 1 AS create RETURN create",
+      "WITH 1 AS set MATCH (n) RETURN n, set",
+      "MATCH (delete:Match)-[merge:CREATE|:SET]->(remove) "
+          "RETURN delete, merge.call, remove.start",
+      "MATCH (n) RETURN n.create, {set: 1, delete: 2}, $remove, {merge}",
+      "RETURN 'MATCH (n) CREATE (m)', \"SET\", `DELETE` AS `CREATE`",
+      "RETURN 1 // CREATE (n)\n/* MERGE\n(n) */",
+      "MATCH (n) WITH n ORDER BY n.x DESC LIMIT 1 DELETE n",
+      "MATCH (n) WHERE n.x IS NULL SET n.x = 0",
+      "MATCH (n) WITH * MATCH (m) RETURN *",
+      "MATCH (n) RETURN n UNION ALL MATCH (n) RETURN n",
+      "RETURN [x IN range(0, 10) WHERE x % 2 = 0 | x * 2] AS evens",
+      "RETURN [(a)-->(b) | b.name] AS names",
+      "FOREACH (x IN [y IN [1, 2] | y] | MERGE (n {v: x}))",
+      "RETURN CASE WHEN true THEN 1 ELSE 2 END AS x",
+      "MATCH (n) RETURN n; CREATE (m); CALL foo()",
+      "MATCH (a) USING INDEX a:Foo(x) WHERE a.x = 1 RETURN a",
+      "MATCH (a), (b) USING JOIN ON a RETURN a",
+      "RETURN 1.5e3, 0x1F, 'it\\'s' AS `explain`" };
+
+
+START_TEST (classify_matches_parser)
+{
+    for (unsigned int i = 0; i < sizeof(queries) / sizeof(queries[0]); ++i)
+    {
+        const char *q = queries[i];
+        unsigned int expected = classify_parsed(q);
+        unsigned int actual = classify(q, 0);
+        ck_assert_msg(actual == expected,
+                "classified as 0x%x, rather than 0x%x: %s",
+                actual, expected, q);
+    }
+}
+END_TEST
+
+
+START_TEST (classify_statements)
+{
+    const char *q = "MATCH (n) RETURN n;";
+    ck_assert_uint_eq(classify(q, 0), READS);
+    q = "MATCH (n) SET n.x = 1";
+    ck_assert_uint_eq(classify(q, 0), READS | WRITES);
+    q = "CREATE INDEX ON :Foo(bar)";
+    ck_assert_uint_eq(classify(q, 0), SCHEMA);
+    q = "RETURN 1";
+    ck_assert_uint_eq(classify(q, 0), 0);
+    ck_assert_uint_eq(classify("", 0), 0);
+}
+END_TEST
+
+
+START_TEST (classify_combines_statements)
+{
+    const char *q = "MATCH (n) RETURN n;\n:schema CREATE\nCALL foo(); "
+            "RETURN 1";
+    ck_assert_uint_eq(classify(q, 0), READS | CALLS);
+    ck_assert_uint_eq(classify(q, CYPHER_PARSE_SINGLE), READS);
+
+    // without commands, the input is a sequence of statements
+    q = ":schema CREATE (n);\nCALL foo()";
+    ck_assert_uint_eq(classify(q, 0), CALLS);
+    ck_assert_uint_eq(classify(q, CYPHER_PARSE_ONLY_STATEMENTS),
+            WRITES | CALLS);
+}
+END_TEST
+
+
+START_TEST (classify_options)
+{
+    const char *q = "EXPLAIN MATCH (n) RETURN n";
+    ck_assert_uint_eq(classify(q, 0),
+            CYPHER_QUICK_CLASS_EXPLAIN | READS);
+    q = "PROFILE MATCH (n) DELETE n";
+    ck_assert_uint_eq(classify(q, 0),
+            CYPHER_QUICK_CLASS_PROFILE | READS | WRITES);
+    q = "USING PERIODIC COMMIT LOAD CSV FROM 'x' AS l CREATE (n)";
+    ck_assert_uint_eq(classify(q, 0),
+            CYPHER_QUICK_CLASS_PERIODIC_COMMIT | WRITES);
+    q = "RETURN 1 AS explain";
+    ck_assert_uint_eq(classify(q, 0), 0);
+}
+END_TEST
+
+
+TCase* quick_classify_tcase(void)
+{
+    TCase *tc = tcase_create("quick_classify");
+    tcase_add_test(tc, classify_matches_parser);
+    tcase_add_test(tc, classify_statements);
+    tcase_add_test(tc, classify_combines_statements);
+    tcase_add_test(tc, classify_options);
+    return tc;
+}
@@ -651,6 +651,36 @@ START_TEST (parse_command_with_unclosed_quote)
 END_TEST
 
 
+START_TEST (parse_long_input)
+{
+    // longer than a single block (1024 bytes) read from the input
+    char input[2048];
+    size_t n = (size_t)snprintf(input, sizeof(input), "RETURN [0");
+    for (unsigned int i = 1; i < 300; ++i)
+    {
+        n += (size_t)snprintf(input + n, sizeof(input) - n, ", %u", i);
+    }
+    n += (size_t)snprintf(input + n, sizeof(input) - n, "]");
+    size_t end = n;
+    n += (size_t)snprintf(input + n, sizeof(input) - n, "; RETURN 2");
+    ck_assert(n > 1024 && n < sizeof(input));
+
+    int result = cypher_quick_parse(input, segment_callback, NULL, 0);
+    ck_assert_int_eq(result, 0);
+    ck_assert_int_eq(nsegments, 2);
+
+    ck_assert(is_statement[0]);
+    ck_assert_int_eq(strlen(segments[0]), end);
+    ck_assert(strncmp(segments[0], input, end) == 0);
+    ck_assert_int_eq(ranges[0].end.offset, end);
+    ck_assert(is_statement[1]);
+    ck_assert_str_eq(segments[1], "RETURN 2");
+    ck_assert_int_eq(ranges[1].start.offset, n - 8);
+    ck_assert(eofs[1]);
+}
+END_TEST
+
+
 TCase* quick_parse_tcase(void)
 {
     TCase *tc = tcase_create("quick_parse");
@@ -675,5 +705,6 @@ TCase* quick_parse_tcase(void)
     tcase_add_test(tc, parse_command_with_unclosed_block_comment);
     tcase_add_test(tc, parse_statement_with_unclosed_quote);
     tcase_add_test(tc, parse_command_with_unclosed_quote);
+    tcase_add_test(tc, parse_long_input);
     return tc;
 }
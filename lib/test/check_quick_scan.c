@@ -0,0 +1,355 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "../../lib/src/cypher-parser.h"
+#include "memstream.h"
+#include "util.h"
+#include <check.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+
+
+static const char *input =
+    "MATCH (n:Person {name: 'Bob'})-[r:KNOWS*1..3]->(m) RETURN m;\n"
+    "/* a comment; with a semicolon */ CREATE (n {x: 'a;b'});\n"
+    ":help match  // trailing comment\n"
+    ":schema \\\n  labels\n"
+    "RETURN \"it's; \\\"here\\\"\" /* before */ ;\n"
+    "RETURN 1 // comment; not the end\n;  \n"
+    ";;\n"
+    "RETURN 'unterminated; MATCH (n) RETURN n;";
+
+
+static cypher_quick_scanner_t *scanner;
+static char *memstream_buffer;
+static size_t memstream_size;
+static FILE *memstream;
+
+
+static void setup(void)
+{
+    scanner = cypher_quick_scanner_new(0);
+    ck_assert_ptr_ne(scanner, NULL);
+    memstream = open_memstream(&memstream_buffer, &memstream_size);
+    ck_assert_ptr_ne(memstream, NULL);
+}
+
+
+static void teardown(void)
+{
+    cypher_quick_scanner_free(scanner);
+    fclose(memstream);
+    free(memstream_buffer);
+}
+
+
+struct description
+{
+    unsigned int n;
+    unsigned int limit;
+};
+
+
+static int segment_callback(void *data,
+        const cypher_quick_parse_segment_t *segment)
+{
+    struct description *d = (struct description *)data;
+    size_t n;
+    const char *s = cypher_quick_parse_segment_get_text(segment, &n);
+    struct cypher_input_range range =
+            cypher_quick_parse_segment_get_range(segment);
+    struct cypher_input_position next =
+            cypher_quick_parse_segment_get_next(segment);
+    fprintf(memstream, "%s: %u:%u@%zu..%u:%u@%zu, next: %u:%u@%zu, "
+            "eof: %d, text: <%.*s>\n",
+            cypher_quick_parse_segment_is_statement(segment)?
+                    "statement" : "command",
+            range.start.line, range.start.column, range.start.offset,
+            range.end.line, range.end.column, range.end.offset,
+            next.line, next.column, next.offset,
+            cypher_quick_parse_segment_is_eof(segment), (int)n, s);
+    ++(d->n);
+    return (d->limit > 0 && d->n % d->limit == 0)? 1 : 0;
+}
+
+
+// the stream parser is driven by the quick parser grammar, so serves as
+// the reference for the scanner
+static void describe_quick_parse(const char *s, uint_fast32_t flags)
+{
+    struct description d = { .n = 0 };
+    FILE *in = open_file_input(s, strlen(s));
+    ck_assert_int_eq(cypher_quick_fparse(in, segment_callback, &d, flags), 0);
+    close_input(in);
+}
+
+
+static void describe_quick_uparse(const char *s, uint_fast32_t flags)
+{
+    struct description d = { .n = 0 };
+    ck_assert_int_eq(cypher_quick_uparse(s, strlen(s), segment_callback, &d,
+                flags), 0);
+}
+
+
+static void describe_scanned(const char *s, size_t chunk_size,
+        uint_fast32_t flags)
+{
+    struct description d = { .n = 0 };
+    cypher_quick_scanner_t *scanner = cypher_quick_scanner_new(flags);
+    ck_assert_ptr_ne(scanner, NULL);
+    size_t len = strlen(s);
+    for (size_t i = 0; i < len; i += chunk_size)
+    {
+        size_t n = (len - i < chunk_size)? len - i : chunk_size;
+        ck_assert_int_eq(cypher_quick_scanner_feed(scanner, s + i, n,
+                    segment_callback, &d), 0);
+    }
+    ck_assert_int_eq(cypher_quick_scanner_finish(scanner,
+                segment_callback, &d), 0);
+    cypher_quick_scanner_free(scanner);
+}
+
+
+static void assert_scanned_matches_quick_parse(const char *s,
+        size_t chunk_size, uint_fast32_t flags)
+{
+    ASSERT_SAME_DESCRIPTION(describe_quick_parse(s, flags),
+            describe_scanned(s, chunk_size, flags));
+    ASSERT_SAME_DESCRIPTION(describe_quick_parse(s, flags),
+            describe_quick_uparse(s, flags));
+}
+
+
+START_TEST (scan_whole_input)
+{
+    assert_scanned_matches_quick_parse(input, strlen(input), 0);
+    assert_scanned_matches_quick_parse(input, strlen(input),
+            CYPHER_PARSE_ONLY_STATEMENTS);
+}
+END_TEST
+
+
+START_TEST (scan_input_in_pieces)
+{
+    for (size_t n = 1; n <= 16; ++n)
+    {
+        assert_scanned_matches_quick_parse(input, n, 0);
+        assert_scanned_matches_quick_parse(input, n,
+                CYPHER_PARSE_ONLY_STATEMENTS);
+    }
+}
+END_TEST
+
+
+START_TEST (scan_edge_cases_in_pieces)
+{
+    const char *inputs[] =
+        { "", " ", "\n", ";", "RETURN 1;", "RETURN 1;\n", "RETURN 1  ",
+          "  /* unclosed", "RETURN 1 /* unclosed", ":cmd \\", ":cmd \\ x\n",
+          ":cmd /* c */ \r\nRETURN 1", ":cmd a ;b", ":cmd 'a\nb'\n",
+          "RETURN 1/* c */ ;", "RETURN \\'; x'", "RETURN 1 // c",
+          "\r\r\n;\r", "//\n:a//b\n",
+          "RETURN abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyz0123"
+          "      \t    /* abcdefghijklmnopqrstuvwxyz0123456789abcdefghijk */"
+          " 'abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrst\\'"
+          "abcdefghijklmnopqrstuvwxyz0123456789;' // abcdefghijklmnopqrstuv"
+          "wxyz0123456789abcdefghijklmnopqrstuvwxyz0123456789\n;", NULL };
+    for (const char **s = inputs; *s != NULL; ++s)
+    {
+        for (size_t n = 1; n <= 3; ++n)
+        {
+            assert_scanned_matches_quick_parse(*s, n, 0);
+            assert_scanned_matches_quick_parse(*s, n,
+                    CYPHER_PARSE_ONLY_STATEMENTS);
+        }
+    }
+}
+END_TEST
+
+
+START_TEST (scan_single_matches_quick_parse)
+{
+    const char *inputs[] = { input, "  ", ":help\nRETURN 1;",
+        "RETURN 1; RETURN 2;", "/* unclosed", NULL };
+    for (const char **s = inputs; *s != NULL; ++s)
+    {
+        assert_scanned_matches_quick_parse(*s, strlen(*s),
+                CYPHER_PARSE_SINGLE);
+        for (size_t n = 1; n <= 3; ++n)
+        {
+            assert_scanned_matches_quick_parse(*s, n, CYPHER_PARSE_SINGLE);
+        }
+    }
+}
+END_TEST
+
+
+START_TEST (scan_single_ignores_further_input)
+{
+    cypher_quick_scanner_free(scanner);
+    scanner = cypher_quick_scanner_new(CYPHER_PARSE_SINGLE);
+    ck_assert_ptr_ne(scanner, NULL);
+
+    struct description d = { .n = 0 };
+    ck_assert_int_eq(cypher_quick_scanner_feed(scanner, "RETURN 1; RET", 13,
+                segment_callback, &d), 0);
+    ck_assert_uint_eq(d.n, 1);
+    ck_assert_uint_eq(cypher_quick_scanner_state(scanner), 0);
+    ck_assert_int_eq(cypher_quick_scanner_feed(scanner, "URN 2;", 6,
+                segment_callback, &d), 0);
+    ck_assert_uint_eq(d.n, 1);
+    ck_assert_int_eq(cypher_quick_scanner_finish(scanner,
+                segment_callback, &d), 0);
+    ck_assert_uint_eq(d.n, 1);
+
+    // the scanner can be reused once the input is finished
+    ck_assert_int_eq(cypher_quick_scanner_feed(scanner, "RETURN 3; RETURN 4",
+                18, segment_callback, &d), 0);
+    ck_assert_uint_eq(d.n, 2);
+    fflush(memstream);
+
+    ck_assert_str_eq(memstream_buffer,
+            "statement: 1:1@0..1:9@8, next: 1:10@9, eof: 0, "
+            "text: <RETURN 1>\n"
+            "statement: 1:1@0..1:9@8, next: 1:10@9, eof: 0, "
+            "text: <RETURN 3>\n");
+}
+END_TEST
+
+
+START_TEST (scan_tracks_state)
+{
+    struct description d = { .n = 0 };
+    ck_assert_uint_eq(cypher_quick_scanner_state(scanner), 0);
+
+    ck_assert_int_eq(cypher_quick_scanner_feed(scanner, "RETURN 'a;", 10,
+                segment_callback, &d), 0);
+    ck_assert_uint_eq(d.n, 0);
+    ck_assert_uint_eq(cypher_quick_scanner_state(scanner),
+            CYPHER_QUICK_SCAN_PENDING | CYPHER_QUICK_SCAN_IN_QUOTE);
+
+    ck_assert_int_eq(cypher_quick_scanner_feed(scanner, "\\", 1,
+                segment_callback, &d), 0);
+    ck_assert_uint_eq(cypher_quick_scanner_state(scanner),
+            CYPHER_QUICK_SCAN_PENDING | CYPHER_QUICK_SCAN_IN_QUOTE |
+            CYPHER_QUICK_SCAN_IN_ESCAPE);
+
+    ck_assert_int_eq(cypher_quick_scanner_feed(scanner, "'' /* x;", 8,
+                segment_callback, &d), 0);
+    ck_assert_uint_eq(d.n, 0);
+    ck_assert_uint_eq(cypher_quick_scanner_state(scanner),
+            CYPHER_QUICK_SCAN_PENDING | CYPHER_QUICK_SCAN_IN_COMMENT);
+
+    ck_assert_int_eq(cypher_quick_scanner_feed(scanner, "\n*/ ;", 5,
+                segment_callback, &d), 0);
+    ck_assert_uint_eq(d.n, 1);
+    ck_assert_uint_eq(cypher_quick_scanner_state(scanner), 0);
+    struct cypher_input_position position =
+            cypher_quick_scanner_position(scanner);
+    ck_assert_uint_eq(position.line, 2);
+    ck_assert_uint_eq(position.column, 5);
+    ck_assert_uint_eq(position.offset, 24);
+
+    ck_assert_int_eq(cypher_quick_scanner_feed(scanner, " :help \\", 8,
+                segment_callback, &d), 0);
+    ck_assert_uint_eq(cypher_quick_scanner_state(scanner),
+            CYPHER_QUICK_SCAN_PENDING | CYPHER_QUICK_SCAN_IN_ESCAPE);
+    ck_assert_int_eq(cypher_quick_scanner_feed(scanner, "\nmatch\n", 7,
+                segment_callback, &d), 0);
+    ck_assert_uint_eq(d.n, 2);
+    ck_assert_uint_eq(cypher_quick_scanner_state(scanner), 0);
+
+    ck_assert_int_eq(cypher_quick_scanner_finish(scanner,
+                segment_callback, &d), 0);
+    ck_assert_uint_eq(d.n, 2);
+    fflush(memstream);
+
+    size_t mid = memstream_size;
+    describe_quick_parse("RETURN 'a;\\'' /* x;\n*/ ; :help \\\nmatch\n", 0);
+    fflush(memstream);
+    assert_same_descriptions(memstream_buffer, 0, mid, memstream_size);
+}
+END_TEST
+
+
+START_TEST (scan_stops_when_callback_returns)
+{
+    struct description d = { .limit = 2 };
+    const char *s = "RETURN 1; RETURN 2; RETURN 3; RETURN 4; RETURN";
+    ck_assert_int_eq(cypher_quick_scanner_feed(scanner, s, strlen(s),
+                segment_callback, &d), 0);
+    ck_assert_uint_eq(d.n, 2);
+    ck_assert_uint_eq(cypher_quick_scanner_state(scanner),
+            CYPHER_QUICK_SCAN_PENDING);
+    ck_assert_int_eq(cypher_quick_scanner_feed(scanner, "", 0,
+                segment_callback, &d), 0);
+    ck_assert_uint_eq(d.n, 4);
+    ck_assert_int_eq(cypher_quick_scanner_finish(scanner,
+                segment_callback, &d), 0);
+    ck_assert_uint_eq(d.n, 5);
+    fflush(memstream);
+
+    size_t mid = memstream_size;
+    describe_quick_parse(s, 0);
+    fflush(memstream);
+    assert_same_descriptions(memstream_buffer, 0, mid, memstream_size);
+
+    // the scanner can be reused once the input is finished
+    ck_assert_uint_eq(cypher_quick_scanner_position(scanner).offset, 0);
+    ck_assert_int_eq(cypher_quick_scanner_feed(scanner, "RETURN 5;", 9,
+                segment_callback, &d), 0);
+    ck_assert_uint_eq(d.n, 6);
+}
+END_TEST
+
+
+static int feed_callback(void *data,
+        const cypher_quick_parse_segment_t *segment)
+{
+    errno = 0;
+    ck_assert_int_eq(cypher_quick_scanner_feed(scanner, "RETURN 2;", 9,
+                feed_callback, NULL), -1);
+    ck_assert_int_eq(errno, EBUSY);
+    return -2;
+}
+
+
+START_TEST (scan_from_callback_fails)
+{
+    ck_assert_int_eq(cypher_quick_scanner_feed(scanner, "RETURN 1;", 9,
+                feed_callback, NULL), -2);
+}
+END_TEST
+
+
+TCase* quick_scan_tcase(void)
+{
+    TCase *tc = tcase_create("quick_scan");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, scan_whole_input);
+    tcase_add_test(tc, scan_input_in_pieces);
+    tcase_add_test(tc, scan_edge_cases_in_pieces);
+    tcase_add_test(tc, scan_single_matches_quick_parse);
+    tcase_add_test(tc, scan_single_ignores_further_input);
+    tcase_add_test(tc, scan_tracks_state);
+    tcase_add_test(tc, scan_stops_when_callback_returns);
+    tcase_add_test(tc, scan_from_callback_fails);
+    return tc;
+}
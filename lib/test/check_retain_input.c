@@ -0,0 +1,290 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "../../lib/src/cypher-parser.h"
+#include "memstream.h"
+#include "util.h"
+#include <check.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+
+static cypher_parse_result_t *result;
+static char *memstream_buffer;
+static size_t memstream_size;
+static FILE *memstream;
+
+
+static void setup(void)
+{
+    result = NULL;
+    memstream = open_memstream(&memstream_buffer, &memstream_size);
+    fputc('\n', memstream);
+}
+
+
+static void teardown(void)
+{
+    cypher_parse_result_free(result);
+    fclose(memstream);
+    free(memstream_buffer);
+}
+
+
+static const cypher_astnode_t *find(const cypher_astnode_t *node,
+        cypher_astnode_type_t type)
+{
+    if (cypher_astnode_type(node) == type)
+    {
+        return node;
+    }
+    for (unsigned int i = 0; i < cypher_astnode_nchildren(node); ++i)
+    {
+        const cypher_astnode_t *found =
+                find(cypher_astnode_get_child(node, i), type);
+        if (found != NULL)
+        {
+            return found;
+        }
+    }
+    return NULL;
+}
+
+
+static const cypher_astnode_t *projected(unsigned int directive,
+        unsigned int i)
+{
+    const cypher_astnode_t *ast =
+            cypher_parse_result_get_directive(result, directive);
+    const cypher_astnode_t *query = cypher_ast_statement_get_body(ast);
+    const cypher_astnode_t *clause = cypher_ast_query_get_clause(query, 0);
+    ck_assert_int_eq(cypher_astnode_type(clause), CYPHER_AST_RETURN);
+    const cypher_astnode_t *proj = cypher_ast_return_get_projection(clause, i);
+    return cypher_ast_projection_get_expression(proj);
+}
+
+
+START_TEST (parse_retained_strings)
+{
+    result = cypher_parse("RETURN 'abc' AS a, \"a\\tb\" AS b, 'xy' AS c",
+            NULL, NULL, CYPHER_PARSE_RETAIN_INPUT);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 0);
+
+    ck_assert(cypher_parse_result_fprint_ast(result, memstream, 0, NULL, 0) == 0);
+    fflush(memstream);
+    const char *expected = "\n"
+" @0   0..41  statement           body=@1\n"
+" @1   0..41  > query             clauses=[@2]\n"
+" @2   0..41  > > RETURN          projections=[@3, @6, @9]\n"
+" @3   7..17  > > > projection    expression=@4, alias=@5\n"
+" @4   7..12  > > > > string      \"abc\"\n"
+" @5  16..17  > > > > identifier  `a`\n"
+" @6  19..30  > > > projection    expression=@7, alias=@8\n"
+" @7  19..25  > > > > string      \"a\\tb\"\n"
+" @8  29..30  > > > > identifier  `b`\n"
+" @9  32..41  > > > projection    expression=@10, alias=@11\n"
+"@10  32..36  > > > > string      \"xy\"\n"
+"@11  40..41  > > > > identifier  `c`\n";
+    ck_assert_str_eq(memstream_buffer, expected);
+
+    const cypher_astnode_t *a = projected(0, 0);
+    ck_assert_str_eq(cypher_ast_string_get_value(a), "abc");
+    ck_assert_int_eq(cypher_ast_string_get_length(a), 3);
+    const cypher_astnode_t *b = projected(0, 1);
+    ck_assert_str_eq(cypher_ast_string_get_value(b), "a\tb");
+    ck_assert_int_eq(cypher_ast_string_get_length(b), 3);
+    const cypher_astnode_t *c = projected(0, 2);
+    ck_assert_str_eq(cypher_ast_string_get_value(c), "xy");
+    ck_assert_int_eq(cypher_ast_string_get_length(c), 2);
+
+    // unescaped strings reference the same copy of the input
+    ck_assert_int_eq(cypher_ast_string_get_value(c) -
+            cypher_ast_string_get_value(a), 33 - 8);
+}
+END_TEST
+
+
+// print the AST of the input parsed without retaining it
+static void print_copied(const char *s)
+{
+    cypher_parse_result_t *copied = cypher_parse(s, NULL, NULL, 0);
+    ck_assert_ptr_ne(copied, NULL);
+    ck_assert(cypher_parse_result_fprint_ast(copied, memstream, 0,
+                NULL, 0) == 0);
+    cypher_parse_result_free(copied);
+}
+
+
+static void print_result(void)
+{
+    ck_assert(cypher_parse_result_fprint_ast(result, memstream, 0,
+                NULL, 0) == 0);
+}
+
+
+START_TEST (parse_retained_comments_and_errors)
+{
+    const char *s = "MATCH (n) // x\nRETRUN /* y */ n; RETURN 1 /*z*/";
+    struct cypher_input_position last = cypher_input_position_zero;
+    result = cypher_parse(s, &last, NULL, CYPHER_PARSE_RETAIN_INPUT);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(last.offset, 47);
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 1);
+
+    ASSERT_SAME_DESCRIPTION(print_copied(s), print_result());
+
+    const cypher_astnode_t *first = cypher_parse_result_get_root(result, 0);
+    const cypher_astnode_t *error = find(first, CYPHER_AST_ERROR);
+    ck_assert_ptr_ne(error, NULL);
+    ck_assert_str_eq(cypher_ast_error_get_value(error), "RETRUN /* y */ n");
+    ck_assert_int_eq(cypher_ast_error_get_length(error), 16);
+    const cypher_astnode_t *line_comment =
+            find(first, CYPHER_AST_LINE_COMMENT);
+    ck_assert_ptr_ne(line_comment, NULL);
+    const cypher_astnode_t *comment = find(
+            cypher_parse_result_get_root(result, 1), CYPHER_AST_BLOCK_COMMENT);
+    ck_assert_ptr_ne(comment, NULL);
+    ck_assert_str_eq(cypher_ast_block_comment_get_value(comment), "z");
+    ck_assert_int_eq(cypher_ast_block_comment_get_length(comment), 1);
+    ck_assert_str_eq(cypher_ast_line_comment_get_value(line_comment), " x");
+    ck_assert_int_eq(cypher_ast_line_comment_get_length(line_comment), 2);
+}
+END_TEST
+
+
+static void check_errors(const cypher_astnode_t *node)
+{
+    if (cypher_astnode_type(node) == CYPHER_AST_ERROR)
+    {
+        ck_assert_int_eq(cypher_ast_error_get_length(node),
+                strlen(cypher_ast_error_get_value(node)));
+    }
+    for (unsigned int i = 0; i < cypher_astnode_nchildren(node); ++i)
+    {
+        check_errors(cypher_astnode_get_child(node, i));
+    }
+}
+
+
+START_TEST (parse_retained_adjacent_errors)
+{
+    static const char *inputs[] =
+        { "OPTIONAL MATCH",
+          "MATCH (n) // c\nRETRUN n",
+          "RETURN 'a' FOO BAR /* x */ BAZ" };
+
+    for (unsigned int i = 0; i < sizeof(inputs) / sizeof(char *); ++i)
+    {
+        result = cypher_parse(inputs[i], NULL, NULL,
+                CYPHER_PARSE_RETAIN_INPUT);
+        ck_assert_ptr_ne(result, NULL);
+        ck_assert_int_gt(cypher_parse_result_nerrors(result), 0);
+        ASSERT_SAME_DESCRIPTION(print_copied(inputs[i]), print_result());
+
+        for (unsigned int j = 0; j < cypher_parse_result_nroots(result); ++j)
+        {
+            check_errors(cypher_parse_result_get_root(result, j));
+        }
+        cypher_parse_result_free(result);
+        result = NULL;
+    }
+}
+END_TEST
+
+
+START_TEST (parse_retained_stream)
+{
+    const char *s = "RETURN 'a' /* b */;\nRETURN 'c' // d";
+    FILE *in = open_pipe_input(s);
+    result = cypher_fparse(in, NULL, NULL, CYPHER_PARSE_RETAIN_INPUT);
+    close_input(in);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(cypher_parse_result_ndirectives(result), 2);
+
+    ck_assert_str_eq(cypher_ast_string_get_value(projected(0, 0)), "a");
+    ck_assert_str_eq(cypher_ast_string_get_value(projected(1, 0)), "c");
+
+    ck_assert(cypher_parse_result_fprint_ast(result, memstream, 0, NULL, 0) == 0);
+    fflush(memstream);
+    const char *expected = "\n"
+" @0   0..19  statement              body=@1\n"
+" @1   0..19  > query                clauses=[@2]\n"
+" @2   0..18  > > RETURN             projections=[@3]\n"
+" @3   7..18  > > > projection       expression=@4, alias=@6\n"
+" @4   7..10  > > > > string         \"a\"\n"
+" @5  13..16  > > > > block_comment  /* b */\n"
+" @6   7..18  > > > > identifier     `'a' /* b */`\n"
+" @7  20..35  statement              body=@8\n"
+" @8  20..35  > query                clauses=[@9]\n"
+" @9  20..35  > > RETURN             projections=[@10]\n"
+"@10  27..35  > > > projection       expression=@11, alias=@13\n"
+"@11  27..30  > > > > string         \"c\"\n"
+"@12  33..35  > > > > line_comment   // d\n"
+"@13  27..35  > > > > identifier     `'c' // d`\n";
+    ck_assert_str_eq(memstream_buffer, expected);
+}
+END_TEST
+
+
+START_TEST (clone_retained_string)
+{
+    result = cypher_parse("RETURN 'abc'", NULL, NULL,
+            CYPHER_PARSE_RETAIN_INPUT);
+    ck_assert_ptr_ne(result, NULL);
+    cypher_astnode_t *clone = cypher_ast_clone(projected(0, 0));
+    ck_assert_ptr_ne(clone, NULL);
+    cypher_parse_result_free(result);
+    result = NULL;
+
+    ck_assert_str_eq(cypher_ast_string_get_value(clone), "abc");
+    ck_assert_int_eq(cypher_ast_string_get_length(clone), 3);
+    cypher_ast_free(clone);
+}
+END_TEST
+
+
+START_TEST (parse_retained_input_with_arena)
+{
+    cypher_parser_config_t *config = cypher_parser_new_config();
+    ck_assert_ptr_ne(config, NULL);
+    cypher_parser_config_set_arena_allocation(config, true);
+    result = cypher_parse("RETURN 'a', 'b\\'' // c", NULL, config,
+            CYPHER_PARSE_RETAIN_INPUT);
+    cypher_parser_config_free(config);
+    ck_assert_ptr_ne(result, NULL);
+
+    ck_assert_str_eq(cypher_ast_string_get_value(projected(0, 0)), "a");
+    ck_assert_str_eq(cypher_ast_string_get_value(projected(0, 1)), "b'");
+    ck_assert_int_eq(cypher_ast_string_get_length(projected(0, 1)), 2);
+}
+END_TEST
+
+
+TCase* retain_input_tcase(void)
+{
+    TCase *tc = tcase_create("retain_input");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, parse_retained_strings);
+    tcase_add_test(tc, parse_retained_comments_and_errors);
+    tcase_add_test(tc, parse_retained_adjacent_errors);
+    tcase_add_test(tc, parse_retained_stream);
+    tcase_add_test(tc, clone_retained_string);
+    tcase_add_test(tc, parse_retained_input_with_arena);
+    return tc;
+}
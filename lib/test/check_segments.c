@@ -227,6 +227,68 @@ START_TEST (segments_with_directives)
 END_TEST
 
 
+START_TEST (segments_from_unterminated_buffer)
+{
+    // parsed in place, so the input need not be null terminated (and, being
+    // static and const, must never be written to)
+    static const char input[] = "return 1; return 2; return 3";
+
+    struct cypher_input_position last = cypher_input_position_zero;
+    int result = cypher_uparse_each(input, 18, segment_callback, NULL, &last,
+            NULL, 0);
+    ck_assert_int_eq(result, 0);
+    ck_assert_int_eq(last.offset, 18);
+
+    fflush(memstream);
+    const char *expected = "\n"
+"@0  0..9  statement           body=@1\n"
+"@1  0..9  > query             clauses=[@2]\n"
+"@2  0..8  > > RETURN          projections=[@3]\n"
+"@3  7..8  > > > projection    expression=@4, alias=@5\n"
+"@4  7..8  > > > > integer     1\n"
+"@5  7..8  > > > > identifier  `1`\n"
+"--1--\n"
+" @6  10..18  statement           body=@7\n"
+" @7  10..18  > query             clauses=[@8]\n"
+" @8  10..18  > > RETURN          projections=[@9]\n"
+" @9  17..18  > > > projection    expression=@10, alias=@11\n"
+"@10  17..18  > > > > integer     2\n"
+"@11  17..18  > > > > identifier  `2`\n"
+"--2--\n";
+    ck_assert_str_eq(memstream_buffer, expected);
+
+    ck_assert_int_eq(nsegments, 2);
+}
+END_TEST
+
+
+START_TEST (segments_from_long_input)
+{
+    // longer than a single block (1024 bytes) read from the input
+    char input[2048];
+    size_t n = (size_t)snprintf(input, sizeof(input), "RETURN [0");
+    for (unsigned int i = 1; i < 300; ++i)
+    {
+        n += (size_t)snprintf(input + n, sizeof(input) - n, ", %u", i);
+    }
+    n += (size_t)snprintf(input + n, sizeof(input) - n, "]; RETURN 2");
+    ck_assert(n > 1024 && n < sizeof(input));
+
+    cypher_parse_result_t *result = cypher_parse(input, NULL, NULL, 0);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 0);
+    ck_assert_int_eq(cypher_parse_result_ndirectives(result), 2);
+
+    const cypher_astnode_t *directive =
+            cypher_parse_result_get_directive(result, 1);
+    struct cypher_input_range range = cypher_astnode_range(directive);
+    ck_assert_int_eq(range.start.offset, n - 8);
+    ck_assert_int_eq(range.end.offset, n);
+    cypher_parse_result_free(result);
+}
+END_TEST
+
+
 TCase* segments_tcase(void)
 {
     TCase *tc = tcase_create("segments");
@@ -235,5 +297,7 @@ TCase* segments_tcase(void)
     tcase_add_test(tc, single_segment_without_directive);
     tcase_add_test(tc, single_segment_with_only_a_comment);
     tcase_add_test(tc, segments_with_directives);
+    tcase_add_test(tc, segments_from_unterminated_buffer);
+    tcase_add_test(tc, segments_from_long_input);
     return tc;
 }
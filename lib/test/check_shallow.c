@@ -0,0 +1,244 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "../../lib/src/cypher-parser.h"
+#include "memstream.h"
+#include "util.h"
+#include <check.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+
+static cypher_parse_result_t *result;
+static char *memstream_buffer;
+static size_t memstream_size;
+static FILE *memstream;
+
+
+static void setup(void)
+{
+    result = NULL;
+    memstream = open_memstream(&memstream_buffer, &memstream_size);
+    fputc('\n', memstream);
+}
+
+
+static void teardown(void)
+{
+    cypher_parse_result_free(result);
+    fclose(memstream);
+    free(memstream_buffer);
+}
+
+
+static const cypher_astnode_t *deferred_body(unsigned int i)
+{
+    const cypher_astnode_t *ast = cypher_parse_result_get_directive(result, i);
+    ck_assert_int_eq(cypher_astnode_type(ast), CYPHER_AST_STATEMENT);
+    const cypher_astnode_t *body = cypher_ast_statement_get_body(ast);
+    ck_assert_int_eq(cypher_astnode_type(body), CYPHER_AST_DEFERRED_BODY);
+    return body;
+}
+
+
+START_TEST (parse_shallow_statements)
+{
+    struct cypher_input_position last = cypher_input_position_zero;
+    result = cypher_parse(
+            "EXPLAIN MATCH (n) /* ; */ RETURN 'a;b';\n"
+            ":help\n"
+            "USING PERIODIC COMMIT 500 LOAD CSV FROM 'f' AS l CREATE (n)",
+            &last, NULL, CYPHER_PARSE_SHALLOW);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(last.offset, 105);
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 0);
+    ck_assert(cypher_parse_result_eof(result));
+
+    ck_assert(cypher_parse_result_fprint_ast(result, memstream, 0, NULL, 0) == 0);
+    fflush(memstream);
+    const char *expected = "\n"
+"@0   0..39   statement        options=[@1], body=@2\n"
+"@1   0..7    > EXPLAIN\n"
+"@2   8..39   > deferred body  MATCH, 31 bytes\n"
+"@3  40..45   command          name=@4, args=[]\n"
+"@4  41..45   > string         \"help\"\n"
+"@5  46..105  statement        body=@6\n"
+"@6  46..105  > deferred body  LOAD CSV, 59 bytes\n";
+    ck_assert_str_eq(memstream_buffer, expected);
+
+    const cypher_astnode_t *body = deferred_body(0);
+    ck_assert_int_eq(cypher_ast_deferred_body_get_clause_type(body),
+            CYPHER_AST_MATCH);
+    size_t n;
+    ck_assert_str_eq(cypher_ast_deferred_body_get_text(body, &n),
+            "MATCH (n) /* ; */ RETURN 'a;b';");
+    ck_assert_int_eq(n, 31);
+
+    body = deferred_body(2);
+    ck_assert_int_eq(cypher_ast_deferred_body_get_clause_type(body),
+            CYPHER_AST_LOAD_CSV);
+    ck_assert_ptr_ne(cypher_ast_deferred_body_get_text(body, NULL), NULL);
+}
+END_TEST
+
+
+START_TEST (parse_shallow_schema_commands)
+{
+    result = cypher_parse(
+            "CREATE INDEX ON :Foo(bar); DROP INDEX ON :Foo(bar);\n"
+            "CREATE CONSTRAINT ON (f:Foo) ASSERT f.bar IS UNIQUE;\n"
+            "DROP CONSTRAINT ON /* rel */ ( ) -[r:R]-() ASSERT exists(r.x);\n"
+            "CREATE (n:Foo);",
+            NULL, NULL, CYPHER_PARSE_SHALLOW);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(cypher_parse_result_ndirectives(result), 5);
+
+    ck_assert_int_eq(cypher_ast_deferred_body_get_clause_type(
+                deferred_body(0)), CYPHER_AST_CREATE_NODE_PROPS_INDEX);
+    ck_assert_int_eq(cypher_ast_deferred_body_get_clause_type(
+                deferred_body(1)), CYPHER_AST_DROP_NODE_PROPS_INDEX);
+    ck_assert_int_eq(cypher_ast_deferred_body_get_clause_type(
+                deferred_body(2)), CYPHER_AST_CREATE_NODE_PROP_CONSTRAINT);
+    ck_assert_int_eq(cypher_ast_deferred_body_get_clause_type(
+                deferred_body(3)), CYPHER_AST_DROP_REL_PROP_CONSTRAINT);
+    ck_assert_int_eq(cypher_ast_deferred_body_get_clause_type(
+                deferred_body(4)), CYPHER_AST_CREATE);
+}
+END_TEST
+
+
+START_TEST (parse_deferred_body)
+{
+    struct cypher_input_position last = cypher_input_position_zero;
+    result = cypher_parse(
+            "RETURN 1;\n  MATCH (n)\n  WHERE n.x = \"a\\\";\"\n  RETURN n;",
+            &last, NULL, CYPHER_PARSE_SHALLOW);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(cypher_parse_result_ndirectives(result), 2);
+
+    const cypher_astnode_t *body = deferred_body(1);
+    cypher_parse_result_t *body_result =
+            cypher_parse_deferred_body(body, NULL, 0);
+    ck_assert_ptr_ne(body_result, NULL);
+    ck_assert_int_eq(cypher_parse_result_nerrors(body_result), 0);
+    ck_assert_int_eq(cypher_parse_result_ndirectives(body_result), 1);
+
+    const cypher_astnode_t *ast =
+            cypher_parse_result_get_directive(body_result, 0);
+    struct cypher_input_range range = cypher_astnode_range(ast);
+    struct cypher_input_range expected_range = cypher_astnode_range(body);
+    ck_assert_int_eq(range.start.offset, expected_range.start.offset);
+    ck_assert_int_eq(range.start.line, 2);
+    ck_assert_int_eq(range.start.column, 3);
+    ck_assert_int_eq(range.end.offset, expected_range.end.offset);
+    ck_assert_int_eq(range.end.line, 4);
+    ck_assert_int_eq(range.end.column, 12);
+
+    ck_assert(cypher_parse_result_fprint_ast(body_result, memstream, 0,
+                NULL, 0) == 0);
+    cypher_parse_result_free(body_result);
+    fflush(memstream);
+    const char *expected = "\n"
+" @0  12..54  statement               body=@1\n"
+" @1  12..54  > query                 clauses=[@2, @12]\n"
+" @2  12..45  > > MATCH               pattern=@3, where=@7\n"
+" @3  18..21  > > > pattern           paths=[@4]\n"
+" @4  18..21  > > > > pattern path    (@5)\n"
+" @5  18..21  > > > > > node pattern  (@6)\n"
+" @6  19..20  > > > > > > identifier  `n`\n"
+" @7  30..45  > > > binary operator   @8 = @11\n"
+" @8  30..34  > > > > property        @9.@10\n"
+" @9  30..31  > > > > > identifier    `n`\n"
+"@10  32..33  > > > > > prop name     `x`\n"
+"@11  36..42  > > > > string          \"a\";\"\n"
+"@12  45..53  > > RETURN              projections=[@13]\n"
+"@13  52..53  > > > projection        expression=@14\n"
+"@14  52..53  > > > > identifier      `n`\n";
+    ck_assert_str_eq(memstream_buffer, expected);
+}
+END_TEST
+
+
+START_TEST (parse_shallow_unrecognized_bodies)
+{
+    struct cypher_input_position last = cypher_input_position_zero;
+    result = cypher_parse("RETRUN 1; MATCH (n) RETURN 'x", &last, NULL,
+            CYPHER_PARSE_SHALLOW);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(last.offset, 29);
+
+    ck_assert(cypher_parse_result_fprint_ast(result, memstream, 0, NULL, 0) == 0);
+    fflush(memstream);
+    const char *expected = "\n"
+"@0   0..8   error                   >>RETRUN 1<<\n"
+"@1  10..29  statement               body=@2\n"
+"@2  10..29  > query                 clauses=[@3]\n"
+"@3  10..20  > > MATCH               pattern=@4\n"
+"@4  16..19  > > > pattern           paths=[@5]\n"
+"@5  16..19  > > > > pattern path    (@6)\n"
+"@6  16..19  > > > > > node pattern  (@7)\n"
+"@7  17..18  > > > > > > identifier  `n`\n"
+"@8  20..29  > > error               >>RETURN 'x<<\n";
+    ck_assert_str_eq(memstream_buffer, expected);
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 2);
+}
+END_TEST
+
+
+START_TEST (parse_shallow_stream)
+{
+    const char *s = "MATCH (n)\n/* ;\n */ RETURN n;\n"
+            "// ;\nCREATE (n {x: 'a\n;'})";
+    struct cypher_input_position last = cypher_input_position_zero;
+    result = cypher_parse(s, &last, NULL, CYPHER_PARSE_SHALLOW);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert(cypher_parse_result_fprint_ast(result, memstream, 0, NULL, 0) == 0);
+    fflush(memstream);
+    const char *expected = "\n"
+"@0   0..28  statement        body=@1\n"
+"@1   0..28  > deferred body  MATCH, 28 bytes\n"
+"@2  31..33  line_comment     // ;\n"
+"@3  34..55  statement        body=@4\n"
+"@4  34..55  > deferred body  CREATE, 21 bytes\n";
+    ck_assert_str_eq(memstream_buffer, expected);
+    cypher_parse_result_free(result);
+
+    size_t mid = memstream_size;
+    fputc('\n', memstream);
+    FILE *in = open_pipe_input(s);
+    result = cypher_fparse(in, &last, NULL, CYPHER_PARSE_SHALLOW);
+    close_input(in);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert(cypher_parse_result_fprint_ast(result, memstream, 0, NULL, 0) == 0);
+    fflush(memstream);
+    ck_assert_str_eq(memstream_buffer + mid, expected);
+}
+END_TEST
+
+
+TCase* shallow_tcase(void)
+{
+    TCase *tc = tcase_create("shallow");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, parse_shallow_statements);
+    tcase_add_test(tc, parse_shallow_schema_commands);
+    tcase_add_test(tc, parse_deferred_body);
+    tcase_add_test(tc, parse_shallow_unrecognized_bodies);
+    tcase_add_test(tc, parse_shallow_stream);
+    return tc;
+}
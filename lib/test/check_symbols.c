@@ -0,0 +1,181 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "../../lib/src/cypher-parser.h"
+#include <check.h>
+#include <errno.h>
+#include <unistd.h>
+
+
+static cypher_parse_result_t *result;
+
+
+static void setup(void)
+{
+    result = NULL;
+}
+
+
+static void teardown(void)
+{
+    cypher_parse_result_free(result);
+}
+
+
+static const cypher_astnode_t *find(const cypher_astnode_t *node,
+        cypher_astnode_type_t type, unsigned int *skip)
+{
+    if (cypher_astnode_instanceof(node, type) && (*skip)-- == 0)
+    {
+        return node;
+    }
+    unsigned int n = cypher_astnode_nchildren(node);
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        const cypher_astnode_t *found =
+                find(cypher_astnode_get_child(node, i), type, skip);
+        if (found != NULL)
+        {
+            return found;
+        }
+    }
+    return NULL;
+}
+
+
+static const cypher_astnode_t *nth(unsigned int directive,
+        cypher_astnode_type_t type, unsigned int skip)
+{
+    const cypher_astnode_t *node = find(
+            cypher_parse_result_get_directive(result, directive), type, &skip);
+    ck_assert_ptr_ne(node, NULL);
+    return node;
+}
+
+
+START_TEST (intern_names_in_statement)
+{
+    result = cypher_parse(
+            "MATCH (name:name)-[:name]->(x) RETURN name.name AS name, "
+            "count(x) AS x",
+            NULL, NULL, 0);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(cypher_parse_result_nerrors(result), 0);
+
+    unsigned int symbol =
+            cypher_ast_identifier_get_symbol(nth(0, CYPHER_AST_IDENTIFIER, 0));
+    ck_assert_int_ne(symbol, 0);
+    ck_assert_int_eq(cypher_ast_label_get_symbol(
+                nth(0, CYPHER_AST_LABEL, 0)), symbol);
+    ck_assert_int_eq(cypher_ast_reltype_get_symbol(
+                nth(0, CYPHER_AST_RELTYPE, 0)), symbol);
+    ck_assert_int_eq(cypher_ast_identifier_get_symbol(
+                nth(0, CYPHER_AST_IDENTIFIER, 2)), symbol);
+    ck_assert_int_eq(cypher_ast_prop_name_get_symbol(
+                nth(0, CYPHER_AST_PROP_NAME, 0)), symbol);
+    ck_assert_int_eq(cypher_ast_identifier_get_symbol(
+                nth(0, CYPHER_AST_IDENTIFIER, 3)), symbol);
+
+    const cypher_astnode_t *x = nth(0, CYPHER_AST_IDENTIFIER, 1);
+    ck_assert_str_eq(cypher_ast_identifier_get_name(x), "x");
+    unsigned int x_symbol = cypher_ast_identifier_get_symbol(x);
+    ck_assert_int_ne(x_symbol, 0);
+    ck_assert_int_ne(x_symbol, symbol);
+    ck_assert_int_eq(cypher_ast_identifier_get_symbol(
+                nth(0, CYPHER_AST_IDENTIFIER, 4)), x_symbol);
+    ck_assert_int_eq(cypher_ast_identifier_get_symbol(
+                nth(0, CYPHER_AST_IDENTIFIER, 5)), x_symbol);
+
+    unsigned int count_symbol = cypher_ast_function_name_get_symbol(
+            nth(0, CYPHER_AST_FUNCTION_NAME, 0));
+    ck_assert_int_ne(count_symbol, 0);
+    ck_assert_int_ne(count_symbol, symbol);
+    ck_assert_int_ne(count_symbol, x_symbol);
+}
+END_TEST
+
+
+START_TEST (intern_names_across_statements)
+{
+    result = cypher_parse("RETURN a, b;\nRETURN c;\nRETURN b AS a;",
+            NULL, NULL, 0);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(cypher_parse_result_ndirectives(result), 3);
+
+    unsigned int a = cypher_ast_identifier_get_symbol(
+            nth(0, CYPHER_AST_IDENTIFIER, 0));
+    unsigned int b = cypher_ast_identifier_get_symbol(
+            nth(0, CYPHER_AST_IDENTIFIER, 1));
+    unsigned int c = cypher_ast_identifier_get_symbol(
+            nth(1, CYPHER_AST_IDENTIFIER, 0));
+    ck_assert_int_ne(a, b);
+    ck_assert_int_ne(a, c);
+    ck_assert_int_ne(b, c);
+
+    const cypher_astnode_t *node = nth(2, CYPHER_AST_IDENTIFIER, 0);
+    ck_assert_str_eq(cypher_ast_identifier_get_name(node), "b");
+    ck_assert_int_eq(cypher_ast_identifier_get_symbol(node), b);
+    node = nth(2, CYPHER_AST_IDENTIFIER, 1);
+    ck_assert_str_eq(cypher_ast_identifier_get_name(node), "a");
+    ck_assert_int_eq(cypher_ast_identifier_get_symbol(node), a);
+}
+END_TEST
+
+
+START_TEST (constructed_names_have_no_symbol)
+{
+    struct cypher_input_range range = { .start = { 1, 1, 0 },
+        .end = { 1, 2, 1 } };
+    cypher_astnode_t *node = cypher_ast_label("a", 1, range);
+    ck_assert_ptr_ne(node, NULL);
+    ck_assert_str_eq(cypher_ast_label_get_name(node), "a");
+    ck_assert_int_eq(cypher_ast_label_get_symbol(node), 0);
+    cypher_ast_free(node);
+}
+END_TEST
+
+
+START_TEST (cloned_names_keep_symbol)
+{
+    result = cypher_parse("MATCH (n:Foo) RETURN n", NULL, NULL, 0);
+    ck_assert_ptr_ne(result, NULL);
+    const cypher_astnode_t *label = nth(0, CYPHER_AST_LABEL, 0);
+    unsigned int symbol = cypher_ast_label_get_symbol(label);
+    ck_assert_int_ne(symbol, 0);
+
+    cypher_astnode_t *clone = cypher_ast_clone(label);
+    ck_assert_ptr_ne(clone, NULL);
+    cypher_parse_result_free(result);
+    result = NULL;
+
+    ck_assert_str_eq(cypher_ast_label_get_name(clone), "Foo");
+    ck_assert_int_eq(cypher_ast_label_get_symbol(clone), symbol);
+    cypher_ast_free(clone);
+}
+END_TEST
+
+
+TCase* symbols_tcase(void)
+{
+    TCase *tc = tcase_create("symbols");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, intern_names_in_statement);
+    tcase_add_test(tc, intern_names_across_statements);
+    tcase_add_test(tc, constructed_names_have_no_symbol);
+    tcase_add_test(tc, cloned_names_keep_symbol);
+    return tc;
+}
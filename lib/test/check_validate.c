@@ -0,0 +1,181 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "../../lib/src/cypher-parser.h"
+#include "memstream.h"
+#include "util.h"
+#include <check.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+static const char *input =
+    "MATCH (n:Person {name: 'Bob'})-[r:KNOWS*1..3]->(m)\n"
+    "WHERE n.age > 3 < 5 RETURN [x IN [[1, 2], [3]] | x[0]];\n"
+    "/* a comment */ CREATE (n {x: 'a;b'}); // trailing\n"
+    ":help match\n"
+    "RETURN 1 +;\n"
+    "MATCH (n) WHERE n.name = \"it's\" RETRUN n;\n"
+    "RETURN [1, 2;\n"
+    "RETURN 'unterminated";
+
+
+static char *memstream_buffer;
+static size_t memstream_size;
+static FILE *memstream;
+
+
+static void setup(void)
+{
+    memstream = open_memstream(&memstream_buffer, &memstream_size);
+    fputc('\n', memstream);
+}
+
+
+static void teardown(void)
+{
+    fclose(memstream);
+    free(memstream_buffer);
+}
+
+
+static int segment_callback(void *data, cypher_parse_segment_t *segment)
+{
+    describe_segment(memstream, segment, false);
+    return 0;
+}
+
+
+static int check_no_ast(void *data, cypher_parse_segment_t *segment)
+{
+    ck_assert_ptr_eq(cypher_parse_segment_get_directive(segment), NULL);
+    ck_assert_uint_eq(cypher_parse_segment_nroots(segment), 0);
+    ck_assert_uint_eq(cypher_parse_segment_nnodes(segment), 0);
+    return segment_callback(data, segment);
+}
+
+
+static void describe(const char *s, cypher_parser_config_t *config,
+        uint_fast32_t flags)
+{
+    struct cypher_input_position last = cypher_input_position_zero;
+    ck_assert_int_eq(cypher_uparse_each(s, strlen(s),
+                (flags & CYPHER_PARSE_VALIDATE_ONLY)?
+                        check_no_ast : segment_callback,
+                NULL, &last, config, flags), 0);
+    describe_last(memstream, last);
+}
+
+
+static void assert_validated_matches_parsed(const char *s,
+        cypher_parser_config_t *config, uint_fast32_t flags)
+{
+    ASSERT_SAME_DESCRIPTION(describe(s, config, flags),
+            describe(s, config, flags | CYPHER_PARSE_VALIDATE_ONLY));
+}
+
+
+START_TEST (validate_valid_input)
+{
+    struct cypher_input_position last;
+    cypher_parse_result_t *result = cypher_parse(
+            "MATCH (n) RETURN n; :help\nRETURN 1", &last, NULL,
+            CYPHER_PARSE_VALIDATE_ONLY);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_uint_eq(cypher_parse_result_nerrors(result), 0);
+    ck_assert_uint_eq(cypher_parse_result_ndirectives(result), 0);
+    ck_assert_uint_eq(cypher_parse_result_nroots(result), 0);
+    ck_assert_uint_eq(cypher_parse_result_nnodes(result), 0);
+    ck_assert(cypher_parse_result_eof(result));
+    ck_assert_uint_eq(last.offset, 34);
+    cypher_parse_result_free(result);
+}
+END_TEST
+
+
+START_TEST (validate_reports_same_errors)
+{
+    assert_validated_matches_parsed(input, NULL, 0);
+    assert_validated_matches_parsed(input, NULL,
+            CYPHER_PARSE_ONLY_STATEMENTS);
+    assert_validated_matches_parsed(input, NULL, CYPHER_PARSE_SINGLE);
+    assert_validated_matches_parsed("", NULL, 0);
+    assert_validated_matches_parsed("  \n", NULL, 0);
+    assert_validated_matches_parsed("RETURN 1", NULL, 0);
+}
+END_TEST
+
+
+START_TEST (validate_with_config)
+{
+    cypher_parser_config_t *config = cypher_parser_new_config();
+    ck_assert_ptr_ne(config, NULL);
+    struct cypher_input_position position = { .line = 10, .column = 3,
+        .offset = 1000 };
+    cypher_parser_config_set_initial_position(config, position);
+    assert_validated_matches_parsed(input, config, 0);
+    cypher_parser_config_set_memoization(config, true);
+    assert_validated_matches_parsed(input, config, 0);
+    cypher_parser_config_set_optimistic_parsing(config, false);
+    assert_validated_matches_parsed(input, config, 0);
+    cypher_parser_config_set_arena_allocation(config, true);
+    assert_validated_matches_parsed(input, config, 0);
+    cypher_parser_config_free(config);
+}
+END_TEST
+
+
+START_TEST (validate_with_parser)
+{
+    cypher_parser_t *parser = cypher_parser_new();
+    ck_assert_ptr_ne(parser, NULL);
+    cypher_parse_result_t *expected = cypher_parser_parse(parser, input,
+            NULL, NULL, 0);
+    ck_assert_ptr_ne(expected, NULL);
+    cypher_parse_result_t *result = cypher_parser_parse(parser, input,
+            NULL, NULL, CYPHER_PARSE_VALIDATE_ONLY);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_uint_eq(cypher_parse_result_ndirectives(result), 0);
+    ck_assert_uint_eq(cypher_parse_result_nerrors(result),
+            cypher_parse_result_nerrors(expected));
+    ck_assert_uint_gt(cypher_parse_result_nerrors(result), 0);
+    cypher_parse_result_free(result);
+
+    // the parser constructs an AST again once the flag is not set
+    result = cypher_parser_parse(parser, input, NULL, NULL, 0);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_uint_eq(cypher_parse_result_ndirectives(result),
+            cypher_parse_result_ndirectives(expected));
+    cypher_parse_result_free(result);
+    cypher_parse_result_free(expected);
+    cypher_parser_free(parser);
+}
+END_TEST
+
+
+TCase* validate_tcase(void)
+{
+    TCase *tc = tcase_create("validate");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, validate_valid_input);
+    tcase_add_test(tc, validate_reports_same_errors);
+    tcase_add_test(tc, validate_with_config);
+    tcase_add_test(tc, validate_with_parser);
+    return tc;
+}
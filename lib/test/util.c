@@ -0,0 +1,125 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "util.h"
+#include <check.h>
+#include <string.h>
+#include <unistd.h>
+
+
+void describe_last(FILE *stream, struct cypher_input_position last)
+{
+    fprintf(stream, "last: %u:%u@%zu\n", last.line, last.column, last.offset);
+}
+
+
+void describe_error(FILE *stream, const cypher_parse_error_t *error)
+{
+    struct cypher_input_position pos = cypher_parse_error_position(error);
+    fprintf(stream, "error: %u:%u@%zu %s\n%s\n%zu\n", pos.line, pos.column,
+            pos.offset, cypher_parse_error_message(error),
+            cypher_parse_error_context(error),
+            cypher_parse_error_context_offset(error));
+}
+
+
+void describe_result(FILE *stream, const cypher_parse_result_t *result)
+{
+    ck_assert_ptr_ne(result, NULL);
+    fprintf(stream, "nodes: %u, directives: %u, eof: %d\n",
+            cypher_parse_result_nnodes(result),
+            cypher_parse_result_ndirectives(result),
+            cypher_parse_result_eof(result));
+    ck_assert(cypher_parse_result_fprint_ast(result, stream, 0, NULL, 0) == 0);
+    unsigned int nerrors = cypher_parse_result_nerrors(result);
+    for (unsigned int i = 0; i < nerrors; ++i)
+    {
+        describe_error(stream, cypher_parse_result_get_error(result, i));
+    }
+}
+
+
+void describe_segment(FILE *stream, const cypher_parse_segment_t *segment,
+        bool ast)
+{
+    struct cypher_input_range range = cypher_parse_segment_get_range(segment);
+    fprintf(stream, "segment: %u:%u@%zu..%u:%u@%zu, eof: %d\n",
+            range.start.line, range.start.column, range.start.offset,
+            range.end.line, range.end.column, range.end.offset,
+            cypher_parse_segment_is_eof(segment));
+    if (ast)
+    {
+        fprintf(stream, "nodes: %u\n", cypher_parse_segment_nnodes(segment));
+        ck_assert(cypher_parse_segment_fprint_ast(segment, stream, 0,
+                    NULL, 0) == 0);
+    }
+    unsigned int nerrors = cypher_parse_segment_nerrors(segment);
+    for (unsigned int i = 0; i < nerrors; ++i)
+    {
+        describe_error(stream, cypher_parse_segment_get_error(segment, i));
+    }
+}
+
+
+void assert_same_descriptions(const char *buffer, size_t start, size_t mid,
+        size_t end)
+{
+    ck_assert_msg(end - mid == mid - start &&
+            memcmp(buffer + start, buffer + mid, mid - start) == 0,
+            "Descriptions differ:\n%.*s\n----\n%.*s",
+            (int)(mid - start), buffer + start,
+            (int)(end - mid), buffer + mid);
+}
+
+
+FILE *open_pipe_input(const char *s)
+{
+    int fds[2];
+    ck_assert(pipe(fds) == 0);
+    FILE *out = fdopen(fds[1], "w");
+    ck_assert_ptr_ne(out, NULL);
+    fputs(s, out);
+    ck_assert(fclose(out) == 0);
+    FILE *in = fdopen(fds[0], "r");
+    ck_assert_ptr_ne(in, NULL);
+    return in;
+}
+
+
+FILE *open_file_input(const char *s, size_t n)
+{
+    FILE *in = tmpfile();
+    ck_assert_ptr_ne(in, NULL);
+    ck_assert_uint_eq(fwrite(s, 1, n, in), n);
+    rewind(in);
+    return in;
+}
+
+
+void close_input(FILE *stream)
+{
+    fclose(stream);
+}
+
+
+void write_file(const char *path, const char *s)
+{
+    FILE *stream = fopen(path, "w");
+    ck_assert_ptr_ne(stream, NULL);
+    fputs(s, stream);
+    ck_assert(fclose(stream) == 0);
+}
@@ -0,0 +1,136 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CYPHER_PARSER_TEST_UTIL_H
+#define CYPHER_PARSER_TEST_UTIL_H
+
+#include "../../lib/src/cypher-parser.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+/*
+ * Descriptions of parses, for checking that two ways of parsing the same
+ * input give the same results. Descriptions are written to the memstream of
+ * a test, one after the other, and then compared (see
+ * ASSERT_SAME_DESCRIPTION()).
+ */
+
+/**
+ * Describe the position of the last character consumed from the input.
+ *
+ * @param [stream] The stream to write to.
+ * @param [last] The position.
+ */
+void describe_last(FILE *stream, struct cypher_input_position last);
+
+/**
+ * Describe a parse error: its position, message and context.
+ *
+ * @param [stream] The stream to write to.
+ * @param [error] The error.
+ */
+void describe_error(FILE *stream, const cypher_parse_error_t *error);
+
+/**
+ * Describe a parse result: the numbers of nodes and directives, whether the
+ * end of input was reached, the AST and all errors.
+ *
+ * @param [stream] The stream to write to.
+ * @param [result] The result.
+ */
+void describe_result(FILE *stream, const cypher_parse_result_t *result);
+
+/**
+ * Describe a parsed segment: its range, whether it reaches the end of input,
+ * and all errors, optionally preceded by the number of nodes and the AST.
+ *
+ * @param [stream] The stream to write to.
+ * @param [segment] The segment.
+ * @param [ast] Whether to describe the number of nodes and the AST.
+ */
+void describe_segment(FILE *stream, const cypher_parse_segment_t *segment,
+        bool ast);
+
+/**
+ * Check two consecutive descriptions written to a memstream are the same.
+ *
+ * @param [buffer] The buffer of the memstream (after it has been flushed).
+ * @param [start] The offset of the start of the first description.
+ * @param [mid] The offset of the end of the first description, and the start
+ *         of the second.
+ * @param [end] The offset of the end of the second description.
+ */
+void assert_same_descriptions(const char *buffer, size_t start, size_t mid,
+        size_t end);
+
+/**
+ * Check the descriptions written by two statements are the same.
+ *
+ * The descriptions are written to the memstream of the calling test, which
+ * must be named `memstream` (with `memstream_buffer` and `memstream_size`).
+ */
+#define ASSERT_SAME_DESCRIPTION(first, second) \
+    do { \
+        fflush(memstream); \
+        size_t _start = memstream_size; \
+        first; \
+        fflush(memstream); \
+        size_t _mid = memstream_size; \
+        second; \
+        fflush(memstream); \
+        assert_same_descriptions(memstream_buffer, _start, _mid, \
+                memstream_size); \
+    } while (0)
+
+/*
+ * Input streams. As memstream.h may redefine fclose() to close the memstream
+ * of a test, other streams are opened and closed by these helpers.
+ */
+
+/**
+ * Open a stream that reads the given input from a pipe, and so cannot be
+ * mapped, seeked or read ahead of the parser.
+ *
+ * @param [s] The input, which must fit within the buffer of a pipe.
+ * @return The stream.
+ */
+FILE *open_pipe_input(const char *s);
+
+/**
+ * Open a stream that reads the given input from a temporary file.
+ *
+ * @param [s] The input.
+ * @param [n] The length of the input.
+ * @return The stream.
+ */
+FILE *open_file_input(const char *s, size_t n);
+
+/**
+ * Close an input stream.
+ *
+ * @param [stream] The stream.
+ */
+void close_input(FILE *stream);
+
+/**
+ * Replace the contents of a file.
+ *
+ * @param [path] The path of the file.
+ * @param [s] The new contents of the file.
+ */
+void write_file(const char *path, const char *s);
+
+#endif/*CYPHER_PARSER_TEST_UTIL_H*/
@@ -82,16 +82,18 @@ struct lint_config
     bool colorize_output;
     bool colorize_errors;
     bool stream;
+    cypher_parser_t *parser;
 };
 
 
-static int process(FILE *stream, const char *filename,
+static int process(FILE *stream, const char *path, const char *filename,
         struct lint_config *config);
-static int process_streamed(FILE *stream, const char *filename,
-        struct lint_config *config, cypher_parser_config_t *cp_config,
+static int process_streamed(FILE *stream, const char *path,
+        const char *filename, struct lint_config *config,
+        cypher_parser_config_t *cp_config,
         const struct cypher_parser_colorization *error_colorization,
         const struct cypher_parser_colorization *output_colorization);
-static int process_all(FILE *stream, const char *filename,
+static int process_all(FILE *stream, const char *path, const char *filename,
         struct lint_config *config, cypher_parser_config_t *cp_config,
         const struct cypher_parser_colorization *error_colorization,
         const struct cypher_parser_colorization *output_colorization);
@@ -211,10 +213,19 @@ int main(int argc, char *argv[])
     argc -= optind;
     argv += optind;
 
-    // Always stream if ast dumping is disabled
+    // Always stream, and skip constructing the AST, if dumping is disabled
     if (!config.dump_ast)
     {
         config.stream = true;
+        config.flags |= CYPHER_PARSE_VALIDATE_ONLY;
+    }
+
+    // Reuse a single parser for all inputs
+    config.parser = cypher_parser_new();
+    if (config.parser == NULL)
+    {
+        perror("cypher_parser_new");
+        goto cleanup;
     }
 
     if (argc > 0)
@@ -225,23 +236,17 @@ int main(int argc, char *argv[])
             int res;
             if (strcmp(*argv, "-") == 0)
             {
-                res = process(stdin, "<stdin>", &config);
+                res = process(stdin, NULL, "<stdin>", &config);
             }
             else
             {
-                FILE *stream = fopen(*argv, "r");
-                if (stream == NULL)
+                res = process(NULL, *argv, *argv, &config);
+                if (res < 0)
                 {
                     fprintf(stderr, "%s: %s: %s\n", prog_name, *argv,
                             strerror(errno));
                     goto cleanup;
                 }
-                res = process(stream, *argv, &config);
-                if (res < 0)
-                {
-                    goto cleanup;
-                }
-                fclose(stream);
             }
             err |= res;
         }
@@ -252,7 +257,7 @@ int main(int argc, char *argv[])
     }
     else
     {
-        if (process(stdin, NULL, &config))
+        if (process(stdin, NULL, NULL, &config))
         {
             goto cleanup;
         }
@@ -261,11 +266,16 @@ int main(int argc, char *argv[])
     result = EXIT_SUCCESS;
 
 cleanup:
+    cypher_parser_free(config.parser);
     return result;
 }
 
 
-int process(FILE *stream, const char *filename, struct lint_config *config)
+/*
+ * Process input from a stream, or if `path` is not NULL, from the named file.
+ */
+int process(FILE *stream, const char *path, const char *filename,
+        struct lint_config *config)
 {
     cypher_parser_config_t *cp_config = cypher_parser_new_config();
     if (cp_config == NULL)
@@ -286,9 +296,9 @@ int process(FILE *stream, const char *filename, struct lint_config *config)
         config->colorize_output? cypher_parser_ansi_colorization : NULL;
 
     int err = (config->stream)?
-        process_streamed(stream, filename, config, cp_config,
+        process_streamed(stream, path, filename, config, cp_config,
               error_colorization, output_colorization) :
-        process_all(stream, filename, config, cp_config,
+        process_all(stream, path, filename, config, cp_config,
               error_colorization, output_colorization);
 
     int errsv = errno;
@@ -308,8 +318,9 @@ struct parse_callback_data
 };
 
 
-int process_streamed(FILE *stream, const char *filename,
-        struct lint_config *config, cypher_parser_config_t *cp_config,
+int process_streamed(FILE *stream, const char *path,
+        const char *filename, struct lint_config *config,
+        cypher_parser_config_t *cp_config,
         const struct cypher_parser_colorization *error_colorization,
         const struct cypher_parser_colorization *output_colorization)
 {
@@ -321,10 +332,20 @@ int process_streamed(FILE *stream, const char *filename,
           .nerrors = 0
         };
 
-    if (cypher_fparse_each(stream, parse_callback, &callback_data, NULL,
-                cp_config, config->flags))
+    if (path != NULL)
     {
-        perror("cypher_fparse_each");
+        if (cypher_parser_parse_file_each(config->parser, path,
+                    parse_callback, &callback_data, NULL, cp_config,
+                    config->flags))
+        {
+            return -1;
+        }
+    }
+    else if (cypher_parser_fparse_each(config->parser, stream,
+                parse_callback, &callback_data, NULL, cp_config,
+                config->flags))
+    {
+        perror("cypher_parser_fparse_each");
         return -1;
     }
 
@@ -358,17 +379,30 @@ int parse_callback(void *data, cypher_parse_segment_t *segment)
 }
 
 
-int process_all(FILE *stream, const char *filename,
+int process_all(FILE *stream, const char *path, const char *filename,
         struct lint_config *config, cypher_parser_config_t *cp_config,
         const struct cypher_parser_colorization *error_colorization,
         const struct cypher_parser_colorization *output_colorization)
 {
-    cypher_parse_result_t *result =
-            cypher_fparse(stream, NULL, cp_config, config->flags);
-    if (result == NULL)
+    cypher_parse_result_t *result;
+    if (path != NULL)
     {
-        perror("cypher_fparse");
-        return -1;
+        result = cypher_parser_parse_file(config->parser, path, NULL,
+                cp_config, config->flags);
+        if (result == NULL)
+        {
+            return -1;
+        }
+    }
+    else
+    {
+        result = cypher_parser_fparse(config->parser, stream, NULL,
+                cp_config, config->flags);
+        if (result == NULL)
+        {
+            perror("cypher_parser_fparse");
+            return -1;
+        }
     }
 
     int err = -1;